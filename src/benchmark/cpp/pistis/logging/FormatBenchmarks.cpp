@@ -0,0 +1,49 @@
+#include <pistis/logging/LogMacros.hpp>
+#include <pistis/logging/LogMessagePool.hpp>
+#include <benchmark/benchmark.h>
+
+#include "helpers/AllocationCounter.hpp"
+#include "helpers/BenchmarkLog.hpp"
+#include "helpers/ReleasingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+namespace {
+  void reportAllocations(benchmark::State& state, uint64_t numAllocations) {
+    state.counters["allocs/stmt"] =
+      benchmark::Counter((double)numAllocations,
+			 benchmark::Counter::kAvgIterations);
+  }
+}
+
+static void BM_FormatStatement(benchmark::State& state) {
+  LogMessagePool pool(256, 65536, 65536, 4, 16);
+  ReleasingLogMessageReceiver receiver(&pool);
+  BenchmarkLog log(&pool, &receiver, "benchmark.destination", LogLevel::INFO);
+  int64_t n= 0;
+
+  uint64_t startingAllocations= AllocationCounter::numAllocations();
+  for (auto _ : state) {
+    log.info(PISTIS_FMT("Request {} completed in {} us"), n, 250);
+    ++n;
+  }
+  reportAllocations(state,
+		    AllocationCounter::numAllocations() - startingAllocations);
+}
+BENCHMARK(BM_FormatStatement);
+
+static void BM_DeferredStatement(benchmark::State& state) {
+  LogMessagePool pool(256, 65536, 65536, 4, 16);
+  ReleasingLogMessageReceiver receiver(&pool);
+  BenchmarkLog log(&pool, &receiver, "benchmark.destination", LogLevel::INFO);
+  int64_t n= 0;
+
+  uint64_t startingAllocations= AllocationCounter::numAllocations();
+  for (auto _ : state) {
+    PISTIS_INFO_DEFERRED(log, "Request {} completed in {} us")(n, 250);
+    ++n;
+  }
+  reportAllocations(state,
+		    AllocationCounter::numAllocations() - startingAllocations);
+}
+BENCHMARK(BM_DeferredStatement);
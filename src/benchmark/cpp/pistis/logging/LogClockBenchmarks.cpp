@@ -0,0 +1,36 @@
+#include <pistis/logging/LogClock.hpp>
+#include <benchmark/benchmark.h>
+
+using namespace pistis::logging;
+
+// Cost of stamping one message with each clock source.  The argument is
+// the LogClockSource.
+
+static void BM_LogClockNow(benchmark::State& state) {
+  const LogClockSource source= (LogClockSource)state.range(0);
+  LogClock::calibrate();
+  state.SetLabel(toString(source));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LogClock::now(source));
+  }
+}
+BENCHMARK(BM_LogClockNow)
+    ->Arg((int)LogClockSource::TSC)
+    ->Arg((int)LogClockSource::COARSE)
+    ->Arg((int)LogClockSource::REALTIME);
+
+// Cost of converting a timestamp to wall time, which receivers pay
+static void BM_LogClockToNanoseconds(benchmark::State& state) {
+  const LogClockSource source= (LogClockSource)state.range(0);
+  const LogTimestamp timestamp= LogClock::now(source);
+  LogClock::calibrate();
+  state.SetLabel(toString(source));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LogClock::toNanoseconds(timestamp));
+  }
+}
+BENCHMARK(BM_LogClockToNanoseconds)
+    ->Arg((int)LogClockSource::TSC)
+    ->Arg((int)LogClockSource::REALTIME);
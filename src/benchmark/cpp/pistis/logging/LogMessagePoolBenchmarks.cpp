@@ -0,0 +1,100 @@
+#include <pistis/logging/CachingLogMessagePool.hpp>
+#include <pistis/logging/LogMessagePool.hpp>
+#include <pistis/logging/ShardedLogMessagePool.hpp>
+#include <benchmark/benchmark.h>
+#include <thread>
+
+#include "helpers/MutexLogMessagePool.hpp"
+
+using namespace pistis::logging;
+
+// Each thread gets a few messages from a shared pool and releases them,
+// as producers and the writer thread do under load.  Compares the
+// lock-free LogMessagePool with the mutex-guarded pool it replaced and
+// with CachingLogMessagePool, which keeps each thread off the shared pool.
+// ShardedLogMessagePool runs once per shard policy, and reports how many
+// gets had to leave the caller's shard and how many nodes the machine has.
+
+namespace {
+  const size_t MESSAGES_PER_ITERATION= 4;
+
+  template <typename Pool>
+  Pool& sharedPool() {
+    static Pool* pool= new Pool(256, 65536, 65536, 16, 64);
+    return *pool;
+  }
+
+  template <>
+  CachingLogMessagePool& sharedPool<CachingLogMessagePool>() {
+    static CachingLogMessagePool* pool=
+        new CachingLogMessagePool(256, 65536, 65536, 16, 64, 32);
+    return *pool;
+  }
+
+  ShardedLogMessagePool& shardedPool(LogShardPolicy policy) {
+    static ShardedLogMessagePool* perNode=
+        new ShardedLogMessagePool(256, 65536, 65536, 16, 64,
+				  LogShardPolicy::PER_NODE);
+    static ShardedLogMessagePool* perCpu=
+        new ShardedLogMessagePool(256, 65536, 65536, 16, 64,
+				  LogShardPolicy::PER_CPU);
+    return (policy == LogShardPolicy::PER_CPU) ? *perCpu : *perNode;
+  }
+
+  // glibc skips atomic operations when locking a mutex until a process
+  // starts its first thread, which would flatter the mutex-guarded pool
+  // in the single-threaded runs
+  const bool STARTED_THREAD= (std::thread([]() { }).join(), true);
+}
+
+template <typename Pool>
+static void BM_PoolGetAndRelease(benchmark::State& state) {
+  Pool& pool= sharedPool<Pool>();
+  LogMessage* msgs[MESSAGES_PER_ITERATION];
+
+  for (auto _ : state) {
+    for (size_t i= 0; i < MESSAGES_PER_ITERATION; ++i) {
+      msgs[i]= pool.get();
+    }
+    for (size_t i= 0; i < MESSAGES_PER_ITERATION; ++i) {
+      pool.release(msgs[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * MESSAGES_PER_ITERATION);
+}
+BENCHMARK_TEMPLATE(BM_PoolGetAndRelease, MutexLogMessagePool)
+    ->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PoolGetAndRelease, LogMessagePool)
+    ->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PoolGetAndRelease, CachingLogMessagePool)
+    ->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_ShardedPoolGetAndRelease(benchmark::State& state) {
+  const LogShardPolicy policy= (LogShardPolicy)state.range(0);
+  ShardedLogMessagePool& pool= shardedPool(policy);
+  const uint64_t remoteGetsBefore= pool.numRemoteGets();
+  LogMessage* msgs[MESSAGES_PER_ITERATION];
+
+  for (auto _ : state) {
+    for (size_t i= 0; i < MESSAGES_PER_ITERATION; ++i) {
+      msgs[i]= pool.get();
+    }
+    for (size_t i= 0; i < MESSAGES_PER_ITERATION; ++i) {
+      pool.release(msgs[i]);
+    }
+  }
+
+  const uint64_t numGets= state.iterations() * MESSAGES_PER_ITERATION;
+  state.SetItemsProcessed(numGets);
+  if (state.thread_index() == 0) {
+    // Remote gets by every thread, so only the first thread reports them
+    state.counters["remote_gets"]=
+        (double)(pool.numRemoteGets() - remoteGetsBefore) /
+	(double)(numGets * state.threads());
+    state.counters["nodes"]= pool.topology().numNodes();
+    state.counters["shards"]= pool.numShards();
+  }
+}
+BENCHMARK(BM_ShardedPoolGetAndRelease)
+    ->Arg((int)LogShardPolicy::PER_NODE)->Arg((int)LogShardPolicy::PER_CPU)
+    ->ThreadRange(1, 64)->UseRealTime();
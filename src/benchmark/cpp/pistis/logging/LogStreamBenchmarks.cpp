@@ -0,0 +1,187 @@
+#include <pistis/logging/FanOutLogMessageReceiver.hpp>
+#include <pistis/logging/LogMacros.hpp>
+#include <pistis/logging/LogMessagePool.hpp>
+#include <benchmark/benchmark.h>
+#include <string.h>
+
+#include "helpers/AllocationCounter.hpp"
+#include "helpers/BenchmarkLog.hpp"
+#include "helpers/ReleasingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+namespace {
+  void reportAllocations(benchmark::State& state, uint64_t numAllocations) {
+    state.counters["allocs/stmt"] =
+      benchmark::Counter((double)numAllocations,
+			 benchmark::Counter::kAvgIterations);
+  }
+
+  /** @brief Sends a copy of each message to every receiver but the
+   *         first, which is how fan-out works without shared messages
+   */
+  class CopyingFanOutReceiver : public LogMessageReceiver {
+  public:
+    CopyingFanOutReceiver(LogMessageFactory* factory,
+			  const std::vector<LogMessageReceiver*>& receivers):
+        factory_(factory), receivers_(receivers) {
+      // Intentionally left blank
+    }
+
+    virtual void receive(LogMessage* msg) {
+      for (size_t i= 1; i < receivers_.size(); ++i) {
+	LogMessage* copy= factory_->get();
+	copy->increaseCapacity(msg->size());
+	memcpy(copy->begin(), msg->begin(), msg->size());
+	copy->setEnd(copy->begin() + msg->size());
+	copy->setDestination(msg->destinationHandle());
+	copy->setLogLevel(msg->logLevel());
+	receivers_[i]->receive(copy);
+      }
+      receivers_[0]->receive(msg);
+    }
+
+  private:
+    LogMessageFactory* factory_;
+    std::vector<LogMessageReceiver*> receivers_;
+  };
+}
+
+static void BM_LogStatement(benchmark::State& state) {
+  LogMessagePool pool(256, 65536, 65536, 4, 16);
+  ReleasingLogMessageReceiver receiver(&pool);
+  BenchmarkLog log(&pool, &receiver, "benchmark.destination", LogLevel::INFO);
+  int64_t n= 0;
+
+  uint64_t startingAllocations= AllocationCounter::numAllocations();
+  for (auto _ : state) {
+    log.info() << "Request " << n << " completed in " << 250 << " us";
+    ++n;
+  }
+  reportAllocations(state,
+		    AllocationCounter::numAllocations() - startingAllocations);
+}
+BENCHMARK(BM_LogStatement);
+
+static void BM_StructuredLogStatement(benchmark::State& state) {
+  LogMessagePool pool(256, 65536, 65536, 4, 16);
+  ReleasingLogMessageReceiver receiver(&pool);
+  BenchmarkLog log(&pool, &receiver, "benchmark.destination", LogLevel::INFO);
+  int64_t n= 0;
+
+  uint64_t startingAllocations= AllocationCounter::numAllocations();
+  for (auto _ : state) {
+    log.info().kv("request", n).kv("latency_us", 250) << "Request completed";
+    ++n;
+  }
+  reportAllocations(state,
+		    AllocationCounter::numAllocations() - startingAllocations);
+}
+BENCHMARK(BM_StructuredLogStatement);
+
+static void BM_WideLogStatement(benchmark::State& state) {
+  LogMessagePool pool(256, 65536, 65536, 4, 16);
+  ReleasingLogMessageReceiver receiver(&pool);
+  BenchmarkLog log(&pool, &receiver, "benchmark.destination", LogLevel::INFO);
+  int64_t n= 0;
+
+  uint64_t startingAllocations= AllocationCounter::numAllocations();
+  for (auto _ : state) {
+    log.winfo() << L"Request " << n << L" from the accounts service "
+		<< L"completed in " << 250 << L" \u00b5s";
+    ++n;
+  }
+  reportAllocations(state,
+		    AllocationCounter::numAllocations() - startingAllocations);
+}
+BENCHMARK(BM_WideLogStatement);
+
+// A 16k diagnostic dump, written to messages that grow (argument 0) or
+// to segmented messages (argument 1)
+static void BM_LargeLogStatement(benchmark::State& state) {
+  LogMessagePool pool(256, 65536, 65536, 4, 256);
+  pool.setSegmented(state.range(0) != 0);
+  ReleasingLogMessageReceiver receiver(&pool);
+  BenchmarkLog log(&pool, &receiver, "benchmark.destination", LogLevel::INFO);
+  const std::string line(63, 'x');
+
+  uint64_t startingAllocations= AllocationCounter::numAllocations();
+  for (auto _ : state) {
+    auto out= log.info();
+    for (int i= 0; i < 256; ++i) {
+      out << line << '\n';
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * 256 * 64);
+  reportAllocations(state,
+		    AllocationCounter::numAllocations() - startingAllocations);
+}
+BENCHMARK(BM_LargeLogStatement)->Arg(0)->Arg(1);
+
+static void BM_DisabledLogStatement(benchmark::State& state) {
+  LogMessagePool pool(256, 65536, 65536, 4, 16);
+  ReleasingLogMessageReceiver receiver(&pool);
+  BenchmarkLog log(&pool, &receiver, "benchmark.destination", LogLevel::INFO);
+  int64_t n= 0;
+
+  uint64_t startingAllocations= AllocationCounter::numAllocations();
+  for (auto _ : state) {
+    log.debug() << "Request " << n << " completed in " << 250 << " us";
+    ++n;
+  }
+  reportAllocations(state,
+		    AllocationCounter::numAllocations() - startingAllocations);
+}
+BENCHMARK(BM_DisabledLogStatement);
+
+static void BM_DisabledLogMacro(benchmark::State& state) {
+  LogMessagePool pool(256, 65536, 65536, 4, 16);
+  ReleasingLogMessageReceiver receiver(&pool);
+  BenchmarkLog log(&pool, &receiver, "benchmark.destination", LogLevel::INFO);
+  int64_t n= 0;
+
+  for (auto _ : state) {
+    PISTIS_DEBUG(log) << "Request " << n << " completed in " << 250 << " us";
+    ++n;
+  }
+  benchmark::DoNotOptimize(n);
+}
+BENCHMARK(BM_DisabledLogMacro);
+
+static void BM_RateLimitedLogMacro(benchmark::State& state) {
+  LogMessagePool pool(256, 65536, 65536, 4, 16);
+  ReleasingLogMessageReceiver receiver(&pool);
+  BenchmarkLog log(&pool, &receiver, "benchmark.destination", LogLevel::INFO);
+  int64_t n= 0;
+
+  // Nearly every statement is suppressed, as in an error storm
+  for (auto _ : state) {
+    PISTIS_LOG_RATE_LIMITED(log, LogLevel::ERROR, 10)
+        << "Request " << n << " failed";
+    ++n;
+  }
+  benchmark::DoNotOptimize(n);
+}
+BENCHMARK(BM_RateLimitedLogMacro)->ThreadRange(1, 4);
+
+// A 1k statement sent to three receivers by copying it for each extra
+// receiver (argument 0) or by sharing it (argument 1)
+static void BM_FanOut(benchmark::State& state) {
+  LogMessagePool pool(2048, 2048, 2048, 4, 16);
+  ReleasingLogMessageReceiver first(&pool);
+  ReleasingLogMessageReceiver second(&pool);
+  ReleasingLogMessageReceiver third(&pool);
+  const std::vector<LogMessageReceiver*> receivers{ &first, &second, &third };
+  CopyingFanOutReceiver copying(&pool, receivers);
+  FanOutLogMessageReceiver sharing(receivers);
+  LogMessageReceiver* receiver= state.range(0) ? (LogMessageReceiver*)&sharing
+                                               : (LogMessageReceiver*)&copying;
+  BenchmarkLog log(&pool, receiver, "benchmark.destination", LogLevel::INFO);
+  const std::string text(1024, 'x');
+
+  for (auto _ : state) {
+    log.info() << text;
+  }
+  state.SetBytesProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_FanOut)->Arg(0)->Arg(1);
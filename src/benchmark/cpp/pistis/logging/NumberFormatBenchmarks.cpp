@@ -0,0 +1,100 @@
+#include <pistis/logging/LogMessagePool.hpp>
+#include <pistis/logging/LogStream.hpp>
+#include <benchmark/benchmark.h>
+#include <ostream>
+
+#include "helpers/ReleasingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+// Each pair of benchmarks writes the same values to a LogStream, which
+// formats numbers itself, and to a std::ostream over a LogStreamBuffer,
+// which formats them with std::num_put.  The stream stays open across
+// iterations so the numbers dominate; messages are sent as they fill.
+
+namespace {
+  const std::string DESTINATION("benchmark.destination");
+
+  template <typename NextValueT>
+  void writeToLogStream(benchmark::State& state, NextValueT nextValue) {
+    LogMessagePool pool(65536, 65536, 65536, 4, 16);
+    ReleasingLogMessageReceiver receiver(&pool);
+    LogStream<char> out(pool, receiver, DESTINATION, LogLevel::INFO, true);
+    uint64_t i= 0;
+
+    for (auto _ : state) {
+      out << nextValue(i++) << ' ';
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  template <typename NextValueT>
+  void writeToOstream(benchmark::State& state, NextValueT nextValue) {
+    LogMessagePool pool(65536, 65536, 65536, 4, 16);
+    ReleasingLogMessageReceiver receiver(&pool);
+    LogStreamBuffer<char> buffer(pool, receiver, DESTINATION, LogLevel::INFO);
+    std::ostream out(&buffer);
+    uint64_t i= 0;
+
+    for (auto _ : state) {
+      out << nextValue(i++) << ' ';
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  int64_t nextInt64(uint64_t i) {
+    return (int64_t)(i * 0x9E3779B97F4A7C15ULL) >> (i & 63);
+  }
+
+  uint32_t nextUInt32(uint64_t i) {
+    return (uint32_t)(i * 2654435761U) >> (i & 31);
+  }
+
+  double nextDouble(uint64_t i) {
+    return (double)nextInt64(i) / 1024.0;
+  }
+
+  const void* nextPointer(uint64_t i) {
+    return (const void*)(uintptr_t)(0x7F0000000000ULL + i * 64);
+  }
+}
+
+static void BM_LogStreamInt64(benchmark::State& state) {
+  writeToLogStream(state, nextInt64);
+}
+BENCHMARK(BM_LogStreamInt64);
+
+static void BM_OstreamInt64(benchmark::State& state) {
+  writeToOstream(state, nextInt64);
+}
+BENCHMARK(BM_OstreamInt64);
+
+static void BM_LogStreamUInt32(benchmark::State& state) {
+  writeToLogStream(state, nextUInt32);
+}
+BENCHMARK(BM_LogStreamUInt32);
+
+static void BM_OstreamUInt32(benchmark::State& state) {
+  writeToOstream(state, nextUInt32);
+}
+BENCHMARK(BM_OstreamUInt32);
+
+static void BM_LogStreamDouble(benchmark::State& state) {
+  writeToLogStream(state, nextDouble);
+}
+BENCHMARK(BM_LogStreamDouble);
+
+static void BM_OstreamDouble(benchmark::State& state) {
+  writeToOstream(state, nextDouble);
+}
+BENCHMARK(BM_OstreamDouble);
+
+static void BM_LogStreamPointer(benchmark::State& state) {
+  writeToLogStream(state, nextPointer);
+}
+BENCHMARK(BM_LogStreamPointer);
+
+static void BM_OstreamPointer(benchmark::State& state) {
+  writeToOstream(state, nextPointer);
+}
+BENCHMARK(BM_OstreamPointer);
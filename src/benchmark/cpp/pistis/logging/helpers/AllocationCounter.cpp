@@ -0,0 +1,30 @@
+#include "AllocationCounter.hpp"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+using namespace pistis::logging;
+
+namespace {
+  std::atomic<uint64_t> numAllocations_(0);
+
+  void* allocate_(size_t n) {
+    numAllocations_.fetch_add(1, std::memory_order_relaxed);
+    void* p= malloc(n ? n : 1);
+    if (!p) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+}
+
+uint64_t AllocationCounter::numAllocations() {
+  return numAllocations_.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t n) { return allocate_(n); }
+void* operator new[](size_t n) { return allocate_(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
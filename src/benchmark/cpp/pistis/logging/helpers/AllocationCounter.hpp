@@ -0,0 +1,24 @@
+#ifndef __PISTIS__LOGGING__HELPERS__ALLOCATIONCOUNTER_HPP__
+#define __PISTIS__LOGGING__HELPERS__ALLOCATIONCOUNTER_HPP__
+
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Counts calls to the global operator new.
+     *
+     *  The benchmark executable replaces the global operator new and
+     *  operator delete with versions that increment a counter before
+     *  delegating to malloc() and free().  Benchmarks use the counter to
+     *  report the number of allocations made per iteration.
+     */
+    class AllocationCounter {
+    public:
+      /** @brief Total number of allocations made by the process so far */
+      static uint64_t numAllocations();
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,24 @@
+#ifndef __PISTIS__LOGGING__HELPERS__BENCHMARKLOG_HPP__
+#define __PISTIS__LOGGING__HELPERS__BENCHMARKLOG_HPP__
+
+#include <pistis/logging/Log.hpp>
+
+namespace pistis {
+  namespace logging {
+
+    class BenchmarkLog : public Log {
+    public:
+      BenchmarkLog(LogMessageFactory* msgFactory,
+		   LogMessageReceiver* msgReceiver,
+		   const std::string& destination,
+		   LogLevel logLevel):
+	  Log(msgFactory, msgReceiver, destination, logLevel) {
+	// Intentionally left blank
+      }
+
+      void setLogLevel(LogLevel l) { setLogLevel_(l); }
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,35 @@
+#include "BenchmarkLogFactoryImpl.hpp"
+
+using namespace pistis::logging;
+
+BenchmarkLogFactoryImpl::BenchmarkLogFactoryImpl():
+    logs_(), msgFactory_(256, 65536, 65536, 16, 64),
+    msgReceiver_(&msgFactory_), sync_() {
+  // Intentionally left blank
+}
+
+BenchmarkLogFactoryImpl::~BenchmarkLogFactoryImpl() {
+  // Intentionally left blank
+}
+
+BenchmarkLog* BenchmarkLogFactoryImpl::getLog(const std::string& destination) {
+  std::unique_lock<std::mutex> lock(sync_);
+  auto i= logs_.find(destination);
+  if (i != logs_.end()) {
+    return i->second.get();
+  }
+  BenchmarkLog* l= new BenchmarkLog(&msgFactory_, &msgReceiver_, destination,
+				    LogLevel::INFO);
+  logs_[destination].reset(l);
+  return l;
+}
+
+void BenchmarkLogFactoryImpl::setLogLevel(const std::string& destination,
+					  LogLevel logLevel) {
+  BenchmarkLog* l= getLog(destination);
+  l->setLogLevel(logLevel);
+}
+
+LogFactoryImpl* pistis::logging::createLogFactoryImpl() {
+  return new BenchmarkLogFactoryImpl;
+}
@@ -0,0 +1,43 @@
+#ifndef __PISTIS__LOGGING__HELPERS__BENCHMARKLOGFACTORYIMPL_HPP__
+#define __PISTIS__LOGGING__HELPERS__BENCHMARKLOGFACTORYIMPL_HPP__
+
+#include <pistis/logging/LogFactoryImpl.hpp>
+#include <pistis/logging/LogMessagePool.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "BenchmarkLog.hpp"
+#include "ReleasingLogMessageReceiver.hpp"
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Minimal logging implementation that discards every message.
+     *
+     *  The library expects the application to supply
+     *  createLogFactoryImpl(), so the benchmarks provide one.  Benchmarks
+     *  that measure a particular factory or receiver construct their own
+     *  instead of going through the LogFactory.
+     */
+    class BenchmarkLogFactoryImpl : public LogFactoryImpl {
+    public:
+      BenchmarkLogFactoryImpl();
+      virtual ~BenchmarkLogFactoryImpl();
+
+      virtual BenchmarkLog* getLog(const std::string& destination);
+      virtual void setLogLevel(const std::string& destination,
+			       LogLevel logLevel);
+
+    private:
+      std::map<std::string, std::unique_ptr<BenchmarkLog> > logs_;
+      LogMessagePool msgFactory_;
+      ReleasingLogMessageReceiver msgReceiver_;
+      std::mutex sync_;
+    };
+
+    LogFactoryImpl* createLogFactoryImpl();
+
+  }
+}
+#endif
@@ -0,0 +1,53 @@
+#include "MutexLogMessagePool.hpp"
+
+using namespace pistis::logging;
+
+MutexLogMessagePool::MutexLogMessagePool(size_t initialMessageSize,
+					 size_t maxMessageSize,
+					 size_t maxReturnedMessageSize,
+					 uint32_t initialPoolSize,
+					 uint32_t maxPoolSize):
+    initialMessageSize_(initialMessageSize), maxMessageSize_(maxMessageSize),
+    maxReturnedMessageSize_(maxReturnedMessageSize), maxPoolSize_(maxPoolSize),
+    pool_(), sync_() {
+  pool_.reserve(initialPoolSize);
+  while (pool_.size() < initialPoolSize) {
+    pool_.push_back(LogMessage::create(initialMessageSize_, maxMessageSize_));
+  }
+}
+
+MutexLogMessagePool::~MutexLogMessagePool() {
+  for (auto msg : pool_) {
+    LogMessage::destroy(msg);
+  }
+}
+
+LogMessage* MutexLogMessagePool::get_() {
+  {
+    std::unique_lock<std::mutex> lock(sync_);
+    if (!pool_.empty()) {
+      LogMessage* msg= pool_.back();
+      pool_.pop_back();
+      msg->setEnd(msg->begin());
+      msg->setEncoding(LogMessageEncoding::TEXT);
+      msg->setSourceLocation(LogSourceLocation());
+      msg->setTimestamp(LogTimestamp());
+      msg->setThread(LogThreadInfo());
+      msg->setPart(0, 0, true);
+      msg->clearFields();
+      return msg;
+    }
+  }
+  return LogMessage::create(initialMessageSize_, maxMessageSize_);
+}
+
+void MutexLogMessagePool::release_(LogMessage* msg) {
+  if (msg->capacity() <= maxReturnedMessageSize_) {
+    std::unique_lock<std::mutex> lock(sync_);
+    if (pool_.size() < maxPoolSize_) {
+      pool_.push_back(msg);
+      return;
+    }
+  }
+  LogMessage::destroy(msg);
+}
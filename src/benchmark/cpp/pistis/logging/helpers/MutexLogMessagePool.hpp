@@ -0,0 +1,38 @@
+#ifndef __PISTIS__LOGGING__HELPERS__MUTEXLOGMESSAGEPOOL_HPP__
+#define __PISTIS__LOGGING__HELPERS__MUTEXLOGMESSAGEPOOL_HPP__
+
+#include <pistis/logging/AbstractLogMessageFactory.hpp>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief The pool LogMessagePool replaced, which guards a vector of
+     *         messages with a mutex.  Kept as a baseline for the pool
+     *         benchmarks.
+     */
+    class MutexLogMessagePool : public AbstractLogMessageFactory {
+    public:
+      MutexLogMessagePool(size_t initialMessageSize, size_t maxMessageSize,
+			  size_t maxReturnedMessageSize,
+			  uint32_t initialPoolSize, uint32_t maxPoolSize);
+      virtual ~MutexLogMessagePool();
+
+    protected:
+      virtual LogMessage* get_();
+      virtual void release_(LogMessage* msg);
+
+    private:
+      size_t initialMessageSize_;
+      size_t maxMessageSize_;
+      size_t maxReturnedMessageSize_;
+      size_t maxPoolSize_;
+      std::vector<LogMessage*> pool_;
+      std::mutex sync_;
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,18 @@
+#include "ReleasingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+ReleasingLogMessageReceiver::ReleasingLogMessageReceiver(
+    LogMessageFactory* factory
+):
+    factory_(factory), numReceived_(0), numBytesReceived_(0) {
+  // Intentionally left blank
+}
+
+void ReleasingLogMessageReceiver::receive(LogMessage* msg) {
+  if (msg) {
+    ++numReceived_;
+    numBytesReceived_ += msg->size();
+    factory_->release(msg);
+  }
+}
@@ -0,0 +1,31 @@
+#ifndef __PISTIS__LOGGING__HELPERS__RELEASINGLOGMESSAGERECEIVER_HPP__
+#define __PISTIS__LOGGING__HELPERS__RELEASINGLOGMESSAGERECEIVER_HPP__
+
+#include <pistis/logging/LogMessageFactory.hpp>
+#include <pistis/logging/LogMessageReceiver.hpp>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Counts the messages it receives and returns them to their
+     *         factory immediately.
+     */
+    class ReleasingLogMessageReceiver : public LogMessageReceiver {
+    public:
+      ReleasingLogMessageReceiver(LogMessageFactory* factory);
+
+      uint64_t numReceived() const { return numReceived_; }
+      uint64_t numBytesReceived() const { return numBytesReceived_; }
+
+      virtual void receive(LogMessage* msg);
+
+    private:
+      LogMessageFactory* factory_;
+      uint64_t numReceived_;
+      uint64_t numBytesReceived_;
+    };
+
+  }
+}
+#endif
@@ -1,45 +1,101 @@
 #include "AbstractLogMessageFactory.hpp"
-#include <thread>
+#include <condition_variable>
+#include <mutex>
 
 using namespace pistis::logging;
 
-const std::chrono::milliseconds AbstractLogMessageFactory::SPIN_DELAY_(100);
+namespace {
+  /** @brief Threads in waitUntilAllReturned(), on any factory.
+   *
+   *  release() may still be waking them after the factory it returned
+   *  the last message to is gone, so they are kept apart from every
+   *  factory, and never destroyed.
+   */
+  struct AllReturnedWaiters {
+    std::atomic<size_t> numWaiting;
+    std::mutex sync;
+    std::condition_variable allReturned;
+
+    AllReturnedWaiters(): numWaiting(0), sync(), allReturned() {
+      // Intentionally left blank
+    }
+  };
+
+  AllReturnedWaiters& allReturnedWaiters() {
+    static AllReturnedWaiters* waiters= new AllReturnedWaiters();
+    return *waiters;
+  }
+}
 
 AbstractLogMessageFactory::AbstractLogMessageFactory():
-    numMessagesActive_(0), numWaitingUntilAllReturned_(0) {
+    numMessagesActive_(0), numWaitingUntilAllReturned_(0),
+    segmented_(false) {
 }
 
 LogMessage* AbstractLogMessageFactory::get() {
   LogMessage* msg= get_();
-  ++numMessagesActive_;
+  messageIssued_();
+  return msg;
+}
+
+LogMessage* AbstractLogMessageFactory::get(size_t sizeHint) {
+  LogMessage* msg= get_(sizeHint);
+  messageIssued_();
   return msg;
 }
 
 
 void AbstractLogMessageFactory::release(LogMessage* msg) {
-  if (msg) {
+  if (msg && !msg->removeReference()) {
+    return;  // Someone else still holds the message
+  }
+
+  while (msg) {
+    LogMessage* next= msg->detachSegments();
     release_(msg);
-    --numMessagesActive_;
+    messageReturned_();
+    msg= next;
+  }
+
+  // The factory may be gone by now.  A waiter registers before it reads
+  // the count, and this reads the number of waiters after counting the
+  // message, so either this sees the waiter or the waiter sees the
+  // message returned.  Every waiter wakes to check its own factory.
+  AllReturnedWaiters& waiters= allReturnedWaiters();
+  if (waiters.numWaiting.load(std::memory_order_seq_cst)) {
+    std::unique_lock<std::mutex> lock(waiters.sync);
+    waiters.allReturned.notify_all();
   }
 }
 
 bool AbstractLogMessageFactory::waitUntilAllReturned(
     const std::chrono::system_clock::time_point& deadline
 ) {
-  size_t numActive = numMessagesActive();
-  if (numActive) {
-    ++numWaitingUntilAllReturned_;
-    // Since the typical usage pattern acquires a message and returns it
-    // within a relatively short period of time, and because
-    // waitUntilAllReturned() is typically called as part of shutdown code,
-    // spinning until the condition is true is tolerable.
-    while ((std::chrono::system_clock::now() < deadline) && numActive) {
-      std::this_thread::sleep_until(
-          std::chrono::system_clock::now() + SPIN_DELAY_
-      );
-      numActive = numMessagesActive();
+  if (!numMessagesActive()) {
+    return true;
+  }
+
+  // The default deadline means wait for as long as it takes
+  const bool hasDeadline=
+      deadline != std::chrono::system_clock::time_point();
+  AllReturnedWaiters& waiters= allReturnedWaiters();
+  std::unique_lock<std::mutex> lock(waiters.sync);
+  waiters.numWaiting.fetch_add(1, std::memory_order_seq_cst);
+  numWaitingUntilAllReturned_.fetch_add(1, std::memory_order_seq_cst);
+
+  size_t numActive= numMessagesActive();
+  bool timedOut= false;
+  while (numActive && !timedOut) {
+    if (hasDeadline) {
+      timedOut= waiters.allReturned.wait_until(lock, deadline) ==
+	            std::cv_status::timeout;
+    } else {
+      waiters.allReturned.wait(lock);
     }
-    --numWaitingUntilAllReturned_;
+    numActive= numMessagesActive();
   }
+
+  numWaitingUntilAllReturned_.fetch_sub(1, std::memory_order_seq_cst);
+  waiters.numWaiting.fetch_sub(1, std::memory_order_seq_cst);
   return !numActive;
 }
@@ -14,9 +14,7 @@ namespace pistis {
       /** @brief Returns the number of messages created by get() but not yet
        *           returned to the factory by release().
        */
-      size_t numMessagesActive() const {
-	return numMessagesActive_.load(std::memory_order_acquire);
-      }
+      size_t numMessagesActive() const { return countMessagesActive_(); }
 
       /** @brief Returns the number of threads waiting until all messages
        *           have been returned to the factory.
@@ -25,14 +23,35 @@ namespace pistis {
 	return numWaitingUntilAllReturned_.load(std::memory_order_acquire);
       }
 
+      virtual bool segmented() const override { return segmented_; }
+
+      /** @brief Make writers chain segments onto messages from this
+       *         factory instead of growing them.
+       *
+       *  Should be called before any messages are obtained from the
+       *  factory, and only if every receiver reads segments.
+       */
+      void setSegmented(bool segmented) { segmented_ = segmented; }
+
       /** @brief Obtain a new LogMessage */
       virtual LogMessage* get();
 
+      /** @brief Obtain a new LogMessage for a write of about
+       *         <tt>sizeHint</tt> bytes
+       */
+      virtual LogMessage* get(size_t sizeHint);
+
       /** @brief Return a LogMessage to the factory
        *
        *  Applications should not delete messages themselves, but must call
        *  this method when done using a message.  The log factory may
-       *  elect to reuse messages rather than deleting them.
+       *  elect to reuse messages rather than deleting them.  The
+       *  message's segments, if any, are released along with it.  If
+       *  the message is shared, each holder calls release() once, and
+       *  only the call that gives up the last reference returns the
+       *  message to the factory and counts it as no longer active.
+       *
+       *  @see LogMessage::addReferences()
        */
       virtual void release(LogMessage* msg);
 
@@ -42,6 +61,21 @@ namespace pistis {
        *  This message is typically called when the logging system shuts
        *  down to wait until all threads currently writing a log messag
        *  have completed their task.
+       *
+       *  Waiting threads sleep until a release() wakes them, so they
+       *  return as soon as the factory is drained.  A release() counts
+       *  its message as returned before it checks for waiters, and a
+       *  waiter says it is waiting before it checks the count, so one
+       *  always sees the other.  The waiters, and what wakes them, are
+       *  shared by all factories and outlive them, so release() is done
+       *  with the factory once it counts the message, and the factory
+       *  may be destroyed as soon as this returns true.  release() only
+       *  reads how many threads are waiting, so it costs one atomic read
+       *  more when no one is.
+       *
+       *  @param deadline  Time to wait until, or
+       *                     std::chrono::system_clock::time_point() to
+       *                     wait indefinitely
        */
       virtual bool waitUntilAllReturned(
           const std::chrono::system_clock::time_point& deadline
@@ -50,8 +84,36 @@ namespace pistis {
     protected:
       AbstractLogMessageFactory();
       virtual LogMessage* get_() = 0;
+
+      /** @brief Obtain a message for get(sizeHint).  Ignores the hint
+       *         unless overridden.
+       */
+      virtual LogMessage* get_(size_t /*sizeHint*/) { return get_(); }
       virtual void release_(LogMessage* msg) = 0;
 
+      /** @brief Record that get() issued a message.
+       *
+       *  Factories that keep their own counts, e.g. one per thread so
+       *  getting and releasing never share a counter between threads,
+       *  override this, messageReturned_() and countMessagesActive_()
+       *  together.  Returns must be counted with sequentially consistent
+       *  writes, and countMessagesActive_() must read them the same way.
+       */
+      virtual void messageIssued_() { ++numMessagesActive_; }
+
+      /** @brief Record that release() returned a message.
+       *
+       *  Called after release_() has filed the message.  The factory
+       *  may be destroyed as soon as the count shows every message
+       *  returned, so counting must be the last thing this does.
+       */
+      virtual void messageReturned_() { --numMessagesActive_; }
+
+      /** @brief Number of messages issued but not yet returned */
+      virtual size_t countMessagesActive_() const {
+	return numMessagesActive_.load(std::memory_order_seq_cst);
+      }
+
     private:
       /** @brief Number of messages allocated by the factory but not yet
        *          released.
@@ -63,10 +125,8 @@ namespace pistis {
        */
       std::atomic_uint_fast64_t numWaitingUntilAllReturned_;
 
-      /** @brief How much time to spend between checks for all messages to
-       *         return to the factory in waitUntilAllReturned()
-       */
-      static const std::chrono::milliseconds SPIN_DELAY_;
+      /** @brief Whether writers chain segments onto full messages */
+      bool segmented_;
     };
     
   }
@@ -0,0 +1,143 @@
+#include "BinaryLogMessage.hpp"
+#include "FormatArgEncoding.hpp"
+#include <algorithm>
+#include <streambuf>
+#include <string.h>
+
+using namespace pistis::logging;
+
+namespace {
+  /** @brief Appends bytes to a LogMessage, growing it as needed, and
+   *         remembers whether anything failed to fit.
+   */
+  class BinaryWriter : public std::streambuf {
+  public:
+    BinaryWriter(LogMessage& msg):
+        msg_(msg), end_(msg.begin()), eos_(msg.eos()), ok_(true) {
+      // Intentionally left blank
+    }
+
+    bool ok() const { return ok_; }
+    size_t size() const { return (size_t)(end_ - msg_.begin()); }
+
+    void write(const void* data, size_t n) {
+      if (((size_t)(eos_ - end_) >= n) || grow_(n)) {
+	memcpy(end_, data, n);
+	end_ += n;
+      }
+    }
+
+    /** @brief Overwrite bytes already written, starting at
+     *         <tt>offset</tt>
+     */
+    void writeAt(size_t offset, const void* data, size_t n) {
+      if (ok_) {
+	memcpy(msg_.begin() + offset, data, n);
+      }
+    }
+
+    void finish() { msg_.setEnd(end_); }
+
+  protected:
+    virtual std::streamsize xsputn(const char* data, std::streamsize n) {
+      write(data, (size_t)n);
+      return n;
+    }
+
+    virtual int_type overflow(int_type c= traits_type::eof()) {
+      if (!traits_type::eq_int_type(c, traits_type::eof())) {
+	const char ch= traits_type::to_char_type(c);
+	write(&ch, 1);
+      }
+      return traits_type::not_eof(c);
+    }
+
+  private:
+    LogMessage& msg_;
+    char* end_;
+    char* eos_;
+    bool ok_;
+
+    bool grow_(size_t n) {
+      const size_t target= size() + n;
+      if (ok_ && (target <= msg_.maxCapacity())) {
+	size_t newCapacity= std::max(msg_.capacity(), (size_t)1);
+	while (newCapacity < target) {
+	  newCapacity *= 2;
+	}
+	msg_.setEnd(end_);
+	msg_.increaseCapacity(newCapacity);
+	end_= msg_.end();
+	eos_= msg_.eos();
+	return true;
+      }
+      ok_= false;
+      return false;
+    }
+  };
+}
+
+bool pistis::logging::writeBinaryLogMessage(LogMessage& msg,
+					    const LogSite& site,
+					    const FormatArg* args,
+					    size_t numArgs) {
+  BinaryWriter out(msg);
+  const LogSite* sitePtr= &site;
+
+  out.write(&sitePtr, sizeof(sitePtr));
+  for (const FormatArg* arg= args; arg != args + numArgs; ++arg) {
+    writeEncodedFormatArg(out, *arg);
+  }
+  out.finish();
+  msg.setEncoding(LogMessageEncoding::BINARY);
+  return out.ok();
+}
+
+BinaryLogDecoder::BinaryLogDecoder(): siteIds_(), args_() {
+  // Intentionally left blank
+}
+
+const LogSite* BinaryLogDecoder::siteOf(const LogMessage& msg) {
+  if (msg.encoding() != LogMessageEncoding::BINARY) {
+    return nullptr;
+  }
+  EncodedFormatArgReader in(msg.begin(), msg.end());
+  const LogSite* site= in.read<const LogSite*>();
+  return in.ok() ? site : nullptr;
+}
+
+uint32_t BinaryLogDecoder::registerSite(const LogSite& site) {
+  return siteIds_.emplace(&site, (uint32_t)siteIds_.size()).first->second;
+}
+
+bool BinaryLogDecoder::write(const LogMessage& msg, LogMessageWriter& out) {
+  if (msg.encoding() != LogMessageEncoding::BINARY) {
+    return false;
+  }
+
+  EncodedFormatArgReader in(msg.begin(), msg.end());
+  const LogSite* site= in.read<const LogSite*>();
+
+  args_.clear();
+  while (in.ok() && !in.atEnd()) {
+    args_.push_back(in.readFormatArg());
+  }
+
+  if (!in.ok() || !site) {
+    return false;
+  }
+  out.format(site->format(), args_.data(), args_.size());
+  return true;
+}
+
+void BinaryLogDecoder::writeDictionaryEntry(const LogSite& site,
+					    LogMessageWriter& out) {
+  const FormatArg args[]= {
+    FormatArg(registerSite(site)), FormatArg(toString(site.logLevel())),
+    FormatArg(site.file()), FormatArg(site.line()), FormatArg(site.format())
+  };
+  // Write the format string verbatim rather than as a format string, so
+  // it looks the same as it does in the source code
+  out.format("{} {} {}:{} ", args, 4);
+  out.write(args[4]);
+}
@@ -0,0 +1,100 @@
+#ifndef __PISTIS__LOGGING__BINARYLOGMESSAGE_HPP__
+#define __PISTIS__LOGGING__BINARYLOGMESSAGE_HPP__
+
+#include <pistis/logging/FormatArg.hpp>
+#include <pistis/logging/LogMessage.hpp>
+#include <pistis/logging/LogMessageWriter.hpp>
+#include <pistis/logging/LogSite.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Write a LogSite and its arguments into <tt>msg</tt> without
+     *         formatting them.
+     *
+     *  Replaces the contents of <tt>msg</tt> with the address of
+     *  <tt>site</tt> followed by each argument's type and value, and
+     *  marks <tt>msg</tt> as LogMessageEncoding::BINARY.  Numbers are
+     *  copied as they are, strings are copied byte for byte and values of
+     *  any other type are formatted with their operator<< right away,
+     *  since the objects themselves may be gone by the time the message
+     *  is decoded.  BinaryLogDecoder turns the message back into text.
+     *
+     *  @param msg      Message to write to
+     *  @param site     The statement being logged
+     *  @param args     The statement's arguments
+     *  @param numArgs  Number of arguments in <tt>args</tt>
+     *  @returns True if the message was written.  False if the arguments
+     *           will not fit in a message of <tt>msg</tt>'s maximum
+     *           capacity, in which case the contents of <tt>msg</tt> are
+     *           unspecified.
+     */
+    bool writeBinaryLogMessage(LogMessage& msg, const LogSite& site,
+			       const FormatArg* args, size_t numArgs);
+
+    /** @brief Formats messages written by writeBinaryLogMessage().
+     *
+     *  The decoder also assigns each LogSite it is asked about a small
+     *  integer id, in the order it first sees them, so that sites can be
+     *  written out once as a dictionary and referred to by id afterwards.
+     *  Decoders are not thread-safe.  They are meant to be used by the
+     *  single thread that writes messages out, not by the threads that
+     *  create them.
+     */
+    class BinaryLogDecoder {
+    public:
+      BinaryLogDecoder();
+      BinaryLogDecoder(const BinaryLogDecoder&)= delete;
+
+      /** @brief Returns the LogSite a binary message refers to, or
+       *         nullptr if <tt>msg</tt> is not a valid binary message
+       */
+      static const LogSite* siteOf(const LogMessage& msg);
+
+      /** @brief Returns true if registerSite() has been called for
+       *         <tt>site</tt>
+       */
+      bool isRegistered(const LogSite& site) const {
+	return siteIds_.find(&site) != siteIds_.end();
+      }
+
+      /** @brief Returns the id of <tt>site</tt>, assigning it the next
+       *         available id if it does not have one yet.
+       */
+      uint32_t registerSite(const LogSite& site);
+
+      /** @brief Number of sites registered so far */
+      size_t numSites() const { return siteIds_.size(); }
+
+      /** @brief Write the text of a binary message to <tt>out</tt>
+       *
+       *  @returns True if <tt>msg</tt> was decoded successfully.  False if
+       *           it is not a valid binary message, in which case nothing
+       *           is written.
+       */
+      bool write(const LogMessage& msg, LogMessageWriter& out);
+
+      /** @brief Write a description of <tt>site</tt> to <tt>out</tt>
+       *
+       *  The description has the form
+       *  "<id> <level> <file>:<line> <format>", with the format string
+       *  written as it appears in the source.
+       */
+      void writeDictionaryEntry(const LogSite& site, LogMessageWriter& out);
+
+      BinaryLogDecoder& operator=(const BinaryLogDecoder&)= delete;
+
+    private:
+      std::unordered_map<const LogSite*, uint32_t> siteIds_;
+
+      /** @brief Reused between calls to write() to hold the decoded
+       *         arguments
+       */
+      std::vector<FormatArg> args_;
+    };
+
+  }
+}
+#endif
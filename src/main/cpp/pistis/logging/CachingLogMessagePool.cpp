@@ -0,0 +1,438 @@
+#include "CachingLogMessagePool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
+using namespace pistis::logging;
+
+namespace {
+  std::atomic<uint64_t> nextPoolId(1);
+
+  /** @brief Pools that have not been destroyed, by id, so an exiting
+   *         thread knows which of its caches it can still hand back
+   */
+  class LivePools {
+  public:
+    LivePools(): pools_(), sync_() { }
+
+    std::mutex& sync() { return sync_; }
+
+    CachingLogMessagePool* find(uint64_t id) const {
+      auto i= pools_.find(id);
+      return (i == pools_.end()) ? nullptr : i->second;
+    }
+
+    void add(uint64_t id, CachingLogMessagePool* pool) {
+      std::unique_lock<std::mutex> lock(sync_);
+      pools_[id]= pool;
+    }
+
+    void remove(uint64_t id) {
+      std::unique_lock<std::mutex> lock(sync_);
+      pools_.erase(id);
+    }
+
+  private:
+    std::unordered_map<uint64_t, CachingLogMessagePool*> pools_;
+    std::mutex sync_;
+  };
+
+  LivePools& livePools() {
+    static LivePools* pools= new LivePools();
+    return *pools;
+  }
+
+  const size_t CACHE_LINE_SIZE= 64;
+}
+
+/** @brief The messages a thread keeps to itself.
+ *
+ *  Only the owning thread touches <tt>messages</tt> and
+ *  <tt>pending</tt> and writes the counts.  Other threads only push
+ *  onto <tt>returned</tt>, which lives on a cache line of its own.
+ */
+struct CachingLogMessagePool::ThreadCache_ {
+  /** @brief Messages released on this thread that belong to another,
+   *         chained newest first, waiting to go back to it in one step
+   */
+  struct Batch {
+    ThreadCache_* owner;
+    LogMessage* head;
+    LogMessage* tail;
+    size_t size;
+  };
+
+  char leadingPad[CACHE_LINE_SIZE];
+  std::vector<LogMessage*> messages;
+  std::vector<Batch> pending;
+  size_t numPending;
+  std::atomic<uint64_t> numIssued;
+  std::atomic<uint64_t> numReturned;
+
+  /** @brief Whether the thread that owned the cache has exited.
+   *         Guarded by the pool's cachesSync_.
+   */
+  bool orphaned;
+  char returnedPad[CACHE_LINE_SIZE];
+  std::atomic<LogMessage*> returned;
+  char trailingPad[CACHE_LINE_SIZE - sizeof(std::atomic<LogMessage*>)];
+
+  ThreadCache_(size_t size):
+      messages(), pending(), numPending(0), numIssued(0), numReturned(0),
+      orphaned(false), returned(nullptr) {
+    messages.reserve(size + 1);
+  }
+
+  /** @brief Take the messages other threads have returned, oldest last */
+  LogMessage* takeReturned() {
+    return returned.exchange(nullptr, std::memory_order_acquire);
+  }
+
+  /** @brief Put a chain of messages from another thread in front of
+   *         <tt>returned</tt> with a single compare-and-swap
+   */
+  void pushReturned(LogMessage* head, LogMessage* tail) {
+    LogMessage* top= returned.load(std::memory_order_relaxed);
+    do {
+      tail->detachSegments();
+      if (top) {
+	tail->appendSegment(top);
+      }
+    } while (!returned.compare_exchange_weak(top, head,
+					     std::memory_order_release,
+					     std::memory_order_relaxed));
+  }
+
+  void countIssued() {
+    numIssued.store(numIssued.load(std::memory_order_relaxed) + 1,
+		    std::memory_order_relaxed);
+  }
+
+  void countReturned() {
+    // Sequentially consistent, so a thread that starts waiting for the
+    // pool to drain either sees the count or is seen by release()
+    numReturned.store(numReturned.load(std::memory_order_relaxed) + 1,
+		      std::memory_order_seq_cst);
+  }
+};
+
+/** @brief The caches a thread has in every pool it has used */
+struct CachingLogMessagePool::ThreadCacheSet_ {
+  uint64_t lastPoolId;
+  ThreadCache_* lastCache;
+  std::vector< std::pair<uint64_t, ThreadCache_*> > caches;
+
+  ThreadCacheSet_(): lastPoolId(0), lastCache(nullptr), caches() { }
+
+  ~ThreadCacheSet_() {
+    std::unique_lock<std::mutex> lock(livePools().sync());
+    for (const auto& cache : caches) {
+      CachingLogMessagePool* pool= livePools().find(cache.first);
+      if (pool) {
+	pool->abandon_(cache.second);
+      }
+    }
+  }
+};
+
+CachingLogMessagePool::CachingLogMessagePool(size_t initialMessageSize,
+					     size_t maxMessageSize,
+					     size_t maxReturnedMessageSize,
+					     uint32_t initialPoolSize,
+					     uint32_t maxPoolSize,
+					     uint32_t threadCacheSize,
+					     LogMemoryResource* resource):
+    CachingLogMessagePool(initialMessageSize, maxMessageSize,
+			  maxReturnedMessageSize, initialPoolSize,
+			  LogPoolSizingPolicy::fixed(maxPoolSize),
+			  threadCacheSize, resource) {
+  // Intentionally left blank
+}
+
+CachingLogMessagePool::CachingLogMessagePool(
+    size_t initialMessageSize, size_t maxMessageSize,
+    size_t maxReturnedMessageSize, uint32_t initialPoolSize,
+    const LogPoolSizingPolicy& sizingPolicy, uint32_t threadCacheSize,
+    LogMemoryResource* resource
+):
+    LogMessagePool(initialMessageSize, maxMessageSize,
+		   maxReturnedMessageSize, initialPoolSize, sizingPolicy,
+		   resource),
+    id_(nextPoolId.fetch_add(1, std::memory_order_relaxed)),
+    threadCacheSize_(threadCacheSize),
+    batchSize_(std::max(threadCacheSize / 2, (uint32_t)1)),
+    caches_(), cachesSync_() {
+  livePools().add(id_, this);
+}
+
+CachingLogMessagePool::~CachingLogMessagePool() {
+  // Once the pool is gone from livePools, exiting threads leave its
+  // caches alone
+  livePools().remove(id_);
+  for (auto& cache : caches_) {
+    destroyMessages_(cache.get());
+  }
+}
+
+size_t CachingLogMessagePool::numThreadCaches() const {
+  std::unique_lock<std::mutex> lock(cachesSync_);
+  return caches_.size();
+}
+
+LogMessage* CachingLogMessagePool::get_() {
+  ThreadCache_* cache= localCache_();
+  if (cache->messages.empty()) {
+    refill_(cache);
+  }
+
+  LogMessage* msg;
+  if (cache->messages.empty()) {
+    // Settle for a larger message before allocating a new one
+    msg= popMessage_();
+    if (!msg) {
+      recordMiss_(0);
+      msg= createMessage_();
+    }
+  } else {
+    msg= cache->messages.back();
+    cache->messages.pop_back();
+    resetMessage_(msg);
+  }
+  msg->setFactoryTag(cache);
+  cache->countIssued();
+  return msg;
+}
+
+LogMessage* CachingLogMessagePool::get_(size_t sizeHint) {
+  if (sizeHint <= sizeClassCapacity(0)) {
+    return get_();
+  }
+
+  ThreadCache_* cache= localCache_();
+  LogMessage* msg= LogMessagePool::get_(sizeHint);
+  msg->setFactoryTag(cache);
+  cache->countIssued();
+  return msg;
+}
+
+void CachingLogMessagePool::release_(LogMessage* msg) {
+  ThreadCache_* cache= localCache_();
+  ThreadCache_* owner= static_cast<ThreadCache_*>(msg->factoryTag());
+
+  if (sizeClassOf(msg->capacity())) {
+    // Too large for the thread caches
+    LogMessagePool::release_(msg);
+  } else if (!owner || (owner == cache)) {
+    cache->messages.push_back(msg);
+    if (cache->messages.size() > threadCacheSize_) {
+      drain_(cache, cache->messages.size() - threadCacheSize_ / 2);
+    }
+  } else {
+    giveBack_(cache, owner, msg);
+  }
+}
+
+void CachingLogMessagePool::messageIssued_() {
+  // Counted by get_(), which already has the thread's cache at hand
+}
+
+void CachingLogMessagePool::messageReturned_() {
+  // Only now that release_() has filed the message.  As soon as the
+  // count shows every message returned, the pool may be destroyed
+  localCache_()->countReturned();
+}
+
+size_t CachingLogMessagePool::countMessagesActive_() const {
+  std::unique_lock<std::mutex> lock(cachesSync_);
+  uint64_t numIssued= 0;
+  uint64_t numReturned= 0;
+  // Sum the returns first, so every return counted has its issue
+  // counted too, even if another thread issued it
+  for (const auto& cache : caches_) {
+    numReturned += cache->numReturned.load(std::memory_order_seq_cst);
+  }
+  for (const auto& cache : caches_) {
+    numIssued += cache->numIssued.load(std::memory_order_relaxed);
+  }
+  return (size_t)(numIssued - numReturned);
+}
+
+size_t CachingLogMessagePool::numThreadCacheEntries_() {
+  return threadCaches_().caches.size();
+}
+
+size_t CachingLogMessagePool::numMessagesInThreadCache_() {
+  return localCache_()->messages.size();
+}
+
+CachingLogMessagePool::ThreadCacheSet_&
+    CachingLogMessagePool::threadCaches_() {
+  static thread_local ThreadCacheSet_ caches;
+  return caches;
+}
+
+CachingLogMessagePool::ThreadCache_* CachingLogMessagePool::localCache_() {
+  ThreadCacheSet_& caches= threadCaches_();
+  if (caches.lastPoolId == id_) {
+    return caches.lastCache;
+  }
+  return findCache_(caches);
+}
+
+CachingLogMessagePool::ThreadCache_* CachingLogMessagePool::findCache_(
+    ThreadCacheSet_& caches
+) {
+  auto i= std::find_if(caches.caches.begin(), caches.caches.end(),
+		       [this](const std::pair<uint64_t, ThreadCache_*>& c) {
+			 return c.first == id_;
+		       });
+  ThreadCache_* cache;
+  if (i != caches.caches.end()) {
+    cache= i->second;
+  } else {
+    pruneCaches_(caches);
+    cache= adoptOrCreateCache_();
+    caches.caches.emplace_back(id_, cache);
+  }
+  caches.lastPoolId= id_;
+  caches.lastCache= cache;
+  return cache;
+}
+
+void CachingLogMessagePool::pruneCaches_(ThreadCacheSet_& caches) {
+  // Pool ids are never reused, so a thread that has not seen this pool
+  // before is the first chance to forget pools destroyed since
+  std::unique_lock<std::mutex> lock(livePools().sync());
+  auto end= std::remove_if(
+      caches.caches.begin(), caches.caches.end(),
+      [](const std::pair<uint64_t, ThreadCache_*>& c) {
+	return !livePools().find(c.first);
+      }
+  );
+  caches.caches.erase(end, caches.caches.end());
+}
+
+CachingLogMessagePool::ThreadCache_*
+    CachingLogMessagePool::adoptOrCreateCache_() {
+  std::unique_lock<std::mutex> lock(cachesSync_);
+  for (auto& cache : caches_) {
+    if (cache->orphaned) {
+      cache->orphaned= false;
+      return cache.get();
+    }
+  }
+  caches_.emplace_back(new ThreadCache_(threadCacheSize_));
+  return caches_.back().get();
+}
+
+void CachingLogMessagePool::giveBack_(ThreadCache_* cache,
+				      ThreadCache_* owner, LogMessage* msg) {
+  auto i= std::find_if(cache->pending.begin(), cache->pending.end(),
+		       [owner](const ThreadCache_::Batch& b) {
+			 return b.owner == owner;
+		       });
+  if (i == cache->pending.end()) {
+    cache->pending.push_back(ThreadCache_::Batch{ owner, nullptr, msg, 0 });
+    i= cache->pending.end() - 1;
+  }
+
+  msg->detachSegments();
+  if (i->head) {
+    msg->appendSegment(i->head);
+  }
+  i->head= msg;
+  ++i->size;
+  ++cache->numPending;
+
+  if (i->size >= batchSize_) {
+    i->owner->pushReturned(i->head, i->tail);
+    cache->numPending -= i->size;
+    *i= cache->pending.back();
+    cache->pending.pop_back();
+  } else if (cache->numPending > threadCacheSize_) {
+    // Too many owners to fill a batch for each of them
+    flushPending_(cache);
+  }
+}
+
+void CachingLogMessagePool::flushPending_(ThreadCache_* cache) {
+  for (const auto& batch : cache->pending) {
+    batch.owner->pushReturned(batch.head, batch.tail);
+  }
+  cache->pending.clear();
+  cache->numPending= 0;
+}
+
+void CachingLogMessagePool::refill_(ThreadCache_* cache) {
+  flushPending_(cache);
+
+  LogMessage* msg= cache->takeReturned();
+  while (msg) {
+    LogMessage* next= msg->detachSegments();
+    if (cache->messages.size() < threadCacheSize_) {
+      cache->messages.push_back(msg);
+    } else if (!pushMessage_(msg)) {
+      releaseMessage_(msg);
+    }
+    msg= next;
+  }
+
+  while (cache->messages.size() < batchSize_) {
+    msg= popMessageOfClass_(0);
+    if (!msg) {
+      break;
+    }
+    cache->messages.push_back(msg);
+  }
+}
+
+void CachingLogMessagePool::drain_(ThreadCache_* cache, size_t n) {
+  // The oldest messages are the least likely to still be in the cache
+  auto end= cache->messages.begin() + n;
+  for (auto i= cache->messages.begin(); i != end; ++i) {
+    if (!pushMessage_(*i)) {
+      releaseMessage_(*i);
+    }
+  }
+  cache->messages.erase(cache->messages.begin(), end);
+}
+
+void CachingLogMessagePool::abandon_(ThreadCache_* cache) {
+  flushPending_(cache);
+  drain_(cache, cache->messages.size());
+  std::unique_lock<std::mutex> lock(cachesSync_);
+  cache->orphaned= true;
+}
+
+void CachingLogMessagePool::destroyMessages_(ThreadCache_* cache) {
+  for (auto msg : cache->messages) {
+    releaseMessage_(msg);
+  }
+  cache->messages.clear();
+
+  for (const auto& batch : cache->pending) {
+    releaseChain_(batch.head);
+  }
+  cache->pending.clear();
+  cache->numPending= 0;
+
+  releaseChain_(cache->takeReturned());
+}
+
+void CachingLogMessagePool::releaseChain_(LogMessage* msg) {
+  while (msg) {
+    LogMessage* next= msg->detachSegments();
+    releaseMessage_(msg);
+    msg= next;
+  }
+}
+
+size_t CachingLogMessagePool::numMessagesReturnedToThread_() {
+  ThreadCache_* cache= localCache_();
+  size_t n= 0;
+  for (LogMessage* msg= cache->returned.load(std::memory_order_acquire);
+       msg; msg= msg->nextSegment()) {
+    ++n;
+  }
+  return n;
+}
@@ -0,0 +1,126 @@
+#ifndef __PISTIS__LOGGING__CACHINGLOGMESSAGEPOOL_HPP__
+#define __PISTIS__LOGGING__CACHINGLOGMESSAGEPOOL_HPP__
+
+#include <pistis/logging/LogMessagePool.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief LogMessagePool that keeps a small cache of messages for
+     *         each thread in front of the shared pool.
+     *
+     *  Each thread gets messages from its own cache.  When the cache is
+     *  empty, the thread refills it, first with the messages other
+     *  threads have returned to it and then with a batch from the
+     *  shared pool.  A message released on the thread that got it goes
+     *  back into that thread's cache.  When the cache holds more than
+     *  threadCacheSize() messages, half of them go back to the shared
+     *  pool.
+     *
+     *  A message released on any other thread, such as the thread that
+     *  writes messages out, joins a small batch the releasing thread
+     *  keeps for the thread that got it.  When the batch fills, or the
+     *  releasing thread refills its own cache or exits, the whole batch
+     *  goes onto a list belonging to the thread that got the messages
+     *  in one step.  That thread takes the whole list back in one step
+     *  the next time its cache runs dry.  Each thread also keeps
+     *  its own counts of messages issued and returned.  Between
+     *  refills, a thread's get() and release() of its own messages touch
+     *  only memory that thread owns.
+     *
+     *  Thread caches only hold messages of the pool's smallest size
+     *  class.  Larger messages, and get() calls with a size hint too
+     *  large for the smallest class, go straight to the shared pool.
+     *
+     *  trim() only frees messages in the shared pool, so at most
+     *  threadCacheSize() messages per thread escape it, plus as many
+     *  again held in batches for other threads.
+     *
+     *  A thread's cache goes back to the shared pool when the thread
+     *  exits, and the next thread to use the pool takes over the cache
+     *  and whatever was returned to it since.
+     *
+     *  numMessagesActive() adds up the counts of every thread, so it
+     *  is exact only while no thread is getting or releasing messages,
+     *  as is the case when the logging system shuts down.
+     */
+    class CachingLogMessagePool : public LogMessagePool {
+    public:
+      CachingLogMessagePool(size_t initialMessageSize, size_t maxMessageSize,
+			    size_t maxReturnedMessageSize,
+			    uint32_t initialPoolSize, uint32_t maxPoolSize,
+			    uint32_t threadCacheSize,
+			    LogMemoryResource* resource=
+			        LogMemoryResource::defaultResource());
+      CachingLogMessagePool(size_t initialMessageSize, size_t maxMessageSize,
+			    size_t maxReturnedMessageSize,
+			    uint32_t initialPoolSize,
+			    const LogPoolSizingPolicy& sizingPolicy,
+			    uint32_t threadCacheSize,
+			    LogMemoryResource* resource=
+			        LogMemoryResource::defaultResource());
+      CachingLogMessagePool(const CachingLogMessagePool&) = delete;
+      virtual ~CachingLogMessagePool();
+
+      /** @brief Most messages a thread keeps in its cache */
+      uint32_t threadCacheSize() const { return threadCacheSize_; }
+
+      /** @brief Number of thread caches, including those left behind
+       *         by threads that have exited
+       */
+      size_t numThreadCaches() const;
+
+      CachingLogMessagePool& operator=(const CachingLogMessagePool&) = delete;
+
+    protected:
+      virtual LogMessage* get_();
+      virtual LogMessage* get_(size_t sizeHint);
+      virtual void release_(LogMessage* msg);
+
+      virtual void messageIssued_();
+      virtual void messageReturned_();
+      virtual size_t countMessagesActive_() const;
+
+      /** @brief Number of messages in the calling thread's cache */
+      size_t numMessagesInThreadCache_();
+
+      /** @brief Number of pools the calling thread keeps a cache for */
+      static size_t numThreadCacheEntries_();
+
+      /** @brief Number of messages other threads have returned to the
+       *         calling thread that it has not taken back yet
+       */
+      size_t numMessagesReturnedToThread_();
+
+    private:
+      struct ThreadCache_;
+      struct ThreadCacheSet_;
+
+      uint64_t id_;
+      uint32_t threadCacheSize_;
+      uint32_t batchSize_;
+      std::vector< std::unique_ptr<ThreadCache_> > caches_;
+      mutable std::mutex cachesSync_;
+
+      ThreadCache_* localCache_();
+      ThreadCache_* findCache_(ThreadCacheSet_& caches);
+      void pruneCaches_(ThreadCacheSet_& caches);
+      ThreadCache_* adoptOrCreateCache_();
+      void giveBack_(ThreadCache_* cache, ThreadCache_* owner,
+		     LogMessage* msg);
+      void flushPending_(ThreadCache_* cache);
+      void refill_(ThreadCache_* cache);
+      void drain_(ThreadCache_* cache, size_t n);
+      void abandon_(ThreadCache_* cache);
+      void destroyMessages_(ThreadCache_* cache);
+      void releaseChain_(LogMessage* msg);
+
+      static ThreadCacheSet_& threadCaches_();
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,42 @@
+#include "DecodingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+DecodingLogMessageReceiver::DecodingLogMessageReceiver(
+    LogMessageFactory* msgFactory, LogMessageReceiver* next,
+    bool emitSiteDictionary
+):
+    msgFactory_(msgFactory), next_(next),
+    emitSiteDictionary_(emitSiteDictionary), decoder_() {
+  // Intentionally left blank
+}
+
+void DecodingLogMessageReceiver::receive(LogMessage* msg) {
+  if (!msg) {
+    return;
+  }
+  if (msg->encoding() != LogMessageEncoding::BINARY) {
+    next_->receive(msg);
+    return;
+  }
+
+  const LogSite* site= BinaryLogDecoder::siteOf(*msg);
+  if (site && emitSiteDictionary_ && !decoder_.isRegistered(*site)) {
+    LogMessageWriter out(*msgFactory_, *next_, msg->destinationHandle(),
+			 msg->logLevel(), LogMessageEncoding::SITE_DICTIONARY,
+			 msg->sourceLocation());
+    out.setTimestamp(msg->timestamp());
+    out.setThread(msg->thread());
+    decoder_.writeDictionaryEntry(*site, out);
+  }
+
+  {
+    LogMessageWriter out(*msgFactory_, *next_, msg->destinationHandle(),
+			 msg->logLevel(), LogMessageEncoding::TEXT,
+			 msg->sourceLocation());
+    out.setTimestamp(msg->timestamp());
+    out.setThread(msg->thread());
+    decoder_.write(*msg, out);
+  }
+  msgFactory_->release(msg);
+}
@@ -0,0 +1,51 @@
+#ifndef __PISTIS__LOGGING__DECODINGLOGMESSAGERECEIVER_HPP__
+#define __PISTIS__LOGGING__DECODINGLOGMESSAGERECEIVER_HPP__
+
+#include <pistis/logging/BinaryLogMessage.hpp>
+#include <pistis/logging/LogMessageFactory.hpp>
+#include <pistis/logging/LogMessageReceiver.hpp>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Turns binary log messages into text before passing them on
+     *         to another LogMessageReceiver.
+     *
+     *  Messages written by Log::logDeferred() hold a LogSite and the
+     *  raw values of its arguments.  A logging implementation that
+     *  hands messages off to a background thread should put a
+     *  DecodingLogMessageReceiver on that thread, so that formatting
+     *  happens there instead of in the code doing the logging.  Text
+     *  messages are passed through unchanged.  Each binary message is
+     *  replaced by one or more text messages from <tt>msgFactory</tt>
+     *  and then released to <tt>msgFactory</tt>, which must be the
+     *  factory the binary messages came from.
+     *
+     *  If <tt>emitSiteDictionary</tt> is true, the first message from
+     *  each LogSite is preceded by a message with encoding
+     *  LogMessageEncoding::SITE_DICTIONARY describing the site, as
+     *  written by BinaryLogDecoder::writeDictionaryEntry().
+     *
+     *  Like BinaryLogDecoder, DecodingLogMessageReceiver is not
+     *  thread-safe.
+     */
+    class DecodingLogMessageReceiver : public LogMessageReceiver {
+    public:
+      DecodingLogMessageReceiver(LogMessageFactory* msgFactory,
+				 LogMessageReceiver* next,
+				 bool emitSiteDictionary= false);
+
+      const BinaryLogDecoder& decoder() const { return decoder_; }
+
+      virtual void receive(LogMessage* msg);
+
+    private:
+      LogMessageFactory* msgFactory_;
+      LogMessageReceiver* next_;
+      bool emitSiteDictionary_;
+      BinaryLogDecoder decoder_;
+    };
+
+  }
+}
+#endif
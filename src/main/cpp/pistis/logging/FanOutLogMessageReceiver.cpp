@@ -0,0 +1,25 @@
+#include "FanOutLogMessageReceiver.hpp"
+#include <stdexcept>
+
+using namespace pistis::logging;
+
+FanOutLogMessageReceiver::FanOutLogMessageReceiver(
+    const std::vector<LogMessageReceiver*>& receivers
+):
+    receivers_(receivers) {
+  if (receivers_.empty()) {
+    throw std::invalid_argument("A FanOutLogMessageReceiver needs at least "
+				"one receiver");
+  }
+}
+
+void FanOutLogMessageReceiver::receive(LogMessage* msg) {
+  // Add every reference before passing the message on, since the first
+  // receiver may release it before the others see it
+  if (receivers_.size() > 1) {
+    msg->addReferences((uint32_t)(receivers_.size() - 1));
+  }
+  for (auto receiver : receivers_) {
+    receiver->receive(msg);
+  }
+}
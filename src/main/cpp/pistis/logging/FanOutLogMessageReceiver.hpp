@@ -0,0 +1,40 @@
+#ifndef __PISTIS__LOGGING__FANOUTLOGMESSAGERECEIVER_HPP__
+#define __PISTIS__LOGGING__FANOUTLOGMESSAGERECEIVER_HPP__
+
+#include <pistis/logging/LogMessageReceiver.hpp>
+#include <vector>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Passes each message it receives on to several other
+     *         LogMessageReceivers without copying it.
+     *
+     *  Each message gets one more reference for every receiver after
+     *  the first, so every receiver must release the message to its
+     *  factory when it is done with it, just as if it had been the only
+     *  one to receive it.  The factory must be an
+     *  AbstractLogMessageFactory, or otherwise honor
+     *  LogMessage::removeReference().  Receivers may keep the message
+     *  as long as they like, but must not modify it.
+     */
+    class FanOutLogMessageReceiver : public LogMessageReceiver {
+    public:
+      /** @throws std::invalid_argument if <tt>receivers</tt> is empty */
+      FanOutLogMessageReceiver(
+	  const std::vector<LogMessageReceiver*>& receivers
+      );
+
+      const std::vector<LogMessageReceiver*>& receivers() const {
+	return receivers_;
+      }
+
+      virtual void receive(LogMessage* msg);
+
+    private:
+      std::vector<LogMessageReceiver*> receivers_;
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,131 @@
+#ifndef __PISTIS__LOGGING__FORMATARG_HPP__
+#define __PISTIS__LOGGING__FORMATARG_HPP__
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief A type-erased argument to a format string.
+     *
+     *  FormatArg captures an argument's value (or, for strings and
+     *  objects, a pointer to it) along with a tag saying how to write it,
+     *  so the formatting code is not instantiated once per combination of
+     *  argument types.  A FormatArg that refers to a string or object is
+     *  only valid while that string or object is.
+     *
+     *  Booleans are written as "true" or "false", char as a character and
+     *  all other integers, including signed and unsigned char, as decimal
+     *  numbers.  Floating-point values are written in the notation of
+     *  printf's "%g", with the fewest digits that read back as the same
+     *  value (see formatDouble(char*, double)), pointers in hexadecimal
+     *  with a leading "0x", and strings verbatim.  Any other type is
+     *  written with its operator<<.
+     */
+    class FormatArg {
+    public:
+      enum class Type : uint8_t {
+	NONE,
+	BOOL,
+	CHAR,
+	INT,
+	UINT,
+	DOUBLE,
+	STRING,
+	POINTER,
+	CUSTOM
+      };
+
+      typedef void (*CustomWriter)(std::streambuf&, const void*);
+
+    public:
+      FormatArg(): type_(Type::NONE) { }
+      FormatArg(bool v): type_(Type::BOOL) { value_.u = v; }
+      FormatArg(char v): type_(Type::CHAR) { value_.u = (unsigned char)v; }
+      FormatArg(signed char v): type_(Type::INT) { value_.i = v; }
+      FormatArg(short v): type_(Type::INT) { value_.i = v; }
+      FormatArg(int v): type_(Type::INT) { value_.i = v; }
+      FormatArg(long v): type_(Type::INT) { value_.i = v; }
+      FormatArg(long long v): type_(Type::INT) { value_.i = v; }
+      FormatArg(unsigned char v): type_(Type::UINT) { value_.u = v; }
+      FormatArg(unsigned short v): type_(Type::UINT) { value_.u = v; }
+      FormatArg(unsigned int v): type_(Type::UINT) { value_.u = v; }
+      FormatArg(unsigned long v): type_(Type::UINT) { value_.u = v; }
+      FormatArg(unsigned long long v): type_(Type::UINT) { value_.u = v; }
+      FormatArg(float v): type_(Type::DOUBLE) { value_.d = v; }
+      FormatArg(double v): type_(Type::DOUBLE) { value_.d = v; }
+      FormatArg(long double v): type_(Type::DOUBLE) { value_.d = (double)v; }
+      FormatArg(const char* v): type_(Type::STRING) {
+	value_.s.data = v ? v : "(null)";
+	value_.s.size = strlen(value_.s.data);
+      }
+      FormatArg(char* v): FormatArg((const char*)v) { }
+      FormatArg(const char* data, size_t size): type_(Type::STRING) {
+	value_.s.data = data;
+	value_.s.size = size;
+      }
+      FormatArg(const std::string& v): FormatArg(v.data(), v.size()) { }
+      FormatArg(std::nullptr_t): type_(Type::POINTER) { value_.p = nullptr; }
+
+      template <typename T>
+      FormatArg(T* v): type_(Type::POINTER) { value_.p = (const void*)v; }
+
+      template <typename T,
+		typename = typename std::enable_if<
+		    !std::is_arithmetic<T>::value &&
+		    !std::is_pointer<T>::value &&
+		    !std::is_array<T>::value
+		>::type>
+      FormatArg(const T& v): type_(Type::CUSTOM) {
+	value_.custom.obj = &v;
+	value_.custom.write = &writeWithOstream_<T>;
+      }
+
+      Type type() const { return type_; }
+      bool boolValue() const { return (bool)value_.u; }
+      char charValue() const { return (char)value_.u; }
+      int64_t intValue() const { return value_.i; }
+      uint64_t uintValue() const { return value_.u; }
+      double doubleValue() const { return value_.d; }
+      const char* stringData() const { return value_.s.data; }
+      size_t stringSize() const { return value_.s.size; }
+      const void* pointerValue() const { return value_.p; }
+
+      /** @brief Write a CUSTOM argument to <tt>out</tt> */
+      void writeCustom(std::streambuf& out) const {
+	value_.custom.write(out, value_.custom.obj);
+      }
+
+    private:
+      union {
+	int64_t i;
+	uint64_t u;
+	double d;
+	const void* p;
+	struct {
+	  const char* data;
+	  size_t size;
+	} s;
+	struct {
+	  const void* obj;
+	  CustomWriter write;
+	} custom;
+      } value_;
+      Type type_;
+
+      template <typename T>
+      static void writeWithOstream_(std::streambuf& out, const void* obj) {
+	std::ostream stream(&out);
+	stream << *static_cast<const T*>(obj);
+      }
+    };
+
+  }
+}
+#endif
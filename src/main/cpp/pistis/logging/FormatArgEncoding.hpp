@@ -0,0 +1,186 @@
+#ifndef __PISTIS__LOGGING__FORMATARGENCODING_HPP__
+#define __PISTIS__LOGGING__FORMATARGENCODING_HPP__
+
+#include <pistis/logging/FormatArg.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Write <tt>arg</tt>'s type and value to <tt>out</tt> in the
+     *         binary form used by deferred log statements and structured
+     *         fields.
+     *
+     *  Each argument is a one-byte FormatArg::Type followed by its value:
+     *  one byte for BOOL and CHAR, eight for INT, UINT, DOUBLE and
+     *  POINTER, and a four-byte length followed by the bytes themselves
+     *  for STRING.  CUSTOM values are formatted with their operator<< and
+     *  written as strings.  NONE is not written at all.
+     *
+     *  @tparam SinkT  A std::streambuf with methods
+     *                   <tt>write(const void*, size_t)</tt>,
+     *                   <tt>size_t size() const</tt>, which returns the
+     *                   number of bytes written so far, and
+     *                   <tt>writeAt(size_t offset, const void*, size_t)</tt>,
+     *                   which overwrites bytes already written.
+     */
+    template <typename SinkT>
+    void writeEncodedFormatArg(SinkT& out, const FormatArg& arg) {
+      uint8_t tag= (uint8_t)arg.type();
+      uint8_t b;
+      int64_t i;
+      uint64_t u;
+      double d;
+      const void* p;
+      uint32_t n;
+
+      switch (arg.type()) {
+	case FormatArg::Type::NONE:
+	  break;
+
+	case FormatArg::Type::BOOL:
+	case FormatArg::Type::CHAR:
+	  b= (uint8_t)arg.uintValue();
+	  out.write(&tag, sizeof(tag));
+	  out.write(&b, sizeof(b));
+	  break;
+
+	case FormatArg::Type::INT:
+	  i= arg.intValue();
+	  out.write(&tag, sizeof(tag));
+	  out.write(&i, sizeof(i));
+	  break;
+
+	case FormatArg::Type::UINT:
+	  u= arg.uintValue();
+	  out.write(&tag, sizeof(tag));
+	  out.write(&u, sizeof(u));
+	  break;
+
+	case FormatArg::Type::DOUBLE:
+	  d= arg.doubleValue();
+	  out.write(&tag, sizeof(tag));
+	  out.write(&d, sizeof(d));
+	  break;
+
+	case FormatArg::Type::POINTER:
+	  p= arg.pointerValue();
+	  out.write(&tag, sizeof(tag));
+	  out.write(&p, sizeof(p));
+	  break;
+
+	case FormatArg::Type::STRING:
+	  n= (uint32_t)arg.stringSize();
+	  out.write(&tag, sizeof(tag));
+	  out.write(&n, sizeof(n));
+	  out.write(arg.stringData(), n);
+	  break;
+
+	case FormatArg::Type::CUSTOM: {
+	  // Format the value now and record it as a string.  Its length is
+	  // not known until it has been written, so fill it in afterwards.
+	  tag= (uint8_t)FormatArg::Type::STRING;
+	  out.write(&tag, sizeof(tag));
+	  const size_t sizeOffset= out.size();
+	  n= 0;
+	  out.write(&n, sizeof(n));
+	  arg.writeCustom(out);
+	  n= (uint32_t)(out.size() - sizeOffset - sizeof(n));
+	  out.writeAt(sizeOffset, &n, sizeof(n));
+	  break;
+	}
+      }
+    }
+
+    /** @brief Reads values written by writeEncodedFormatArg() and
+     *         friends back out of a buffer.
+     *
+     *  Once a read runs past the end of the buffer, ok() returns false
+     *  and all further reads return default values.
+     */
+    class EncodedFormatArgReader {
+    public:
+      EncodedFormatArgReader(const char* begin, const char* end):
+	  p_(begin), end_(end), ok_(true) {
+	// Intentionally left blank
+      }
+
+      bool ok() const { return ok_; }
+      bool atEnd() const { return p_ == end_; }
+      const char* current() const { return p_; }
+
+      template <typename T>
+      T read() {
+	T value= T();
+	if (ok_ && ((size_t)(end_ - p_) >= sizeof(T))) {
+	  memcpy(&value, p_, sizeof(T));
+	  p_ += sizeof(T);
+	} else {
+	  ok_= false;
+	}
+	return value;
+      }
+
+      /** @brief Returns a pointer to the next <tt>n</tt> bytes and skips
+       *         over them
+       */
+      const char* skip(size_t n) {
+	const char* start= p_;
+	if (ok_ && ((size_t)(end_ - p_) >= n)) {
+	  p_ += n;
+	} else {
+	  ok_= false;
+	}
+	return start;
+      }
+
+      /** @brief Read an argument written by writeEncodedFormatArg()
+       *
+       *  STRING arguments refer to the buffer being read.
+       *
+       *  @returns The argument, or a FormatArg of type NONE if the buffer
+       *           does not hold a valid argument, in which case ok()
+       *           returns false afterwards.
+       */
+      FormatArg readFormatArg() {
+	uint32_t n;
+	switch ((FormatArg::Type)read<uint8_t>()) {
+	  case FormatArg::Type::BOOL:
+	    return FormatArg((bool)read<uint8_t>());
+
+	  case FormatArg::Type::CHAR:
+	    return FormatArg((char)read<uint8_t>());
+
+	  case FormatArg::Type::INT:
+	    return FormatArg((long long)read<int64_t>());
+
+	  case FormatArg::Type::UINT:
+	    return FormatArg((unsigned long long)read<uint64_t>());
+
+	  case FormatArg::Type::DOUBLE:
+	    return FormatArg(read<double>());
+
+	  case FormatArg::Type::POINTER:
+	    return FormatArg(read<const void*>());
+
+	  case FormatArg::Type::STRING:
+	    n= read<uint32_t>();
+	    return FormatArg(skip(n), n);
+
+	  default:
+	    ok_= false;
+	    return FormatArg();
+	}
+      }
+
+    private:
+      const char* p_;
+      const char* end_;
+      bool ok_;
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,108 @@
+#ifndef __PISTIS__LOGGING__FORMATSTRING_HPP__
+#define __PISTIS__LOGGING__FORMATSTRING_HPP__
+
+#include <pistis/logging/LogSourceLocation.hpp>
+#include <stdexcept>
+#include <type_traits>
+#include <stddef.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Count the number of "{}" placeholders in a format string.
+     *
+     *  A format string is ordinary text in which "{}" marks the place
+     *  where the next argument is written, "{{" stands for a literal "{"
+     *  and "}}" for a literal "}".  Any other use of "{" or "}" is an
+     *  error.  When evaluated at compile time, as PISTIS_FMT does, an
+     *  error in the format string is a compile error.
+     *
+     *  @param text  The format string
+     *  @returns     The number of placeholders in <tt>text</tt>
+     *  @throws std::invalid_argument if <tt>text</tt> is malformed
+     */
+    constexpr size_t countFormatArgs(const char* text) {
+      size_t n= 0;
+      while (*text) {
+	if (*text == '{') {
+	  if (text[1] == '{') {
+	    text += 2;
+	  } else if (text[1] == '}') {
+	    ++n;
+	    text += 2;
+	  } else {
+	    throw std::invalid_argument(
+	        "Format string contains a '{' that does not begin \"{}\" or "
+		"\"{{\""
+	    );
+	  }
+	} else if (*text == '}') {
+	  if (text[1] != '}') {
+	    throw std::invalid_argument(
+	        "Format string contains a '}' that does not end \"{}\" or "
+		"\"}}\""
+	    );
+	  }
+	  text += 2;
+	} else {
+	  ++text;
+	}
+      }
+      return n;
+    }
+
+    /** @brief A format string whose placeholders have been counted at
+     *         compile time.
+     *
+     *  Create one with the PISTIS_FMT macro and pass it to
+     *  Log::log(LogLevel, const FormatString<N>&, const ArgsT&...) or one
+     *  of its kin.  Because the number of placeholders is part of the
+     *  type, passing the wrong number of arguments is a compile error.
+     *  A FormatString also records where it was created, which is where
+     *  the statement that uses it is.
+     *
+     *  @tparam NUM_ARGS  Number of "{}" placeholders in the string
+     */
+    template <size_t NUM_ARGS>
+    class FormatString {
+    public:
+      constexpr explicit FormatString(
+	  const char* text,
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ):
+	  text_(text), location_(location) {
+	// Intentionally left blank
+      }
+
+      constexpr const char* text() const { return text_; }
+      constexpr const LogSourceLocation& location() const {
+	return location_;
+      }
+      static constexpr size_t numArgs() { return NUM_ARGS; }
+
+    private:
+      const char* text_;
+      LogSourceLocation location_;
+    };
+
+    template <typename T>
+    struct IsFormatString : std::false_type { };
+
+    template <size_t NUM_ARGS>
+    struct IsFormatString< FormatString<NUM_ARGS> > : std::true_type { };
+
+  }
+}
+
+/** @brief Create a FormatString from a string literal, checking it at
+ *         compile time.
+ *
+ *  <pre>
+ *    log.info(PISTIS_FMT("User {} took {} ms"), userId, elapsed);
+ *  </pre>
+ */
+#define PISTIS_FMT(text)						\
+  ::pistis::logging::FormatString<					\
+      ::pistis::logging::countFormatArgs(text)>(text)
+
+#endif
@@ -1,4 +1,5 @@
 #include "Log.hpp"
+#include "BinaryLogMessage.hpp"
 
 using namespace pistis::logging;
 
@@ -9,3 +10,31 @@ Log::Log(LogMessageFactory* msgFactory, LogMessageReceiver* msgReceiver,
   // Intentionally left blank
 }
 
+
+void Log::logDeferred(const LogSite& site, const FormatArg* args,
+		      size_t numArgs) const {
+  if (isEnabled(site.logLevel())) {
+    logDeferredUnchecked(site, args, numArgs);
+  }
+}
+
+void Log::logDeferredUnchecked(const LogSite& site, const FormatArg* args,
+			       size_t numArgs) const {
+  LogMessage* msg= msgFactory_->get();
+  msg->setLogLevel(site.logLevel());
+  msg->setDestination(destination_);
+  msg->setSourceLocation(site.location());
+  msg->setTimestamp(LogClock::now());
+  msg->setThread(LogThreadInfo::current());
+  if (writeBinaryLogMessage(*msg, site, args, numArgs)) {
+    msgReceiver_->receive(msg);
+  } else {
+    // Too big for a single message, so format it now and let
+    // LogMessageWriter split it across as many as it needs
+    msgFactory_->release(msg);
+    LogMessageWriter out(*msgFactory_, *msgReceiver_, destination_,
+			 site.logLevel(), LogMessageEncoding::TEXT,
+			 site.location());
+    out.format(site.format(), args, numArgs);
+  }
+}
@@ -1,17 +1,32 @@
 #ifndef __PISTIS__LOGGING__LOG_HPP__
 #define __PISTIS__LOGGING__LOG_HPP__
 
+#include <pistis/logging/FormatArg.hpp>
+#include <pistis/logging/FormatString.hpp>
+#include <pistis/logging/LogMessageWriter.hpp>
+#include <pistis/logging/LogSite.hpp>
 #include <pistis/logging/LogStream.hpp>
 
 namespace pistis {
   namespace logging {
 
+    /** @brief Removes an overload from consideration when <tt>T</tt> is a
+     *         FormatString or LogSourceLocation, leaving the overloads
+     *         that take a callable
+     */
+    template <typename T>
+    using EnableIfLogWriter= typename std::enable_if<
+        !IsFormatString<typename std::decay<T>::type>::value &&
+	!std::is_same<typename std::decay<T>::type, LogSourceLocation>::value
+    >::type;
+
     class Log {
     public:
       Log(const Log&)= delete;
       Log& operator=(const Log&)= delete;
 
-      const std::string& destination() const { return destination_; }
+      const std::string& destination() const { return destination_.name(); }
+      const LogDestination& destinationHandle() const { return destination_; }
       LogLevel logLevel() const { return logLevel_; }
 
       bool isEnabled(LogLevel l) const { return logLevel_ <= l; }
@@ -21,25 +36,255 @@ namespace pistis {
       bool isWarnEnabled() const { return isEnabled(LogLevel::WARN); }
       bool isErrorEnabled() const { return isEnabled(LogLevel::ERROR); }
 	
-      LogStream<char> log(LogLevel l) const {
-	return LogStream<char>(*msgFactory_, *msgReceiver_, destination(),
-			       l, isEnabled(l));
-      }
-      LogStream<char> trace() { return log(LogLevel::TRACE); }
-      LogStream<char> debug() const { return log(LogLevel::DEBUG); }
-      LogStream<char> info() const { return log(LogLevel::INFO); }
-      LogStream<char> warn() const { return log(LogLevel::WARN); }
-      LogStream<char> error() const { return log(LogLevel::ERROR); }
-
-      LogStream<wchar_t> wlog(LogLevel l) const {
-	return LogStream<wchar_t>(*msgFactory_, *msgReceiver_, destination(),
-				  l, isEnabled(l));
-      }
-      LogStream<wchar_t> wtrace() const { return wlog(LogLevel::TRACE); }
-      LogStream<wchar_t> wdebug() const { return wlog(LogLevel::DEBUG); }
-      LogStream<wchar_t> winfo() const { return wlog(LogLevel::INFO); }
-      LogStream<wchar_t> wwarn() const { return wlog(LogLevel::WARN); }
-      LogStream<wchar_t> werror() const { return wlog(LogLevel::ERROR); }
+      /** @brief Start a log statement at level <tt>l</tt>
+       *
+       *  Messages the statement writes record <tt>location</tt>, which
+       *  defaults to where log() was called.
+       */
+      LogStream<char> log(
+	  LogLevel l,
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return LogStream<char>(*msgFactory_, *msgReceiver_, destination_,
+			       l, isEnabled(l), location);
+      }
+      /** @brief Start a log statement at level <tt>l</tt> whether or not
+       *         <tt>l</tt> is enabled.
+       *
+       *  Used by the PISTIS_LOG family of macros, which have already
+       *  decided to log the statement, possibly because its
+       *  LogSiteSwitch is on.
+       */
+      LogStream<char> logUnchecked(
+	  LogLevel l,
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return LogStream<char>(*msgFactory_, *msgReceiver_, destination_,
+			       l, true, location);
+      }
+
+      LogStream<char> trace(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return log(LogLevel::TRACE, location);
+      }
+      LogStream<char> debug(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return log(LogLevel::DEBUG, location);
+      }
+      LogStream<char> info(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return log(LogLevel::INFO, location);
+      }
+      LogStream<char> warn(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return log(LogLevel::WARN, location);
+      }
+      LogStream<char> error(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return log(LogLevel::ERROR, location);
+      }
+
+      /** @brief Write a log statement only if level <tt>l</tt> is enabled.
+       *
+       *  If <tt>l</tt> is enabled, creates a LogStream and calls
+       *  <tt>writer</tt> with it.  Otherwise, neither the LogStream is
+       *  created nor <tt>writer</tt> called, so the arguments to the
+       *  statement are never evaluated.  For example:
+       *
+       *  <pre>
+       *    log.debug([&](auto& s) { s << "Summary: " << summarize(data); });
+       *  </pre>
+       *
+       *  @param l         Level to log at
+       *  @param writer    Callable that accepts a LogStream<char>&
+       *  @param location  Where the statement is
+       */
+      template <typename WriterT,
+		typename = EnableIfLogWriter<WriterT> >
+      void log(LogLevel l, WriterT&& writer,
+	       const LogSourceLocation& location=
+		   LogSourceLocation::current()) const {
+	if (isEnabled(l)) {
+	  LogStream<char> s(log(l, location));
+	  writer(s);
+	}
+      }
+      template <typename WriterT,
+		typename = EnableIfLogWriter<WriterT> >
+      void trace(WriterT&& writer, const LogSourceLocation& location=
+		    LogSourceLocation::current()) const {
+	log(LogLevel::TRACE, std::forward<WriterT>(writer), location);
+      }
+      template <typename WriterT,
+		typename = EnableIfLogWriter<WriterT> >
+      void debug(WriterT&& writer, const LogSourceLocation& location=
+		    LogSourceLocation::current()) const {
+	log(LogLevel::DEBUG, std::forward<WriterT>(writer), location);
+      }
+      template <typename WriterT,
+		typename = EnableIfLogWriter<WriterT> >
+      void info(WriterT&& writer, const LogSourceLocation& location=
+		    LogSourceLocation::current()) const {
+	log(LogLevel::INFO, std::forward<WriterT>(writer), location);
+      }
+      template <typename WriterT,
+		typename = EnableIfLogWriter<WriterT> >
+      void warn(WriterT&& writer, const LogSourceLocation& location=
+		    LogSourceLocation::current()) const {
+	log(LogLevel::WARN, std::forward<WriterT>(writer), location);
+      }
+      template <typename WriterT,
+		typename = EnableIfLogWriter<WriterT> >
+      void error(WriterT&& writer, const LogSourceLocation& location=
+		    LogSourceLocation::current()) const {
+	log(LogLevel::ERROR, std::forward<WriterT>(writer), location);
+      }
+
+      LogStream<wchar_t> wlog(
+	  LogLevel l,
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return LogStream<wchar_t>(*msgFactory_, *msgReceiver_, destination_,
+				  l, isEnabled(l), location);
+      }
+      /** @brief Wide-character version of logUnchecked() */
+      LogStream<wchar_t> wlogUnchecked(
+	  LogLevel l,
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return LogStream<wchar_t>(*msgFactory_, *msgReceiver_, destination_,
+				  l, true, location);
+      }
+
+      LogStream<wchar_t> wtrace(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return wlog(LogLevel::TRACE, location);
+      }
+      LogStream<wchar_t> wdebug(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return wlog(LogLevel::DEBUG, location);
+      }
+      LogStream<wchar_t> winfo(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return wlog(LogLevel::INFO, location);
+      }
+      LogStream<wchar_t> wwarn(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return wlog(LogLevel::WARN, location);
+      }
+      LogStream<wchar_t> werror(
+	  const LogSourceLocation& location= LogSourceLocation::current()
+      ) const {
+	return wlog(LogLevel::ERROR, location);
+      }
+
+      /** @brief Wide-character version of log(LogLevel, WriterT&&) */
+      template <typename WriterT,
+		typename = EnableIfLogWriter<WriterT> >
+      void wlog(LogLevel l, WriterT&& writer,
+		const LogSourceLocation& location=
+		    LogSourceLocation::current()) const {
+	if (isEnabled(l)) {
+	  LogStream<wchar_t> s(wlog(l, location));
+	  writer(s);
+	}
+      }
+
+      /** @brief Write a log statement from a format string and arguments
+       *
+       *  Replaces each "{}" in <tt>text</tt> with the next argument and
+       *  writes the result directly into a LogMessage, without going
+       *  through a std::basic_ostream.  Create <tt>text</tt> with
+       *  PISTIS_FMT, which checks the format string at compile time:
+       *
+       *  <pre>
+       *    log.info(PISTIS_FMT("User {} took {} ms"), userId, elapsed);
+       *  </pre>
+       *
+       *  Passing a different number of arguments than the format string
+       *  has placeholders is a compile error.  Nothing is formatted if
+       *  <tt>l</tt> is not enabled, though the arguments themselves are
+       *  evaluated.  See FormatArg for how each type of argument is
+       *  written.  Messages record the location where <tt>text</tt> was
+       *  created.
+       */
+      template <size_t NUM_ARGS, typename... ArgsT>
+      void log(LogLevel l, const FormatString<NUM_ARGS>& text,
+	       const ArgsT&... args) const {
+	static_assert(NUM_ARGS == sizeof...(ArgsT),
+		      "Number of arguments does not match the number of "
+		      "placeholders in the format string");
+	if (isEnabled(l)) {
+	  // The extra FormatArg keeps the array from having size zero
+	  const FormatArg formatArgs[]= { FormatArg(args)..., FormatArg() };
+	  LogMessageWriter out(*msgFactory_, *msgReceiver_, destination_, l,
+			       LogMessageEncoding::TEXT, text.location());
+	  out.format(text.text(), formatArgs, NUM_ARGS);
+	}
+      }
+      template <size_t NUM_ARGS, typename... ArgsT>
+      void trace(const FormatString<NUM_ARGS>& text,
+		 const ArgsT&... args) const {
+	log(LogLevel::TRACE, text, args...);
+      }
+      template <size_t NUM_ARGS, typename... ArgsT>
+      void debug(const FormatString<NUM_ARGS>& text,
+		 const ArgsT&... args) const {
+	log(LogLevel::DEBUG, text, args...);
+      }
+      template <size_t NUM_ARGS, typename... ArgsT>
+      void info(const FormatString<NUM_ARGS>& text,
+		const ArgsT&... args) const {
+	log(LogLevel::INFO, text, args...);
+      }
+      template <size_t NUM_ARGS, typename... ArgsT>
+      void warn(const FormatString<NUM_ARGS>& text,
+		const ArgsT&... args) const {
+	log(LogLevel::WARN, text, args...);
+      }
+      template <size_t NUM_ARGS, typename... ArgsT>
+      void error(const FormatString<NUM_ARGS>& text,
+		 const ArgsT&... args) const {
+	log(LogLevel::ERROR, text, args...);
+      }
+
+      /** @brief Log a statement without formatting it
+       *
+       *  Records the address of <tt>site</tt> and the values of
+       *  <tt>args</tt> in a LogMessage with encoding
+       *  LogMessageEncoding::BINARY, leaving it to the receiving side to
+       *  format the message with BinaryLogDecoder.  This keeps the cost
+       *  of formatting out of the code doing the logging.  If the
+       *  arguments are too large to fit in a single message, the
+       *  statement is formatted immediately instead.  Nothing is logged
+       *  if the site's level is not enabled.
+       *
+       *  Most code should use the PISTIS_LOG_DEFERRED family of macros,
+       *  which create the LogSite and check the number of arguments at
+       *  compile time, rather than calling this method directly.
+       *
+       *  @param site     The statement being logged
+       *  @param args     Values for the placeholders in the site's format
+       *                    string
+       *  @param numArgs  Number of values in <tt>args</tt>
+       */
+      void logDeferred(const LogSite& site, const FormatArg* args,
+		       size_t numArgs) const;
+
+      /** @brief Same as logDeferred(), but logs the statement whether or
+       *         not the site's level is enabled
+       */
+      void logDeferredUnchecked(const LogSite& site, const FormatArg* args,
+				size_t numArgs) const;
 
     protected:
       Log(LogMessageFactory* msgFactory, LogMessageReceiver* msgReceiver,
@@ -58,7 +303,7 @@ namespace pistis {
       LogMessageReceiver* msgReceiver_;
 
       /** @brief Name of the Log's target */
-      std::string destination_;
+      LogDestination destination_;
 
       /** @brief The current logging level */
       LogLevel logLevel_;
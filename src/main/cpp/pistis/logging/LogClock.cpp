@@ -0,0 +1,105 @@
+#include "LogClock.hpp"
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace pistis::logging;
+
+namespace {
+  /** @brief Rate of the time stamp counter and a reading of it taken
+   *         at a known wall time
+   */
+  struct TscCalibration {
+    uint64_t tscBase;
+    uint64_t nanosBase;
+    double nanosPerTick;
+  };
+
+  const std::chrono::milliseconds CALIBRATION_TIME(20);
+
+  std::once_flag calibrationFlag;
+  std::atomic<bool> calibrated(false);
+  TscCalibration calibration{ 0, 0, 1.0 };
+
+  /** @brief Read the time stamp counter and CLOCK_REALTIME as close
+   *         together as possible
+   */
+  void readBoth(uint64_t& tsc, uint64_t& nanos) {
+    const uint64_t before= LogClock::now(LogClockSource::TSC).raw();
+    nanos= LogClock::now(LogClockSource::REALTIME).raw();
+    const uint64_t after= LogClock::now(LogClockSource::TSC).raw();
+    tsc= before + (after - before) / 2;
+  }
+
+  void measureTscRate() {
+    uint64_t startTsc, startNanos, endTsc, endNanos;
+    readBoth(startTsc, startNanos);
+    std::this_thread::sleep_for(CALIBRATION_TIME);
+    readBoth(endTsc, endNanos);
+
+    calibration.tscBase= endTsc;
+    calibration.nanosBase= endNanos;
+    if (endTsc > startTsc) {
+      calibration.nanosPerTick=
+	  (double)(endNanos - startNanos) / (double)(endTsc - startTsc);
+    }
+    calibrated.store(true, std::memory_order_release);
+  }
+
+  class SourceToNameMap {
+  public:
+    SourceToNameMap(): names_{ "NONE", "TSC", "COARSE", "REALTIME" } {
+      // Intentionally left blank
+    }
+
+    const std::string& operator[](LogClockSource source) const {
+      return names_[(uint32_t)source];
+    }
+
+  private:
+    std::vector<std::string> names_;
+  };
+}
+
+std::atomic<LogClockSource> LogClock::source_(LogClockSource::REALTIME);
+
+const std::string& pistis::logging::toString(LogClockSource source) {
+  static const SourceToNameMap NAME_FOR_SOURCE;
+  return NAME_FOR_SOURCE[source];
+}
+
+void LogClock::setSource(LogClockSource source) {
+  if (source == LogClockSource::NONE) {
+    throw std::invalid_argument("Cannot stamp log messages with NONE");
+  }
+  if (source == LogClockSource::TSC) {
+    calibrate();
+  }
+  source_.store(source, std::memory_order_relaxed);
+}
+
+void LogClock::calibrate() {
+  // Receivers convert every message, so skip call_once once it is done
+  if (!calibrated.load(std::memory_order_acquire)) {
+    std::call_once(calibrationFlag, measureTscRate);
+  }
+}
+
+uint64_t LogClock::toNanoseconds(const LogTimestamp& timestamp) {
+  switch (timestamp.source()) {
+    case LogClockSource::TSC: {
+      calibrate();
+      const int64_t ticks= (int64_t)(timestamp.raw() - calibration.tscBase);
+      return calibration.nanosBase +
+	  (int64_t)((double)ticks * calibration.nanosPerTick);
+    }
+
+    case LogClockSource::COARSE:
+    case LogClockSource::REALTIME:
+      return timestamp.raw();
+
+    default:
+      return 0;
+  }
+}
@@ -0,0 +1,176 @@
+#ifndef __PISTIS__LOGGING__LOGCLOCK_HPP__
+#define __PISTIS__LOGGING__LOGCLOCK_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Clock a LogTimestamp was read from */
+    enum class LogClockSource : uint8_t {
+      /** @brief No timestamp */
+      NONE = 0,
+
+      /** @brief The CPU's time stamp counter, converted to wall time with
+       *         a calibrated rate.  The cheapest source by far, but only
+       *         meaningful on machines whose counter runs at a constant
+       *         rate and is synchronized across cores.  On processors
+       *         without a time stamp counter, CLOCK_MONOTONIC stands in
+       *         for it.
+       */
+      TSC = 1,
+
+      /** @brief CLOCK_REALTIME_COARSE, which the kernel updates once per
+       *         tick.  Almost as cheap as TSC, with a resolution of a few
+       *         milliseconds.
+       */
+      COARSE = 2,
+
+      /** @brief CLOCK_REALTIME, read through the vDSO */
+      REALTIME = 3
+    };
+
+    const std::string& toString(LogClockSource source);
+
+    inline std::ostream& operator<<(std::ostream& out,
+				    LogClockSource source) {
+      return out << toString(source);
+    }
+
+    /** @brief When a log statement was written, as read from a LogClock.
+     *
+     *  Holds the clock's raw reading, which is only converted to wall
+     *  time by LogClock::toNanoseconds() when a receiver needs it.
+     */
+    class LogTimestamp {
+    public:
+      /** @brief Create a timestamp for a message that has none */
+      constexpr LogTimestamp(): raw_(0), source_(LogClockSource::NONE) {
+	// Intentionally left blank
+      }
+
+      constexpr LogTimestamp(LogClockSource source, uint64_t raw):
+	  raw_(raw), source_(source) {
+	// Intentionally left blank
+      }
+
+      constexpr bool isSet() const {
+	return source_ != LogClockSource::NONE;
+      }
+      constexpr LogClockSource source() const { return source_; }
+      constexpr uint64_t raw() const { return raw_; }
+
+    private:
+      uint64_t raw_;
+      LogClockSource source_;
+    };
+
+    inline bool operator==(const LogTimestamp& left,
+			   const LogTimestamp& right) {
+      return (left.source() == right.source()) && (left.raw() == right.raw());
+    }
+
+    inline bool operator!=(const LogTimestamp& left,
+			   const LogTimestamp& right) {
+      return !(left == right);
+    }
+
+    /** @brief The clock that timestamps log messages.
+     *
+     *  Messages are stamped by the thread that writes them, when the log
+     *  statement starts, so the time does not depend on how long the
+     *  message waits to be received.  The source is process-wide and may
+     *  be changed at any time; each timestamp records the source it came
+     *  from, so messages stamped before the change still convert
+     *  correctly.  The default source is REALTIME.
+     */
+    class LogClock {
+    public:
+      /** @brief The source new timestamps are read from */
+      static LogClockSource source() {
+	return source_.load(std::memory_order_relaxed);
+      }
+
+      /** @brief Change the source new timestamps are read from.
+       *
+       *  Calibrates the time stamp counter the first time the source is
+       *  set to TSC, which takes about 20 milliseconds.
+       *
+       *  @throws std::invalid_argument if <tt>source</tt> is NONE
+       */
+      static void setSource(LogClockSource source);
+
+      /** @brief Read the current source */
+      static LogTimestamp now() { return now(source()); }
+
+      /** @brief Read <tt>source</tt>.
+       *
+       *  Does not calibrate the time stamp counter, so call setSource()
+       *  or calibrate() before converting TSC timestamps to wall time.
+       */
+      static LogTimestamp now(LogClockSource source) {
+	switch (source) {
+	  case LogClockSource::TSC:
+	    return LogTimestamp(source, readTsc_());
+
+	  case LogClockSource::COARSE:
+	    return LogTimestamp(source, readClock_(CLOCK_REALTIME_COARSE));
+
+	  case LogClockSource::REALTIME:
+	    return LogTimestamp(source, readClock_(CLOCK_REALTIME));
+
+	  default:
+	    return LogTimestamp();
+	}
+      }
+
+      /** @brief Measure the rate of the time stamp counter against
+       *         CLOCK_REALTIME, if it has not been measured yet
+       */
+      static void calibrate();
+
+      /** @brief Nanoseconds since the epoch at which <tt>timestamp</tt>
+       *         was taken, or zero if it is not set
+       */
+      static uint64_t toNanoseconds(const LogTimestamp& timestamp);
+
+      static std::chrono::system_clock::time_point toTimePoint(
+	  const LogTimestamp& timestamp
+      ) {
+	return std::chrono::system_clock::time_point(
+	    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+	        std::chrono::nanoseconds(toNanoseconds(timestamp))
+	    )
+	);
+      }
+
+    private:
+      static std::atomic<LogClockSource> source_;
+
+      static uint64_t readClock_(clockid_t clock) {
+	struct timespec t;
+	clock_gettime(clock, &t);
+	return (uint64_t)t.tv_sec * 1000000000 + (uint64_t)t.tv_nsec;
+      }
+
+      static uint64_t readTsc_() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return readClock_(CLOCK_MONOTONIC);
+#endif
+      }
+    };
+
+  }
+}
+#endif
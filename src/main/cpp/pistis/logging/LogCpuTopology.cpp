@@ -0,0 +1,216 @@
+#include "LogCpuTopology.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace pistis::logging;
+
+namespace {
+  const std::string SYSTEM_NODE_DIR("/sys/devices/system/node");
+
+  bool readLine(const std::string& path, std::string& line) {
+    std::ifstream in(path);
+    return in && std::getline(in, line);
+  }
+
+  uint32_t parseCpu(const std::string& text) {
+    char* end= nullptr;
+    const unsigned long cpu= strtoul(text.c_str(), &end, 10);
+    if (text.empty() || *end) {
+      throw std::invalid_argument("Invalid CPU \"" + text + "\"");
+    }
+    return (uint32_t)cpu;
+  }
+
+  LogCpuTopology* readSystemTopology() {
+    try {
+      return new LogCpuTopology(LogCpuTopology::readNodes(SYSTEM_NODE_DIR));
+    } catch(const std::invalid_argument&) {
+      // Fall back to a single node when sysfs is missing or says
+      // something unexpected
+    }
+
+    const long numCpus= sysconf(_SC_NPROCESSORS_CONF);
+    return new LogCpuTopology(
+	std::vector<uint32_t>((numCpus > 0) ? (size_t)numCpus : 1, 0)
+    );
+  }
+}
+
+const uint32_t LogCpuTopology::NO_NODE;
+
+LogCpuTopology::LogCpuTopology(
+    const std::vector<uint32_t>& nodeOfCpu,
+    const std::vector< std::vector<uint32_t> >& distances,
+    const std::vector<uint32_t>& nodeIds
+):
+    nodeOfCpu_(nodeOfCpu), cpus_(), nodeIds_(nodeIds), cpusOnNode_(),
+    nearestNodes_() {
+  for (uint32_t cpu= 0; cpu < nodeOfCpu_.size(); ++cpu) {
+    const uint32_t node= nodeOfCpu_[cpu];
+    if (node == NO_NODE) {
+      continue;
+    }
+    if (node >= cpusOnNode_.size()) {
+      cpusOnNode_.resize(node + 1);
+    }
+    cpusOnNode_[node].push_back(cpu);
+    cpus_.push_back(cpu);
+  }
+  if (cpus_.empty()) {
+    throw std::invalid_argument("A LogCpuTopology needs at least one CPU");
+  }
+  for (const auto& cpus : cpusOnNode_) {
+    if (cpus.empty()) {
+      throw std::invalid_argument("Nodes must be numbered without gaps");
+    }
+  }
+
+  const uint32_t n= numNodes();
+  if (nodeIds_.empty()) {
+    for (uint32_t node= 0; node < n; ++node) {
+      nodeIds_.push_back(node);
+    }
+  } else if (nodeIds_.size() != n) {
+    throw std::invalid_argument("There must be one node id for each node");
+  }
+
+  const bool haveDistances=
+      (distances.size() == n) &&
+      std::all_of(distances.begin(), distances.end(),
+		  [n](const std::vector<uint32_t>& row) {
+		    return row.size() == n;
+		  });
+  if (!distances.empty() && !haveDistances) {
+    throw std::invalid_argument("Node distances must be a square table "
+				"with a row for each node");
+  }
+
+  for (uint32_t node= 0; node < n; ++node) {
+    auto distance= [&](uint32_t other) {
+      return haveDistances ? distances[node][other]
+	                   : (uint32_t)abs((int)other - (int)node);
+    };
+    std::vector<uint32_t> nearest;
+    for (uint32_t other= 0; other < n; ++other) {
+      nearest.push_back(other);
+    }
+    std::stable_sort(nearest.begin(), nearest.end(),
+		     [&](uint32_t x, uint32_t y) {
+		       if (x == node || y == node) {
+			 return (x == node) && (y != node);
+		       }
+		       return distance(x) < distance(y);
+		     });
+    nearestNodes_.push_back(nearest);
+  }
+}
+
+const LogCpuTopology& LogCpuTopology::system() {
+  static const LogCpuTopology* topology= readSystemTopology();
+  return *topology;
+}
+
+LogCpuTopology LogCpuTopology::readNodes(const std::string& nodeDir) {
+  std::string line;
+  if (!readLine(nodeDir + "/online", line)) {
+    throw std::invalid_argument("Cannot read " + nodeDir + "/online");
+  }
+
+  // Node ids may have gaps, and the distance tables have a column for
+  // every online node, in order of id, with or without CPUs
+  const std::vector<uint32_t> onlineIds= parseCpuList(line);
+  std::vector<uint32_t> nodeOfCpu;
+  std::vector<uint32_t> nodeIds;
+  std::vector<size_t> columns;
+  std::vector< std::vector<uint32_t> > rows;
+
+  for (size_t i= 0; i < onlineIds.size(); ++i) {
+    const std::string dir= nodeDir + "/node" + std::to_string(onlineIds[i]);
+    std::vector<uint32_t> cpus;
+    if (readLine(dir + "/cpulist", line)) {
+      cpus= parseCpuList(line);
+    }
+    if (cpus.empty()) {
+      continue;  // Memory without CPUs, e.g. CXL or HBM
+    }
+
+    const uint32_t node= (uint32_t)nodeIds.size();
+    for (auto cpu : cpus) {
+      if (cpu >= nodeOfCpu.size()) {
+	nodeOfCpu.resize(cpu + 1, NO_NODE);
+      }
+      nodeOfCpu[cpu]= node;
+    }
+    nodeIds.push_back(onlineIds[i]);
+    columns.push_back(i);
+
+    std::vector<uint32_t> row;
+    if (readLine(dir + "/distance", line)) {
+      std::istringstream in(line);
+      uint32_t d;
+      while (in >> d) {
+	row.push_back(d);
+      }
+    }
+    rows.push_back(row);
+  }
+
+  if (nodeIds.empty()) {
+    throw std::invalid_argument("No node under " + nodeDir + " has CPUs");
+  }
+
+  // Keep the distances between the nodes with CPUs, if every node has
+  // them
+  std::vector< std::vector<uint32_t> > distances;
+  if (std::all_of(rows.begin(), rows.end(),
+		  [&onlineIds](const std::vector<uint32_t>& row) {
+		    return row.size() == onlineIds.size();
+		  })) {
+    for (const auto& row : rows) {
+      std::vector<uint32_t> distancesFrom;
+      for (auto column : columns) {
+	distancesFrom.push_back(row[column]);
+      }
+      distances.push_back(distancesFrom);
+    }
+  }
+  return LogCpuTopology(nodeOfCpu, distances, nodeIds);
+}
+
+std::vector<uint32_t> LogCpuTopology::parseCpuList(const std::string& text) {
+  std::vector<uint32_t> cpus;
+  std::istringstream in(text);
+  std::string range;
+
+  while (std::getline(in, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(), ::isspace),
+		range.end());
+    if (range.empty()) {
+      continue;
+    }
+    const size_t dash= range.find('-');
+    if (dash == std::string::npos) {
+      cpus.push_back(parseCpu(range));
+    } else {
+      const uint32_t first= parseCpu(range.substr(0, dash));
+      const uint32_t last= parseCpu(range.substr(dash + 1));
+      if (last < first) {
+	throw std::invalid_argument("Invalid CPU range \"" + range + "\"");
+      }
+      for (uint32_t cpu= first; cpu <= last; ++cpu) {
+	cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+uint32_t LogCpuTopology::currentCpu_() const {
+  const int cpu= sched_getcpu();
+  return (cpu < 0) ? 0 : (uint32_t)cpu;
+}
@@ -0,0 +1,121 @@
+#ifndef __PISTIS__LOGGING__LOGCPUTOPOLOGY_HPP__
+#define __PISTIS__LOGGING__LOGCPUTOPOLOGY_HPP__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Which NUMA node each CPU belongs to, and how far apart the
+     *         nodes are.
+     *
+     *  system() describes the machine the process runs on, as reported
+     *  under /sys/devices/system/node.  Where that is unavailable, all
+     *  CPUs are taken to be on a single node.  Other topologies can be
+     *  built for testing.
+     *
+     *  Nodes are numbered from zero without gaps, in the order of their
+     *  ids on the system, which may have gaps, and systemNodeId() maps
+     *  one to the other.  Nodes without CPUs, such as those that only
+     *  hold memory, are left out.  CPU ids are the system's, and may
+     *  have gaps where CPUs are offline or absent.
+     */
+    class LogCpuTopology {
+    public:
+      /** @brief Marks a CPU id in <tt>nodeOfCpu</tt> that no CPU has */
+      static const uint32_t NO_NODE= 0xFFFFFFFF;
+
+      /** @brief Describe a machine with a CPU for each entry of
+       *         <tt>nodeOfCpu</tt> that is not NO_NODE.
+       *
+       *  @param nodeOfCpu  The node each CPU is on, indexed by CPU id.
+       *                      Nodes must be numbered from zero without
+       *                      gaps.
+       *  @param distances  Distance from each node to every other, as
+       *                      in the kernel's node distance tables.  If
+       *                      empty, nodes are nearer the closer their
+       *                      numbers are.
+       *  @param nodeIds    The system's id for each node.  If empty,
+       *                      each node's id is its number.
+       *  @throws std::invalid_argument if <tt>nodeOfCpu</tt> has no
+       *            CPUs, skips a node, or <tt>distances</tt> or
+       *            <tt>nodeIds</tt> has the wrong shape
+       */
+      LogCpuTopology(const std::vector<uint32_t>& nodeOfCpu,
+		     const std::vector< std::vector<uint32_t> >& distances=
+		         std::vector< std::vector<uint32_t> >(),
+		     const std::vector<uint32_t>& nodeIds=
+		         std::vector<uint32_t>());
+      virtual ~LogCpuTopology() { }
+
+      /** @brief The topology of this machine */
+      static const LogCpuTopology& system();
+
+      /** @brief Read the topology from <tt>nodeDir</tt>, laid out as
+       *         /sys/devices/system/node is
+       *
+       *  @throws std::invalid_argument if <tt>nodeDir</tt> is missing,
+       *            malformed or lists no node with CPUs
+       */
+      static LogCpuTopology readNodes(const std::string& nodeDir);
+
+      /** @brief Number of CPUs, which may be fewer than the largest CPU
+       *         id
+       */
+      uint32_t numCpus() const { return (uint32_t)cpus_.size(); }
+      uint32_t numNodes() const { return (uint32_t)cpusOnNode_.size(); }
+
+      /** @brief Every CPU's id, in increasing order */
+      const std::vector<uint32_t>& cpus() const { return cpus_; }
+
+      /** @brief The node <tt>cpu</tt> is on, or node zero if there is no
+       *         such CPU
+       */
+      uint32_t nodeOf(uint32_t cpu) const {
+	return ((cpu < nodeOfCpu_.size()) && (nodeOfCpu_[cpu] != NO_NODE))
+	           ? nodeOfCpu_[cpu] : 0;
+      }
+
+      /** @brief The id the system gives <tt>node</tt>, e.g. for mbind() */
+      uint32_t systemNodeId(uint32_t node) const { return nodeIds_[node]; }
+
+      const std::vector<uint32_t>& cpusOn(uint32_t node) const {
+	return cpusOnNode_[node];
+      }
+
+      /** @brief Every node, nearest to <tt>node</tt> first, starting
+       *         with <tt>node</tt> itself
+       */
+      const std::vector<uint32_t>& nodesNearestTo(uint32_t node) const {
+	return nearestNodes_[node];
+      }
+
+      /** @brief The CPU the calling thread is running on */
+      uint32_t currentCpu() const { return currentCpu_(); }
+
+      /** @brief The node the calling thread is running on */
+      uint32_t currentNode() const { return nodeOf(currentCpu()); }
+
+      /** @brief Parse a list of CPUs such as "0-3,8,10-11", as found in
+       *         /sys/devices/system/node/node0/cpulist
+       *
+       *  @throws std::invalid_argument if <tt>text</tt> is malformed
+       */
+      static std::vector<uint32_t> parseCpuList(const std::string& text);
+
+    protected:
+      virtual uint32_t currentCpu_() const;
+
+    private:
+      std::vector<uint32_t> nodeOfCpu_;
+      std::vector<uint32_t> cpus_;
+      std::vector<uint32_t> nodeIds_;
+      std::vector< std::vector<uint32_t> > cpusOnNode_;
+      std::vector< std::vector<uint32_t> > nearestNodes_;
+    };
+
+  }
+}
+#endif
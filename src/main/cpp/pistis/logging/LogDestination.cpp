@@ -0,0 +1,53 @@
+#include "LogDestination.hpp"
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+using namespace pistis::logging;
+
+namespace {
+  /** @brief Every name interned so far.
+   *
+   *  Names live in a deque, which never moves its elements, so
+   *  LogDestinations can point to them.  The table is never destroyed,
+   *  so handles stay valid while other static objects are destroyed.
+   */
+  class InternTable {
+  public:
+    InternTable(): sync_(), ids_(), names_(1) { }
+
+    std::mutex sync_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::deque<std::string> names_;
+  };
+
+  InternTable& internTable() {
+    static InternTable* table= new InternTable();
+    return *table;
+  }
+}
+
+LogDestination::LogDestination(const std::string& name):
+    id_(0), name_(&emptyName_()) {
+  if (!name.empty()) {
+    InternTable& table= internTable();
+    std::unique_lock<std::mutex> lock(table.sync_);
+    auto i= table.ids_.find(name);
+    if (i == table.ids_.end()) {
+      table.names_.push_back(name);
+      i= table.ids_.emplace(name, (uint32_t)(table.names_.size() - 1)).first;
+    }
+    id_= i->second;
+    name_= &table.names_[id_];
+  }
+}
+
+size_t LogDestination::numInterned() {
+  InternTable& table= internTable();
+  std::unique_lock<std::mutex> lock(table.sync_);
+  return table.names_.size();
+}
+
+const std::string& LogDestination::emptyName_() {
+  return internTable().names_.front();
+}
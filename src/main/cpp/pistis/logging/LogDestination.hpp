@@ -0,0 +1,72 @@
+#ifndef __PISTIS__LOGGING__LOGDESTINATION_HPP__
+#define __PISTIS__LOGGING__LOGDESTINATION_HPP__
+
+#include <ostream>
+#include <string>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Handle to an interned destination name.
+     *
+     *  Each distinct name is interned once, the first time a
+     *  LogDestination is created from it, and gets a small integer id
+     *  and an immutable copy that lives until the program exits.
+     *  Handles are two words, copied by value, and compared by id, so
+     *  passing a destination from a Log through its LogStreams to its
+     *  LogMessages copies no strings, and a receiver can route messages
+     *  with an integer compare.  The default handle has id 0 and an
+     *  empty name.
+     */
+    class LogDestination {
+    public:
+      LogDestination(): id_(0), name_(&emptyName_()) { }
+
+      /** @brief Intern <tt>name</tt> and return its handle.
+       *
+       *  Takes a lock and looks <tt>name</tt> up in a hash table, so code
+       *  that logs often should keep the handle rather than convert the
+       *  name each time.
+       */
+      LogDestination(const std::string& name);
+      LogDestination(const char* name): LogDestination(std::string(name)) { }
+
+      uint32_t id() const { return id_; }
+      const std::string& name() const { return *name_; }
+
+      /** @brief Number of distinct names interned so far, including the
+       *         empty name
+       */
+      static size_t numInterned();
+
+    private:
+      uint32_t id_;
+      const std::string* name_;
+
+      static const std::string& emptyName_();
+    };
+
+    inline bool operator==(const LogDestination& left,
+			   const LogDestination& right) {
+      return left.id() == right.id();
+    }
+
+    inline bool operator!=(const LogDestination& left,
+			   const LogDestination& right) {
+      return left.id() != right.id();
+    }
+
+    inline bool operator<(const LogDestination& left,
+			  const LogDestination& right) {
+      return left.id() < right.id();
+    }
+
+    inline std::ostream& operator<<(std::ostream& out,
+				    const LogDestination& destination) {
+      return out << destination.name();
+    }
+
+  }
+}
+#endif
@@ -0,0 +1,23 @@
+#include "LogField.hpp"
+#include "FormatArgEncoding.hpp"
+
+using namespace pistis::logging;
+
+void LogFieldIterator::parse_() {
+  if (p_ == end_) {
+    return;
+  }
+
+  EncodedFormatArgReader in(p_, end_);
+  const uint16_t keySize= in.read<uint16_t>();
+  const char* key= in.skip(keySize);
+  const FormatArg value= in.readFormatArg();
+
+  if (in.ok()) {
+    field_= LogField(key, keySize, value);
+    next_= in.current();
+  } else {
+    p_= end_;
+    next_= end_;
+  }
+}
@@ -0,0 +1,96 @@
+#ifndef __PISTIS__LOGGING__LOGFIELD_HPP__
+#define __PISTIS__LOGGING__LOGFIELD_HPP__
+
+#include <pistis/logging/FormatArg.hpp>
+#include <iterator>
+#include <string>
+#include <stddef.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief A structured key/value field attached to a LogMessage.
+     *
+     *  Fields are added with LogStream::kv() and stored in the message
+     *  in binary form, separately from its text, so receivers can filter
+     *  on them or write them out as JSON or logfmt without parsing the
+     *  text.  The key and, for strings, the value refer to the message's
+     *  storage and are only valid while the message is unchanged.
+     */
+    class LogField {
+    public:
+      LogField(): key_(nullptr), keySize_(0), value_() { }
+      LogField(const char* key, size_t keySize, const FormatArg& value):
+	  key_(key), keySize_(keySize), value_(value) {
+	// Intentionally left blank
+      }
+
+      const char* keyData() const { return key_; }
+      size_t keySize() const { return keySize_; }
+      std::string key() const { return std::string(key_, keySize_); }
+
+      /** @brief The field's value.
+       *
+       *  Values whose type is not built into FormatArg were formatted with
+       *  their operator<< when the field was added and are strings.
+       */
+      const FormatArg& value() const { return value_; }
+
+    private:
+      const char* key_;
+      size_t keySize_;
+      FormatArg value_;
+    };
+
+    /** @brief Iterates over the fields of a LogMessage */
+    class LogFieldIterator {
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef LogField value_type;
+      typedef ptrdiff_t difference_type;
+      typedef const LogField* pointer;
+      typedef const LogField& reference;
+
+    public:
+      LogFieldIterator(const char* p, const char* end):
+	  p_(p), next_(p), end_(end), field_() {
+	parse_();
+      }
+
+      const LogField& operator*() const { return field_; }
+      const LogField* operator->() const { return &field_; }
+
+      LogFieldIterator& operator++() {
+	p_= next_;
+	parse_();
+	return *this;
+      }
+
+      LogFieldIterator operator++(int) {
+	LogFieldIterator tmp(*this);
+	++(*this);
+	return tmp;
+      }
+
+      bool operator==(const LogFieldIterator& other) const {
+	return p_ == other.p_;
+      }
+      bool operator!=(const LogFieldIterator& other) const {
+	return p_ != other.p_;
+      }
+
+    private:
+      const char* p_;
+      const char* next_;
+      const char* end_;
+      LogField field_;
+
+      /** @brief Decode the field at p_, or move to the end if the field is
+       *         corrupt
+       */
+      void parse_();
+    };
+
+  }
+}
+#endif
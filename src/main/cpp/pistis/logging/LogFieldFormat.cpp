@@ -0,0 +1,147 @@
+#include "LogFieldFormat.hpp"
+#include "NumberFormat.hpp"
+#include <math.h>
+
+using namespace pistis::logging;
+
+namespace {
+  static const char HEX_DIGITS[]= "0123456789abcdef";
+
+  bool needsLogfmtQuotes(const char* text, size_t n) {
+    if (!n) {
+      return true;
+    }
+    for (const char* p= text; p != text + n; ++p) {
+      if ((*p == ' ') || (*p == '"') || (*p == '=') || ((uint8_t)*p < 0x20)) {
+	return true;
+      }
+    }
+    return false;
+  }
+
+  void writeLogfmtString(const char* text, size_t n, LogMessageWriter& out) {
+    if (!needsLogfmtQuotes(text, n)) {
+      out.write(text, n);
+      return;
+    }
+
+    const char* literal= text;
+    out.put('"');
+    for (const char* p= text; p != text + n; ++p) {
+      if ((*p == '"') || (*p == '\\') || (*p == '\n')) {
+	out.write(literal, (size_t)(p - literal));
+	out.put('\\');
+	out.put((*p == '\n') ? 'n' : *p);
+	literal= p + 1;
+      }
+    }
+    out.write(literal, (size_t)(text + n - literal));
+    out.put('"');
+  }
+
+  void writeJsonString(const char* text, size_t n, LogMessageWriter& out) {
+    const char* literal= text;
+    out.put('"');
+    for (const char* p= text; p != text + n; ++p) {
+      const uint8_t c= (uint8_t)*p;
+      if ((c == '"') || (c == '\\') || (c < 0x20)) {
+	out.write(literal, (size_t)(p - literal));
+	out.put('\\');
+	switch (c) {
+	  case '"':  out.put('"'); break;
+	  case '\\': out.put('\\'); break;
+	  case '\n': out.put('n'); break;
+	  case '\r': out.put('r'); break;
+	  case '\t': out.put('t'); break;
+	  default:
+	    out.write("u00", 3);
+	    out.put(HEX_DIGITS[c >> 4]);
+	    out.put(HEX_DIGITS[c & 0xF]);
+	    break;
+	}
+	literal= p + 1;
+      }
+    }
+    out.write(literal, (size_t)(text + n - literal));
+    out.put('"');
+  }
+
+  /** @brief Write a value that is not a string as text, the same way
+   *         LogMessageWriter::write(const FormatArg&) does, but into a
+   *         buffer so it can be quoted or escaped.
+   */
+  size_t formatNonString(const FormatArg& value, char* buffer) {
+    switch (value.type()) {
+      case FormatArg::Type::CHAR:
+	buffer[0]= value.charValue();
+	return 1;
+
+      case FormatArg::Type::POINTER:
+	return (size_t)(formatPointer(buffer, value.pointerValue()) - buffer);
+
+      default:
+	return 0;
+    }
+  }
+}
+
+void pistis::logging::writeFieldsAsLogfmt(const LogMessage& msg,
+					  LogMessageWriter& out) {
+  char buffer[MAX_FORMATTED_NUMBER_SIZE];
+
+  for (auto i= msg.fieldsBegin(); i != msg.fieldsEnd(); ++i) {
+    if (i != msg.fieldsBegin()) {
+      out.put(' ');
+    }
+    writeLogfmtString(i->keyData(), i->keySize(), out);
+    out.put('=');
+
+    const FormatArg& value= i->value();
+    if (value.type() == FormatArg::Type::STRING) {
+      writeLogfmtString(value.stringData(), value.stringSize(), out);
+    } else if (value.type() == FormatArg::Type::CHAR) {
+      writeLogfmtString(buffer, formatNonString(value, buffer), out);
+    } else {
+      out.write(value);
+    }
+  }
+}
+
+void pistis::logging::writeFieldsAsJson(const LogMessage& msg,
+					LogMessageWriter& out) {
+  char buffer[MAX_FORMATTED_NUMBER_SIZE];
+
+  out.put('{');
+  for (auto i= msg.fieldsBegin(); i != msg.fieldsEnd(); ++i) {
+    if (i != msg.fieldsBegin()) {
+      out.put(',');
+    }
+    writeJsonString(i->keyData(), i->keySize(), out);
+    out.put(':');
+
+    const FormatArg& value= i->value();
+    switch (value.type()) {
+      case FormatArg::Type::STRING:
+	writeJsonString(value.stringData(), value.stringSize(), out);
+	break;
+
+      case FormatArg::Type::CHAR:
+      case FormatArg::Type::POINTER:
+	writeJsonString(buffer, formatNonString(value, buffer), out);
+	break;
+
+      case FormatArg::Type::DOUBLE:
+	if (isfinite(value.doubleValue())) {
+	  out.write(value);
+	} else {
+	  out.write("null", 4);
+	}
+	break;
+
+      default:
+	out.write(value);
+	break;
+    }
+  }
+  out.put('}');
+}
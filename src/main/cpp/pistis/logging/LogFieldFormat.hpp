@@ -0,0 +1,33 @@
+#ifndef __PISTIS__LOGGING__LOGFIELDFORMAT_HPP__
+#define __PISTIS__LOGGING__LOGFIELDFORMAT_HPP__
+
+#include <pistis/logging/LogMessage.hpp>
+#include <pistis/logging/LogMessageWriter.hpp>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Write the fields of <tt>msg</tt> to <tt>out</tt> in logfmt
+     *         form.
+     *
+     *  Fields are written as <tt>key=value</tt> pairs separated by
+     *  spaces.  Strings that are empty or contain spaces, quotes, equals
+     *  signs or control characters are quoted, with quotes, backslashes
+     *  and newlines escaped by backslashes.  Nothing is written if the
+     *  message has no fields.
+     */
+    void writeFieldsAsLogfmt(const LogMessage& msg, LogMessageWriter& out);
+
+    /** @brief Write the fields of <tt>msg</tt> to <tt>out</tt> as a JSON
+     *         object.
+     *
+     *  Numbers and booleans are written as JSON numbers and booleans,
+     *  except that infinities and NaN, which JSON cannot represent, are
+     *  written as null.  Characters, strings and pointers are written as
+     *  strings.  A message without fields is written as "{}".
+     */
+    void writeFieldsAsJson(const LogMessage& msg, LogMessageWriter& out);
+
+  }
+}
+#endif
@@ -6,6 +6,35 @@
 #include <utility>
 #include <stdint.h>
 
+/** @brief Numeric values of the log levels, for use in preprocessor
+ *         conditionals.  These must match the values of LogLevel.
+ */
+#define PISTIS_LOGGING_LEVEL_TRACE 1
+#define PISTIS_LOGGING_LEVEL_DEBUG 2
+#define PISTIS_LOGGING_LEVEL_INFO 3
+#define PISTIS_LOGGING_LEVEL_WARN 4
+#define PISTIS_LOGGING_LEVEL_ERROR 5
+
+/** @brief Lowest level of log statement compiled into the program.
+ *
+ *  Statements written with the PISTIS_LOG family of macros whose level
+ *  is below this one compile to nothing: no instructions, and none of
+ *  their arguments or string literals end up in the object file.  Set
+ *  it on the compiler command line using the level's name, e.g.
+ *  <tt>-DPISTIS_LOGGING_MIN_LEVEL=INFO</tt>.  Defaults to TRACE, which
+ *  compiles in all statements.
+ */
+#ifndef PISTIS_LOGGING_MIN_LEVEL
+#define PISTIS_LOGGING_MIN_LEVEL TRACE
+#endif
+
+#define PISTIS_LOGGING_LEVEL_VALUE_(name) PISTIS_LOGGING_LEVEL_##name
+#define PISTIS_LOGGING_LEVEL_VALUE(name) PISTIS_LOGGING_LEVEL_VALUE_(name)
+
+/** @brief Numeric value of PISTIS_LOGGING_MIN_LEVEL */
+#define PISTIS_LOGGING_MIN_LEVEL_VALUE \
+  PISTIS_LOGGING_LEVEL_VALUE(PISTIS_LOGGING_MIN_LEVEL)
+
 namespace pistis {
   namespace logging {
 
@@ -17,6 +46,20 @@ namespace pistis {
       ERROR = 5   ///< Highest logging level; errors only
     };
 
+    /** @brief Lowest level of log statement compiled into the program.
+     *
+     *  @see PISTIS_LOGGING_MIN_LEVEL
+     */
+    constexpr LogLevel MIN_COMPILED_LOG_LEVEL=
+      (LogLevel)PISTIS_LOGGING_MIN_LEVEL_VALUE;
+
+    /** @brief Returns true if log statements at level <tt>l</tt> are
+     *         compiled into the program.
+     */
+    constexpr bool isCompiledIn(LogLevel l) {
+      return l >= MIN_COMPILED_LOG_LEVEL;
+    }
+
     std::pair<bool, LogLevel> parseLogLevel(const std::string& text);
 
     const std::string& toString(LogLevel level);
@@ -0,0 +1,280 @@
+#ifndef __PISTIS__LOGGING__LOGMACROS_HPP__
+#define __PISTIS__LOGGING__LOGMACROS_HPP__
+
+#include <pistis/logging/Log.hpp>
+#include <pistis/logging/LogSiteRegistry.hpp>
+#include <pistis/logging/LogThrottle.hpp>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Turns a log statement into an expression of type void.
+     *
+     *  Used by the PISTIS_LOG family of macros so both branches of the
+     *  conditional they expand to have the same type.  The "&" operator
+     *  binds more loosely than "<<", so it applies to the LogStream after
+     *  all of the statement's arguments have been written to it.
+     */
+    struct LogStatementSink {
+      template <typename CharT, typename TraitsT>
+      void operator&(const LogStream<CharT, TraitsT>&) const { }
+    };
+
+    /** @brief Collects the arguments of a deferred log statement.
+     *
+     *  Created by the PISTIS_LOG_DEFERRED family of macros, which call it
+     *  with the statement's arguments.  <tt>NUM_ARGS</tt> is the number
+     *  of placeholders in the site's format string, so passing the wrong
+     *  number of arguments is a compile error.
+     */
+    template <size_t NUM_ARGS>
+    class DeferredLogStatement {
+    public:
+      DeferredLogStatement(const Log& log, const LogSite& site):
+	  log_(log), site_(site) {
+	// Intentionally left blank
+      }
+
+      template <typename... ArgsT>
+      void operator()(const ArgsT&... args) const {
+	static_assert(NUM_ARGS == sizeof...(ArgsT),
+		      "Number of arguments does not match the number of "
+		      "placeholders in the format string");
+	// The extra FormatArg keeps the array from having size zero
+	const FormatArg formatArgs[]= { FormatArg(args)..., FormatArg() };
+	log_.logDeferredUnchecked(site_, formatArgs, NUM_ARGS);
+      }
+
+    private:
+      const Log& log_;
+      const LogSite& site_;
+    };
+
+    /** @brief Runs the body of a throttled log statement at most once.
+     *
+     *  The PISTIS_LOG_FIRST_N family of macros expand to a for statement
+     *  that declares a LogThrottleGate, so the number of executions the
+     *  throttle suppressed can be carried from the check to the
+     *  statement.  report() attaches that number to the statement as a
+     *  field named "suppressed", if it is not zero.
+     */
+    class LogThrottleGate {
+    public:
+      template <typename ThrottleT>
+      LogThrottleGate(ThrottleT& throttle, bool enabled):
+	  suppressed_(0), open_(enabled && throttle.allow(suppressed_)) {
+	// Intentionally left blank
+      }
+
+      bool open() const { return open_; }
+      void close() { open_= false; }
+      uint64_t suppressed() const { return suppressed_; }
+
+      template <typename CharT, typename TraitsT>
+      const LogStream<CharT, TraitsT>& report(
+	  const LogStream<CharT, TraitsT>& s
+      ) const {
+	return suppressed_ ? s.kv("suppressed", suppressed_) : s;
+      }
+
+    private:
+      uint64_t suppressed_;
+      bool open_;
+    };
+
+  }
+}
+
+/** @brief Expands to an expression that is true if a statement at level
+ *         <tt>level</tt> should be written to <tt>logger</tt>.
+ *
+ *  That is the case when the level is compiled in and either enabled
+ *  for <tt>logger</tt> or turned on for this one statement through the
+ *  LogSiteRegistry.  Gives the statement its own LogSiteSwitch, which
+ *  is only consulted when the level is disabled.
+ */
+#define PISTIS_LOG_IS_ON_(logger, level)				\
+  (::pistis::logging::isCompiledIn(level) &&				\
+   ((logger).isEnabled(level) ||					\
+    []() -> ::pistis::logging::LogSiteSwitch& {				\
+      static ::pistis::logging::LogSiteSwitch site(__FILE__, __LINE__);	\
+      return site;							\
+    }().isOn((level), __func__, (logger).destinationHandle())))
+
+/** @brief Log a statement at level <tt>level</tt> to <tt>logger</tt>
+ *
+ *  Checks whether <tt>level</tt> is enabled before doing anything else.
+ *  When it is not, no LogStream is created and none of the arguments
+ *  written to the statement are evaluated, so disabled statements cost
+ *  a load and a branch, plus a relaxed load and a branch to check the
+ *  statement's LogSiteSwitch.  Turning the switch on with
+ *  LogSiteRegistry logs the statement even though its level is
+ *  disabled.  Use it like a LogStream:
+ *
+ *  <pre>
+ *    PISTIS_LOG(log, LogLevel::DEBUG) << "Total is " << computeTotal();
+ *  </pre>
+ *
+ *  The statement expands to a single expression, so it is safe to use
+ *  as the body of an unbraced if or else.
+ *
+ *  When <tt>level</tt> is a constant below PISTIS_LOGGING_MIN_LEVEL,
+ *  the optimizer removes the statement entirely.  The per-level macros
+ *  (PISTIS_TRACE, PISTIS_DEBUG, ...) remove statements below
+ *  PISTIS_LOGGING_MIN_LEVEL even when optimization is off.
+ */
+#define PISTIS_LOG(logger, level)					\
+  !PISTIS_LOG_IS_ON_(logger, level) ? (void)0 :				\
+    ::pistis::logging::LogStatementSink() & (logger).logUnchecked(level)
+
+/** @brief Wide-character version of PISTIS_LOG */
+#define PISTIS_WLOG(logger, level)					\
+  !PISTIS_LOG_IS_ON_(logger, level) ? (void)0 :				\
+    ::pistis::logging::LogStatementSink() & (logger).wlogUnchecked(level)
+
+/** @brief Expands to a log statement that is never executed.
+ *
+ *  The statement's arguments are still parsed and type-checked, so
+ *  code that compiles at one PISTIS_LOGGING_MIN_LEVEL compiles at all of
+ *  them, but the constant condition means the compiler emits neither
+ *  code nor data for it.
+ */
+#define PISTIS_LOG_DISCARDED_(logger, level)				\
+  true ? (void)0 :							\
+    ::pistis::logging::LogStatementSink() & (logger).log(level)
+
+#if PISTIS_LOGGING_MIN_LEVEL_VALUE <= PISTIS_LOGGING_LEVEL_TRACE
+#define PISTIS_TRACE(logger)						\
+  PISTIS_LOG(logger, ::pistis::logging::LogLevel::TRACE)
+#else
+#define PISTIS_TRACE(logger)						\
+  PISTIS_LOG_DISCARDED_(logger, ::pistis::logging::LogLevel::TRACE)
+#endif
+
+#if PISTIS_LOGGING_MIN_LEVEL_VALUE <= PISTIS_LOGGING_LEVEL_DEBUG
+#define PISTIS_DEBUG(logger)						\
+  PISTIS_LOG(logger, ::pistis::logging::LogLevel::DEBUG)
+#else
+#define PISTIS_DEBUG(logger)						\
+  PISTIS_LOG_DISCARDED_(logger, ::pistis::logging::LogLevel::DEBUG)
+#endif
+
+#if PISTIS_LOGGING_MIN_LEVEL_VALUE <= PISTIS_LOGGING_LEVEL_INFO
+#define PISTIS_INFO(logger)						\
+  PISTIS_LOG(logger, ::pistis::logging::LogLevel::INFO)
+#else
+#define PISTIS_INFO(logger)						\
+  PISTIS_LOG_DISCARDED_(logger, ::pistis::logging::LogLevel::INFO)
+#endif
+
+#if PISTIS_LOGGING_MIN_LEVEL_VALUE <= PISTIS_LOGGING_LEVEL_WARN
+#define PISTIS_WARN(logger)						\
+  PISTIS_LOG(logger, ::pistis::logging::LogLevel::WARN)
+#else
+#define PISTIS_WARN(logger)						\
+  PISTIS_LOG_DISCARDED_(logger, ::pistis::logging::LogLevel::WARN)
+#endif
+
+// ERROR is the highest level, so it is always compiled in
+#define PISTIS_ERROR(logger)						\
+  PISTIS_LOG(logger, ::pistis::logging::LogLevel::ERROR)
+
+/** @brief Log a statement at level <tt>level</tt> without formatting it
+ *
+ *  Defines a LogSite for the statement, with <tt>text</tt> as its
+ *  format string, and logs the statement with Log::logDeferred(), so
+ *  the statement's arguments are copied into a LogMessage and only
+ *  formatted once the message reaches a DecodingLogMessageReceiver or
+ *  other user of BinaryLogDecoder.  Follow the macro with the arguments
+ *  in parentheses:
+ *
+ *  <pre>
+ *    PISTIS_LOG_DEFERRED(log, LogLevel::INFO, "User {} took {} ms")(
+ *        userId, elapsed
+ *    );
+ *  </pre>
+ *
+ *  <tt>text</tt> must be a string literal and <tt>level</tt> a constant.
+ *  As with PISTIS_LOG, the arguments are not evaluated when
+ *  <tt>level</tt> is disabled, unless the statement's LogSiteSwitch is
+ *  on.  The statement expands to an if-else, so
+ *  it is safe to use as the body of an unbraced if or else.
+ */
+#define PISTIS_LOG_DEFERRED(logger, level, text)			\
+  if (!PISTIS_LOG_IS_ON_(logger, level)) { } else			\
+    ::pistis::logging::DeferredLogStatement<				\
+        ::pistis::logging::countFormatArgs(text)			\
+    >((logger), []() -> const ::pistis::logging::LogSite& {		\
+	static constexpr ::pistis::logging::LogSite site(		\
+	    text, __FILE__, __LINE__, level				\
+	);								\
+	return site;							\
+      }())
+
+#define PISTIS_TRACE_DEFERRED(logger, text)				\
+  PISTIS_LOG_DEFERRED(logger, ::pistis::logging::LogLevel::TRACE, text)
+#define PISTIS_DEBUG_DEFERRED(logger, text)				\
+  PISTIS_LOG_DEFERRED(logger, ::pistis::logging::LogLevel::DEBUG, text)
+#define PISTIS_INFO_DEFERRED(logger, text)				\
+  PISTIS_LOG_DEFERRED(logger, ::pistis::logging::LogLevel::INFO, text)
+#define PISTIS_WARN_DEFERRED(logger, text)				\
+  PISTIS_LOG_DEFERRED(logger, ::pistis::logging::LogLevel::WARN, text)
+#define PISTIS_ERROR_DEFERRED(logger, text)				\
+  PISTIS_LOG_DEFERRED(logger, ::pistis::logging::LogLevel::ERROR, text)
+
+/** @brief Common implementation of the throttled log statements.
+ *
+ *  Gives the statement its own static throttle of type
+ *  <tt>ThrottleT</tt>, constructed from <tt>limit</tt>, and only logs
+ *  the statement when the level is enabled and the throttle allows it.
+ *  Expands to a for statement whose body runs at most once, so it is
+ *  safe to use as the body of an unbraced if or else.
+ */
+#define PISTIS_LOG_THROTTLED_(logger, level, ThrottleT, limit)		\
+  for (::pistis::logging::LogThrottleGate pistisLogThrottleGate_(	\
+	   []() -> ::pistis::logging::ThrottleT& {			\
+	     static ::pistis::logging::ThrottleT throttle(limit);	\
+	     return throttle;						\
+	   }(),								\
+	   PISTIS_LOG_IS_ON_(logger, level));				\
+       pistisLogThrottleGate_.open(); pistisLogThrottleGate_.close())	\
+    ::pistis::logging::LogStatementSink() &				\
+        pistisLogThrottleGate_.report((logger).logUnchecked(level))
+
+/** @brief Log only the first <tt>n</tt> executions of a statement
+ *
+ *  Used like PISTIS_LOG:
+ *
+ *  <pre>
+ *    PISTIS_LOG_FIRST_N(log, LogLevel::WARN, 10) << "Retrying " << id;
+ *  </pre>
+ *
+ *  Each statement counts its own executions, across all threads, with
+ *  lock-free atomic counters.  <tt>n</tt> must be a constant
+ *  expression.  Executions at a disabled level are not counted, and
+ *  suppressed executions do not evaluate the statement's arguments or
+ *  obtain a LogMessage.
+ */
+#define PISTIS_LOG_FIRST_N(logger, level, n)				\
+  PISTIS_LOG_THROTTLED_(logger, level, FirstNLogThrottle, n)
+
+/** @brief Log the first and then every <tt>n</tt>th execution of a
+ *         statement
+ *
+ *  Messages after the first carry a "suppressed" field with the number
+ *  of executions skipped since the last one logged.  Otherwise the
+ *  same as PISTIS_LOG_FIRST_N.
+ */
+#define PISTIS_LOG_EVERY_N(logger, level, n)				\
+  PISTIS_LOG_THROTTLED_(logger, level, EveryNLogThrottle, n)
+
+/** @brief Log at most <tt>n</tt> executions of a statement per second
+ *
+ *  The first message logged after some executions were suppressed
+ *  carries a "suppressed" field with their number.  Otherwise the same
+ *  as PISTIS_LOG_FIRST_N.
+ */
+#define PISTIS_LOG_RATE_LIMITED(logger, level, n)			\
+  PISTIS_LOG_THROTTLED_(logger, level, RateLimitLogThrottle, n)
+
+#endif
@@ -0,0 +1,38 @@
+#include "LogMemoryResource.hpp"
+#include <new>
+#include <stdlib.h>
+
+using namespace pistis::logging;
+
+namespace {
+  /** @brief Allocates with operator new, or posix_memalign() when the
+   *         alignment is stricter than operator new guarantees
+   */
+  class HeapLogMemoryResource : public LogMemoryResource {
+  protected:
+    virtual void* allocate_(size_t bytes, size_t alignment) override {
+      if (alignment <= alignof(max_align_t)) {
+	return ::operator new(bytes);
+      }
+
+      void* p= nullptr;
+      if (posix_memalign(&p, alignment, bytes)) {
+	throw std::bad_alloc();
+      }
+      return p;
+    }
+
+    virtual void deallocate_(void* p, size_t, size_t alignment) override {
+      if (alignment <= alignof(max_align_t)) {
+	::operator delete(p);
+      } else {
+	free(p);
+      }
+    }
+  };
+}
+
+LogMemoryResource* LogMemoryResource::defaultResource() {
+  static LogMemoryResource* resource= new HeapLogMemoryResource();
+  return resource;
+}
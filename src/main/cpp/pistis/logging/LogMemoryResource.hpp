@@ -0,0 +1,56 @@
+#ifndef __PISTIS__LOGGING__LOGMEMORYRESOURCE_HPP__
+#define __PISTIS__LOGGING__LOGMEMORYRESOURCE_HPP__
+
+#include <stddef.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Source of the memory LogMessages are made of.
+     *
+     *  Modelled on C++17's std::pmr::memory_resource.  LogMessages
+     *  allocate their text and fields from the resource they were
+     *  constructed with, and LogMessage::create() allocates the message
+     *  itself from it too, so logging can be backed by a dedicated arena
+     *  instead of the process-wide heap.  Factories pass their resource
+     *  on to every message they make.
+     *
+     *  Implementations override allocate_() and deallocate_().  They
+     *  must be thread-safe if messages from the same resource are
+     *  created or destroyed on more than one thread, and must outlive
+     *  every message allocated from them.
+     */
+    class LogMemoryResource {
+    public:
+      virtual ~LogMemoryResource() { }
+
+      /** @brief Allocate <tt>bytes</tt> bytes aligned on an
+       *         <tt>alignment</tt>-byte boundary.
+       *
+       *  @throws std::bad_alloc if the memory cannot be allocated
+       */
+      void* allocate(size_t bytes, size_t alignment= alignof(max_align_t)) {
+	return allocate_(bytes, alignment);
+      }
+
+      /** @brief Return memory obtained from allocate() with the same
+       *         <tt>bytes</tt> and <tt>alignment</tt>
+       */
+      void deallocate(void* p, size_t bytes,
+		      size_t alignment= alignof(max_align_t)) {
+	deallocate_(p, bytes, alignment);
+      }
+
+      /** @brief The resource messages use unless told otherwise, which
+       *         allocates from the heap
+       */
+      static LogMemoryResource* defaultResource();
+
+    protected:
+      virtual void* allocate_(size_t bytes, size_t alignment) = 0;
+      virtual void deallocate_(void* p, size_t bytes, size_t alignment) = 0;
+    };
+
+  }
+}
+#endif
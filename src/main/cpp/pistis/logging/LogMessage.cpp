@@ -1,34 +1,204 @@
 #include "LogMessage.hpp"
-#include <memory>
+#include "FormatArgEncoding.hpp"
+#include <algorithm>
+#include <atomic>
 #include <string.h>
 
 using namespace pistis::logging;
 
-LogMessage::LogMessage(size_t capacity):
-    data_(new char[capacity]), end_(data_), eos_(data_ + capacity),
-    maxCapacity_(capacity), logLevel_(), destination_() {
+/** @brief Appends to a LogMessage's fields, growing the field buffer as
+ *         needed.
+ *
+ *  Nothing is visible in the message until commit() is called, so a
+ *  field that does not fit leaves the message unchanged.
+ */
+class LogMessage::FieldWriter_ : public std::streambuf {
+public:
+  FieldWriter_(LogMessage& msg):
+      msg_(msg), end_(msg.fieldsEnd_), ok_(true) {
+    // Intentionally left blank
+  }
+
+  bool ok() const { return ok_; }
+  size_t size() const { return (size_t)(end_ - msg_.fieldsEnd_); }
+
+  void write(const void* data, size_t n) {
+    if (((size_t)(msg_.fieldsEos_ - end_) >= n) || grow_(n)) {
+      memcpy(end_, data, n);
+      end_ += n;
+    }
+  }
+
+  void writeAt(size_t offset, const void* data, size_t n) {
+    if (ok_) {
+      memcpy(msg_.fieldsEnd_ + offset, data, n);
+    }
+  }
+
+  bool commit() {
+    if (ok_) {
+      msg_.fieldsEnd_= end_;
+    }
+    return ok_;
+  }
+
+protected:
+  virtual std::streamsize xsputn(const char* data, std::streamsize n) {
+    write(data, (size_t)n);
+    return n;
+  }
+
+  virtual int_type overflow(int_type c= traits_type::eof()) {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      const char ch= traits_type::to_char_type(c);
+      write(&ch, 1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+private:
+  static const size_t INITIAL_SIZE_= 64;
+
+  LogMessage& msg_;
+  char* end_;
+  bool ok_;
+
+  bool grow_(size_t n) {
+    const size_t used= (size_t)(end_ - msg_.fields_);
+    const size_t target= used + n;
+    if (!ok_ || (target > msg_.maxCapacity())) {
+      ok_= false;
+      return false;
+    }
+
+    size_t newSize= std::max((size_t)(msg_.fieldsEos_ - msg_.fields_),
+			     INITIAL_SIZE_);
+    while (newSize < target) {
+      newSize *= 2;
+    }
+    newSize= std::min(newSize, msg_.maxCapacity());
+
+    char* newFields= msg_.allocateBuffer_(newSize);
+    if (used) {
+      memcpy(newFields, msg_.fields_, used);
+    }
+    const size_t committed= msg_.fieldsSize();
+    msg_.deallocateBuffer_(msg_.fields_,
+			   (size_t)(msg_.fieldsEos_ - msg_.fields_));
+    msg_.fields_= newFields;
+    msg_.fieldsEnd_= newFields + committed;
+    msg_.fieldsEos_= newFields + newSize;
+    end_= newFields + used;
+    return true;
+  }
+};
+
+const size_t LogMessage::FieldWriter_::INITIAL_SIZE_;
+
+LogMessage::LogMessage(size_t capacity, LogMemoryResource* resource):
+    resource_(resource), headerResource_(nullptr),
+    data_(allocateBuffer_(capacity)), end_(data_), eos_(data_ + capacity),
+    maxCapacity_(capacity), inlineCapacity_(0), logLevel_(),
+    encoding_(LogMessageEncoding::TEXT), location_(), destination_(),
+    timestamp_(), thread_(), statementId_(0), partNumber_(0),
+    finalPart_(true), fields_(nullptr), fieldsEnd_(nullptr),
+    fieldsEos_(nullptr), nextSegment_(nullptr), refCount_(1),
+    factoryTag_(nullptr) {
   // Intentionally left blank
 }
 
-LogMessage::LogMessage(size_t initialCapacity, size_t maximumCapacity):
-    data_(new char[initialCapacity]), end_(data_),
+LogMessage::LogMessage(size_t initialCapacity, size_t maximumCapacity,
+		       LogMemoryResource* resource):
+    resource_(resource), headerResource_(nullptr),
+    data_(allocateBuffer_(initialCapacity)), end_(data_),
     eos_(data_ + initialCapacity), maxCapacity_(maximumCapacity),
-    logLevel_(), destination_() {
+    inlineCapacity_(0), logLevel_(), encoding_(LogMessageEncoding::TEXT),
+    location_(), destination_(), timestamp_(), thread_(), statementId_(0),
+    partNumber_(0), finalPart_(true), fields_(nullptr),
+    fieldsEnd_(nullptr), fieldsEos_(nullptr), nextSegment_(nullptr),
+    refCount_(1), factoryTag_(nullptr) {
+  // Intentionally left blank
+}
+
+LogMessage::LogMessage(size_t maximumCapacity,
+		       const InlineStorage_& storage):
+    resource_(storage.resource), headerResource_(storage.resource),
+    data_(inlineData_()), end_(data_), eos_(data_ + storage.capacity),
+    maxCapacity_(maximumCapacity), inlineCapacity_(storage.capacity),
+    logLevel_(), encoding_(LogMessageEncoding::TEXT), location_(),
+    destination_(), timestamp_(), thread_(), statementId_(0),
+    partNumber_(0), finalPart_(true), fields_(nullptr),
+    fieldsEnd_(nullptr), fieldsEos_(nullptr), nextSegment_(nullptr),
+    refCount_(1), factoryTag_(nullptr) {
   // Intentionally left blank
 }
 
 LogMessage::LogMessage(LogMessage&& other):
-    data_(other.data_), end_(other.end_), eos_(other.eos_),
-    maxCapacity_(other.maxCapacity()), logLevel_(other.logLevel()),
-    destination_(std::move(other.destination_)) {
-  other.data_ = nullptr;
-  other.end_ = nullptr;
-  other.eos_ = nullptr;
+    resource_(other.resource_), headerResource_(nullptr),
+    data_(nullptr), end_(nullptr), eos_(nullptr),
+    maxCapacity_(other.maxCapacity()), inlineCapacity_(0),
+    logLevel_(other.logLevel()), encoding_(other.encoding()),
+    location_(other.location_), destination_(other.destination_),
+    timestamp_(other.timestamp_), thread_(other.thread_),
+    statementId_(other.statementId_), partNumber_(other.partNumber_),
+    finalPart_(other.finalPart_),
+    fields_(nullptr), fieldsEnd_(nullptr), fieldsEos_(nullptr),
+    nextSegment_(other.detachSegments()), refCount_(1),
+    factoryTag_(nullptr) {
+  takeData_(other);
+  takeFields_(other);
   other.maxCapacity_ = 0;
 }
 
 LogMessage::~LogMessage() {
-  delete data_;
+  freeData_();
+  deallocateBuffer_(fields_, (size_t)(fieldsEos_ - fields_));
+  deleteSegments_();
+}
+
+LogMessage* LogMessage::create(size_t initialCapacity,
+			       size_t maximumCapacity,
+			       LogMemoryResource* resource) {
+  const InlineStorage_ storage{ initialCapacity, resource };
+  return new(storage) LogMessage(maximumCapacity, storage);
+}
+
+void LogMessage::destroy(LogMessage* msg) {
+  if (msg && msg->headerResource_) {
+    LogMemoryResource* resource= msg->headerResource_;
+    const size_t size= allocationSize_(msg->inlineCapacity_);
+    msg->~LogMessage();
+    resource->deallocate(msg, size, LOG_MESSAGE_ALIGNMENT);
+  } else {
+    delete msg;
+  }
+}
+
+void* LogMessage::operator new(size_t size) {
+  // size is larger than sizeof(LogMessage) for classes derived from it
+  return LogMemoryResource::defaultResource()->allocate(
+      allocationSize_(size - sizeof(LogMessage)), LOG_MESSAGE_ALIGNMENT
+  );
+}
+
+void* LogMessage::operator new(size_t /*size*/,
+			       const InlineStorage_& storage) {
+  // Only create() uses this, for a LogMessage itself, so the size is
+  // always sizeof(LogMessage)
+  return storage.resource->allocate(allocationSize_(storage.capacity),
+				    LOG_MESSAGE_ALIGNMENT);
+}
+
+void LogMessage::operator delete(void* p) {
+  // Only messages from the default resource may be deleted, and it
+  // ignores the size
+  LogMemoryResource::defaultResource()->deallocate(p, 0,
+						   LOG_MESSAGE_ALIGNMENT);
+}
+
+void LogMessage::operator delete(void* p, const InlineStorage_& storage) {
+  storage.resource->deallocate(p, allocationSize_(storage.capacity),
+			       LOG_MESSAGE_ALIGNMENT);
 }
 
 size_t LogMessage::increaseCapacity(size_t desiredCapacity) {
@@ -42,30 +212,144 @@ size_t LogMessage::increaseCapacity(size_t desiredCapacity) {
 
 LogMessage& LogMessage::operator=(LogMessage&& other) {
   if (this != &other) {
-    data_ = other.data_; other.data_ = nullptr;
-    end_ = other.end_; other.end_ = nullptr;
-    eos_ = other.eos_; other.eos_ = nullptr;
+    freeData_();
+    takeData_(other);
     maxCapacity_ = other.maxCapacity_; other.maxCapacity_ = 0;
     logLevel_ = other.logLevel_;
-    destination_ = std::move(other.destination_);
+    encoding_ = other.encoding_;
+    location_ = other.location_;
+    destination_ = other.destination_;
+    timestamp_ = other.timestamp_;
+    thread_ = other.thread_;
+    statementId_ = other.statementId_;
+    partNumber_ = other.partNumber_;
+    finalPart_ = other.finalPart_;
+    deallocateBuffer_(fields_, (size_t)(fieldsEos_ - fields_));
+    takeFields_(other);
+    deleteSegments_();
+    nextSegment_ = other.detachSegments();
   }
   return *this;
 }
 
-void LogMessage::increaseBufferSize_(size_t newSize, bool copyData) {
-  std::unique_ptr<char[]> newData(new char[newSize]);
-  char* tmp= data_;
-  size_t oldSize= size();
-  if (copyData && oldSize) {
-    memcpy(newData.get(), data_, oldSize);
-    end_ = newData.get() + oldSize;
+uint64_t LogMessage::newStatementId() {
+  static std::atomic<uint64_t> nextId(1);
+  return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LogMessage::appendSegment(LogMessage* segment) {
+  LogMessage* last= this;
+  while (last->nextSegment_) {
+    last= last->nextSegment_;
+  }
+  last->nextSegment_ = segment;
+}
+
+size_t LogMessage::numSegments() const {
+  size_t n= 0;
+  for (const LogMessage* p= this; p; p= p->nextSegment_) {
+    ++n;
+  }
+  return n;
+}
+
+size_t LogMessage::totalSize() const {
+  size_t n= 0;
+  for (const LogMessage* p= this; p; p= p->nextSegment_) {
+    n += p->size();
+  }
+  return n;
+}
+
+size_t LogMessage::gather(struct iovec* iov, size_t maxIov) const {
+  size_t n= 0;
+  for (const LogMessage* p= this; p && (n < maxIov); p= p->nextSegment_) {
+    iov[n].iov_base= p->begin();
+    iov[n].iov_len= p->size();
+    ++n;
+  }
+  return n;
+}
+
+void LogMessage::deleteSegments_() {
+  // Iterate rather than recurse, so long chains cannot overflow the stack
+  LogMessage* segment= detachSegments();
+  while (segment) {
+    LogMessage* next= segment->detachSegments();
+    destroy(segment);
+    segment= next;
+  }
+}
+
+void LogMessage::freeData_() {
+  if (!usesInlineStorage()) {
+    deallocateBuffer_(data_, capacity());
+  }
+}
+
+void LogMessage::takeData_(LogMessage& other) {
+  if (other.usesInlineStorage() || (other.resource_ != resource_)) {
+    const size_t n= other.size();
+    data_ = allocateBuffer_(other.capacity());
+    end_ = data_ + n;
+    eos_ = data_ + other.capacity();
+    if (n) {
+      memcpy(data_, other.data_, n);
+    }
+    other.freeData_();
   } else {
-    end_ = newData.get();
+    data_ = other.data_;
+    end_ = other.end_;
+    eos_ = other.eos_;
   }
+  other.data_ = nullptr;
+  other.end_ = nullptr;
+  other.eos_ = nullptr;
+}
 
-  // Swap _data and newData.  newData will clean up old buffer when control
-  // exits this block
-  data_ = newData.release();
+void LogMessage::takeFields_(LogMessage& other) {
+  if (other.fields_ && (other.resource_ != resource_)) {
+    const size_t n= other.fieldsSize();
+    const size_t capacity= (size_t)(other.fieldsEos_ - other.fields_);
+    fields_ = allocateBuffer_(capacity);
+    fieldsEnd_ = fields_ + n;
+    fieldsEos_ = fields_ + capacity;
+    memcpy(fields_, other.fields_, n);
+    other.deallocateBuffer_(other.fields_, capacity);
+  } else {
+    fields_ = other.fields_;
+    fieldsEnd_ = other.fieldsEnd_;
+    fieldsEos_ = other.fieldsEos_;
+  }
+  other.fields_ = nullptr;
+  other.fieldsEnd_ = nullptr;
+  other.fieldsEos_ = nullptr;
+}
+
+void LogMessage::increaseBufferSize_(size_t newSize, bool copyData) {
+  char* newData= allocateBuffer_(newSize);
+  size_t oldSize= (copyData && data_) ? size() : 0;
+  if (oldSize) {
+    memcpy(newData, data_, oldSize);
+  }
+
+  // Free the old buffer, unless it is the inline storage
+  freeData_();
+  data_ = newData;
+  end_ = data_ + oldSize;
   eos_ = data_ + newSize;
-  newData.reset(tmp);
+}
+
+bool LogMessage::addField(const char* key, size_t keySize,
+			  const FormatArg& value) {
+  if ((value.type() == FormatArg::Type::NONE) || (keySize > UINT16_MAX)) {
+    return false;
+  }
+
+  FieldWriter_ out(*this);
+  const uint16_t n= (uint16_t)keySize;
+  out.write(&n, sizeof(n));
+  out.write(key, keySize);
+  writeEncodedFormatArg(out, value);
+  return out.commit();
 }
@@ -1,21 +1,137 @@
 #ifndef __PISTIS__LOGGING__LOGMESSAGE_HPP__
 #define __PISTIS__LOGGING__LOGMESSAGE_HPP__
 
+#include <pistis/logging/LogClock.hpp>
+#include <pistis/logging/LogDestination.hpp>
+#include <pistis/logging/LogField.hpp>
 #include <pistis/logging/LogLevel.hpp>
+#include <pistis/logging/LogMemoryResource.hpp>
+#include <pistis/logging/LogSourceLocation.hpp>
+#include <pistis/logging/LogThreadInfo.hpp>
+#include <atomic>
 #include <iostream>
+#include <stdint.h>
 #include <stdlib.h>
+#include <sys/uio.h>
 
 namespace pistis {
   namespace logging {
 
-    class LogMessage {
+    /** @brief How the contents of a LogMessage are encoded */
+    enum class LogMessageEncoding : uint8_t {
+      /** @brief Formatted text */
+      TEXT,
+
+      /** @brief A LogSite and its arguments, not yet formatted.
+       *
+       *  Written by Log::logDeferred() and turned into text by
+       *  BinaryLogDecoder.
+       */
+      BINARY,
+
+      /** @brief Text describing a LogSite, written by
+       *         DecodingLogMessageReceiver the first time it sees the site.
+       */
+      SITE_DICTIONARY,
+
+      /** @brief Text transcoded to UTF-8 from wide characters, written by
+       *         LogStreamBuffer<wchar_t>.
+       */
+      UTF8
+    };
+
+    /** @brief Alignment of every LogMessage, which is the size of a
+     *         cache line
+     */
+    constexpr size_t LOG_MESSAGE_ALIGNMENT= 64;
+
+    /** @brief Buffer for the text of a log statement.
+     *
+     *  A LogMessage made by create() keeps its first bytes of text in
+     *  the same allocation as the LogMessage itself, right after it.
+     *  LogMessages are aligned on cache lines, so a message is one
+     *  contiguous run of cache lines, and getting and filling a short
+     *  message touches no memory outside it.  The text moves to a buffer
+     *  of its own only when it outgrows that inline storage.  Messages
+     *  made with the constructors always keep their text in a separate
+     *  buffer.
+     *
+     *  Text and fields are allocated from the LogMemoryResource the
+     *  message was constructed with, as is the message itself when it
+     *  is made by create().
+     *
+     *  A statement that writes more than a message's maximum capacity
+     *  is sent as several messages, called parts, which share a
+     *  statement id and are numbered from zero.  Only the last has its
+     *  final flag set.  A message that holds a whole statement has
+     *  statement id zero, part number zero and the final flag set.
+     *
+     *  When its factory is segmented, a message that fills up is not
+     *  grown.  Instead, writers chain another message from the factory
+     *  onto it as a segment and continue there, so text already written
+     *  is never copied.  The text of such a message is the text of the
+     *  message followed by the text of each segment in turn.  Segments
+     *  carry no metadata or fields of their own, belong to the first
+     *  message in the chain and go back to the factory with it.
+     *
+     *  A message starts with one reference, held by whoever got it from
+     *  its factory.  To hand the same message to several receivers
+     *  without copying it, add a reference for each extra receiver with
+     *  addReferences().  Every holder then calls release() on the
+     *  factory once, and only the last of those calls returns the
+     *  message to the factory.  Shared messages must not be modified.
+     */
+    class alignas(LOG_MESSAGE_ALIGNMENT) LogMessage {
     public:
-      LogMessage(size_t capacity);
-      LogMessage(size_t initialCapacity, size_t maximumCapacity);
+      LogMessage(size_t capacity,
+		 LogMemoryResource* resource=
+		     LogMemoryResource::defaultResource());
+      LogMessage(size_t initialCapacity, size_t maximumCapacity,
+		 LogMemoryResource* resource=
+		     LogMemoryResource::defaultResource());
       LogMessage(const LogMessage& other)= delete;
+
+      /** @brief Take over the contents of <tt>other</tt>, along with its
+       *         memory resource
+       */
       LogMessage(LogMessage&& other);
       virtual ~LogMessage();
 
+      /** @brief Create a LogMessage whose initial capacity is inline
+       *         storage, allocating both the message and its storage
+       *         from <tt>resource</tt>.
+       *
+       *  Destroy the message with destroy().  Messages from the default
+       *  resource may also be destroyed with delete.
+       */
+      static LogMessage* create(size_t initialCapacity,
+				size_t maximumCapacity,
+				LogMemoryResource* resource=
+				    LogMemoryResource::defaultResource());
+
+      /** @brief Destroy <tt>msg</tt> and return its memory to the
+       *         resource it came from.
+       *
+       *  Works for messages made by create() and by new.  Null values
+       *  are ignored.
+       */
+      static void destroy(LogMessage* msg);
+
+      /** @brief Where the message's text and fields are allocated */
+      LogMemoryResource* resource() const { return resource_; }
+
+      /** @brief Number of bytes of inline storage, which is zero unless
+       *         the message was made by create()
+       */
+      size_t inlineCapacity() const { return inlineCapacity_; }
+
+      /** @brief Returns true if the message's text is in its inline
+       *         storage
+       */
+      bool usesInlineStorage() const {
+	return inlineCapacity_ && (data_ == inlineData_());
+      }
+
       bool empty() const { return end_ == data_; }
       bool full() const { return end_ == eos_; }
       bool atMaxCapacity() const { return capacity() == maxCapacity(); }
@@ -26,11 +142,112 @@ namespace pistis {
       size_t maxCapacity() const { return maxCapacity_; }
 	
       LogLevel logLevel() const { return logLevel_; }
-      const std::string& destination() const { return destination_; }
+      const std::string& destination() const { return destination_.name(); }
+      const LogDestination& destinationHandle() const { return destination_; }
       void setLogLevel(LogLevel l) { logLevel_ = l; }
-      void setDestination(const std::string& destination) {
+      void setDestination(const LogDestination& destination) {
 	destination_ = destination;
       }
+      LogMessageEncoding encoding() const { return encoding_; }
+      void setEncoding(LogMessageEncoding e) { encoding_ = e; }
+
+      /** @brief Where the statement that wrote the message is.
+       *
+       *  Unknown unless the statement captured its location.  Only
+       *  pointers are stored, so it is up to the receiver to decide
+       *  whether to render the location.
+       */
+      const LogSourceLocation& sourceLocation() const { return location_; }
+      void setSourceLocation(const LogSourceLocation& location) {
+	location_ = location;
+      }
+
+      /** @brief When the statement that wrote the message started.
+       *
+       *  Taken from LogClock by the writing thread, and left in the
+       *  clock's raw units until a receiver converts it with
+       *  LogClock::toNanoseconds().
+       */
+      const LogTimestamp& timestamp() const { return timestamp_; }
+      void setTimestamp(const LogTimestamp& timestamp) {
+	timestamp_ = timestamp;
+      }
+
+      /** @brief Identifies the statement the message is a part of, or
+       *         zero if the message holds the whole statement
+       */
+      uint64_t statementId() const { return statementId_; }
+
+      /** @brief Position of the message among the parts of its
+       *         statement, starting from zero
+       */
+      uint32_t partNumber() const { return partNumber_; }
+
+      /** @brief Returns true if the message is the last part of its
+       *         statement
+       */
+      bool isFinalPart() const { return finalPart_; }
+
+      /** @brief Returns true if the statement that wrote the message
+       *         was split across several messages
+       */
+      bool isMultiPart() const { return statementId_ != 0; }
+
+      void setPart(uint64_t statementId, uint32_t partNumber, bool final) {
+	statementId_ = statementId;
+	partNumber_ = partNumber;
+	finalPart_ = final;
+      }
+
+      /** @brief Returns a new statement id, which is never zero */
+      static uint64_t newStatementId();
+
+      /** @brief Number of holders that must release the message before
+       *         it goes back to its factory
+       */
+      uint32_t numReferences() const {
+	return refCount_.load(std::memory_order_acquire);
+      }
+
+      /** @brief Let <tt>n</tt> more holders share the message */
+      void addReferences(uint32_t n= 1) {
+	refCount_.fetch_add(n, std::memory_order_relaxed);
+      }
+
+      /** @brief Give up one reference to the message.
+       *
+       *  Called by factories from release().  The count is back to one
+       *  afterwards if the last reference was given up, so the message
+       *  can be reused.
+       *
+       *  @returns True if the caller held the last reference
+       */
+      bool removeReference() {
+	// A message that was never shared skips the read-modify-write,
+	// since nobody else holds a reference that could add another
+	if (refCount_.load(std::memory_order_acquire) == 1) {
+	  return true;
+	}
+	if (refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+	  refCount_.store(1, std::memory_order_relaxed);
+	  return true;
+	}
+	return false;
+      }
+
+      /** @brief A value the message's factory attached to it, such as
+       *         the cache the message belongs to, or nullptr.
+       *
+       *  Only the factory that issued the message may set or interpret
+       *  the tag.  It stays with the message, not its contents, so
+       *  moving a message does not move its tag.
+       */
+      void* factoryTag() const { return factoryTag_; }
+      void setFactoryTag(void* tag) { factoryTag_ = tag; }
+
+      /** @brief The thread that wrote the message */
+      const LogThreadInfo& thread() const { return thread_; }
+      void setThread(const LogThreadInfo& thread) { thread_ = thread; }
 
       char* begin() const { return data_; }
       char* end() const { return end_; }
@@ -39,16 +256,181 @@ namespace pistis {
       void setEnd(char* newEnd) { end_ = newEnd; }
       virtual size_t increaseCapacity(size_t desiredCapacity);
 
+      /** @brief The segment that continues the message's text, or
+       *         nullptr if there is none
+       */
+      LogMessage* nextSegment() const { return nextSegment_; }
+
+      /** @brief Append <tt>segment</tt> to the end of the message's
+       *         chain of segments.
+       *
+       *  The message takes ownership of <tt>segment</tt> and its
+       *  segments.
+       */
+      void appendSegment(LogMessage* segment);
+
+      /** @brief Remove the message's segments and return the first, or
+       *         nullptr if it has none.
+       *
+       *  Ownership of the segments passes to the caller.
+       */
+      LogMessage* detachSegments() {
+	LogMessage* segments= nextSegment_;
+	nextSegment_ = nullptr;
+	return segments;
+      }
+
+      /** @brief Number of buffers the message's text is in, which is
+       *         one more than the number of segments
+       */
+      size_t numSegments() const;
+
+      /** @brief Length of the message's text, including the text in its
+       *         segments
+       */
+      size_t totalSize() const;
+
+      /** @brief Fill <tt>iov</tt> with the buffers that hold the
+       *         message's text, for use with writev() and its kin.
+       *
+       *  @param iov     Where to write the buffers
+       *  @param maxIov  Number of entries in <tt>iov</tt>
+       *  @returns The number of entries filled, which is less than
+       *           numSegments() if <tt>iov</tt> is too small
+       */
+      size_t gather(struct iovec* iov, size_t maxIov) const;
+
+      /** @brief Returns true if the message has structured fields */
+      bool hasFields() const { return fieldsEnd_ != fields_; }
+
+      /** @brief Number of bytes taken up by the message's fields */
+      size_t fieldsSize() const { return (size_t)(fieldsEnd_ - fields_); }
+
+      LogFieldIterator fieldsBegin() const {
+	return LogFieldIterator(fields_, fieldsEnd_);
+      }
+      LogFieldIterator fieldsEnd() const {
+	return LogFieldIterator(fieldsEnd_, fieldsEnd_);
+      }
+
+      /** @brief Add a structured field to the message.
+       *
+       *  Fields are kept in their own buffer, which is allocated the
+       *  first time a field is added and may grow to maxCapacity() bytes.
+       *  Keys are limited to 65535 bytes.
+       *
+       *  @param key      The field's name
+       *  @param keySize  Length of <tt>key</tt>
+       *  @param value    The field's value.  Its contents are copied, so
+       *                    it need not outlive the call.
+       *  @returns True if the field was added.  False if it would not fit
+       *           or <tt>value</tt> has type FormatArg::Type::NONE, in
+       *           which case the message's fields are unchanged.
+       */
+      bool addField(const char* key, size_t keySize, const FormatArg& value);
+
+      /** @brief Remove all of the message's fields */
+      void clearFields() { fieldsEnd_ = fields_; }
+
       LogMessage& operator=(const LogMessage&) = delete;
+
+      /** @brief Take over the contents of <tt>other</tt>.
+       *
+       *  The message keeps its own memory resource, so if
+       *  <tt>other</tt> uses a different one, its text and fields are
+       *  copied rather than taken over.
+       */
       LogMessage& operator=(LogMessage&& other);
 
+      static void* operator new(size_t size);
+      static void operator delete(void* p);
+
     private:
+      /** @brief Requests inline storage from operator new */
+      struct InlineStorage_ {
+	size_t capacity;
+	LogMemoryResource* resource;
+      };
+
+      LogMemoryResource* resource_;
+
+      /** @brief Resource the message itself was allocated from, if it
+       *         was made by create(), or nullptr if it was not
+       */
+      LogMemoryResource* headerResource_;
       char* data_;
       char* end_;
       char* eos_;
       size_t maxCapacity_;
+      size_t inlineCapacity_;
       LogLevel logLevel_;
-      std::string destination_;
+      LogMessageEncoding encoding_;
+      LogSourceLocation location_;
+      LogDestination destination_;
+      LogTimestamp timestamp_;
+      LogThreadInfo thread_;
+      uint64_t statementId_;
+      uint32_t partNumber_;
+      bool finalPart_;
+      char* fields_;
+      char* fieldsEnd_;
+      char* fieldsEos_;
+      LogMessage* nextSegment_;
+      std::atomic<uint32_t> refCount_;
+      void* factoryTag_;
+
+      class FieldWriter_;
+
+      /** @brief Create a message whose initial buffer is the
+       *         <tt>storage.capacity</tt> bytes right after it
+       */
+      LogMessage(size_t maximumCapacity, const InlineStorage_& storage);
+
+      static void* operator new(size_t size, const InlineStorage_& storage);
+      static void operator delete(void* p, const InlineStorage_& storage);
+
+      char* inlineData_() const {
+	return (char*)this + sizeof(LogMessage);
+      }
+
+      /** @brief Number of bytes create() allocates for a message with
+       *         <tt>inlineCapacity</tt> bytes of inline storage, which is
+       *         rounded up to whole cache lines so no other object shares
+       *         the last one
+       */
+      static size_t allocationSize_(size_t inlineCapacity) {
+	return (sizeof(LogMessage) + inlineCapacity +
+		LOG_MESSAGE_ALIGNMENT - 1) & ~(LOG_MESSAGE_ALIGNMENT - 1);
+      }
+
+      char* allocateBuffer_(size_t size) {
+	return (char*)resource_->allocate(size, 1);
+      }
+
+      void deallocateBuffer_(char* buffer, size_t size) {
+	if (buffer) {
+	  resource_->deallocate(buffer, size, 1);
+	}
+      }
+
+      /** @brief Delete the message's segments */
+      void deleteSegments_();
+
+      /** @brief Free the buffer, unless it is the inline storage */
+      void freeData_();
+
+      /** @brief Take over the text of <tt>other</tt>, copying it into a
+       *         new buffer if it is in <tt>other</tt>'s inline storage or
+       *         comes from another resource, and leave <tt>other</tt>
+       *         without a buffer
+       */
+      void takeData_(LogMessage& other);
+
+      /** @brief Take over the fields of <tt>other</tt>, copying them if
+       *         they come from another resource, and leave
+       *         <tt>other</tt> without fields
+       */
+      void takeFields_(LogMessage& other);
 
       /** @brief Increase the size of the buffer.
        *
@@ -63,7 +445,9 @@ namespace pistis {
 
     inline std::ostream& operator<<(std::ostream& out,
 				    const LogMessage& msg) {
-      out.write(msg.begin(), msg.size());
+      for (const LogMessage* p= &msg; p; p= p->nextSegment()) {
+	out.write(p->begin(), p->size());
+      }
       return out;
     }
 
@@ -43,12 +43,27 @@ namespace pistis {
        */
       virtual LogMessage* get() = 0;
 
+      /** @brief Obtain a LogMessage for a write of about
+       *         <tt>sizeHint</tt> bytes
+       *
+       *  Writers that know how much they are about to write pass it
+       *  here, so factories that keep messages of different sizes can
+       *  hand out one that is already large enough.  Other factories
+       *  ignore the hint, which is what this default does, and the
+       *  writer grows the message as usual.
+       *
+       *  @returns A fresh LogMessage
+       *  @throws std::bad_alloc if the factory cannot allocate a new message
+       */
+      virtual LogMessage* get(size_t /*sizeHint*/) { return get(); }
+
       /** @brief Return a message to the factory.
        *
        *  Applications should use this method to release messages they
        *  no longer need, rather than deleting them.  Deleting a message
        *  will probably cause waitUntilFull() to block indefinitely waiting
-       *  for the deleted messge to be returned.
+       *  for the deleted messge to be returned.  A message shared with
+       *  LogMessage::addReferences() is released once by each holder.
        *
        *  @param msg  The message to release.  Null values will be ignored.
        *  @pre msg was obtained by calling <code>this->get()</code>.
@@ -56,6 +71,19 @@ namespace pistis {
        */
       virtual void release(LogMessage* msg) = 0;
 
+      /** @brief Returns true if writers should chain segments onto
+       *         messages that fill up instead of growing them.
+       *
+       *  Growing a message copies everything already written to it,
+       *  while chaining a segment copies nothing, but then receivers
+       *  must read every segment of a message, e.g. with
+       *  LogMessage::gather().  Factories are not segmented unless they
+       *  say otherwise.
+       *
+       *  @see LogMessage::nextSegment()
+       */
+      virtual bool segmented() const { return false; }
+
       /** @brief Wait until all LogMessages have been returned to the factory
        *
        *  Blocks until either (a) all messages obtained from the factory by
@@ -1,35 +1,130 @@
 #include "LogMessagePool.hpp"
 #include <algorithm>
-#include <iostream>
-#include <iomanip>
 
 using namespace pistis::logging;
 
+namespace {
+  size_t ringSizeFor(size_t n) {
+    size_t size= 1;
+    while (size < n) {
+      size *= 2;
+    }
+    return size;
+  }
+}
+
+const size_t LogMessagePool::CACHE_LINE_SIZE_;
+
+LogMessagePool::LogMessagePool(size_t initialMessageSize,
+			       size_t maxMessageSize,
+			       size_t maxReturnedMessageSize,
+			       uint32_t initialPoolSize,
+			       uint32_t maxPoolSize,
+			       LogMemoryResource* resource):
+    LogMessagePool(initialMessageSize, maxMessageSize,
+		   maxReturnedMessageSize, initialPoolSize,
+		   LogPoolSizingPolicy::fixed(maxPoolSize), resource) {
+  // Intentionally left blank
+}
+
 LogMessagePool::LogMessagePool(size_t initialMessageSize,
 			       size_t maxMessageSize,
 			       size_t maxReturnedMessageSize,
 			       uint32_t initialPoolSize,
-			       uint32_t maxPoolSize):
+			       const LogPoolSizingPolicy& sizingPolicy,
+			       LogMemoryResource* resource):
     initialMessageSize_(initialMessageSize), maxMessageSize_(maxMessageSize),
-    maxReturnedMessageSize_(maxReturnedMessageSize), maxPoolSize_(maxPoolSize),
-    pool_() {
-  pool_.reserve(initialPoolSize);
-  while (pool_.size() < initialPoolSize) {
-    pool_.push_back(new LogMessage(initialMessageSize_, maxMessageSize_));
+    maxReturnedMessageSize_(maxReturnedMessageSize),
+    sizingPolicy_(sizingPolicy), resource_(resource), sizeClasses_(),
+    numRetained_(0), windowStart_(std::chrono::steady_clock::now()),
+    sizingSync_() {
+  // The smallest class also holds the initial messages, which may exceed
+  // its limit, and keeps as many of them as the policy allows
+  const uint32_t maxRetained= sizingPolicy.maxRetained();
+  const size_t ringSize= ringSizeFor(maxRetained);
+  sizeClasses_.emplace_back(
+      new SizeClass_(initialMessageSize,
+		     ringSizeFor(std::max(initialPoolSize, maxRetained)),
+		     std::min(std::max(initialPoolSize,
+				       sizingPolicy.minRetained()),
+			      maxRetained))
+  );
+  for (size_t capacity= std::max(initialMessageSize, (size_t)1) * 2;
+       capacity <= maxReturnedMessageSize; capacity *= 2) {
+    sizeClasses_.emplace_back(
+        new SizeClass_(capacity, ringSize, sizingPolicy.minRetained())
+    );
   }
+
+  SizeClass_& smallest= *sizeClasses_.front();
+  for (uint32_t i= 0; i < initialPoolSize; ++i) {
+    smallest.enqueue(createMessage_(), smallest.ring.size());
+  }
+  numRetained_.store(initialPoolSize, std::memory_order_relaxed);
 }
 
 LogMessagePool::~LogMessagePool() {
-  for (auto i : pool_) {
-    delete i;
+  for (auto& sizeClass : sizeClasses_) {
+    while (LogMessage* msg= sizeClass->dequeue()) {
+      LogMessage::destroy(msg);
+    }
+  }
+}
+
+size_t LogMessagePool::sizeClassOf(size_t capacity) const {
+  if (capacity > maxReturnedMessageSize_) {
+    return sizeClasses_.size();
+  }
+
+  // Classes are few, and the smallest ones are the busiest
+  size_t sizeClass= 0;
+  while (((sizeClass + 1) < sizeClasses_.size()) &&
+	 (sizeClasses_[sizeClass + 1]->capacity <= capacity)) {
+    ++sizeClass;
+  }
+  return sizeClass;
+}
+
+uint64_t LogMessagePool::numMisses() const {
+  uint64_t n= 0;
+  for (const auto& sizeClass : sizeClasses_) {
+    n += sizeClass->numMisses.load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+size_t LogMessagePool::trim(std::chrono::steady_clock::time_point now) {
+  if (sizingPolicy_.isFixed()) {
+    return 0;
+  }
+
+  std::unique_lock<std::mutex> lock(sizingSync_);
+  const auto elapsed= now - windowStart_;
+  if (elapsed < sizingPolicy_.window()) {
+    return 0;
   }
+
+  // Windows stay aligned to when the pool was created however late
+  // trim() is called, and those that passed without a call count as one
+  windowStart_ += (elapsed / sizingPolicy_.window()) * sizingPolicy_.window();
+
+  size_t numFreed= 0;
+  for (auto& sizeClass : sizeClasses_) {
+    numFreed += closeWindow_(*sizeClass);
+  }
+  return numFreed;
 }
 
 LogMessage* LogMessagePool::get_() {
-  LogMessage* m= popMessage_();
+  return get_(0);
+}
+
+LogMessage* LogMessagePool::get_(size_t sizeHint) {
+  LogMessage* m= popMessage_(sizeHint);
   if (!m) {
-    // Pool is empty
-    m = createMessage_();
+    // Pool has no message large enough
+    recordMiss_(sizeHint);
+    m = createMessage_(sizeHint);
   }
   return m;
 }
@@ -37,40 +132,233 @@ LogMessage* LogMessagePool::get_() {
 void LogMessagePool::release_(LogMessage* msg) {
   if ((msg->capacity() > maxReturnedMessageSize()) || !pushMessage_(msg)) {
     // Message is too big to be returned or the pool is full
-    // std::cout << "Destroying " << msg << std::endl;
     releaseMessage_(msg);
   }
 }
 
+size_t LogMessagePool::numMessagesInPool_() const {
+  size_t n= 0;
+  for (const auto& sizeClass : sizeClasses_) {
+    n += sizeClass->numMessages();
+  }
+  return n;
+}
+
 bool LogMessagePool::pushMessage_(LogMessage* msg) {
   if (!msg) {
     return false;  // Cannot push a null message
   }
 
-  std::unique_lock<std::mutex> lock(sync_);
-  if (pool_.size() == maxPoolSize_) {
+  const size_t sizeClass= sizeClassOf(msg->capacity());
+  if (sizeClass >= sizeClasses_.size()) {
+    return false;
+  }
+
+  // Claim room in the pool as a whole before the class, and give it
+  // back if the class is full
+  if (numRetained_.fetch_add(1, std::memory_order_relaxed) >=
+        maxPoolSize()) {
+    numRetained_.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  SizeClass_& target= *sizeClasses_[sizeClass];
+  if (!target.enqueue(msg, target.limit.load(std::memory_order_relaxed))) {
+    numRetained_.fetch_sub(1, std::memory_order_relaxed);
     return false;
   }
-  pool_.push_back(msg);
   return true;
 }
 
-LogMessage* LogMessagePool::popMessage_() {
-  std::unique_lock<std::mutex> lock(sync_);
-  LogMessage* m = nullptr;
+LogMessage* LogMessagePool::popMessage_(size_t sizeHint) {
+  for (size_t sizeClass= sizeClassForHint_(sizeHint);
+       sizeClass < sizeClasses_.size(); ++sizeClass) {
+    LogMessage* m= popMessageOfClass_(sizeClass);
+    if (m) {
+      return m;
+    }
+  }
+  return nullptr;
+}
 
-  if (!pool_.empty()) {
-    m = pool_.back();
-    pool_.pop_back();
-    m->setEnd(m->begin());
+LogMessage* LogMessagePool::popMessageOfClass_(size_t sizeClass) {
+  LogMessage* m = sizeClasses_[sizeClass]->dequeue();
+
+  if (m) {
+    numRetained_.fetch_sub(1, std::memory_order_relaxed);
+    resetMessage_(m);
   }
   return m;
 }
 
+void LogMessagePool::recordMiss_(size_t sizeHint) {
+  const size_t sizeClass= sizeClassForHint_(sizeHint);
+  if (sizeClass < sizeClasses_.size()) {
+    sizeClasses_[sizeClass]->numMisses.fetch_add(1,
+						 std::memory_order_relaxed);
+  }
+}
+
 LogMessage* LogMessagePool::createMessage_() {
-  return new LogMessage(initialMessageSize(), maxMessageSize());
+  return LogMessage::create(initialMessageSize(), maxMessageSize(),
+			    resource_);
+}
+
+LogMessage* LogMessagePool::createMessage_(size_t sizeHint) {
+  if (sizeHint <= initialMessageSize()) {
+    return createMessage_();
+  }
+
+  // Round up to a class size, so the message is filed where get() will
+  // look for it once it comes back
+  size_t capacity= initialMessageSize();
+  while (capacity < sizeHint) {
+    capacity= capacity ? capacity * 2 : 1;
+  }
+  return LogMessage::create(std::min(capacity, maxMessageSize()),
+			    maxMessageSize(), resource_);
 }
 
 void LogMessagePool::releaseMessage_(LogMessage* msg) {
-  delete msg;
+  LogMessage::destroy(msg);
+}
+
+void LogMessagePool::resetMessage_(LogMessage* msg) {
+  msg->setEnd(msg->begin());
+  msg->setEncoding(LogMessageEncoding::TEXT);
+  msg->setSourceLocation(LogSourceLocation());
+  msg->setTimestamp(LogTimestamp());
+  msg->setThread(LogThreadInfo());
+  msg->setPart(0, 0, true);
+  msg->clearFields();
+}
+
+size_t LogMessagePool::sizeClassForHint_(size_t sizeHint) const {
+  size_t sizeClass= 0;
+  while ((sizeClass < sizeClasses_.size()) &&
+	 (sizeClasses_[sizeClass]->capacity < sizeHint)) {
+    ++sizeClass;
+  }
+  return sizeClass;
+}
+
+size_t LogMessagePool::closeWindow_(SizeClass_& sizeClass) {
+  const size_t minRetained= sizingPolicy_.minRetained();
+  const uint64_t totalMisses=
+      sizeClass.numMisses.load(std::memory_order_relaxed);
+  const uint64_t numMisses= totalMisses - sizeClass.lastNumMisses;
+  sizeClass.lastNumMisses= totalMisses;
+
+  // Keep enough messages that the burst just past would not have had to
+  // allocate
+  size_t limit= std::min(
+      sizeClass.limit.load(std::memory_order_relaxed) + (size_t)numMisses,
+      (size_t)sizingPolicy_.maxRetained()
+  );
+
+  sizeClass.history.push_back(WindowSample_{ sizeClass.numMessages(),
+					     numMisses });
+  if (sizeClass.history.size() > sizingPolicy_.idleWindows()) {
+    sizeClass.history.pop_front();
+  }
+
+  size_t numFreed= 0;
+  if (sizeClass.history.size() == sizingPolicy_.idleWindows()) {
+    // Messages that were in the pool at the close of every window were
+    // not needed, unless some get had to allocate anyway
+    size_t numIdle= sizeClass.history.front().numMessages;
+    uint64_t recentMisses= 0;
+    for (const auto& sample : sizeClass.history) {
+      numIdle= std::min(numIdle, sample.numMessages);
+      recentMisses += sample.numMisses;
+    }
+
+    if (!recentMisses) {
+      const size_t numMessages= sizeClass.numMessages();
+      const size_t numToFree=
+	  std::min(numIdle, (numMessages > minRetained)
+		                ? (numMessages - minRetained) : 0);
+      while (numFreed < numToFree) {
+	LogMessage* msg= sizeClass.dequeue();
+	if (!msg) {
+	  break;
+	}
+	releaseMessage_(msg);
+	++numFreed;
+      }
+      numRetained_.fetch_sub(numFreed, std::memory_order_relaxed);
+
+      limit= std::max((limit > numIdle) ? (limit - numIdle) : 0,
+		      (size_t)minRetained);
+      for (auto& sample : sizeClass.history) {
+	sample.numMessages -= std::min(sample.numMessages, numFreed);
+      }
+    }
+  }
+
+  sizeClass.limit.store(limit, std::memory_order_relaxed);
+  return numFreed;
+}
+
+LogMessagePool::SizeClass_::SizeClass_(size_t capacity, size_t ringSize,
+				       size_t limit):
+    capacity(capacity), ring(ringSize), ringMask(ringSize - 1),
+    limit(limit), head(0), tail(0), numMisses(0), lastNumMisses(0),
+    history() {
+  for (size_t i= 0; i < ring.size(); ++i) {
+    ring[i].sequence.store(i, std::memory_order_relaxed);
+    ring[i].msg= nullptr;
+  }
+}
+
+bool LogMessagePool::SizeClass_::enqueue(LogMessage* msg, size_t limit) {
+  size_t pos= tail.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot_& slot= ring[pos & ringMask];
+    const size_t seq= slot.sequence.load(std::memory_order_acquire);
+    const intptr_t diff= (intptr_t)seq - (intptr_t)pos;
+
+    if (!diff) {
+      // Head only moves forward, so if the pool has room as of this
+      // reading of head, it still has room when pos is claimed
+      if ((pos - head.load(std::memory_order_acquire)) >= limit) {
+	return false;
+      }
+      if (tail.compare_exchange_weak(pos, pos + 1,
+				     std::memory_order_relaxed)) {
+	slot.msg= msg;
+	slot.sequence.store(pos + 1, std::memory_order_release);
+	return true;
+      }
+    } else if (diff < 0) {
+      // The slot has not been emptied since the ring last wrapped around
+      return false;
+    } else {
+      // Another thread filled the slot first
+      pos= tail.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+LogMessage* LogMessagePool::SizeClass_::dequeue() {
+  size_t pos= head.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot_& slot= ring[pos & ringMask];
+    const size_t seq= slot.sequence.load(std::memory_order_acquire);
+    const intptr_t diff= (intptr_t)seq - (intptr_t)(pos + 1);
+
+    if (!diff) {
+      if (head.compare_exchange_weak(pos, pos + 1,
+				     std::memory_order_relaxed)) {
+	LogMessage* msg= slot.msg;
+	slot.sequence.store(pos + ringMask + 1, std::memory_order_release);
+	return msg;
+      }
+    } else if (diff < 0) {
+      return nullptr;  // The ring is empty
+    } else {
+      // Another thread emptied the slot first
+      pos= head.load(std::memory_order_relaxed);
+    }
+  }
 }
@@ -2,7 +2,11 @@
 #define __PISTIS__LOGGING__LOGMESSAGEPOOL_HPP__
 
 #include <pistis/logging/AbstractLogMessageFactory.hpp>
-#include <algorithm>
+#include <pistis/logging/LogPoolSizingPolicy.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <vector>
 #include <stdint.h>
@@ -10,45 +14,263 @@
 namespace pistis {
   namespace logging {
 
+    /** @brief LogMessageFactory that reuses released messages.
+     *
+     *  Released messages no larger than maxReturnedMessageSize() go back
+     *  into the pool, until it holds maxPoolSize() of them, and get()
+     *  takes messages from the pool before it allocates new ones.
+     *
+     *  The pool is a bounded ring of message pointers that threads get
+     *  from and release to without taking a lock.  Each slot in the ring
+     *  carries a sequence number that tells a thread whether the slot is
+     *  ready to be filled or emptied, so contending threads only retry a
+     *  compare-and-swap on the ring's head or tail.  The distance from
+     *  head to tail is the number of messages in the ring, which keeps
+     *  it to its limit without a separate count.  A thread that
+     *  releases a message into a slot another thread is still emptying
+     *  treats the pool as full, so the pool may hold fewer than
+     *  maxPoolSize() messages when it is heavily contended.
+     *
+     *  Messages are filed by capacity into size classes, each with a
+     *  ring of its own.  The smallest class holds messages of
+     *  initialMessageSize(), and each class after it holds messages of
+     *  at least twice the capacity of the one before, up to
+     *  maxReturnedMessageSize().  get(sizeHint) takes a message from the
+     *  smallest class whose messages hold <tt>sizeHint</tt> bytes, or
+     *  from a larger one if that class is empty, so a large write reuses
+     *  a message that has already grown, and a small one does not tie
+     *  up a large message.
+     *
+     *  The pool as a whole holds at most maxPoolSize() messages, counted
+     *  on a cache line of its own, and each class at most its retain
+     *  limit of them.  A pool constructed with a maximum pool size keeps
+     *  every class's limit at that size, so any one class may fill the
+     *  pool.  One constructed with an adaptive LogPoolSizingPolicy moves
+     *  the limits between the policy's bounds: call trim() periodically,
+     *  e.g. from a LogMessagePoolTrimmer, and each class keeps more
+     *  messages after a burst outgrew it and frees those that have sat
+     *  unused for a while.  Only trim() changes the limits, so get() and
+     *  release() cost the same either way.
+     */
     class LogMessagePool : public AbstractLogMessageFactory {
     public:
       LogMessagePool(size_t initialMessageSize, size_t maxMessageSize,
 		     size_t maxReturnedMessageSize,
-		     uint32_t initialPoolSize, uint32_t maxPoolSize);
+		     uint32_t initialPoolSize, uint32_t maxPoolSize,
+		     LogMemoryResource* resource=
+		         LogMemoryResource::defaultResource());
+      LogMessagePool(size_t initialMessageSize, size_t maxMessageSize,
+		     size_t maxReturnedMessageSize,
+		     uint32_t initialPoolSize,
+		     const LogPoolSizingPolicy& sizingPolicy,
+		     LogMemoryResource* resource=
+		         LogMemoryResource::defaultResource());
       virtual ~LogMessagePool();
 
       size_t initialMessageSize() const { return initialMessageSize_; }
       size_t maxMessageSize() const { return maxMessageSize_; }
       size_t maxReturnedMessageSize() const { return maxReturnedMessageSize_; }
-      uint32_t maxPoolSize() const { return maxPoolSize_; }
+      uint32_t maxPoolSize() const { return sizingPolicy_.maxRetained(); }
+      const LogPoolSizingPolicy& sizingPolicy() const { return sizingPolicy_; }
+
+      /** @brief Where the pool allocates messages */
+      LogMemoryResource* resource() const { return resource_; }
+
+      size_t numSizeClasses() const { return sizeClasses_.size(); }
+
+      /** @brief Smallest capacity of the messages in <tt>sizeClass</tt> */
+      size_t sizeClassCapacity(size_t sizeClass) const {
+	return sizeClasses_[sizeClass]->capacity;
+      }
+
+      /** @brief The size class a message of <tt>capacity</tt> is filed
+       *         under, or numSizeClasses() if it is too large to return
+       *         to the pool
+       */
+      size_t sizeClassOf(size_t capacity) const;
+
+      /** @brief Most messages <tt>sizeClass</tt> keeps at present.
+       *
+       *  The classes together never keep more than maxPoolSize().
+       */
+      size_t retainLimit(size_t sizeClass) const {
+	return sizeClasses_[sizeClass]->limit.load(std::memory_order_relaxed);
+      }
+
+      /** @brief Number of times get() allocated a message because the
+       *         pool had none large enough
+       */
+      uint64_t numMisses() const;
+
+      /** @brief Adjust the retain limits and free idle messages, if a
+       *         sizing window has passed since the last adjustment.
+       *
+       *  Does nothing for pools with a fixed size.  Thread-safe, and
+       *  cheap to call more often than once per window.
+       *
+       *  @returns The number of messages freed
+       *  @see LogPoolSizingPolicy
+       */
+      size_t trim() { return trim(std::chrono::steady_clock::now()); }
+
+      /** @brief Trim the pool, taking the current time to be
+       *         <tt>now</tt>
+       */
+      size_t trim(std::chrono::steady_clock::time_point now);
 
     protected:
+      /** @brief Put <tt>msg</tt> in the pool, under the size class for
+       *         its capacity
+       *
+       *  @returns False if the pool has no room for it
+       */
       bool pushMessage_(LogMessage* msg);
-      LogMessage* popMessage_();
+
+      /** @brief Take a message that can hold <tt>sizeHint</tt> bytes
+       *         without growing from the pool, or null if there is none
+       */
+      LogMessage* popMessage_(size_t sizeHint= 0);
+
+      /** @brief Take a message from <tt>sizeClass</tt> only */
+      LogMessage* popMessageOfClass_(size_t sizeClass);
+
+      /** @brief Count a get() for <tt>sizeHint</tt> bytes that found no
+       *         message in the pool
+       */
+      void recordMiss_(size_t sizeHint);
 
       virtual LogMessage* createMessage_();
+
+      /** @brief Allocate a message that can hold <tt>sizeHint</tt> bytes,
+       *         up to maxMessageSize()
+       */
+      LogMessage* createMessage_(size_t sizeHint);
       void releaseMessage_(LogMessage* msg);
 
+      /** @brief Clear what the last writer left in <tt>msg</tt> */
+      static void resetMessage_(LogMessage* msg);
+
       virtual LogMessage* get_();
+      virtual LogMessage* get_(size_t sizeHint);
       virtual void release_(LogMessage* msg);
 
-      size_t numMessagesInPool_() const { return pool_.size(); }
+      size_t numMessagesInPool_() const;
+
+      size_t numMessagesInSizeClass_(size_t sizeClass) const {
+	return sizeClasses_[sizeClass]->numMessages();
+      }
 
+      /** @brief Write the messages in the pool to <tt>out</tt>.
+       *
+       *  Only call when no other thread is using the pool.
+       */
       template <typename OutputIterator>
-      OutputIterator getMessagesInPool_(const OutputIterator& out) const {
-	return std::copy(pool_.begin(), pool_.end(), out);
+      OutputIterator getMessagesInPool_(OutputIterator out) const {
+	for (const auto& sizeClass : sizeClasses_) {
+	  const size_t end= sizeClass->tail.load(std::memory_order_acquire);
+	  for (size_t i= sizeClass->head.load(std::memory_order_acquire);
+	       i != end; ++i) {
+	    *out= sizeClass->ring[i & sizeClass->ringMask].msg;
+	    ++out;
+	  }
+	}
+	return out;
       }
       
     private:
+      /** @brief A place in the ring.
+       *
+       *  <tt>sequence</tt> equals the position a thread must claim to
+       *  fill the slot while it is empty, and one more than the position
+       *  a thread must claim to empty it while it is full.
+       */
+      struct Slot_ {
+	std::atomic<size_t> sequence;
+	LogMessage* msg;
+      };
+
+      /** @brief Keeps a ring's head and tail on cache lines of their
+       *         own, so getting threads and releasing threads do not
+       *         contend for the same line
+       */
+      static const size_t CACHE_LINE_SIZE_= 64;
+
+      /** @brief Demand a size class saw during one sizing window */
+      struct WindowSample_ {
+	size_t numMessages;
+	uint64_t numMisses;
+      };
+
+      /** @brief The ring of messages of one size class.
+       *
+       *  The capacity, ring and limit are read by every get() and
+       *  release() but only written by the constructor and trim(), so
+       *  they share a cache line.  Misses are counted on a line of their
+       *  own.
+       */
+      struct SizeClass_ {
+	size_t capacity;
+	std::vector<Slot_> ring;
+	size_t ringMask;
+	std::atomic<size_t> limit;
+	char headPad[CACHE_LINE_SIZE_];
+	std::atomic<size_t> head;
+	char tailPad[CACHE_LINE_SIZE_ - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> tail;
+	char missesPad[CACHE_LINE_SIZE_ - sizeof(std::atomic<size_t>)];
+	std::atomic<uint64_t> numMisses;
+	char endPad[CACHE_LINE_SIZE_ - sizeof(std::atomic<uint64_t>)];
+
+	/** @brief Misses counted at the close of the last window, and the
+	 *         windows closed since trim() last freed messages.
+	 *         Guarded by the pool's sizingSync_.
+	 */
+	uint64_t lastNumMisses;
+	std::deque<WindowSample_> history;
+
+	SizeClass_(size_t capacity, size_t ringSize, size_t limit);
+
+	size_t numMessages() const {
+	  // Read head first, so a dequeue() racing with the two reads
+	  // cannot move it past the tail already read.  Never let the
+	  // difference wrap around in any case
+	  const size_t h= head.load(std::memory_order_acquire);
+	  const size_t t= tail.load(std::memory_order_relaxed);
+	  return (t > h) ? (t - h) : 0;
+	}
+
+	bool enqueue(LogMessage* msg, size_t limit);
+	LogMessage* dequeue();
+      };
+
       size_t initialMessageSize_;
       size_t maxMessageSize_;
       size_t maxReturnedMessageSize_;
-      size_t maxPoolSize_;
-      std::vector<LogMessage*> pool_;
-      std::mutex sync_;
+      LogPoolSizingPolicy sizingPolicy_;
+      LogMemoryResource* resource_;
+      std::vector< std::unique_ptr<SizeClass_> > sizeClasses_;
+      char numRetainedPad_[CACHE_LINE_SIZE_];
+
+      /** @brief Messages in all the size classes, including any a
+       *         release has claimed room for but not yet filed
+       */
+      std::atomic<size_t> numRetained_;
+      char endPad_[CACHE_LINE_SIZE_ - sizeof(std::atomic<size_t>)];
+      std::chrono::steady_clock::time_point windowStart_;
+      std::mutex sizingSync_;
+
+      /** @brief The smallest class whose messages all hold
+       *         <tt>sizeHint</tt> bytes, or numSizeClasses() if none do
+       */
+      size_t sizeClassForHint_(size_t sizeHint) const;
+
+      /** @brief Close a sizing window for <tt>sizeClass</tt>
+       *
+       *  @returns The number of messages freed
+       */
+      size_t closeWindow_(SizeClass_& sizeClass);
     };
 
   }
 }
 #endif
-
@@ -0,0 +1,50 @@
+#include "LogMessagePoolTrimmer.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace pistis::logging;
+
+LogMessagePoolTrimmer::LogMessagePoolTrimmer(
+    const std::vector<LogMessagePool*>& pools,
+    std::chrono::steady_clock::duration interval
+):
+    pools_(pools), interval_(interval), numMessagesFreed_(0), sync_(),
+    stopRequested_(), stopping_(false), thread_() {
+  if (pools_.empty()) {
+    throw std::invalid_argument("A LogMessagePoolTrimmer needs a pool");
+  }
+  if (std::find(pools_.begin(), pools_.end(), nullptr) != pools_.end()) {
+    throw std::invalid_argument("Cannot trim a null pool");
+  }
+  if (interval_ <= std::chrono::steady_clock::duration::zero()) {
+    throw std::invalid_argument("The trimming interval must be positive");
+  }
+
+  // Start the thread last, once every member it reads is set
+  thread_= std::thread([this]() { run_(); });
+}
+
+LogMessagePoolTrimmer::~LogMessagePoolTrimmer() {
+  {
+    std::unique_lock<std::mutex> lock(sync_);
+    stopping_= true;
+  }
+  stopRequested_.notify_all();
+  thread_.join();
+}
+
+void LogMessagePoolTrimmer::run_() {
+  std::unique_lock<std::mutex> lock(sync_);
+  auto next= std::chrono::steady_clock::now() + interval_;
+  while (!stopRequested_.wait_until(lock, next, [this]() {
+	   return stopping_;
+	 })) {
+    // Trim without the lock, so the destructor never waits on a trim
+    lock.unlock();
+    for (auto pool : pools_) {
+      numMessagesFreed_.fetch_add(pool->trim(), std::memory_order_relaxed);
+    }
+    lock.lock();
+    next += interval_;
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef __PISTIS__LOGGING__LOGMESSAGEPOOLTRIMMER_HPP__
+#define __PISTIS__LOGGING__LOGMESSAGEPOOLTRIMMER_HPP__
+
+#include <pistis/logging/LogMessagePool.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Calls LogMessagePool::trim() on a set of pools from a
+     *         thread of its own.
+     *
+     *  The thread trims every pool once per interval until the trimmer
+     *  is destroyed.  An interval equal to the pools' sizing window
+     *  closes each window on time, as long as the trimmer starts after
+     *  the pools are created.  The pools must outlive the trimmer.
+     */
+    class LogMessagePoolTrimmer {
+    public:
+      /** @brief Start trimming <tt>pools</tt>
+       *
+       *  @throws std::invalid_argument if <tt>pools</tt> is empty or
+       *            holds a null pool, or <tt>interval</tt> is not
+       *            positive
+       */
+      LogMessagePoolTrimmer(const std::vector<LogMessagePool*>& pools,
+			    std::chrono::steady_clock::duration interval);
+      LogMessagePoolTrimmer(const LogMessagePoolTrimmer&) = delete;
+
+      /** @brief Stop the thread and wait for it to exit */
+      ~LogMessagePoolTrimmer();
+
+      std::chrono::steady_clock::duration interval() const {
+	return interval_;
+      }
+
+      /** @brief Number of messages freed by trimming so far */
+      uint64_t numMessagesFreed() const {
+	return numMessagesFreed_.load(std::memory_order_relaxed);
+      }
+
+      LogMessagePoolTrimmer& operator=(const LogMessagePoolTrimmer&) = delete;
+
+    private:
+      std::vector<LogMessagePool*> pools_;
+      std::chrono::steady_clock::duration interval_;
+      std::atomic<uint64_t> numMessagesFreed_;
+      std::mutex sync_;
+      std::condition_variable stopRequested_;
+      bool stopping_;
+      std::thread thread_;
+
+      void run_();
+    };
+
+  }
+}
+#endif
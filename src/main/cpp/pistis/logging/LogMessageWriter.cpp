@@ -0,0 +1,317 @@
+#include "LogMessageWriter.hpp"
+#include "FormatArg.hpp"
+#include "NumberFormat.hpp"
+#include <algorithm>
+
+using namespace pistis::logging;
+
+LogMessageWriter::LogMessageWriter(LogMessageFactory& msgFactory,
+				   LogMessageReceiver& msgReceiver,
+				   const LogDestination& destination,
+				   LogLevel logLevel,
+				   LogMessageEncoding encoding,
+				   const LogSourceLocation& location):
+    msgFactory_(&msgFactory), msgReceiver_(&msgReceiver),
+    destination_(destination), logLevel_(logLevel), encoding_(encoding),
+    location_(location), timestamp_(), thread_(), current_(nullptr),
+    tail_(nullptr), chainSize_(0), statementId_(0), partNumber_(0),
+    end_(nullptr), eos_(nullptr) {
+  // Intentionally left blank
+}
+
+LogMessageWriter::LogMessageWriter(LogMessageWriter&& other):
+    msgFactory_(other.msgFactory_), msgReceiver_(other.msgReceiver_),
+    destination_(other.destination_), logLevel_(other.logLevel_),
+    encoding_(other.encoding_), location_(other.location_),
+    timestamp_(other.timestamp_), thread_(other.thread_),
+    current_(other.current_), tail_(other.tail_),
+    chainSize_(other.chainSize_), statementId_(other.statementId_),
+    partNumber_(other.partNumber_), end_(other.end_), eos_(other.eos_) {
+  other.current_= nullptr;
+  other.tail_= nullptr;
+  other.statementId_= 0;
+  other.partNumber_= 0;
+  other.end_= nullptr;
+  other.eos_= nullptr;
+}
+
+LogMessageWriter::~LogMessageWriter() {
+  flush();
+}
+
+LogMessageWriter& LogMessageWriter::operator=(LogMessageWriter&& other) {
+  if (this != &other) {
+    flush();
+    msgFactory_= other.msgFactory_;
+    msgReceiver_= other.msgReceiver_;
+    destination_= other.destination_;
+    logLevel_= other.logLevel_;
+    encoding_= other.encoding_;
+    location_= other.location_;
+    timestamp_= other.timestamp_;
+    thread_= other.thread_;
+    current_= other.current_;
+    tail_= other.tail_;
+    chainSize_= other.chainSize_;
+    statementId_= other.statementId_;
+    partNumber_= other.partNumber_;
+    end_= other.end_;
+    eos_= other.eos_;
+    other.current_= nullptr;
+    other.tail_= nullptr;
+    other.statementId_= 0;
+    other.partNumber_= 0;
+    other.end_= nullptr;
+    other.eos_= nullptr;
+  }
+  return *this;
+}
+
+void LogMessageWriter::write(const FormatArg& arg) {
+  char tmp[MAX_FORMATTED_NUMBER_SIZE];
+  char* p;
+  char* start;
+
+  switch (arg.type()) {
+    case FormatArg::Type::NONE:
+      return;
+
+    case FormatArg::Type::BOOL:
+      if (arg.boolValue()) {
+	write("true", 4);
+      } else {
+	write("false", 5);
+      }
+      return;
+
+    case FormatArg::Type::CHAR:
+      put(arg.charValue());
+      return;
+
+    case FormatArg::Type::STRING:
+      write(arg.stringData(), arg.stringSize());
+      return;
+
+    case FormatArg::Type::CUSTOM: {
+      LogMessageWriterStreamBuffer buffer(*this);
+      arg.writeCustom(buffer);
+      return;
+    }
+
+    default:
+      break;
+  }
+
+  // Numbers are formatted straight into the message when there is room
+  // and into a temporary buffer otherwise
+  start= reserve(MAX_FORMATTED_NUMBER_SIZE);
+  if (!start) {
+    start= tmp;
+  }
+  switch (arg.type()) {
+    case FormatArg::Type::INT:
+      p= formatSigned(start, arg.intValue());
+      break;
+
+    case FormatArg::Type::UINT:
+      p= formatUnsigned(start, arg.uintValue());
+      break;
+
+    case FormatArg::Type::DOUBLE:
+      p= formatDouble(start, arg.doubleValue());
+      break;
+
+    case FormatArg::Type::POINTER:
+      p= formatPointer(start, arg.pointerValue());
+      break;
+
+    default:
+      p= start;
+      break;
+  }
+  if (start == tmp) {
+    write(tmp, (size_t)(p - tmp));
+  } else {
+    commit(p);
+  }
+}
+
+void LogMessageWriter::format(const char* text, const FormatArg* args,
+			      size_t numArgs) {
+  const FormatArg* nextArg= args;
+  const FormatArg* const endOfArgs= args + numArgs;
+  const char* literal= text;
+  const char* p= text;
+
+  while (*p) {
+    if (((*p == '{') || (*p == '}')) && (p[1] == *p)) {
+      // Escaped brace.  Write the text up to and including the first
+      // brace and skip the second.
+      write(literal, (size_t)(p - literal) + 1);
+      p += 2;
+      literal= p;
+    } else if ((*p == '{') && (p[1] == '}')) {
+      write(literal, (size_t)(p - literal));
+      if (nextArg != endOfArgs) {
+	write(*nextArg++);
+      } else {
+	write("{}", 2);
+      }
+      p += 2;
+      literal= p;
+    } else {
+      ++p;
+    }
+  }
+  write(literal, (size_t)(p - literal));
+}
+
+bool LogMessageWriter::addField(const char* key, size_t keySize,
+				const FormatArg& value) {
+  if (!current_) {
+    getNewMessage_();
+  }
+  return current_->addField(key, keySize, value);
+}
+
+void LogMessageWriter::flush() {
+  if (!current_ && statementId_) {
+    // The last part ended exactly where the statement did, but the
+    // receiver still needs to hear that the statement is complete
+    getNewMessage_();
+  }
+  send_(true);
+}
+
+void LogMessageWriter::flushPart() {
+  send_(false);
+}
+
+void LogMessageWriter::send_(bool final) {
+  if (current_) {
+    if (statementId_ || !final) {
+      if (!statementId_) {
+	statementId_= LogMessage::newStatementId();
+      }
+      current_->setPart(statementId_, partNumber_++, final);
+    }
+    tail_->setEnd(end_);
+    msgReceiver_->receive(current_);
+    current_= nullptr;
+    tail_= nullptr;
+    end_= nullptr;
+    eos_= nullptr;
+  }
+  if (final) {
+    statementId_= 0;
+    partNumber_= 0;
+  }
+}
+
+void LogMessageWriter::writeSlow_(const char* data, size_t n) {
+  while (n) {
+    size_t available= (size_t)(eos_ - end_);
+    if (!available) {
+      available= growToFit_(n);
+    }
+    if (!available) {
+      // The message is as large as it can get.  Send it and continue in a
+      // new one.
+      flushPart();
+      available= growToFit_(n);
+      if (!available) {
+	return;  // Messages cannot hold even a single byte
+      }
+    }
+
+    size_t nToWrite= std::min(available, n);
+    memcpy(end_, data, nToWrite);
+    end_ += nToWrite;
+    data += nToWrite;
+    n -= nToWrite;
+  }
+}
+
+bool LogMessageWriter::makeRoom_(size_t n) {
+  if ((growToFit_(n) < n) && current_ && (n <= current_->maxCapacity())) {
+    // Whatever is written must not be split between messages, so send
+    // the current one and start another
+    flushPart();
+    growToFit_(n);
+  }
+  return (size_t)(eos_ - end_) >= n;
+}
+
+size_t LogMessageWriter::growToFit_(size_t n) {
+  if (!current_) {
+    getNewMessage_(n);
+  }
+
+  if (((size_t)(eos_ - end_) < n) && (end_ != tail_->begin()) &&
+      msgFactory_->segmented()) {
+    addSegment_();
+  }
+  if ((size_t)(eos_ - end_) < n) {
+    growTail_(n);
+  }
+  return (size_t)(eos_ - end_);
+}
+
+void LogMessageWriter::growTail_(size_t n) {
+  const size_t limit=
+      std::min(tail_->maxCapacity(), current_->maxCapacity() - chainSize_);
+  if (tail_->capacity() < limit) {
+    // Double the capacity until it is large enough or reaches the maximum,
+    // as LogStreamBuffer does
+    tail_->setEnd(end_);
+    size_t target= tail_->size() + n;
+    size_t newCapacity= std::max(tail_->capacity(), (size_t)1);
+    while ((newCapacity < target) && (newCapacity < limit)) {
+      newCapacity *= 2;
+    }
+    tail_->increaseCapacity(std::min(newCapacity, limit));
+    resetEnd_();
+  }
+}
+
+void LogMessageWriter::addSegment_() {
+  const size_t used= chainSize_ + (size_t)(end_ - tail_->begin());
+  if (used < current_->maxCapacity()) {
+    LogMessage* segment= msgFactory_->get();
+    tail_->setEnd(end_);
+    tail_->appendSegment(segment);
+    tail_= segment;
+    chainSize_= used;
+    resetEnd_();
+  }
+}
+
+void LogMessageWriter::resetEnd_() {
+  end_= tail_->end();
+  if (chainSize_) {
+    // Segments may be larger than what is left of the chain's maximum
+    eos_= tail_->begin() +
+        std::min(tail_->capacity(), current_->maxCapacity() - chainSize_);
+  } else {
+    eos_= tail_->eos();
+  }
+}
+
+void LogMessageWriter::getNewMessage_(size_t sizeHint) {
+  if (!timestamp_.isSet()) {
+    timestamp_= LogClock::now();
+  }
+  if (!thread_.known()) {
+    thread_= LogThreadInfo::current();
+  }
+  current_= msgFactory_->get(sizeHint);
+  current_->setLogLevel(logLevel_);
+  current_->setDestination(destination_);
+  current_->setEncoding(encoding_);
+  current_->setSourceLocation(location_);
+  current_->setTimestamp(timestamp_);
+  current_->setThread(thread_);
+  tail_= current_;
+  chainSize_= 0;
+  resetEnd_();
+}
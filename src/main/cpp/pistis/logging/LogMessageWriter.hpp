@@ -0,0 +1,263 @@
+#ifndef __PISTIS__LOGGING__LOGMESSAGEWRITER_HPP__
+#define __PISTIS__LOGGING__LOGMESSAGEWRITER_HPP__
+
+#include <pistis/logging/LogLevel.hpp>
+#include <pistis/logging/LogMessage.hpp>
+#include <pistis/logging/LogMessageFactory.hpp>
+#include <pistis/logging/LogMessageReceiver.hpp>
+#include <streambuf>
+#include <string>
+#include <string.h>
+
+namespace pistis {
+  namespace logging {
+
+    class FormatArg;
+
+    /** @brief Writes text directly into LogMessage buffers.
+     *
+     *  LogMessageWriter is the counterpart of LogStreamBuffer for code
+     *  that does not need a std::basic_ostream.  It obtains a LogMessage
+     *  from its factory when it first writes something, copies text
+     *  straight into the message's buffer, increases the message's
+     *  capacity as needed and, once the message reaches its maximum
+     *  capacity, sends it to the receiver and continues in a new one.
+     *  The messages of a statement that does not fit in one message are
+     *  marked as parts of it, as described in LogMessage.
+     *  If the factory is segmented, the writer chains segments onto the
+     *  message instead of growing it, until the text in the chain reaches
+     *  the message's maximum capacity.
+     *  The message in progress is sent when flush() is called or the
+     *  writer is destroyed.  Messages are marked with the encoding given
+     *  to the constructor, which is normally LogMessageEncoding::TEXT,
+     *  and the source location of the statement that wrote them, if known.
+     *  All of the messages are stamped with the time the writer obtained
+     *  the first of them and the thread that obtained it.
+     */
+    class LogMessageWriter {
+    public:
+      LogMessageWriter(LogMessageFactory& msgFactory,
+		       LogMessageReceiver& msgReceiver,
+		       const LogDestination& destination, LogLevel logLevel,
+		       LogMessageEncoding encoding= LogMessageEncoding::TEXT,
+		       const LogSourceLocation& location= LogSourceLocation());
+      LogMessageWriter(const LogMessageWriter&)= delete;
+      LogMessageWriter(LogMessageWriter&& other);
+      ~LogMessageWriter();
+
+      const std::string& destination() const { return destination_.name(); }
+      const LogDestination& destinationHandle() const { return destination_; }
+      LogLevel logLevel() const { return logLevel_; }
+
+      /** @brief Timestamp given to the messages the writer fills.
+       *
+       *  Read from LogClock when the writer obtains its first message,
+       *  so every message of a statement carries the same time and a
+       *  writer that never writes anything never reads the clock.  Not
+       *  set until then, unless given with setTimestamp().
+       */
+      const LogTimestamp& timestamp() const { return timestamp_; }
+
+      /** @brief Change the timestamp given to messages the writer
+       *         obtains from now on
+       */
+      void setTimestamp(const LogTimestamp& timestamp) {
+	timestamp_ = timestamp;
+      }
+
+      /** @brief Thread given to the messages the writer fills, which is
+       *         the thread that obtains its first message.
+       *
+       *  Unknown until then, unless given with setThread().
+       */
+      const LogThreadInfo& thread() const { return thread_; }
+
+      /** @brief Change the thread given to messages the writer obtains
+       *         from now on
+       */
+      void setThread(const LogThreadInfo& thread) { thread_ = thread; }
+
+      /** @brief Append <tt>n</tt> bytes starting at <tt>data</tt> */
+      void write(const char* data, size_t n) {
+	if (n && ((size_t)(eos_ - end_) >= n)) {
+	  memcpy(end_, data, n);
+	  end_ += n;
+	} else {
+	  writeSlow_(data, n);
+	}
+      }
+
+      /** @brief Append a single character */
+      void put(char c) {
+	if ((end_ != eos_) || makeRoom_(1)) {
+	  *end_++ = c;
+	}
+      }
+
+      /** @brief Append the text of a single argument */
+      void write(const FormatArg& arg);
+
+      /** @brief Append <tt>text</tt>, replacing its placeholders with
+       *         <tt>args</tt>.
+       *
+       *  @param text     Format string, as described in countFormatArgs()
+       *  @param args     Values for the placeholders in <tt>text</tt>
+       *  @param numArgs  Number of values in <tt>args</tt>.  Placeholders
+       *                    without a value are written as "{}" and
+       *                    extra values are ignored.
+       */
+      void format(const char* text, const FormatArg* args, size_t numArgs);
+
+      /** @brief Returns a pointer to at least <tt>n</tt> contiguous bytes
+       *         of free space in the current message.
+       *
+       *  Callers write into the space, then call commit() to append what
+       *  they wrote to the message.
+       *
+       *  @returns A pointer to the free space, or nullptr if <tt>n</tt>
+       *           bytes are more than a message can ever hold
+       */
+      char* reserve(size_t n) {
+	return (((size_t)(eos_ - end_) >= n) || makeRoom_(n)) ? end_
+	                                                      : nullptr;
+      }
+
+      /** @brief Returns a pointer to the free space in the current message
+       *         after growing it towards having <tt>n</tt> bytes free.
+       *
+       *  Unlike reserve(), never sends the current message, so
+       *  <tt>available</tt> may be less than <tt>n</tt>, or even zero if
+       *  the message is already at its maximum capacity.
+       *
+       *  @param n          Number of bytes wanted
+       *  @param available  Set to the number of bytes actually free
+       */
+      char* reserveUpTo(size_t n, size_t& available) {
+	available= growToFit_(n);
+	return end_;
+      }
+
+      /** @brief Append the bytes written into the space returned by
+       *         reserve(), up to but not including <tt>newEnd</tt>.
+       */
+      void commit(char* newEnd) { end_ = newEnd; }
+
+      /** @brief Add a structured field to the message in progress,
+       *         obtaining a message if there is none.
+       *
+       *  @see LogMessage::addField()
+       */
+      bool addField(const char* key, size_t keySize, const FormatArg& value);
+
+      /** @brief Send the message in progress, if any, to the receiver as
+       *         the end of the statement.
+       *
+       *  If earlier parts of the statement have been sent, the message
+       *  is marked as the final part, and if there is no message in
+       *  progress, an empty final part is sent.
+       */
+      void flush();
+
+      /** @brief Send the message in progress, if any, to the receiver as
+       *         a part of a statement that continues in the next message
+       */
+      void flushPart();
+
+      LogMessageWriter& operator=(const LogMessageWriter&)= delete;
+
+      /** @brief Send any message in progress to the receiver, then take
+       *         over the message in progress in <tt>other</tt>.
+       */
+      LogMessageWriter& operator=(LogMessageWriter&& other);
+
+    private:
+      LogMessageFactory* msgFactory_;
+      LogMessageReceiver* msgReceiver_;
+      LogDestination destination_;
+      LogLevel logLevel_;
+      LogMessageEncoding encoding_;
+      LogSourceLocation location_;
+      LogTimestamp timestamp_;
+      LogThreadInfo thread_;
+      LogMessage* current_;
+      LogMessage* tail_;
+      size_t chainSize_;
+      uint64_t statementId_;
+      uint32_t partNumber_;
+      char* end_;
+      char* eos_;
+
+      void writeSlow_(const char* data, size_t n);
+
+      /** @brief Send the message in progress as a part of the current
+       *         statement, which ends with it if <tt>final</tt> is true
+       */
+      void send_(bool final);
+
+      /** @brief Make room for at least <tt>n</tt> more contiguous bytes, if
+       *         possible, by growing the current message or replacing it
+       *         with a new one.
+       *
+       *  @returns True if at least <tt>n</tt> bytes are available
+       */
+      bool makeRoom_(size_t n);
+
+      /** @brief Obtain a message if there is none, then grow it towards
+       *         having <tt>n</tt> bytes available without exceeding its
+       *         maximum capacity.
+       *
+       *  @returns The number of bytes available afterwards
+       */
+      size_t growToFit_(size_t n);
+
+      /** @brief Grow the last segment of the current message towards
+       *         having <tt>n</tt> bytes available, keeping the whole chain
+       *         within the message's maximum capacity
+       */
+      void growTail_(size_t n);
+
+      /** @brief Chain a new segment onto the current message and continue
+       *         writing in it, unless the chain is already full
+       */
+      void addSegment_();
+
+      /** @brief Point end_ and eos_ at the free space in the last
+       *         segment of the current message
+       */
+      void resetEnd_();
+
+      /** @brief Get a message that can hold <tt>sizeHint</tt> bytes from
+       *         the factory
+       */
+      void getNewMessage_(size_t sizeHint= 0);
+    };
+
+    /** @brief Stream buffer that writes to a LogMessageWriter.
+     *
+     *  Used to write values that only know how to write themselves to a
+     *  std::ostream.
+     */
+    class LogMessageWriterStreamBuffer : public std::streambuf {
+    public:
+      LogMessageWriterStreamBuffer(LogMessageWriter& out): out_(out) { }
+
+    protected:
+      virtual std::streamsize xsputn(const char* data, std::streamsize n) {
+	out_.write(data, (size_t)n);
+	return n;
+      }
+
+      virtual int_type overflow(int_type c= traits_type::eof()) {
+	if (!traits_type::eq_int_type(c, traits_type::eof())) {
+	  out_.put(traits_type::to_char_type(c));
+	}
+	return traits_type::not_eof(c);
+      }
+
+    private:
+      LogMessageWriter& out_;
+    };
+
+  }
+}
+#endif
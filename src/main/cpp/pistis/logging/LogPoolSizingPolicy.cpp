@@ -0,0 +1,21 @@
+#include "LogPoolSizingPolicy.hpp"
+#include <stdexcept>
+
+using namespace pistis::logging;
+
+LogPoolSizingPolicy::LogPoolSizingPolicy(
+    uint32_t minRetained, uint32_t maxRetained,
+    std::chrono::steady_clock::duration window, uint32_t idleWindows
+):
+    minRetained_(minRetained), maxRetained_(maxRetained), window_(window),
+    idleWindows_(idleWindows) {
+  if (minRetained > maxRetained) {
+    throw std::invalid_argument("minRetained cannot exceed maxRetained");
+  }
+  if (window <= std::chrono::steady_clock::duration::zero()) {
+    throw std::invalid_argument("The sizing window must be positive");
+  }
+  if (!idleWindows) {
+    throw std::invalid_argument("idleWindows must be at least one");
+  }
+}
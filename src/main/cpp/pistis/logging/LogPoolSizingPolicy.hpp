@@ -0,0 +1,63 @@
+#ifndef __PISTIS__LOGGING__LOGPOOLSIZINGPOLICY_HPP__
+#define __PISTIS__LOGGING__LOGPOOLSIZINGPOLICY_HPP__
+
+#include <chrono>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief How many released messages a LogMessagePool keeps, and how
+     *         that number follows demand.
+     *
+     *  Each size class of the pool keeps at most a retain limit's worth
+     *  of messages, which starts at minRetained().  LogMessagePool::trim()
+     *  closes a window of length window() each time it is called after
+     *  one has passed.  At the close of a window, each size class raises
+     *  its limit by the number of gets it could not satisfy during the
+     *  window, up to maxRetained(), so the messages allocated during a
+     *  burst are kept for the next one.  Messages that stayed in the
+     *  pool through the last idleWindows() windows, during which no get
+     *  had to allocate, are freed, down to minRetained(), and the limit
+     *  comes down with them.  However the limits move, the pool as a
+     *  whole never keeps more than maxRetained() messages.
+     *
+     *  A policy whose minimum and maximum are equal keeps the pool at a
+     *  fixed size, as fixed() creates.
+     */
+    class LogPoolSizingPolicy {
+    public:
+      /** @brief Create a policy
+       *
+       *  @throws std::invalid_argument if <tt>minRetained</tt> exceeds
+       *            <tt>maxRetained</tt>, <tt>window</tt> is not positive
+       *            or <tt>idleWindows</tt> is zero
+       */
+      LogPoolSizingPolicy(uint32_t minRetained, uint32_t maxRetained,
+			  std::chrono::steady_clock::duration window=
+			      std::chrono::seconds(1),
+			  uint32_t idleWindows= 60);
+
+      /** @brief A policy that always keeps up to <tt>poolSize</tt>
+       *         messages, in any mix of size classes
+       */
+      static LogPoolSizingPolicy fixed(uint32_t poolSize) {
+	return LogPoolSizingPolicy(poolSize, poolSize);
+      }
+
+      uint32_t minRetained() const { return minRetained_; }
+      uint32_t maxRetained() const { return maxRetained_; }
+      std::chrono::steady_clock::duration window() const { return window_; }
+      uint32_t idleWindows() const { return idleWindows_; }
+      bool isFixed() const { return minRetained_ == maxRetained_; }
+
+    private:
+      uint32_t minRetained_;
+      uint32_t maxRetained_;
+      std::chrono::steady_clock::duration window_;
+      uint32_t idleWindows_;
+    };
+
+  }
+}
+#endif
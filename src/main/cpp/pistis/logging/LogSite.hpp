@@ -0,0 +1,51 @@
+#ifndef __PISTIS__LOGGING__LOGSITE_HPP__
+#define __PISTIS__LOGGING__LOGSITE_HPP__
+
+#include <pistis/logging/FormatString.hpp>
+#include <pistis/logging/LogLevel.hpp>
+#include <pistis/logging/LogSourceLocation.hpp>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Describes a deferred log statement in the source code.
+     *
+     *  Everything about a statement that is fixed when the program is
+     *  compiled -- its format string, where it is and its level -- lives
+     *  in a LogSite, so a deferred log statement only has to record a
+     *  pointer to the site and the values of its arguments.  The
+     *  PISTIS_LOG_DEFERRED family of macros creates a LogSite with
+     *  static storage duration for each statement.  Because messages
+     *  refer to sites by address, a LogSite must outlive every message
+     *  that refers to it.
+     */
+    class LogSite {
+    public:
+      constexpr LogSite(const char* format, const char* file, uint32_t line,
+			LogLevel logLevel):
+	  format_(format), numArgs_(countFormatArgs(format)), file_(file),
+	  line_(line), logLevel_(logLevel) {
+	// Intentionally left blank
+      }
+
+      constexpr const char* format() const { return format_; }
+      constexpr size_t numArgs() const { return numArgs_; }
+      constexpr const char* file() const { return file_; }
+      constexpr uint32_t line() const { return line_; }
+      constexpr LogLevel logLevel() const { return logLevel_; }
+      constexpr LogSourceLocation location() const {
+	return LogSourceLocation(file_, line_, nullptr);
+      }
+
+    private:
+      const char* format_;
+      size_t numArgs_;
+      const char* file_;
+      uint32_t line_;
+      LogLevel logLevel_;
+    };
+
+  }
+}
+#endif
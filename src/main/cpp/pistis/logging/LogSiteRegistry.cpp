@@ -0,0 +1,241 @@
+#include "LogSiteRegistry.hpp"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace pistis::logging;
+
+namespace {
+  bool matchesFile(const std::string& pattern, const char* file) {
+    const size_t n= strlen(file);
+    if (pattern.size() > n) {
+      return false;
+    }
+    const char* suffix= file + n - pattern.size();
+    return !strcmp(suffix, pattern.c_str()) &&
+           ((suffix == file) || (suffix[-1] == '/'));
+  }
+
+  bool matchesDestination(const std::string& pattern,
+			  const std::string& destination) {
+    if (!pattern.empty() && (pattern.back() == '*')) {
+      return !destination.compare(0, pattern.size() - 1, pattern, 0,
+				  pattern.size() - 1);
+    }
+    return pattern == destination;
+  }
+
+  uint32_t parseLine(const std::string& text) {
+    char* end= nullptr;
+    const unsigned long line= strtoul(text.c_str(), &end, 10);
+    if (text.empty() || *end || !line || (line > UINT32_MAX)) {
+      throw std::invalid_argument("Invalid line number \"" + text + "\"");
+    }
+    return (uint32_t)line;
+  }
+}
+
+constexpr uint32_t LogSiteSwitch::UNREGISTERED_;
+constexpr uint32_t LogSiteSwitch::OFF_;
+constexpr uint32_t LogSiteSwitch::ON_;
+constexpr uint32_t LogSiteSwitch::BY_DESTINATION_;
+constexpr uint32_t LogSiteSwitch::OFF_FOR_DESTINATION_;
+constexpr uint32_t LogSiteSwitch::ON_FOR_DESTINATION_;
+constexpr size_t LogSiteSwitch::NUM_DESTINATIONS_;
+
+bool LogSiteSwitch::register_(LogLevel level, const char* function,
+			      const LogDestination& destination) {
+  return LogSiteRegistry::getInstance()->registerSite(*this, level, function,
+						      destination);
+}
+
+size_t LogSiteSwitch::slotFor_(uint32_t destinationId) const {
+  size_t empty= NUM_DESTINATIONS_;
+  for (size_t i= 0; i < NUM_DESTINATIONS_; ++i) {
+    const uint64_t answer= destinations_[i].load(std::memory_order_relaxed);
+    if ((uint32_t)answer == UNREGISTERED_) {
+      empty= std::min(empty, i);
+    } else if ((uint32_t)(answer >> 32) == destinationId) {
+      return i;
+    }
+  }
+  // With every entry taken, forget one of the other destinations
+  return (empty < NUM_DESTINATIONS_) ? empty
+                                     : (destinationId % NUM_DESTINATIONS_);
+}
+
+LogSitePattern LogSitePattern::parse(const std::string& text) {
+  LogSitePattern pattern;
+  std::istringstream in(text);
+  std::string term;
+
+  while (in >> term) {
+    const size_t eq= term.find('=');
+    if ((eq == std::string::npos) || (eq + 1 == term.size())) {
+      throw std::invalid_argument("Term \"" + term +
+				  "\" is not of the form key=value");
+    }
+    const std::string key= term.substr(0, eq);
+    const std::string value= term.substr(eq + 1);
+    if (key == "file") {
+      const size_t colon= value.rfind(':');
+      if (colon == std::string::npos) {
+	pattern.file= value;
+      } else {
+	pattern.file= value.substr(0, colon);
+	pattern.line= parseLine(value.substr(colon + 1));
+      }
+    } else if (key == "line") {
+      pattern.line= parseLine(value);
+    } else if (key == "func") {
+      pattern.function= value;
+    } else if (key == "destination") {
+      pattern.destination= value;
+    } else {
+      throw std::invalid_argument("Unknown key \"" + key + "\"");
+    }
+  }
+  return pattern;
+}
+
+LogSiteRegistry* LogSiteRegistry::getInstance() {
+  // Never destroyed, so statements can still check their switches while
+  // other static objects are being destroyed
+  static LogSiteRegistry* theRegistry= new LogSiteRegistry();
+  return theRegistry;
+}
+
+void LogSiteRegistry::reset() {
+  std::unique_lock<std::mutex> lock(sync_);
+  rules_.clear();
+  for (const Entry_& entry : entries_) {
+    entry.site->state_.store(LogSiteSwitch::OFF_, std::memory_order_relaxed);
+    for (auto& slot : entry.site->destinations_) {
+      slot.store(LogSiteSwitch::UNREGISTERED_, std::memory_order_relaxed);
+    }
+  }
+}
+
+size_t LogSiteRegistry::numSites() const {
+  std::unique_lock<std::mutex> lock(sync_);
+  return entries_.size();
+}
+
+size_t LogSiteRegistry::numRules() const {
+  std::unique_lock<std::mutex> lock(sync_);
+  return rules_.size();
+}
+
+uint64_t LogSiteRegistry::numLookups() const {
+  std::unique_lock<std::mutex> lock(sync_);
+  return numLookups_;
+}
+
+std::vector<LogSiteInfo> LogSiteRegistry::sites() const {
+  std::unique_lock<std::mutex> lock(sync_);
+  std::vector<LogSiteInfo> result;
+  result.reserve(entries_.size());
+  for (const Entry_& entry : entries_) {
+    bool byDestination;
+    result.push_back(LogSiteInfo{
+	entry.site->file(), entry.site->line(), entry.function,
+	entry.destination.name(), entry.logLevel,
+	isOn_(entry, byDestination)
+    });
+  }
+  return result;
+}
+
+bool LogSiteRegistry::registerSite(LogSiteSwitch& site, LogLevel level,
+				   const char* function,
+				   const LogDestination& destination) {
+  std::unique_lock<std::mutex> lock(sync_);
+  ++numLookups_;
+  const auto key= std::make_pair((const LogSiteSwitch*)&site,
+				 destination.id());
+  auto i= index_.find(key);
+  if (i == index_.end()) {
+    i= index_.emplace(key, entries_.size()).first;
+    entries_.push_back(Entry_{ &site, level, function, destination });
+  }
+  return updateSwitch_(entries_[i->second]);
+}
+
+void LogSiteRegistry::apply_(const LogSitePattern& pattern, bool enable) {
+  std::unique_lock<std::mutex> lock(sync_);
+
+  // Earlier rules that select nothing more than this one can no longer
+  // decide any statement
+  rules_.erase(std::remove_if(rules_.begin(), rules_.end(),
+			      [&pattern](const Rule_& rule) {
+				return covers_(pattern, rule.pattern);
+			      }),
+	       rules_.end());
+  rules_.push_back(Rule_{ pattern, enable });
+
+  for (const Entry_& entry : entries_) {
+    if (matchesLocation_(pattern, entry)) {
+      updateSwitch_(entry);
+    }
+  }
+}
+
+bool LogSiteRegistry::isOn_(const Entry_& entry, bool& byDestination) const {
+  // The latest rule that selects the entry decides it.  Rules that look
+  // at destinations and come after the latest one that does not make the
+  // answer depend on the destination.
+  byDestination= false;
+  for (auto rule= rules_.rbegin(); rule != rules_.rend(); ++rule) {
+    if (matchesLocation_(rule->pattern, entry)) {
+      if (rule->pattern.destination.empty()) {
+	return rule->enable;
+      }
+      byDestination= true;
+      if (matchesDestination(rule->pattern.destination,
+			     entry.destination.name())) {
+	return rule->enable;
+      }
+    }
+  }
+  return false;
+}
+
+bool LogSiteRegistry::updateSwitch_(const Entry_& entry) {
+  bool byDestination;
+  const bool on= isOn_(entry, byDestination);
+  LogSiteSwitch& site= *entry.site;
+  if (byDestination) {
+    const uint32_t id= entry.destination.id();
+    const uint64_t answer= ((uint64_t)id << 32) |
+                           (on ? LogSiteSwitch::ON_FOR_DESTINATION_
+			       : LogSiteSwitch::OFF_FOR_DESTINATION_);
+    site.destinations_[site.slotFor_(id)].store(answer,
+						std::memory_order_relaxed);
+    site.state_.store(LogSiteSwitch::BY_DESTINATION_,
+		      std::memory_order_relaxed);
+  } else {
+    site.state_.store(on ? LogSiteSwitch::ON_ : LogSiteSwitch::OFF_,
+		      std::memory_order_relaxed);
+  }
+  return on;
+}
+
+bool LogSiteRegistry::matchesLocation_(const LogSitePattern& pattern,
+				       const Entry_& entry) {
+  return (pattern.file.empty() ||
+	  matchesFile(pattern.file, entry.site->file())) &&
+         (!pattern.line || (pattern.line == entry.site->line())) &&
+         (pattern.function.empty() ||
+	  (entry.function && (pattern.function == entry.function)));
+}
+
+bool LogSiteRegistry::covers_(const LogSitePattern& pattern,
+			      const LogSitePattern& other) {
+  return (pattern.file.empty() || (pattern.file == other.file)) &&
+         (!pattern.line || (pattern.line == other.line)) &&
+         (pattern.function.empty() || (pattern.function == other.function)) &&
+         (pattern.destination.empty() ||
+	  (pattern.destination == other.destination));
+}
@@ -0,0 +1,268 @@
+#ifndef __PISTIS__LOGGING__LOGSITEREGISTRY_HPP__
+#define __PISTIS__LOGGING__LOGSITEREGISTRY_HPP__
+
+#include <pistis/logging/LogDestination.hpp>
+#include <pistis/logging/LogLevel.hpp>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Runtime switch for a single log statement.
+     *
+     *  The PISTIS_LOG family of macros give each statement a
+     *  LogSiteSwitch with static storage duration.  A statement whose
+     *  level is disabled for its Log is still logged if its switch is
+     *  on.  The constructor is constexpr, so the switch is initialized
+     *  before the program starts, and the switch registers itself with
+     *  the LogSiteRegistry the first time its statement executes at a
+     *  disabled level.  After that, checking the switch is a single
+     *  relaxed load and branch.
+     *
+     *  Several Logs may share a statement, e.g. one in a function that
+     *  takes the Log as an argument.  When the patterns that select the
+     *  statement make the answer depend on the Log's destination, the
+     *  switch remembers the answers for the last few destinations it
+     *  was asked about, and only asks the registry about a destination
+     *  it has not seen yet or has since forgotten.  Checking such a
+     *  switch takes a few more relaxed loads, but never a lock.
+     */
+    class LogSiteSwitch {
+    public:
+      constexpr LogSiteSwitch(const char* file, uint32_t line):
+	  file_(file), line_(line), state_(UNREGISTERED_),
+	  destinations_{ { 0 }, { 0 }, { 0 }, { 0 } } {
+	// Intentionally left blank
+      }
+      LogSiteSwitch(const LogSiteSwitch&)= delete;
+
+      const char* file() const { return file_; }
+      uint32_t line() const { return line_; }
+
+      /** @brief Returns true if the switch is on, registering it first
+       *         if it has not been registered yet.
+       *
+       *  @param level        The statement's level
+       *  @param function     Name of the function the statement is in
+       *  @param destination  Destination of the statement's Log
+       */
+      bool isOn(LogLevel level, const char* function,
+		const LogDestination& destination) {
+	const uint64_t state= state_.load(std::memory_order_relaxed);
+	if (state == OFF_) {
+	  return false;
+	}
+	if (state == ON_) {
+	  return true;
+	}
+	if (state == BY_DESTINATION_) {
+	  for (const auto& slot : destinations_) {
+	    const uint64_t answer= slot.load(std::memory_order_relaxed);
+	    if ((uint32_t)(answer >> 32) == destination.id()) {
+	      const uint32_t code= (uint32_t)answer;
+	      if (code == OFF_FOR_DESTINATION_) {
+		return false;
+	      }
+	      if (code == ON_FOR_DESTINATION_) {
+		return true;
+	      }
+	    }
+	  }
+	}
+	return register_(level, function, destination);
+      }
+
+      LogSiteSwitch& operator=(const LogSiteSwitch&)= delete;
+
+    private:
+      // The state holds one of the first four.  Each of the
+      // destinations_ holds one of the first or the last two in its low
+      // 32 bits and the id of the destination it is for in its high 32.
+      static constexpr uint32_t UNREGISTERED_= 0;
+      static constexpr uint32_t OFF_= 1;
+      static constexpr uint32_t ON_= 2;
+      static constexpr uint32_t BY_DESTINATION_= 3;
+      static constexpr uint32_t OFF_FOR_DESTINATION_= 4;
+      static constexpr uint32_t ON_FOR_DESTINATION_= 5;
+      static constexpr size_t NUM_DESTINATIONS_= 4;
+
+      const char* file_;
+      uint32_t line_;
+      std::atomic<uint64_t> state_;
+      std::atomic<uint64_t> destinations_[NUM_DESTINATIONS_];
+
+      bool register_(LogLevel level, const char* function,
+		     const LogDestination& destination);
+
+      /** @brief Index of the entry in destinations_ to hold the answer
+       *         for <tt>destinationId</tt>.  Called with the registry
+       *         locked.
+       */
+      size_t slotFor_(uint32_t destinationId) const;
+
+      friend class LogSiteRegistry;
+    };
+
+    /** @brief Selects log statements by where they are and which Log
+     *         they write to.
+     *
+     *  Each criterion that is set must match; the rest match anything.
+     *  <tt>file</tt> matches a statement's file name if it is the same
+     *  or a trailing part of it that starts after a '/', so "Server.cpp"
+     *  and "net/Server.cpp" both match "src/net/Server.cpp".
+     *  <tt>destination</tt> matches a Log's destination exactly or, if
+     *  it ends in '*', any destination starting with the text before the
+     *  '*'.
+     */
+    struct LogSitePattern {
+      std::string file;          ///< File name, or empty for any
+      uint32_t line= 0;          ///< Line number, or zero for any
+      std::string function;      ///< Function name, or empty for any
+      std::string destination;   ///< Destination, or empty for any
+
+      /** @brief Parse a pattern from text.
+       *
+       *  The text is a list of <tt>key=value</tt> terms separated by
+       *  spaces, where the keys are "file", "line", "func" and
+       *  "destination".  The value of "file" may end in
+       *  <tt>:line</tt>.  For example:
+       *
+       *  <pre>
+       *    file=net/Server.cpp:120
+       *    func=acceptConnection destination=net.*
+       *  </pre>
+       *
+       *  @throws std::invalid_argument if <tt>text</tt> is malformed
+       */
+      static LogSitePattern parse(const std::string& text);
+    };
+
+    /** @brief Description of a registered log statement and a
+     *         destination it has been logged to
+     */
+    struct LogSiteInfo {
+      const char* file;
+      uint32_t line;
+      const char* function;
+      std::string destination;
+      LogLevel logLevel;
+      bool enabled;
+    };
+
+    /** @brief Keeps track of every LogSiteSwitch and turns them on and
+     *         off.
+     *
+     *  enable() and disable() apply to the statements that have already
+     *  registered, and are remembered and applied to statements that
+     *  register later, in the order they were called.  A statement none
+     *  of them match is off.  A statement is decided separately for
+     *  each destination it is logged to.  A pattern replaces any
+     *  earlier one that selects no more than it does, so giving the
+     *  same patterns over and over does not make the registry grow.
+     *  Statements whose level is below PISTIS_LOGGING_MIN_LEVEL are not
+     *  compiled in, so they cannot be turned on.
+     */
+    class LogSiteRegistry {
+    public:
+      LogSiteRegistry()= default;
+      LogSiteRegistry(const LogSiteRegistry&)= delete;
+
+      static LogSiteRegistry* getInstance();
+
+      /** @brief Turn on the statements <tt>pattern</tt> selects */
+      void enable(const LogSitePattern& pattern) { apply_(pattern, true); }
+
+      /** @brief Turn off the statements <tt>pattern</tt> selects */
+      void disable(const LogSitePattern& pattern) { apply_(pattern, false); }
+
+      /** @brief Forget every call to enable() and disable() and turn all
+       *         statements off
+       */
+      void reset();
+
+      /** @brief Number of distinct statement and destination pairs
+       *         registered
+       */
+      size_t numSites() const;
+
+      /** @brief Number of patterns remembered for statements that
+       *         register later
+       */
+      size_t numRules() const;
+
+      /** @brief Number of times a statement has asked the registry
+       *         whether it is on
+       */
+      uint64_t numLookups() const;
+
+      std::vector<LogSiteInfo> sites() const;
+
+      /** @brief Register <tt>site</tt> as logged to
+       *         <tt>destination</tt>, if it is not registered already,
+       *         and set its switch according to the patterns given so
+       *         far.
+       *
+       *  @returns True if the switch is on for <tt>destination</tt>
+       */
+      bool registerSite(LogSiteSwitch& site, LogLevel level,
+			const char* function,
+			const LogDestination& destination);
+
+      LogSiteRegistry& operator=(const LogSiteRegistry&)= delete;
+
+    private:
+      struct Entry_ {
+	LogSiteSwitch* site;
+	LogLevel logLevel;
+	const char* function;
+	LogDestination destination;
+      };
+
+      struct Rule_ {
+	LogSitePattern pattern;
+	bool enable;
+      };
+
+      mutable std::mutex sync_;
+      std::vector<Entry_> entries_;
+      std::vector<Rule_> rules_;
+      uint64_t numLookups_= 0;
+
+      /** @brief Index into entries_ of each statement and destination id */
+      std::map<std::pair<const LogSiteSwitch*, uint32_t>, size_t> index_;
+
+      void apply_(const LogSitePattern& pattern, bool enable);
+
+      /** @brief Whether <tt>entry</tt> is on, and whether other
+       *         destinations might get a different answer
+       */
+      bool isOn_(const Entry_& entry, bool& byDestination) const;
+
+      /** @brief Set the switch of <tt>entry</tt>'s statement for its
+       *         destination
+       *
+       *  @returns True if the switch is on
+       */
+      bool updateSwitch_(const Entry_& entry);
+
+      /** @brief Whether <tt>pattern</tt> selects <tt>entry</tt>'s
+       *         statement, leaving aside its destination
+       */
+      static bool matchesLocation_(const LogSitePattern& pattern,
+				   const Entry_& entry);
+
+      /** @brief Whether <tt>pattern</tt> selects every statement that
+       *         <tt>other</tt> selects
+       */
+      static bool covers_(const LogSitePattern& pattern,
+			  const LogSitePattern& other);
+    };
+
+  }
+}
+#endif
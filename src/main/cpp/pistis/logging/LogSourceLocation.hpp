@@ -0,0 +1,91 @@
+#ifndef __PISTIS__LOGGING__LOGSOURCELOCATION_HPP__
+#define __PISTIS__LOGGING__LOGSOURCELOCATION_HPP__
+
+#include <iostream>
+#include <stdint.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PISTIS_LOGGING_CURRENT_FILE_ __builtin_FILE()
+#define PISTIS_LOGGING_CURRENT_LINE_ __builtin_LINE()
+#define PISTIS_LOGGING_CURRENT_FUNCTION_ __builtin_FUNCTION()
+#else
+#define PISTIS_LOGGING_CURRENT_FILE_ nullptr
+#define PISTIS_LOGGING_CURRENT_LINE_ 0
+#define PISTIS_LOGGING_CURRENT_FUNCTION_ nullptr
+#endif
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Where a log statement is in the source code.
+     *
+     *  Holds pointers to the file and function names the compiler keeps
+     *  in static storage, so capturing a location copies nothing but
+     *  two pointers and a line number.  Used as a default argument, as
+     *  in
+     *
+     *  <pre>
+     *    void f(LogSourceLocation location= LogSourceLocation::current());
+     *  </pre>
+     *
+     *  current() returns the location of the call to f(), as
+     *  std::source_location::current() does in C++20.  On compilers
+     *  without __builtin_FILE() and its kin, the location is unknown.
+     */
+    class LogSourceLocation {
+    public:
+      /** @brief Create an unknown location */
+      constexpr LogSourceLocation():
+	  file_(nullptr), function_(nullptr), line_(0) {
+	// Intentionally left blank
+      }
+
+      constexpr LogSourceLocation(const char* file, uint32_t line,
+				  const char* function):
+	  file_(file), function_(function), line_(line) {
+	// Intentionally left blank
+      }
+
+      /** @brief Returns the location of the caller when used as a
+       *         default argument
+       */
+      static constexpr LogSourceLocation current(
+	  const char* file= PISTIS_LOGGING_CURRENT_FILE_,
+	  uint32_t line= PISTIS_LOGGING_CURRENT_LINE_,
+	  const char* function= PISTIS_LOGGING_CURRENT_FUNCTION_
+      ) {
+	return LogSourceLocation(file, line, function);
+      }
+
+      /** @brief Returns true if the file is known */
+      constexpr bool known() const { return file_ != nullptr; }
+
+      /** @brief Name of the file, or nullptr if unknown */
+      constexpr const char* file() const { return file_; }
+
+      /** @brief Line number, or zero if unknown */
+      constexpr uint32_t line() const { return line_; }
+
+      /** @brief Name of the function, or nullptr if unknown */
+      constexpr const char* function() const { return function_; }
+
+    private:
+      const char* file_;
+      const char* function_;
+      uint32_t line_;
+    };
+
+    /** @brief Writes "<file>:<line>", or "?" if the location is unknown */
+    inline std::ostream& operator<<(std::ostream& out,
+				    const LogSourceLocation& location) {
+      if (location.known()) {
+	out << location.file() << ':' << location.line();
+      } else {
+	out << '?';
+      }
+      return out;
+    }
+
+  }
+}
+#endif
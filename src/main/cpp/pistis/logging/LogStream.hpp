@@ -1,101 +1,236 @@
 #ifndef __PISTIS__LOGGING__LOGSTREAM_HPP__
 #define __PISTIS__LOGGING__LOGSTREAM_HPP__
 
+#include <pistis/logging/FormatArg.hpp>
 #include <pistis/logging/LogStreamBuffer.hpp>
 #include <pistis/logging/LogLevel.hpp>
+#include <pistis/logging/NumberFormat.hpp>
 #include <iostream>
-#include <memory>
 
 namespace pistis {
   namespace logging {
 
+    /** @brief Output stream that writes a single log statement.
+     *
+     *  A LogStream holds its LogStreamBuffer and std::basic_ostream
+     *  directly, so a log statement lives entirely on the caller's stack
+     *  and does not allocate memory beyond the LogMessage it obtains from
+     *  its LogMessageFactory.
+     *
+     *  Integers, floats, doubles and pointers are formatted straight into
+     *  the message by the functions in NumberFormat.hpp, rather than by
+     *  std::num_put, whenever the stream's format is one those functions
+     *  reproduce exactly: no flags set other than skipws and either dec
+     *  or hex, and a width of zero.  This assumes the stream uses the
+     *  classic "C" locale's number format, as it does unless the program
+     *  changes the global locale.
+     */
     template <typename CharT, typename TraitsT=std::char_traits<CharT> >
     class LogStream {
-    private:
-      class Impl {
-      public:
-	Impl(LogMessageFactory& factory, LogMessageReceiver& receiver,
-	     const std::string& destination, LogLevel logLevel,
-	     bool enabled):
-	    buffer_(factory, receiver, destination, logLevel), out_(&buffer_),
-	    enabled_(enabled) {
-	  // Intentionally left blank
-	}
-	~Impl() { }
-
-	const std::string& destination() const {
-	  return buffer_.destination();
-	}
-	LogLevel logLevel() const { return buffer_.logLevel(); }
-	bool enabled() const { return enabled_; }
-
-	template <typename T>
-	void write(const T& value) {
-	  if (enabled()) {
-	    out_ << value;
-	  }
-	}
-
-	void write(const char* data, std::streamsize n) {
-	  if (enabled()) {
-	      out_.write(data, n);
-	  }
-	}
-
-	void flush() {
-	  if (enabled()) {
-	    out_.flush();
-	  }
-	}
-
-      private:
-	LogStreamBuffer<CharT, TraitsT> buffer_;
-	std::basic_ostream<CharT, TraitsT> out_;
-	bool enabled_;
-      };
-
     public:
       LogStream(LogMessageFactory& factory, LogMessageReceiver& receiver,
-		const std::string& destination, LogLevel logLevel,
-		bool enabled):
-	  impl_(new Impl(factory, receiver, destination, logLevel, enabled)) {
+		const LogDestination& destination, LogLevel logLevel,
+		bool enabled,
+		const LogSourceLocation& location= LogSourceLocation()):
+	  buffer_(factory, receiver, destination, logLevel, location),
+	  out_(&buffer_),
+	  enabled_(enabled) {
 	// Intentionally left blank
       }
       LogStream(const LogStream& other) = delete;
       LogStream(LogStream&& other):
-	  impl_(other.impl_.release()) {
-	// Intentionally left blank
+	  buffer_(std::move(other.buffer_)), out_(&buffer_),
+	  enabled_(other.enabled_) {
+	out_.copyfmt(other.out_);
+	out_.clear(other.out_.rdstate());
       }
       ~LogStream() { }
 
-      const std::string& destination() const { return impl_->destination(); }
-      LogLevel logLevel() const { return impl_->logLevel(); }
-      bool enabled() const { return impl_->enabled(); }
+      const std::string& destination() const { return buffer_.destination(); }
+      const LogDestination& destinationHandle() const {
+	return buffer_.destinationHandle();
+      }
+      LogLevel logLevel() const { return buffer_.logLevel(); }
+      bool enabled() const { return enabled_; }
 
       template <typename ObjectT>
       const LogStream& write(const ObjectT& o) const {
-	impl_->write(o);
+	if (enabled()) {
+	  write_(o, KindTag_<NumberFormatKindOf<ObjectT>::value>());
+	}
+	return *this;
+      }
+
+      /** @brief Attach a structured field to the statement
+       *
+       *  The value is stored in the LogMessage in binary form, apart from
+       *  the statement's text, rather than being written as text.
+       *  Fields can be mixed with text in any order:
+       *
+       *  <pre>
+       *    log.info().kv("user", id).kv("latency_us", t) << "done";
+       *  </pre>
+       *
+       *  Values are captured as FormatArg does.  Types that FormatArg does
+       *  not handle directly are formatted with their operator<< and
+       *  stored as strings.  Fields belong to the message in progress, so
+       *  if a statement's text spills over into more than one message,
+       *  only the first carries its fields.  Fields that do not fit are
+       *  dropped.
+       *
+       *  @param key    The field's name
+       *  @param value  The field's value
+       */
+      template <typename ValueT>
+      const LogStream& kv(const char* key, const ValueT& value) const {
+	if (enabled()) {
+	  buffer_.addField(key, strlen(key), FormatArg(value));
+	}
 	return *this;
       }
 
       const LogStream& write(const CharT* data, std::streamsize n) const {
-	impl_->write(data, n);
+	if (enabled()) {
+	  out_.write(data, n);
+	}
 	return *this;
       }
 
       const LogStream& flush() const {
-	impl_->flush();
+	if (enabled()) {
+	  out_.flush();
+	}
 	return *this;
       }
 
       LogStream& operator=(const LogStream&) = delete;
       LogStream& operator=(LogStream&& other) {
-	impl_ = std::move(other.impl_);
+	if (this != &other) {
+	  buffer_ = std::move(other.buffer_);
+	  out_.copyfmt(other.out_);
+	  out_.clear(other.out_.rdstate());
+	  enabled_ = other.enabled_;
+	}
 	return *this;
       }
 
     private:
-      std::unique_ptr<Impl> impl_;
+      // The stream operators are const so they can be applied to the
+      // temporary LogStream returned by Log::log() and its kin.
+      mutable LogStreamBuffer<CharT, TraitsT> buffer_;
+      mutable std::basic_ostream<CharT, TraitsT> out_;
+      bool enabled_;
+
+      template <NumberFormatKind KIND>
+      using KindTag_ = std::integral_constant<NumberFormatKind, KIND>;
+
+      template <typename ObjectT>
+      void write_(const ObjectT& o, KindTag_<NumberFormatKind::NONE>) const {
+	out_ << o;
+      }
+
+      template <typename ObjectT>
+      void write_(ObjectT v, KindTag_<NumberFormatKind::SIGNED>) const {
+	const std::ios_base::fmtflags f= plainFormat_();
+	if ((f == std::ios_base::dec) &&
+	    writeFormatted_([v](char* p) { return formatSigned(p, v); })) {
+	  return;
+	}
+	if (f == std::ios_base::hex) {
+	  // Negative numbers are written in two's complement at their own
+	  // width, as std::num_put does
+	  typedef typename std::make_unsigned<ObjectT>::type Unsigned;
+	  if (writeFormatted_([v](char* p) {
+		return formatHex(p, (Unsigned)v);
+	      })) {
+	    return;
+	  }
+	}
+	out_ << v;
+      }
+
+      template <typename ObjectT>
+      void write_(ObjectT v, KindTag_<NumberFormatKind::UNSIGNED>) const {
+	const std::ios_base::fmtflags f= plainFormat_();
+	if ((f == std::ios_base::dec) &&
+	    writeFormatted_([v](char* p) { return formatUnsigned(p, v); })) {
+	  return;
+	}
+	if ((f == std::ios_base::hex) &&
+	    writeFormatted_([v](char* p) { return formatHex(p, v); })) {
+	  return;
+	}
+	out_ << v;
+      }
+
+      template <typename ObjectT>
+      void write_(ObjectT v,
+		  KindTag_<NumberFormatKind::FLOATING_POINT>) const {
+	const std::streamsize precision= out_.precision();
+	if ((plainFormat_() != std::ios_base::dec) || (precision < 0) ||
+	    (precision > MAX_DOUBLE_FORMAT_PRECISION) ||
+	    !writeFormatted_([v, precision](char* p) {
+		return formatDouble(p, v, (int)precision);
+	      })) {
+	  out_ << v;
+	}
+      }
+
+      template <typename ObjectT>
+      void write_(ObjectT v, KindTag_<NumberFormatKind::POINTER>) const {
+	const void* const p= (const void*)v;
+	if ((plainFormat_() != std::ios_base::dec) ||
+	    !writeFormatted_([p](char* out) {
+		// std::num_put writes null pointers as "0"
+		if (!p) {
+		  *out++ = '0';
+		  return out;
+		}
+		return formatPointer(out, p);
+	      })) {
+	  out_ << p;
+	}
+      }
+
+      /** @brief Returns the stream's flags, less skipws, if it is in a
+       *         state the fast number formatting path can write to, or
+       *         no flags at all if it is not.
+       */
+      std::ios_base::fmtflags plainFormat_() const {
+	return (out_.width() || !out_.good())
+	    ? std::ios_base::fmtflags()
+	    : (out_.flags() & ~std::ios_base::skipws);
+      }
+
+      /** @brief Reserve room in the message and call
+       *         <tt>format(char*)</tt> to write into it.
+       *
+       *  @returns False if the message cannot hold a formatted number, in
+       *           which case nothing is written
+       */
+      template <typename FormatterT>
+      bool writeFormatted_(FormatterT format) const {
+	CharT* p= buffer_.reserve(MAX_FORMATTED_NUMBER_SIZE);
+	if (!p) {
+	  return false;
+	}
+	buffer_.commit(widen_(p, format));
+	return true;
+      }
+
+      template <typename FormatterT>
+      static char* widen_(char* p, FormatterT format) { return format(p); }
+
+      template <typename OutT, typename FormatterT>
+      static OutT* widen_(OutT* p, FormatterT format) {
+	// Numbers are all ASCII, so widening is a cast
+	char tmp[MAX_FORMATTED_NUMBER_SIZE];
+	const char* const end= format(tmp);
+	for (const char* q= tmp; q != end; ++q) {
+	  *p++ = (OutT)*q;
+	}
+	return p;
+      }
     };
 
     template <typename CharT, typename TraitsT, typename ObjectT>
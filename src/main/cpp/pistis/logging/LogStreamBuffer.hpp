@@ -5,20 +5,36 @@
 #include <pistis/logging/LogMessageFactory.hpp>
 #include <pistis/logging/LogMessage.hpp>
 #include <pistis/logging/LogMessageReceiver.hpp>
+#include <pistis/logging/LogMessageWriter.hpp>
+#include <pistis/logging/NumberFormat.hpp>
+#include <pistis/logging/Utf8.hpp>
+#include <algorithm>
 #include <string.h>
 
 namespace pistis {
   namespace logging {
 
+    /** @brief Stream buffer that writes directly into LogMessages.
+     *
+     *  Grows the message it is writing as needed and, once the message
+     *  reaches its maximum capacity, sends it to the receiver and
+     *  continues in a new one, marking the messages as parts of one
+     *  statement as described in LogMessage.  If the factory is
+     *  segmented, it chains segments onto the message instead of
+     *  growing it.
+     */
     template <typename CharT, typename TraitsT = std::char_traits<CharT> >
     class LogStreamBuffer : public std::basic_streambuf<CharT, TraitsT> {
     public:
       LogStreamBuffer(LogMessageFactory& msgFactory,
 		      LogMessageReceiver& receiver,
-		      const std::string& destination,
-		      LogLevel logLevel):
-	  msgFactory_(msgFactory), msgReceiver_(receiver), 
-          destination_(destination), logLevel_(logLevel), current_(nullptr) {
+		      const LogDestination& destination,
+		      LogLevel logLevel,
+		      const LogSourceLocation& location= LogSourceLocation()):
+	  msgFactory_(&msgFactory), msgReceiver_(&receiver), 
+          destination_(destination), logLevel_(logLevel),
+	  location_(location), timestamp_(), thread_(), current_(nullptr),
+	  tail_(nullptr), chainSize_(0), statementId_(0), partNumber_(0) {
 	this->setp(nullptr, nullptr);	  
       }
 	
@@ -27,11 +43,19 @@ namespace pistis {
       LogStreamBuffer(LogStreamBuffer&& other):
 	  std::basic_streambuf<CharT, TraitsT>(),
 	  msgFactory_(other.msgFactory_), msgReceiver_(other.msgReceiver_),
-	  destination_(std::move(other.destination_)),
-	  logLevel_(other.logLevel_), current_(other.current_) {
+	  destination_(other.destination_),
+	  logLevel_(other.logLevel_), location_(other.location_),
+	  timestamp_(other.timestamp_), thread_(other.thread_),
+	  current_(other.current_), tail_(other.tail_),
+	  chainSize_(other.chainSize_), statementId_(other.statementId_),
+	  partNumber_(other.partNumber_) {
+	other.statementId_= 0;
+	other.partNumber_= 0;
 	if (current_) {
+	  tail_->setEnd((char*)other.pptr());
 	  resetStreamBufPtrs_();
 	  other.current_= nullptr;
+	  other.tail_= nullptr;
 	  other.setp(nullptr, nullptr);
 	} else {
 	  this->setp(nullptr, nullptr);
@@ -42,11 +66,89 @@ namespace pistis {
 	sync();
       }
 
-      const std::string& destination() const { return destination_; }
+      const std::string& destination() const { return destination_.name(); }
+      const LogDestination& destinationHandle() const { return destination_; }
       LogLevel logLevel() const { return logLevel_; }
 
+      /** @brief Timestamp given to the messages the buffer fills, which
+       *         is read from LogClock when the buffer obtains its first
+       *         message, and is not set until then
+       */
+      const LogTimestamp& timestamp() const { return timestamp_; }
+
+      /** @brief Thread given to the messages the buffer fills, which is
+       *         the thread that obtains its first message, and is
+       *         unknown until then
+       */
+      const LogThreadInfo& thread() const { return thread_; }
+
+      /** @brief Add a structured field to the message in progress,
+       *         obtaining a message if there is none.
+       *
+       *  @see LogMessage::addField()
+       */
+      bool addField(const char* key, size_t keySize, const FormatArg& value) {
+	if (!current_) {
+	  getNewMessage_();
+	}
+	return current_->addField(key, keySize, value);
+      }
+
+      /** @brief Returns a pointer to room for at least <tt>n</tt>
+       *         contiguous characters at the end of the message in
+       *         progress.
+       *
+       *  Obtains a message if there is none and grows the message, or
+       *  sends it and continues in a new one, if it does not have room.
+       *  Callers write into the space, then call commit() to append what
+       *  they wrote.  Used to format values directly into the message.
+       *
+       *  @returns A pointer to the free space, or nullptr if <tt>n</tt>
+       *           characters are more than a message can ever hold
+       */
+      CharT* reserve(size_t n) {
+	return (((size_t)(this->epptr() - this->pptr()) >= n) ||
+		makeRoom_(n)) ? this->pptr() : nullptr;
+      }
+
+      /** @brief Append the characters written into the space returned by
+       *         reserve(), up to but not including <tt>newEnd</tt>.
+       */
+      void commit(CharT* newEnd) { this->pbump((int)(newEnd - this->pptr())); }
+
       LogStreamBuffer& operator=(const LogStreamBuffer&)= delete;
 
+      /** @brief Send any message in progress to the receiver, then take
+       *         over the message in progress in <tt>other</tt>.
+       */
+      LogStreamBuffer& operator=(LogStreamBuffer&& other) {
+	if (this != &other) {
+	  sync();
+	  msgFactory_ = other.msgFactory_;
+	  msgReceiver_ = other.msgReceiver_;
+	  destination_ = other.destination_;
+	  logLevel_ = other.logLevel_;
+	  location_ = other.location_;
+	  timestamp_ = other.timestamp_;
+	  thread_ = other.thread_;
+	  current_ = other.current_;
+	  tail_ = other.tail_;
+	  chainSize_ = other.chainSize_;
+	  statementId_ = other.statementId_;
+	  partNumber_ = other.partNumber_;
+	  other.statementId_= 0;
+	  other.partNumber_= 0;
+	  if (current_) {
+	    tail_->setEnd((char*)other.pptr());
+	    resetStreamBufPtrs_();
+	    other.current_= nullptr;
+	    other.tail_= nullptr;
+	    other.setp(nullptr, nullptr);
+	  }
+	}
+	return *this;
+      }
+
     protected:
       virtual std::basic_streambuf<CharT, TraitsT>* setbuf(
 	  CharT* buffer, std::streamsize n
@@ -69,14 +171,42 @@ namespace pistis {
 	return typename TraitsT::pos_type(this->pptr() - this->pbase());
       }
 
+      /** @brief Send the message in progress as the end of the
+       *         statement
+       */
       virtual int sync() {
+	if (!current_ && statementId_) {
+	  // The last part ended exactly where the statement did, but the
+	  // receiver still needs to hear that the statement is complete
+	  getNewMessage_();
+	}
+	send_(true);
+	return 0;
+      }
+
+      /** @brief Send the message in progress as a part of a statement
+       *         that continues in the next message
+       */
+      void sendPart_() { send_(false); }
+
+      void send_(bool final) {
 	if (current_) {
-	  current_->setEnd((char*)this->pptr());
-	  msgReceiver_.receive(current_);
+	  if (statementId_ || !final) {
+	    if (!statementId_) {
+	      statementId_ = LogMessage::newStatementId();
+	    }
+	    current_->setPart(statementId_, partNumber_++, final);
+	  }
+	  tail_->setEnd((char*)this->pptr());
+	  msgReceiver_->receive(current_);
 	  current_ = nullptr;
+	  tail_ = nullptr;
 	  this->setp(nullptr, nullptr);
 	}
-	return 0;
+	if (final) {
+	  statementId_ = 0;
+	  partNumber_ = 0;
+	}
       }
 
       virtual std::streamsize showmanyc() {
@@ -109,22 +239,22 @@ namespace pistis {
 	
 	while (remaining) {
 	  size_t available = (size_t)(this->epptr() - this->pptr());
+	  if (!available && this->pptr() && addSegment_()) {
+	    available = (size_t)(this->epptr() - this->pptr());
+	  }
 	  if (!available) {
-	    sync();
+	    sendPart_();
 	    available = (size_t)(this->epptr() - this->pptr());
 	  }
 	  if (!this->pptr()) {
-	    getNewMessage_();
+	    getNewMessage_((size_t)remaining * sizeof(CharT));
 	    available = (size_t)(this->epptr() - this->pptr());
 	  }
-	  if (available < remaining) {
-	    current_->setEnd((char*)this->pptr());
-	    current_->increaseCapacity(
-	        computeNewCapacity_(current_->capacity(),
-				    current_->size() + remaining*sizeof(CharT),
-				    current_->maxCapacity())
-	    );
-	    resetStreamBufPtrs_();
+	  if ((available < remaining) &&
+	      (!available || !msgFactory_->segmented())) {
+	    // Segments are filled rather than grown, unless they cannot hold
+	    // a single character
+	    growTail_(remaining);
 	    available = (size_t)(this->epptr() - this->pptr());
 	    if (!available) {
 	      // Message buffer is too small to hold at least one char,
@@ -151,27 +281,18 @@ namespace pistis {
 	  // it may be trying to allocate some space prior to writing a
 	  // character, so obtain a new message for it to write to.
 	  getNewMessage_();
-	} else if (this->pptr() == this->epptr()) {
+	} else if ((this->pptr() == this->epptr()) && !addSegment_()) {
 	  // Buffer is genuinely full, so try to increase its size.  Once
 	  // we reach the maximum size, flush the message and obtain a new
 	  // one.
-	  current_->setEnd((char*)this->pptr());
-	  size_t oldCapacity= current_->capacity();
-	  size_t newCapacity= current_->increaseCapacity(oldCapacity*2);
-	  if (newCapacity < sizeof(CharT)) {
-	    // Buffer needs to be large enough to hold at least one char...
-	    newCapacity= current_->increaseCapacity(sizeof(CharT));
-	    if (newCapacity < sizeof(CharT)) {
+	  if (!growTail_(1)) {
+	    sendPart_();
+	    getNewMessage_();
+	    if ((this->pptr() == this->epptr()) && !growTail_(1)) {
 	      // Maximum size of buffer is less than one char, abort...
 	      return TraitsT::eof();
 	    }
 	  }
-	  if (oldCapacity == newCapacity) {
-	    sync();
-	    getNewMessage_();
-	  } else {
-	      resetStreamBufPtrs_();
-	  }
 	}
 	if (c != TraitsT::eof()) {
 	  *this->pptr() = c;
@@ -180,22 +301,124 @@ namespace pistis {
 	return c;
       }
 
-      void getNewMessage_() {
-	current_ = msgFactory_.get();
+      bool makeRoom_(size_t n) {
+	if (!this->pptr()) {
+	  getNewMessage_();
+	}
+	if (!growToFit_(n) && !current_->empty() &&
+	    (n * sizeof(CharT) <= current_->maxCapacity())) {
+	  // Keep what is about to be written in one piece by continuing in
+	  // a new message
+	  sendPart_();
+	  getNewMessage_();
+	  growToFit_(n);
+	}
+	return (size_t)(this->epptr() - this->pptr()) >= n;
+      }
+
+      bool growToFit_(size_t n) {
+	if ((size_t)(this->epptr() - this->pptr()) < n) {
+	  addSegment_();
+	}
+	if ((size_t)(this->epptr() - this->pptr()) < n) {
+	  growTail_(n);
+	}
+	return (size_t)(this->epptr() - this->pptr()) >= n;
+      }
+
+      /** @brief Grow the last segment of the current message towards
+       *         having room for <tt>n</tt> more characters, keeping the
+       *         whole chain within the message's maximum capacity.
+       *
+       *  @returns True if the segment has more room than before
+       */
+      bool growTail_(size_t n) {
+	const size_t available= (size_t)(this->epptr() - this->pptr());
+	const size_t limit= std::min(tail_->maxCapacity(),
+				     current_->maxCapacity() - chainSize_);
+	tail_->setEnd((char*)this->pptr());
+	if (tail_->capacity() < limit) {
+	  tail_->increaseCapacity(
+	      std::min(computeNewCapacity_(std::max(tail_->capacity(),
+						    (size_t)1),
+					   tail_->size() + n * sizeof(CharT),
+					   limit),
+		       limit)
+	  );
+	  resetStreamBufPtrs_();
+	}
+	return (size_t)(this->epptr() - this->pptr()) > available;
+      }
+
+      /** @brief Chain a new segment onto the current message and continue
+       *         writing in it.
+       *
+       *  Does nothing unless the factory is segmented, the last segment
+       *  has text in it and the chain has not reached the message's
+       *  maximum capacity.
+       *
+       *  @returns True if a segment was added
+       */
+      bool addSegment_() {
+	if (!current_ || (this->pptr() == this->pbase()) ||
+	    !msgFactory_->segmented()) {
+	  return false;
+	}
+
+	const size_t used= chainSize_ + (size_t)((char*)this->pptr() -
+						 tail_->begin());
+	if (used >= current_->maxCapacity()) {
+	  return false;
+	}
+
+	LogMessage* segment= msgFactory_->get();
+	tail_->setEnd((char*)this->pptr());
+	tail_->appendSegment(segment);
+	tail_= segment;
+	chainSize_= used;
+	resetStreamBufPtrs_();
+	return true;
+      }
+
+      /** @brief Get a message that can hold <tt>sizeHint</tt> bytes from
+       *         the factory
+       */
+      void getNewMessage_(size_t sizeHint= 0) {
+	// Disabled statements still create a buffer, so leave reading the
+	// clock and looking up the thread until something is written
+	if (!timestamp_.isSet()) {
+	  timestamp_ = LogClock::now();
+	}
+	if (!thread_.known()) {
+	  thread_ = LogThreadInfo::current();
+	}
+	current_ = msgFactory_->get(sizeHint);
 	current_->setLogLevel(logLevel_);
 	current_->setDestination(destination_);
+	current_->setEncoding(LogMessageEncoding::TEXT);
+	current_->setSourceLocation(location_);
+	current_->setTimestamp(timestamp_);
+	current_->setThread(thread_);
+	tail_ = current_;
+	chainSize_ = 0;
 	resetStreamBufPtrs_();
       }
 
       void resetStreamBufPtrs_() {
-	CharT* eos= (CharT*)current_->eos();
+	CharT* eos= (CharT*)tail_->eos();
 	if (sizeof(CharT) > 1) {
 	  // Fix end pointer so it is guaranteed to lie within the buffer
 	  eos =
-	    (CharT*)(current_->begin() + (current_->capacity()/sizeof(CharT)));
+	    (CharT*)tail_->begin() + (tail_->capacity()/sizeof(CharT));
 	}
-	this->setp((CharT*)current_->begin(), eos);
-	this->pbump(current_->size()/sizeof(CharT));
+	if (chainSize_) {
+	  // Segments may be larger than what is left of the chain's maximum
+	  eos= std::min(eos, (CharT*)tail_->begin() +
+			       (current_->maxCapacity() - chainSize_) /
+			           sizeof(CharT));
+	}
+	this->setp((CharT*)tail_->begin(), eos);
+	this->pbump(tail_->size()/sizeof(CharT));
       }
 
       size_t computeNewCapacity_(size_t current, size_t target,
@@ -211,13 +434,276 @@ namespace pistis {
       }
       
     private:
-      LogMessageFactory& msgFactory_;
-      LogMessageReceiver& msgReceiver_;
-      const std::string& destination_;
+      LogMessageFactory* msgFactory_;
+      LogMessageReceiver* msgReceiver_;
+      LogDestination destination_;
       LogLevel logLevel_;
+      LogSourceLocation location_;
+      LogTimestamp timestamp_;
+      LogThreadInfo thread_;
       LogMessage* current_;
+      LogMessage* tail_;
+      size_t chainSize_;
+      uint64_t statementId_;
+      uint32_t partNumber_;
     };
 
+    /** @brief Stream buffer for wide log statements that writes them to
+     *         their LogMessage as UTF-8.
+     *
+     *  Wide characters are collected in a small buffer inside the
+     *  LogStreamBuffer and transcoded into the message with encodeUtf8()
+     *  whenever that buffer fills, the stream is flushed or reserve() is
+     *  called.  The message itself is managed by a LogMessageWriter, which
+     *  grows it as needed and, once it reaches its maximum capacity, sends
+     *  it and continues in a new one.  A character's encoding is never
+     *  split between messages.  Messages are marked as
+     *  LogMessageEncoding::UTF8.
+     */
+    template <typename TraitsT>
+    class LogStreamBuffer<wchar_t, TraitsT>
+        : public std::basic_streambuf<wchar_t, TraitsT> {
+    public:
+      LogStreamBuffer(LogMessageFactory& msgFactory,
+		      LogMessageReceiver& receiver,
+		      const LogDestination& destination,
+		      LogLevel logLevel,
+		      const LogSourceLocation& location= LogSourceLocation()):
+	  writer_(msgFactory, receiver, destination, logLevel,
+		  LogMessageEncoding::UTF8, location) {
+	resetStreamBufPtrs_(0);
+      }
+
+      LogStreamBuffer(const LogStreamBuffer&) = delete;
+
+      LogStreamBuffer(LogStreamBuffer&& other):
+	  std::basic_streambuf<wchar_t, TraitsT>(),
+	  writer_(std::move(other.writer_)) {
+	takeBuffered_(other);
+      }
+
+      virtual ~LogStreamBuffer() {
+	sync();
+      }
+
+      const std::string& destination() const { return writer_.destination(); }
+      const LogDestination& destinationHandle() const {
+	return writer_.destinationHandle();
+      }
+      LogLevel logLevel() const { return writer_.logLevel(); }
+      const LogTimestamp& timestamp() const { return writer_.timestamp(); }
+      const LogThreadInfo& thread() const { return writer_.thread(); }
+
+      /** @brief Add a structured field to the message in progress,
+       *         obtaining a message if there is none.
+       *
+       *  @see LogMessage::addField()
+       */
+      bool addField(const char* key, size_t keySize, const FormatArg& value) {
+	return writer_.addField(key, keySize, value);
+      }
+
+      /** @brief Returns a pointer to room for at least <tt>n</tt>
+       *         contiguous characters.
+       *
+       *  Makes sure the message in progress has room for the UTF-8
+       *  encoding of <tt>n</tt> ASCII characters as well, so ASCII text
+       *  written into the space, such as a formatted number, is not split
+       *  between messages.
+       *
+       *  @returns A pointer to the free space, or nullptr if <tt>n</tt>
+       *           characters are more than can be held at once
+       */
+      wchar_t* reserve(size_t n) {
+	transcode_();
+	const size_t nLeft= (size_t)(this->pptr() - this->pbase());
+	if ((n > (size_t)(this->epptr() - this->pptr())) ||
+	    !writer_.reserve(n + nLeft * MAX_UTF8_BYTES_PER_WCHAR)) {
+	  return nullptr;
+	}
+	return this->pptr();
+      }
+
+      /** @brief Append the characters written into the space returned by
+       *         reserve(), up to but not including <tt>newEnd</tt>.
+       */
+      void commit(wchar_t* newEnd) {
+	this->pbump((int)(newEnd - this->pptr()));
+      }
+
+      LogStreamBuffer& operator=(const LogStreamBuffer&)= delete;
+
+      /** @brief Send any message in progress to the receiver, then take
+       *         over the message in progress in <tt>other</tt>.
+       */
+      LogStreamBuffer& operator=(LogStreamBuffer&& other) {
+	if (this != &other) {
+	  sync();
+	  writer_ = std::move(other.writer_);
+	  takeBuffered_(other);
+	}
+	return *this;
+      }
+
+    protected:
+      virtual std::basic_streambuf<wchar_t, TraitsT>* setbuf(
+	  wchar_t* buffer, std::streamsize n
+      ) {
+	// Cannot use an external buffer, so attempts to do so are ignored
+	return this;
+      }
+
+      virtual typename TraitsT::pos_type seekoff(
+	  typename TraitsT::off_type off, std::ios_base::seekdir way,
+	  std::ios_base::openmode mode= std::ios_base::in|std::ios_base::out
+      ) {
+	return typename TraitsT::pos_type(this->pptr() - this->pbase());
+      }
+
+      virtual typename TraitsT::pos_type seekpos(
+	  typename TraitsT::pos_type pos,
+	  std::ios_base::openmode mode= std::ios_base::in|std::ios_base::out
+      ) {
+	return typename TraitsT::pos_type(this->pptr() - this->pbase());
+      }
+
+      virtual int sync() {
+	transcode_();
+	if (this->pptr() != this->pbase()) {
+	  // A high surrogate that never got its low surrogate
+	  writer_.write("\xEF\xBF\xBD", 3);
+	  resetStreamBufPtrs_(0);
+	}
+	writer_.flush();
+	return 0;
+      }
+
+      virtual std::streamsize showmanyc() {
+	return 0;
+      }
+
+      virtual std::streamsize xsgetn(wchar_t* p, std::streamsize n) {
+	// Cannot read from LogStreamBuffer
+	return 0;
+      }
+
+      virtual typename TraitsT::int_type underflow() {
+	return TraitsT::eof();
+      }
+
+      virtual typename TraitsT::int_type uflow() {
+	return TraitsT::eof();
+      }
+
+      virtual typename TraitsT::int_type pbackfail(
+	  typename TraitsT::int_type c= TraitsT::eof()
+      ) {
+	return TraitsT::eof();
+      }
+
+      virtual std::streamsize xsputn(const wchar_t* data, std::streamsize n) {
+	if (n <= this->epptr() - this->pptr()) {
+	  TraitsT::copy(this->pptr(), data, (size_t)n);
+	  this->pbump((int)n);
+	} else {
+	  // Transcode what is buffered, then the new text straight from
+	  // the caller, keeping only what cannot be transcoded yet
+	  transcode_();
+	  const wchar_t* const end= data + n;
+	  const wchar_t* p= data;
+	  if (this->pptr() != this->pbase()) {
+	    // Pair the buffered high surrogate with the new text
+	    *this->pptr() = *p++;
+	    this->pbump(1);
+	    transcode_();
+	  }
+	  if (this->pptr() == this->pbase()) {
+	    p= transcode_(p, end);
+	  }
+	  TraitsT::copy(this->pptr(), p, (size_t)(end - p));
+	  this->pbump((int)(end - p));
+	}
+	return n;
+      }
+
+      virtual typename TraitsT::int_type overflow(
+	  typename TraitsT::int_type c= TraitsT::eof()
+      ) {
+	transcode_();
+	if (!TraitsT::eq_int_type(c, TraitsT::eof())) {
+	  *this->pptr() = TraitsT::to_char_type(c);
+	  this->pbump(1);
+	}
+	return TraitsT::not_eof(c);
+      }
+
+    private:
+      /** @brief Number of characters buffered before being transcoded */
+      static constexpr size_t BUFFER_SIZE_= 2 * MAX_FORMATTED_NUMBER_SIZE;
+
+      LogMessageWriter writer_;
+      wchar_t buffer_[BUFFER_SIZE_];
+
+      /** @brief Transcode the buffered characters into the message */
+      void transcode_() {
+	const wchar_t* const end= this->pptr();
+	const wchar_t* const p= transcode_(this->pbase(), end);
+	// Only a lone high surrogate at the end can be left over
+	const size_t nLeft= (size_t)(end - p);
+	TraitsT::move(buffer_, p, nLeft);
+	resetStreamBufPtrs_(nLeft);
+      }
+
+      /** @brief Transcode the characters in <tt>[p, end)</tt> into the
+       *         message
+       *
+       *  @returns The end of the characters transcoded.  Anything after
+       *           it must wait for the characters that follow.
+       */
+      const wchar_t* transcode_(const wchar_t* p, const wchar_t* end) {
+	bool newMessage= false;
+	while (p != end) {
+	  const size_t n= (size_t)(end - p);
+	  size_t available;
+	  char* const out= writer_.reserveUpTo(
+	      std::max(n, MAX_UTF8_BYTES_PER_WCHAR), available
+	  );
+	  size_t nWritten;
+	  const size_t nRead= encodeUtf8(p, n, out, available, nWritten);
+	  if (nRead) {
+	    writer_.commit(out + nWritten);
+	    p += nRead;
+	    newMessage= false;
+	  } else if (available >= MAX_UTF8_BYTES_PER_WCHAR) {
+	    break;  // Waiting for the rest of a surrogate pair
+	  } else if (newMessage) {
+	    // Messages cannot hold even one character, so give up
+	    return end;
+	  } else {
+	    // Message is as large as it can get, so continue in a new one
+	    writer_.flushPart();
+	    newMessage= true;
+	  }
+	}
+	return p;
+      }
+
+      void takeBuffered_(LogStreamBuffer& other) {
+	const size_t n= (size_t)(other.pptr() - other.pbase());
+	TraitsT::copy(buffer_, other.buffer_, n);
+	resetStreamBufPtrs_(n);
+	other.resetStreamBufPtrs_(0);
+      }
+
+      void resetStreamBufPtrs_(size_t n) {
+	this->setp(buffer_, buffer_ + BUFFER_SIZE_);
+	this->pbump((int)n);
+      }
+    };
+
+    template <typename TraitsT>
+    constexpr size_t LogStreamBuffer<wchar_t, TraitsT>::BUFFER_SIZE_;
+
   }
 }
 
@@ -0,0 +1,83 @@
+#include "LogThreadInfo.hpp"
+#include <mutex>
+#include <unordered_set>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace pistis::logging;
+
+namespace {
+  /** @brief Longest name a thread can have, not counting the
+   *         terminating nul
+   */
+  const size_t MAX_THREAD_NAME_SIZE= 15;
+
+  /** @brief Every thread name seen so far.
+   *
+   *  Threads come and go, but messages naming them may still be waiting
+   *  to be received, so names are never freed.  Thread pools reuse the
+   *  same few names, so the set stays small.
+   */
+  class ThreadNameTable {
+  public:
+    ThreadNameTable(): sync_(), names_() { }
+
+    const std::string& intern(const std::string& name) {
+      std::unique_lock<std::mutex> lock(sync_);
+      return *names_.insert(name).first;
+    }
+
+  private:
+    std::mutex sync_;
+    std::unordered_set<std::string> names_;
+  };
+
+  ThreadNameTable& threadNames() {
+    static ThreadNameTable* table= new ThreadNameTable();
+    return *table;
+  }
+
+  std::string currentThreadName() {
+    char name[MAX_THREAD_NAME_SIZE + 1];
+    if (pthread_getname_np(pthread_self(), name, sizeof(name))) {
+      return std::string();
+    }
+    return std::string(name);
+  }
+
+  LogThreadInfo readCurrentThread() {
+    return LogThreadInfo((uint32_t)syscall(SYS_gettid), currentThreadName());
+  }
+
+  LogThreadInfo& cachedThreadInfo() {
+    static thread_local LogThreadInfo info= readCurrentThread();
+    return info;
+  }
+}
+
+LogThreadInfo::LogThreadInfo(uint32_t id, const std::string& name):
+    id_(id),
+    name_(name.empty() ? &emptyName_() : &threadNames().intern(name)) {
+  // Intentionally left blank
+}
+
+const LogThreadInfo& LogThreadInfo::current() {
+  return cachedThreadInfo();
+}
+
+void LogThreadInfo::refreshCurrent() {
+  cachedThreadInfo()= readCurrentThread();
+}
+
+void LogThreadInfo::setCurrentName(const std::string& name) {
+  const std::string truncated= name.substr(0, MAX_THREAD_NAME_SIZE);
+  pthread_setname_np(pthread_self(), truncated.c_str());
+  LogThreadInfo& info= cachedThreadInfo();
+  info= LogThreadInfo(info.id(), truncated);
+}
+
+const std::string& LogThreadInfo::emptyName_() {
+  static const std::string* name= new std::string();
+  return *name;
+}
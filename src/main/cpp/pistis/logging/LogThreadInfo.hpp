@@ -0,0 +1,88 @@
+#ifndef __PISTIS__LOGGING__LOGTHREADINFO_HPP__
+#define __PISTIS__LOGGING__LOGTHREADINFO_HPP__
+
+#include <ostream>
+#include <string>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Identifies the thread that wrote a log message.
+     *
+     *  Holds the thread's kernel id and a pointer to an interned copy of
+     *  its name, so it can be copied into every message for the price of
+     *  two words.  Each thread looks up its id and name the first time it
+     *  calls current() and keeps them in thread-local storage, so writing
+     *  a message makes no system calls.
+     */
+    class LogThreadInfo {
+    public:
+      /** @brief Create an unknown thread, with id 0 and no name */
+      LogThreadInfo(): id_(0), name_(&emptyName_()) { }
+
+      /** @brief Create a thread with the given id and name, interning
+       *         the name
+       */
+      LogThreadInfo(uint32_t id, const std::string& name);
+
+      /** @brief Returns true if the id is known */
+      bool known() const { return id_ != 0; }
+
+      /** @brief The thread's id, as returned by gettid() */
+      uint32_t id() const { return id_; }
+
+      /** @brief The thread's name, or an empty string if it has none */
+      const std::string& name() const { return *name_; }
+
+      /** @brief The calling thread's id and name.
+       *
+       *  Read from the system the first time a thread calls this method.
+       *  Later changes to the thread's name made through
+       *  pthread_setname_np() are not seen unless the thread calls
+       *  refreshCurrent(); setCurrentName() keeps both up to date.
+       */
+      static const LogThreadInfo& current();
+
+      /** @brief Read the calling thread's name again */
+      static void refreshCurrent();
+
+      /** @brief Change the name of the calling thread, both in the
+       *         system and in the cached value returned by current().
+       *
+       *  The system limits names to 15 characters and truncates longer
+       *  ones; the cached name is truncated the same way.
+       */
+      static void setCurrentName(const std::string& name);
+
+    private:
+      uint32_t id_;
+      const std::string* name_;
+
+      static const std::string& emptyName_();
+    };
+
+    inline bool operator==(const LogThreadInfo& left,
+			   const LogThreadInfo& right) {
+      return (left.id() == right.id()) && (&left.name() == &right.name());
+    }
+
+    inline bool operator!=(const LogThreadInfo& left,
+			   const LogThreadInfo& right) {
+      return !(left == right);
+    }
+
+    /** @brief Writes "<name>:<id>", or just the id if the thread has no
+     *         name
+     */
+    inline std::ostream& operator<<(std::ostream& out,
+				    const LogThreadInfo& thread) {
+      if (!thread.name().empty()) {
+	out << thread.name() << ':';
+      }
+      return out << thread.id();
+    }
+
+  }
+}
+#endif
@@ -0,0 +1,154 @@
+#ifndef __PISTIS__LOGGING__LOGTHROTTLE_HPP__
+#define __PISTIS__LOGGING__LOGTHROTTLE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Lets only the first <tt>n</tt> executions of a log statement
+     *         through.
+     *
+     *  Like the other throttles, a FirstNLogThrottle is meant to have
+     *  static storage duration, one per statement, as the
+     *  PISTIS_LOG_FIRST_N macro creates it.  Its constructor is
+     *  constexpr, so such a throttle is initialized before the program
+     *  starts and needs no guard.  Once the limit is reached, allow()
+     *  only reads the counter, so a statement that fires constantly does
+     *  not make threads contend for it.
+     */
+    class FirstNLogThrottle {
+    public:
+      constexpr explicit FirstNLogThrottle(uint64_t n): n_(n), count_(0) { }
+      FirstNLogThrottle(const FirstNLogThrottle&)= delete;
+
+      /** @brief Returns true if the statement should be logged
+       *
+       *  @param suppressed  Set to the number of executions suppressed
+       *                       since the last one allowed, which is always
+       *                       zero for this throttle
+       */
+      bool allow(uint64_t& suppressed) {
+	suppressed= 0;
+	return (count_.load(std::memory_order_relaxed) < n_) &&
+	       (count_.fetch_add(1, std::memory_order_relaxed) < n_);
+      }
+
+      FirstNLogThrottle& operator=(const FirstNLogThrottle&)= delete;
+
+    private:
+      const uint64_t n_;
+      std::atomic<uint64_t> count_;
+    };
+
+    /** @brief Lets the first and then every <tt>n</tt>th execution of a
+     *         log statement through.
+     *
+     *  A single atomic counter decides which executions are allowed, and
+     *  the number suppressed between two allowed executions is always
+     *  <tt>n - 1</tt>.
+     */
+    class EveryNLogThrottle {
+    public:
+      constexpr explicit EveryNLogThrottle(uint64_t n):
+	  n_(n ? n : 1), count_(0) {
+	// Intentionally left blank
+      }
+      EveryNLogThrottle(const EveryNLogThrottle&)= delete;
+
+      /** @brief Returns true if the statement should be logged
+       *
+       *  @param suppressed  Set to the number of executions suppressed
+       *                       since the last one allowed
+       */
+      bool allow(uint64_t& suppressed) {
+	const uint64_t c= count_.fetch_add(1, std::memory_order_relaxed);
+	if (c % n_) {
+	  return false;
+	}
+	suppressed= c ? (n_ - 1) : 0;
+	return true;
+      }
+
+      EveryNLogThrottle& operator=(const EveryNLogThrottle&)= delete;
+
+    private:
+      const uint64_t n_;
+      std::atomic<uint64_t> count_;
+    };
+
+    /** @brief Lets at most <tt>n</tt> executions of a log statement
+     *         through each second.
+     *
+     *  Seconds are counted on std::chrono::steady_clock.  The current
+     *  second and the number of executions allowed in it share one
+     *  atomic word, so a single compare-and-swap starts a new second or
+     *  counts an execution.  Executions over the limit only read that
+     *  word and count themselves in a second atomic, which is reset when
+     *  the next execution is allowed.  Limits above MAX_PER_SECOND are
+     *  reduced to it.
+     */
+    class RateLimitLogThrottle {
+    public:
+      static constexpr uint64_t MAX_PER_SECOND= (1 << 24) - 1;
+
+      constexpr explicit RateLimitLogThrottle(uint64_t n):
+	  n_((n < MAX_PER_SECOND) ? n : (uint64_t)MAX_PER_SECOND), state_(0),
+	  suppressed_(0) {
+	// Intentionally left blank
+      }
+      RateLimitLogThrottle(const RateLimitLogThrottle&)= delete;
+
+      /** @brief Returns true if the statement should be logged
+       *
+       *  @param suppressed  Set to the number of executions suppressed
+       *                       since the last one allowed
+       */
+      bool allow(uint64_t& suppressed) {
+	return allow(
+	    suppressed,
+	    (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(
+	        std::chrono::steady_clock::now().time_since_epoch()
+	    ).count()
+	);
+      }
+
+      /** @brief Returns true if the statement should be logged, taking
+       *         the current second to be <tt>second</tt>.
+       */
+      bool allow(uint64_t& suppressed, uint64_t second) {
+	// Second 0 is reserved for the initial state, so a statement that
+	// first fires during it still starts a new window
+	const uint64_t window= (second + 1) << COUNT_BITS_;
+	uint64_t current= state_.load(std::memory_order_relaxed);
+	uint64_t next;
+	do {
+	  const uint64_t count= ((current & ~COUNT_MASK_) == window)
+	                            ? (current & COUNT_MASK_) : 0;
+	  if (count >= n_) {
+	    suppressed_.fetch_add(1, std::memory_order_relaxed);
+	    return false;
+	  }
+	  next= window | (count + 1);
+	} while (!state_.compare_exchange_weak(current, next,
+					       std::memory_order_relaxed));
+	suppressed= suppressed_.exchange(0, std::memory_order_relaxed);
+	return true;
+      }
+
+      RateLimitLogThrottle& operator=(const RateLimitLogThrottle&)= delete;
+
+    private:
+      static constexpr int COUNT_BITS_= 24;
+      static constexpr uint64_t COUNT_MASK_= MAX_PER_SECOND;
+
+      const uint64_t n_;
+      std::atomic<uint64_t> state_;
+      std::atomic<uint64_t> suppressed_;
+    };
+
+  }
+}
+#endif
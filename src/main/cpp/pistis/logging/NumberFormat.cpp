@@ -0,0 +1,994 @@
+#include "NumberFormat.hpp"
+#include <algorithm>
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace pistis::logging;
+
+const char pistis::logging::DIGIT_PAIRS[200]= {
+  '0','0', '0','1', '0','2', '0','3', '0','4',
+  '0','5', '0','6', '0','7', '0','8', '0','9',
+  '1','0', '1','1', '1','2', '1','3', '1','4',
+  '1','5', '1','6', '1','7', '1','8', '1','9',
+  '2','0', '2','1', '2','2', '2','3', '2','4',
+  '2','5', '2','6', '2','7', '2','8', '2','9',
+  '3','0', '3','1', '3','2', '3','3', '3','4',
+  '3','5', '3','6', '3','7', '3','8', '3','9',
+  '4','0', '4','1', '4','2', '4','3', '4','4',
+  '4','5', '4','6', '4','7', '4','8', '4','9',
+  '5','0', '5','1', '5','2', '5','3', '5','4',
+  '5','5', '5','6', '5','7', '5','8', '5','9',
+  '6','0', '6','1', '6','2', '6','3', '6','4',
+  '6','5', '6','6', '6','7', '6','8', '6','9',
+  '7','0', '7','1', '7','2', '7','3', '7','4',
+  '7','5', '7','6', '7','7', '7','8', '7','9',
+  '8','0', '8','1', '8','2', '8','3', '8','4',
+  '8','5', '8','6', '8','7', '8','8', '8','9',
+  '9','0', '9','1', '9','2', '9','3', '9','4',
+  '9','5', '9','6', '9','7', '9','8', '9','9'
+};
+
+namespace {
+  /** @brief The "C" locale, never freed */
+  locale_t classicLocale() {
+    static locale_t locale= newlocale(LC_ALL_MASK, "C", (locale_t)0);
+    return locale;
+  }
+
+  char* writePrintf(char* out, double v, int precision) {
+    // snprintf follows LC_NUMERIC, which a program may set to write a
+    // comma for the decimal point.  std::ostream uses the classic
+    // locale whatever setlocale() says, so this does too, switching
+    // only the calling thread's locale.
+    const locale_t previous= uselocale(classicLocale());
+    int n= snprintf(out, MAX_FORMATTED_NUMBER_SIZE, "%.*g", precision, v);
+    uselocale(previous);
+    return out + ((n < 0) ? 0
+		          : std::min((size_t)n, MAX_FORMATTED_NUMBER_SIZE - 1));
+  }
+
+  /*
+   * The tables and functions from here through shortestDecimal() are
+   * derived from Ryu, https://github.com/ulfjack/ryu:
+   *
+   * Copyright 2018 Ulf Adams
+   *
+   * The contents of this file may be used under the terms of the Apache
+   * License, Version 2.0.
+   *
+   *    (See LICENSE at the top of this repository or copy at
+   *     http://www.apache.org/licenses/LICENSE-2.0)
+   *
+   * Alternatively, the contents of this file may be used under the terms
+   * of the Boost Software License, Version 1.0.
+   *    (See a copy at https://www.boost.org/LICENSE_1_0.txt)
+   *
+   * Unless required by applicable law or agreed to in writing, this
+   * software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   * CONDITIONS OF ANY KIND, either express or implied.
+   */
+
+  /** @brief Bits kept of each power of five in the tables below */
+  const int32_t POW5_BITS= 125;
+
+  /** @brief 5^i, shifted to leave its top POW5_BITS bits, as
+   *         { low word, high word }
+   */
+  const uint64_t POW5_SPLIT[326][2]= {
+    { 0x0000000000000000, 0x1000000000000000 },
+    { 0x0000000000000000, 0x1400000000000000 },
+    { 0x0000000000000000, 0x1900000000000000 },
+    { 0x0000000000000000, 0x1F40000000000000 },
+    { 0x0000000000000000, 0x1388000000000000 },
+    { 0x0000000000000000, 0x186A000000000000 },
+    { 0x0000000000000000, 0x1E84800000000000 },
+    { 0x0000000000000000, 0x1312D00000000000 },
+    { 0x0000000000000000, 0x17D7840000000000 },
+    { 0x0000000000000000, 0x1DCD650000000000 },
+    { 0x0000000000000000, 0x12A05F2000000000 },
+    { 0x0000000000000000, 0x174876E800000000 },
+    { 0x0000000000000000, 0x1D1A94A200000000 },
+    { 0x0000000000000000, 0x12309CE540000000 },
+    { 0x0000000000000000, 0x16BCC41E90000000 },
+    { 0x0000000000000000, 0x1C6BF52634000000 },
+    { 0x0000000000000000, 0x11C37937E0800000 },
+    { 0x0000000000000000, 0x16345785D8A00000 },
+    { 0x0000000000000000, 0x1BC16D674EC80000 },
+    { 0x0000000000000000, 0x1158E460913D0000 },
+    { 0x0000000000000000, 0x15AF1D78B58C4000 },
+    { 0x0000000000000000, 0x1B1AE4D6E2EF5000 },
+    { 0x0000000000000000, 0x10F0CF064DD59200 },
+    { 0x0000000000000000, 0x152D02C7E14AF680 },
+    { 0x0000000000000000, 0x1A784379D99DB420 },
+    { 0x0000000000000000, 0x108B2A2C28029094 },
+    { 0x0000000000000000, 0x14ADF4B7320334B9 },
+    { 0x4000000000000000, 0x19D971E4FE8401E7 },
+    { 0x8800000000000000, 0x1027E72F1F128130 },
+    { 0xAA00000000000000, 0x1431E0FAE6D7217C },
+    { 0xD480000000000000, 0x193E5939A08CE9DB },
+    { 0xC9A0000000000000, 0x1F8DEF8808B02452 },
+    { 0xBE04000000000000, 0x13B8B5B5056E16B3 },
+    { 0xAD85000000000000, 0x18A6E32246C99C60 },
+    { 0xD8E6400000000000, 0x1ED09BEAD87C0378 },
+    { 0x878FE80000000000, 0x13426172C74D822B },
+    { 0x6973E20000000000, 0x1812F9CF7920E2B6 },
+    { 0x03D0DA8000000000, 0x1E17B84357691B64 },
+    { 0x8262889000000000, 0x12CED32A16A1B11E },
+    { 0x22FB2AB400000000, 0x178287F49C4A1D66 },
+    { 0xABB9F56100000000, 0x1D6329F1C35CA4BF },
+    { 0xCB54395CA0000000, 0x125DFA371A19E6F7 },
+    { 0xBE2947B3C8000000, 0x16F578C4E0A060B5 },
+    { 0x2DB399A0BA000000, 0x1CB2D6F618C878E3 },
+    { 0xFC90400474400000, 0x11EFC659CF7D4B8D },
+    { 0x7BB4500591500000, 0x166BB7F0435C9E71 },
+    { 0xDAA16406F5A40000, 0x1C06A5EC5433C60D },
+    { 0xA8A4DE8459868000, 0x118427B3B4A05BC8 },
+    { 0xD2CE16256FE82000, 0x15E531A0A1C872BA },
+    { 0x87819BAECBE22800, 0x1B5E7E08CA3A8F69 },
+    { 0xF4B1014D3F6D5900, 0x111B0EC57E6499A1 },
+    { 0x71DD41A08F48AF40, 0x1561D276DDFDC00A },
+    { 0x0E549208B31ADB10, 0x1ABA4714957D300D },
+    { 0x28F4DB456FF0C8EA, 0x10B46C6CDD6E3E08 },
+    { 0x33321216CBECFB24, 0x14E1878814C9CD8A },
+    { 0xBFFE969C7EE839ED, 0x1A19E96A19FC40EC },
+    { 0xF7FF1E21CF512434, 0x105031E2503DA893 },
+    { 0xF5FEE5AA43256D41, 0x14643E5AE44D12B8 },
+    { 0x337E9F14D3EEC892, 0x197D4DF19D605767 },
+    { 0x005E46DA08EA7AB6, 0x1FDCA16E04B86D41 },
+    { 0xA03AEC4845928CB2, 0x13E9E4E4C2F34448 },
+    { 0xC849A75A56F72FDE, 0x18E45E1DF3B0155A },
+    { 0x7A5C1130ECB4FBD6, 0x1F1D75A5709C1AB1 },
+    { 0xEC798ABE93F11D65, 0x13726987666190AE },
+    { 0xA797ED6E38ED64BF, 0x184F03E93FF9F4DA },
+    { 0x517DE8C9C728BDEF, 0x1E62C4E38FF87211 },
+    { 0xD2EEB17E1C7976B5, 0x12FDBB0E39FB474A },
+    { 0x87AA5DDDA397D462, 0x17BD29D1C87A191D },
+    { 0xE994F5550C7DC97B, 0x1DAC74463A989F64 },
+    { 0x11FD195527CE9DED, 0x128BC8ABE49F639F },
+    { 0xD67C5FAA71C24568, 0x172EBAD6DDC73C86 },
+    { 0x8C1B77950E32D6C2, 0x1CFA698C95390BA8 },
+    { 0x57912ABD28DFC639, 0x121C81F7DD43A749 },
+    { 0xAD75756C7317B7C8, 0x16A3A275D494911B },
+    { 0x98D2D2C78FDDA5BA, 0x1C4C8B1349B9B562 },
+    { 0x9F83C3BCB9EA8794, 0x11AFD6EC0E14115D },
+    { 0x0764B4ABE8652979, 0x161BCCA7119915B5 },
+    { 0x493DE1D6E27E73D7, 0x1BA2BFD0D5FF5B22 },
+    { 0x6DC6AD264D8F0866, 0x1145B7E285BF98F5 },
+    { 0xC938586FE0F2CA80, 0x159725DB272F7F32 },
+    { 0x7B866E8BD92F7D20, 0x1AFCEF51F0FB5EFF },
+    { 0xAD34051767BDAE34, 0x10DE1593369D1B5F },
+    { 0x9881065D41AD19C1, 0x15159AF804446237 },
+    { 0x7EA147F492186032, 0x1A5B01B605557AC5 },
+    { 0x6F24CCF8DB4F3C1F, 0x1078E111C3556CBB },
+    { 0x4AEE003712230B27, 0x14971956342AC7EA },
+    { 0xDDA98044D6ABCDF0, 0x19BCDFABC13579E4 },
+    { 0x0A89F02B062B60B6, 0x10160BCB58C16C2F },
+    { 0xCD2C6C35C7B638E4, 0x141B8EBE2EF1C73A },
+    { 0x8077874339A3C71D, 0x1922726DBAAE3909 },
+    { 0xE0956914080CB8E4, 0x1F6B0F092959C74B },
+    { 0x6C5D61AC8507F38E, 0x13A2E965B9D81C8F },
+    { 0x4774BA17A649F072, 0x188BA3BF284E23B3 },
+    { 0x1951E89D8FDC6C8F, 0x1EAE8CAEF261ACA0 },
+    { 0x0FD3316279E9C3D9, 0x132D17ED577D0BE4 },
+    { 0x13C7FDBB186434CF, 0x17F85DE8AD5C4EDD },
+    { 0x58B9FD29DE7D4203, 0x1DF67562D8B36294 },
+    { 0xB7743E3A2B0E4942, 0x12BA095DC7701D9C },
+    { 0xE5514DC8B5D1DB92, 0x17688BB5394C2503 },
+    { 0xDEA5A13AE3465277, 0x1D42AEA2879F2E44 },
+    { 0x0B2784C4CE0BF38A, 0x1249AD2594C37CEB },
+    { 0xCDF165F6018EF06D, 0x16DC186EF9F45C25 },
+    { 0x416DBF7381F2AC88, 0x1C931E8AB871732F },
+    { 0x88E497A83137ABD5, 0x11DBF316B346E7FD },
+    { 0xEB1DBD923D8596CA, 0x1652EFDC6018A1FC },
+    { 0x25E52CF6CCE6FC7D, 0x1BE7ABD3781ECA7C },
+    { 0x97AF3C1A40105DCE, 0x1170CB642B133E8D },
+    { 0xFD9B0B20D0147542, 0x15CCFE3D35D80E30 },
+    { 0x3D01CDE904199292, 0x1B403DCC834E11BD },
+    { 0x462120B1A28FFB9B, 0x1108269FD210CB16 },
+    { 0xD7A968DE0B33FA82, 0x154A3047C694FDDB },
+    { 0xCD93C3158E00F923, 0x1A9CBC59B83A3D52 },
+    { 0xC07C59ED78C09BB6, 0x10A1F5B813246653 },
+    { 0xB09B7068D6F0C2A3, 0x14CA732617ED7FE8 },
+    { 0xDCC24C830CACF34C, 0x19FD0FEF9DE8DFE2 },
+    { 0xC9F96FD1E7EC180F, 0x103E29F5C2B18BED },
+    { 0x3C77CBC661E71E13, 0x144DB473335DEEE9 },
+    { 0x8B95BEB7FA60E598, 0x1961219000356AA3 },
+    { 0x6E7B2E65F8F91EFE, 0x1FB969F40042C54C },
+    { 0xC50CFCFFBB9BB35F, 0x13D3E2388029BB4F },
+    { 0xB6503C3FAA82A037, 0x18C8DAC6A0342A23 },
+    { 0xA3E44B4F95234844, 0x1EFB1178484134AC },
+    { 0xE66EAF11BD360D2B, 0x135CEAEB2D28C0EB },
+    { 0xE00A5AD62C839075, 0x183425A5F872F126 },
+    { 0x980CF18BB7A47493, 0x1E412F0F768FAD70 },
+    { 0x5F0816F752C6C8DC, 0x12E8BD69AA19CC66 },
+    { 0xF6CA1CB527787B13, 0x17A2ECC414A03F7F },
+    { 0xF47CA3E2715699D7, 0x1D8BA7F519C84F5F },
+    { 0xF8CDE66D86D62026, 0x127748F9301D319B },
+    { 0xF7016008E88BA830, 0x17151B377C247E02 },
+    { 0xB4C1B80B22AE923C, 0x1CDA62055B2D9D83 },
+    { 0x50F91306F5AD1B65, 0x12087D4358FC8272 },
+    { 0xE53757C8B318623F, 0x168A9C942F3BA30E },
+    { 0x9E852DBADFDE7ACF, 0x1C2D43B93B0A8BD2 },
+    { 0xA3133C94CBEB0CC1, 0x119C4A53C4E69763 },
+    { 0x8BD80BB9FEE5CFF1, 0x16035CE8B6203D3C },
+    { 0xAECE0EA87E9F43EE, 0x1B843422E3A84C8B },
+    { 0x4D40C9294F238A75, 0x1132A095CE492FD7 },
+    { 0x2090FB73A2EC6D12, 0x157F48BB41DB7BCD },
+    { 0x68B53A508BA78856, 0x1ADF1AEA12525AC0 },
+    { 0x417144725748B536, 0x10CB70D24B7378B8 },
+    { 0x51CD958EED1AE283, 0x14FE4D06DE5056E6 },
+    { 0xE640FAF2A8619B24, 0x1A3DE04895E46C9F },
+    { 0xEFE89CD7A93D00F7, 0x1066AC2D5DAEC3E3 },
+    { 0xEBE2C40D938C4134, 0x14805738B51A74DC },
+    { 0x26DB7510F86F5181, 0x19A06D06E2611214 },
+    { 0x9849292A9B4592F1, 0x100444244D7CAB4C },
+    { 0xBE5B73754216F7AD, 0x1405552D60DBD61F },
+    { 0xADF25052929CB598, 0x1906AA78B912CBA7 },
+    { 0x996EE4673743E2FF, 0x1F485516E7577E91 },
+    { 0xFFE54EC0828A6DDF, 0x138D352E5096AF1A },
+    { 0xBFDEA270A32D0957, 0x18708279E4BC5AE1 },
+    { 0x2FD64B0CCBF84BAD, 0x1E8CA3185DEB719A },
+    { 0x5DE5EEE7FF7B2F4C, 0x1317E5EF3AB32700 },
+    { 0x755F6AA1FF59FB1F, 0x17DDDF6B095FF0C0 },
+    { 0x92B7454A7F3079E7, 0x1DD55745CBB7ECF0 },
+    { 0x5BB28B4E8F7E4C30, 0x12A5568B9F52F416 },
+    { 0xF29F2E22335DDF3C, 0x174EAC2E8727B11B },
+    { 0xEF46F9AAC035570B, 0x1D22573A28F19D62 },
+    { 0xD58C5C0AB8215667, 0x123576845997025D },
+    { 0x4AEF730D6629AC01, 0x16C2D4256FFCC2F5 },
+    { 0x9DAB4FD0BFB41701, 0x1C73892ECBFBF3B2 },
+    { 0xA28B11E277D08E60, 0x11C835BD3F7D784F },
+    { 0x8B2DD65B15C4B1F9, 0x163A432C8F5CD663 },
+    { 0x6DF94BF1DB35DE77, 0x1BC8D3F7B3340BFC },
+    { 0xC4BBCF772901AB0A, 0x115D847AD000877D },
+    { 0x35EAC354F34215CD, 0x15B4E5998400A95D },
+    { 0x8365742A30129B40, 0x1B221EFFE500D3B4 },
+    { 0xD21F689A5E0BA108, 0x10F5535FEF208450 },
+    { 0x06A742C0F58E894A, 0x1532A837EAE8A565 },
+    { 0x4851137132F22B9D, 0x1A7F5245E5A2CEBE },
+    { 0xED32AC26BFD75B42, 0x108F936BAF85C136 },
+    { 0xA87F57306FCD3212, 0x14B378469B673184 },
+    { 0xD29F2CFC8BC07E97, 0x19E056584240FDE5 },
+    { 0xA3A37C1DD7584F1E, 0x102C35F729689EAF },
+    { 0x8C8C5B254D2E62E6, 0x14374374F3C2C65B },
+    { 0x6FAF71EEA079FB9F, 0x1945145230B377F2 },
+    { 0x0B9B4E6A48987A87, 0x1F965966BCE055EF },
+    { 0x674111026D5F4C94, 0x13BDF7E0360C35B5 },
+    { 0xC111554308B71FBA, 0x18AD75D8438F4322 },
+    { 0x7155AA93CAE4E7A8, 0x1ED8D34E547313EB },
+    { 0x26D58A9C5ECF10C9, 0x13478410F4C7EC73 },
+    { 0xF08AED437682D4FB, 0x1819651531F9E78F },
+    { 0xECADA89454238A3A, 0x1E1FBE5A7E786173 },
+    { 0x73EC895CB4963664, 0x12D3D6F88F0B3CE8 },
+    { 0x90E7ABB3E1BBC3FD, 0x1788CCB6B2CE0C22 },
+    { 0x352196A0DA2AB4FD, 0x1D6AFFE45F818F2B },
+    { 0x0134FE24885AB11E, 0x1262DFEEBBB0F97B },
+    { 0xC1823DADAA715D65, 0x16FB97EA6A9D37D9 },
+    { 0x31E2CD19150DB4BF, 0x1CBA7DE5054485D0 },
+    { 0x1F2DC02FAD2890F7, 0x11F48EAF234AD3A2 },
+    { 0xA6F9303B9872B535, 0x1671B25AEC1D888A },
+    { 0x50B77C4A7E8F6282, 0x1C0E1EF1A724EAAD },
+    { 0x5272ADAE8F199D91, 0x1188D357087712AC },
+    { 0x670F591A32E004F6, 0x15EB082CCA94D757 },
+    { 0x40D32F60BF980633, 0x1B65CA37FD3A0D2D },
+    { 0x4883FD9C77BF03E0, 0x111F9E62FE44483C },
+    { 0x5AA4FD0395AEC4D8, 0x156785FBBDD55A4B },
+    { 0x314E3C447B1A760E, 0x1AC1677AAD4AB0DE },
+    { 0xDED0E5AACCF089C9, 0x10B8E0ACAC4EAE8A },
+    { 0x96851F15802CAC3B, 0x14E718D7D7625A2D },
+    { 0xFC2666DAE037D74A, 0x1A20DF0DCD3AF0B8 },
+    { 0x9D980048CC22E68E, 0x10548B68A044D673 },
+    { 0x84FE005AFF2BA032, 0x1469AE42C8560C10 },
+    { 0xA63D8071BEF6883E, 0x198419D37A6B8F14 },
+    { 0xCFCCE08E2EB42A4E, 0x1FE52048590672D9 },
+    { 0x21E00C58DD309A70, 0x13EF342D37A407C8 },
+    { 0x2A580F6F147CC10D, 0x18EB0138858D09BA },
+    { 0xB4EE134AD99BF150, 0x1F25C186A6F04C28 },
+    { 0x7114CC0EC80176D2, 0x137798F428562F99 },
+    { 0xCD59FF127A01D486, 0x18557F31326BBB7F },
+    { 0xC0B07ED7188249A8, 0x1E6ADEFD7F06AA5F },
+    { 0xD86E4F466F516E09, 0x1302CB5E6F642A7B },
+    { 0xCE89E3180B25C98B, 0x17C37E360B3D351A },
+    { 0x822C5BDE0DEF3BEE, 0x1DB45DC38E0C8261 },
+    { 0xF15BB96AC8B58575, 0x1290BA9A38C7D17C },
+    { 0x2DB2A7C57AE2E6D2, 0x1734E940C6F9C5DC },
+    { 0x391F51B6D99BA086, 0x1D022390F8B83753 },
+    { 0x03B3931248014454, 0x1221563A9B732294 },
+    { 0x04A077D6DA019569, 0x16A9ABC9424FEB39 },
+    { 0x45C895CC9081FAC3, 0x1C5416BB92E3E607 },
+    { 0x8B9D5D9FDA513CBA, 0x11B48E353BCE6FC4 },
+    { 0xAE84B507D0E58BE8, 0x1621B1C28AC20BB5 },
+    { 0x1A25E249C51EEEE3, 0x1BAA1E332D728EA3 },
+    { 0xF057AD6E1B33554D, 0x114A52DFFC679925 },
+    { 0x6C6D98C9A2002AA1, 0x159CE797FB817F6F },
+    { 0x4788FEFC0A803549, 0x1B04217DFA61DF4B },
+    { 0x0CB59F5D8690214E, 0x10E294EEBC7D2B8F },
+    { 0xCFE30734E83429A1, 0x151B3A2A6B9C7672 },
+    { 0x83DBC9022241340A, 0x1A6208B50683940F },
+    { 0xB2695DA15568C086, 0x107D457124123C89 },
+    { 0x1F03B509AAC2F0A7, 0x149C96CD6D16CBAC },
+    { 0x26C4A24C1573ACD1, 0x19C3BC80C85C7E97 },
+    { 0x783AE56F8D684C03, 0x101A55D07D39CF1E },
+    { 0x16499ECB70C25F03, 0x1420EB449C8842E6 },
+    { 0x9BDC067E4CF2F6C4, 0x19292615C3AA539F },
+    { 0x82D3081DE02FB476, 0x1F736F9B3494E887 },
+    { 0xB1C3E512AC1DD0C9, 0x13A825C100DD1154 },
+    { 0xDE34DE57572544FC, 0x18922F31411455A9 },
+    { 0x55C215ED2CEE963B, 0x1EB6BAFD91596B14 },
+    { 0xB5994DB43C151DE5, 0x133234DE7AD7E2EC },
+    { 0xE2FFA1214B1A655E, 0x17FEC216198DDBA7 },
+    { 0xDBBF89699DE0FEB6, 0x1DFE729B9FF15291 },
+    { 0x2957B5E202AC9F31, 0x12BF07A143F6D39B },
+    { 0xF3ADA35A8357C6FE, 0x176EC98994F48881 },
+    { 0x70990C31242DB8BD, 0x1D4A7BEBFA31AAA2 },
+    { 0x865FA79EB69C9376, 0x124E8D737C5F0AA5 },
+    { 0xE7F791866443B854, 0x16E230D05B76CD4E },
+    { 0xA1F575E7FD54A669, 0x1C9ABD04725480A2 },
+    { 0xA53969B0FE54E801, 0x11E0B622C774D065 },
+    { 0x0E87C41D3DEA2202, 0x1658E3AB7952047F },
+    { 0xD229B5248D64AA82, 0x1BEF1C9657A6859E },
+    { 0x435A1136D85EEA91, 0x117571DDF6C81383 },
+    { 0x143095848E76A536, 0x15D2CE55747A1864 },
+    { 0x193CBAE5B2144E83, 0x1B4781EAD1989E7D },
+    { 0x2FC5F4CF8F4CB112, 0x110CB132C2FF630E },
+    { 0xBBB77203731FDD56, 0x154FDD7F73BF3BD1 },
+    { 0x2AA54E844FE7D4AC, 0x1AA3D4DF50AF0AC6 },
+    { 0xDAA75112B1F0E4EB, 0x10A6650B926D66BB },
+    { 0xD15125575E6D1E26, 0x14CFFE4E7708C06A },
+    { 0x85A56EAD360865B0, 0x1A03FDE214CAF085 },
+    { 0x7387652C41C53F8E, 0x10427EAD4CFED653 },
+    { 0x50693E7752368F71, 0x14531E58A03E8BE8 },
+    { 0x64838E1526C4334E, 0x1967E5EEC84E2EE2 },
+    { 0xFDA4719A70754022, 0x1FC1DF6A7A61BA9A },
+    { 0xDE86C70086494815, 0x13D92BA28C7D14A0 },
+    { 0x162878C0A7DB9A1A, 0x18CF768B2F9C59C9 },
+    { 0x5BB296F0D1D280A1, 0x1F03542DFB83703B },
+    { 0x194F9E5683239064, 0x1362149CBD322625 },
+    { 0x5FA385EC23EC747E, 0x183A99C3EC7EAFAE },
+    { 0xF78C67672CE7919D, 0x1E494034E79E5B99 },
+    { 0x3AB7C0A07C10BB02, 0x12EDC82110C2F940 },
+    { 0x4965B0C89B14E9C3, 0x17A93A2954F3B790 },
+    { 0x5BBF1CFAC1DA2433, 0x1D9388B3AA30A574 },
+    { 0xB957721CB92856A0, 0x127C35704A5E6768 },
+    { 0xE7AD4EA3E7726C48, 0x171B42CC5CF60142 },
+    { 0xA198A24CE14F075A, 0x1CE2137F74338193 },
+    { 0x44FF65700CD16498, 0x120D4C2FA8A030FC },
+    { 0x563F3ECC1005BDBE, 0x16909F3B92C83D3B },
+    { 0x2BCF0E7F14072D2E, 0x1C34C70A777A4C8A },
+    { 0x5B61690F6C847C3D, 0x11A0FC668AAC6FD6 },
+    { 0xF239C35347A59B4C, 0x16093B802D578BCB },
+    { 0xEEC83428198F021F, 0x1B8B8A6038AD6EBE },
+    { 0x553D20990FF96153, 0x1137367C236C6537 },
+    { 0x2A8C68BF53F7B9A8, 0x1585041B2C477E85 },
+    { 0x752F82EF28F5A812, 0x1AE64521F7595E26 },
+    { 0x093DB1D57999890B, 0x10CFEB353A97DAD8 },
+    { 0x0B8D1E4AD7FFEB4E, 0x1503E602893DD18E },
+    { 0x8E7065DD8DFFE622, 0x1A44DF832B8D45F1 },
+    { 0xF9063FAA78BFEFD5, 0x106B0BB1FB384BB6 },
+    { 0xB747CF9516EFEBCA, 0x1485CE9E7A065EA4 },
+    { 0xE519C37A5CABE6BD, 0x19A742461887F64D },
+    { 0xAF301A2C79EB7036, 0x1008896BCF54F9F0 },
+    { 0xDAFC20B798664C43, 0x140AABC6C32A386C },
+    { 0x11BB28E57E7FDF54, 0x190D56B873F4C688 },
+    { 0x1629F31EDE1FD72A, 0x1F50AC6690F1F82A },
+    { 0x4DDA37F34AD3E67A, 0x13926BC01A973B1A },
+    { 0xE150C5F01D88E019, 0x187706B0213D09E0 },
+    { 0x19A4F76C24EB181F, 0x1E94C85C298C4C59 },
+    { 0xB0071AA39712EF13, 0x131CFD3999F7AFB7 },
+    { 0x9C08E14C7CD7AAD8, 0x17E43C8800759BA5 },
+    { 0x030B199F9C0D958E, 0x1DDD4BAA0093028F },
+    { 0x61E6F003C1887D79, 0x12AA4F4A405BE199 },
+    { 0xBA60AC04B1EA9CD7, 0x1754E31CD072D9FF },
+    { 0xA8F8D705DE65440D, 0x1D2A1BE4048F907F },
+    { 0xC99B8663AAFF4A88, 0x123A516E82D9BA4F },
+    { 0xBC0267FC95BF1D2A, 0x16C8E5CA239028E3 },
+    { 0xAB0301FBBB2EE474, 0x1C7B1F3CAC74331C },
+    { 0xEAE1E13D54FD4EC9, 0x11CCF385EBC89FF1 },
+    { 0x659A598CAA3CA27B, 0x1640306766BAC7EE },
+    { 0xFF00EFEFD4CBCB1A, 0x1BD03C81406979E9 },
+    { 0x3F6095F5E4FF5EF0, 0x116225D0C841EC32 },
+    { 0xCF38BB735E3F36AC, 0x15BAAF44FA52673E },
+    { 0x8306EA5035CF0457, 0x1B295B1638E7010E },
+    { 0x11E4527221A162B6, 0x10F9D8EDE39060A9 },
+    { 0x565D670EAA09BB64, 0x15384F295C7478D3 },
+    { 0x2BF4C0D2548C2A3D, 0x1A8662F3B3919708 },
+    { 0x1B78F88374D79A66, 0x1093FDD8503AFE65 },
+    { 0x625736A4520D8100, 0x14B8FD4E6449BDFE },
+    { 0xFAED044D6690E140, 0x19E73CA1FD5C2D7D },
+    { 0xBCD422B0601A8CC8, 0x103085E53E599C6E },
+    { 0x6C092B5C78212FFA, 0x143CA75E8DF0038A },
+    { 0x070B763396297BF8, 0x194BD136316C046D },
+    { 0x48CE53C07BB3DAF6, 0x1F9EC583BDC70588 },
+    { 0x2D80F4584D5068DA, 0x13C33B72569C6375 },
+    { 0x78E1316E60A48310, 0x18B40A4EEC437C52 }
+  };
+
+  /** @brief 2^(bits(5^i) - 1 + POW5_BITS) / 5^i + 1, as
+   *         { low word, high word }
+   */
+  const uint64_t POW5_INV_SPLIT[292][2]= {
+    { 0x0000000000000001, 0x2000000000000000 },
+    { 0x999999999999999A, 0x1999999999999999 },
+    { 0x47AE147AE147AE15, 0x147AE147AE147AE1 },
+    { 0x6C8B4395810624DE, 0x10624DD2F1A9FBE7 },
+    { 0x7A786C226809D496, 0x1A36E2EB1C432CA5 },
+    { 0x61F9F01B866E43AB, 0x14F8B588E368F084 },
+    { 0xB4C7F34938583622, 0x10C6F7A0B5ED8D36 },
+    { 0x87A6520EC08D236A, 0x1AD7F29ABCAF4857 },
+    { 0x9FB841A566D74F88, 0x15798EE2308C39DF },
+    { 0xE62D01511F12A607, 0x112E0BE826D694B2 },
+    { 0xD6AE6881CB5109A4, 0x1B7CDFD9D7BDBAB7 },
+    { 0xDEF1ED34A2A73AEA, 0x15FD7FE17964955F },
+    { 0x7F27F0F6E885C8BB, 0x119799812DEA1119 },
+    { 0x650CB4BE40D60DF8, 0x1C25C268497681C2 },
+    { 0xEA70909833DE7193, 0x16849B86A12B9B01 },
+    { 0x21F3A6E0297EC143, 0x1203AF9EE756159B },
+    { 0x6985D7CD0F313537, 0x1CD2B297D889BC2B },
+    { 0x2137DFD73F5A90F9, 0x170EF54646D49689 },
+    { 0xE75FE645CC4873FA, 0x12725DD1D243ABA0 },
+    { 0xA5663D3C7A0D865D, 0x1D83C94FB6D2AC34 },
+    { 0x511E976394D79EB1, 0x179CA10C9242235D },
+    { 0xDA7EDF82DD794BC1, 0x12E3B40A0E9B4F7D },
+    { 0x2A6498D1625BAC68, 0x1E392010175EE596 },
+    { 0xEEB6E0A781E2F053, 0x182DB34012B25144 },
+    { 0x58924D52CE4F26A9, 0x1357C299A88EA76A },
+    { 0x27507BB7B07EA441, 0x1EF2D0F5DA7DD8AA },
+    { 0x52A6C95FC0655034, 0x18C240C4AECB13BB },
+    { 0x0EEBD44C99EAA690, 0x13CE9A36F23C0FC9 },
+    { 0xB17953ADC3110A80, 0x1FB0F6BE50601941 },
+    { 0xC12DDC8B02740867, 0x195A5EFEA6B34767 },
+    { 0x3424B06F3529A052, 0x14484BFEEBC29F86 },
+    { 0x901D59F290EE19DB, 0x1039D66589687F9E },
+    { 0x4CFBC31DB4B0295F, 0x19F623D5A8A73297 },
+    { 0x3D9635B15D59BAB2, 0x14C4E977BA1F5BAC },
+    { 0x97AB5E277DE16228, 0x109D8792FB4C4956 },
+    { 0xF2ABC9D8C9689D0D, 0x1A95A5B7F87A0EF0 },
+    { 0x5BBCA17A3ABA173E, 0x154484932D2E725A },
+    { 0xAFCA1AC82EFB45CB, 0x11039D428A8B8EAE },
+    { 0xB2DCF7A6B1920945, 0x1B38FB9DAA78E44A },
+    { 0xF57D92EBC141A104, 0x15C72FB1552D836E },
+    { 0xC46475896767B403, 0x116C262777579C58 },
+    { 0x6D6D88DBD8A5ECD2, 0x1BE03D0BF225C6F4 },
+    { 0x8ABE071646EB23DB, 0x164CFDA3281E38C3 },
+    { 0x6EFE6C11D255B649, 0x11D7314F534B609C },
+    { 0xB197134FB6EF8A0E, 0x1C8B821885456760 },
+    { 0x27AC0F72F8BFA1A5, 0x16D601AD376AB91A },
+    { 0xB95672C260994E1E, 0x1244CE242C5560E1 },
+    { 0xF5571E03CDC21695, 0x1D3AE36D13BBCE35 },
+    { 0x2AAC18030B01ABAB, 0x17624F8A762FD82B },
+    { 0xBBBCE0026F348956, 0x12B50C6EC4F31355 },
+    { 0x92C7CCD0B1EDA889, 0x1DEE7A4AD4B81EEF },
+    { 0xDBD30A408E57BA07, 0x17F1FB6F10934BF2 },
+    { 0x7CA8D50071DFC806, 0x1327FC58DA0F6FF5 },
+    { 0xFAA7BB33E9660CD6, 0x1EA6608E29B24CBB },
+    { 0x9552FC298784D711, 0x18851A0B548EA3C9 },
+    { 0xAAA8C9BAD2D0AC0E, 0x139DAE6F76D88307 },
+    { 0xDDDADC5E1E1AACE3, 0x1F62B0B257C0D1A5 },
+    { 0x7E48B04B4B488A4F, 0x191BC08EAC9A4151 },
+    { 0xCB6D59D5D5D3A1D9, 0x141633A556E1CDDA },
+    { 0x3C577B1177DC817B, 0x1011C2EAABE7D7E2 },
+    { 0xC6F25E825960CF2A, 0x19B604AAACA62636 },
+    { 0x6BF518684780A5BB, 0x14919D5556EB51C5 },
+    { 0x232A79ED06008496, 0x10747DDDDF22A7D1 },
+    { 0xD1DD8FE1A3340756, 0x1A53FC9631D10C81 },
+    { 0xA7E4731AE8F66C45, 0x150FFD44F4A73D34 },
+    { 0x531D28E253F8569E, 0x10D9976A5D52975D },
+    { 0xEB61DB03B98D5762, 0x1AF5BF109550F22E },
+    { 0xBC4E48CFC7A445E8, 0x159165A6DDDA5B58 },
+    { 0x6371D3D96C836B20, 0x11411E1F17E1E2AD },
+    { 0x9F1C8628AD9F11CD, 0x1B9B6364F3030448 },
+    { 0xE5B06B53BE18DB0B, 0x1615E91D8F359D06 },
+    { 0xEAF3890FCB4715A2, 0x11AB20E472914A6B },
+    { 0x44B8DB4C7871BC37, 0x1C45016D841BAA46 },
+    { 0x03C715D6C6C1635F, 0x169D9ABE03495505 },
+    { 0x3638DE456BCDE919, 0x1217AEFE69077737 },
+    { 0x56C163A2461641C1, 0x1CF2B1970E725858 },
+    { 0xDF011C81D1AB67CE, 0x17288E1271F51379 },
+    { 0x7F3416CE4155ECA5, 0x1286D80EC190DC61 },
+    { 0x6520247D3556476E, 0x1DA48CE468E7C702 },
+    { 0xEA801D30F7783925, 0x17B6D71D20B96C01 },
+    { 0xBB99B0F3F92CFA84, 0x12F8AC174D612334 },
+    { 0x5F5C4E532847F739, 0x1E5AACF215683854 },
+    { 0x7F7D0B75B9D32C2E, 0x18488A5B44536043 },
+    { 0x9930D5F7C7DC2358, 0x136D3B7C36A919CF },
+    { 0x8EB4898C72F9D226, 0x1F152BF9F10E8FB2 },
+    { 0x722A07A38F2E41B8, 0x18DDBCC7F40BA628 },
+    { 0xC1BB394FA5BE9AFA, 0x13E497065CD61E86 },
+    { 0x9C5EC2190930F7F6, 0x1FD424D6FAF030D7 },
+    { 0x49E56814075A5FF8, 0x197683DF2F268D79 },
+    { 0x6E51201005E1E660, 0x145ECFE5BF520AC7 },
+    { 0xF1DA800CD181851A, 0x104BD984990E6F05 },
+    { 0x4FC400148268D4F5, 0x1A12F5A0F4E3E4D6 },
+    { 0xD96999AA01ED772B, 0x14DBF7B3F71CB711 },
+    { 0xADEE1488018AC5BC, 0x10AFF95CC5B09274 },
+    { 0x497CEDA668DE092C, 0x1AB328946F80EA54 },
+    { 0x3ACA57B853E4D424, 0x155C2076BF9A5510 },
+    { 0x623B7960431D7683, 0x1116805EFFAEAA73 },
+    { 0x9D2BF566D1C8BD9E, 0x1B5733CB32B110B8 },
+    { 0x7DBCC452416D647F, 0x15DF5CA28EF40D60 },
+    { 0xCAFD69DB678AB6CC, 0x117F7D4ED8C33DE6 },
+    { 0xAB2F0FC572778ADF, 0x1BFF2EE48E052FD7 },
+    { 0x88F273045B92D580, 0x1665BF1D3E6A8CAC },
+    { 0xD3F528D049424466, 0x11EAFF4A98553D56 },
+    { 0xB988414D4203A0A3, 0x1CAB3210F3BB9557 },
+    { 0x6139CDD76802E6E9, 0x16EF5B40C2FC7779 },
+    { 0xE761717920025254, 0x125915CD68C9F92D },
+    { 0xA568B58E999D5086, 0x1D5B561574765B7C },
+    { 0x5120913EE14AA6D2, 0x177C44DDF6C515FD },
+    { 0xA74D40FF1AA21F0E, 0x12C9D0B1923744CA },
+    { 0x0BAECE64F769CB4A, 0x1E0FB44F50586E11 },
+    { 0x3C8BD850C5EE3C3B, 0x180C903F7379F1A7 },
+    { 0xCA0979DA37F1C9C9, 0x133D4032C2C7F485 },
+    { 0xA9A8C2F6BFE942DB, 0x1EC866B79E0CBA6F },
+    { 0x2153CF2BCCBA9BE3, 0x18A0522C7E709526 },
+    { 0x1AA9728970954982, 0x13B374F06526DDB8 },
+    { 0xF775840F1A88759D, 0x1F8587E7083E2F8C },
+    { 0x5F9136727BA05E17, 0x19379FEC0698260A },
+    { 0x1940F85B9619E4DF, 0x142C7FF0054684D5 },
+    { 0xE100C6AFAB47EA4C, 0x1023998CD1053710 },
+    { 0xCE67A44C453FDD47, 0x19D28F47B4D524E7 },
+    { 0xD852E9D69DCCB106, 0x14A8729FC3DDB71F },
+    { 0x79DBEE454B0A2738, 0x1086C219697E2C19 },
+    { 0x295FE3A211A9D859, 0x1A71368F0F30468F },
+    { 0xBAB31C81A7BB137A, 0x15275ED8D8F36BA5 },
+    { 0x6228E39AEC95A92F, 0x10EC4BE0AD8F8951 },
+    { 0x9D0E38F7E0EF7517, 0x1B13AC9AAF4C0EE8 },
+    { 0xB0D82D931A592A79, 0x15A956E225D67253 },
+    { 0x8D79BE0F4847552E, 0x11544581B7DEC1DC },
+    { 0x158F967EDA0BBB7C, 0x1BBA08CF8C979C94 },
+    { 0x77A611FF14D62F97, 0x162E6D72D6DFB076 },
+    { 0xF951A7FF43DE8C79, 0x11BEBDF578B2F391 },
+    { 0xC21C3FFED2FDAD8E, 0x1C6463225AB7EC1C },
+    { 0x01B0333242648AD8, 0x16B6B5B5155FF017 },
+    { 0x0159C28E9B83A246, 0x122BC490DDE659AC },
+    { 0xCEF604175F3903A3, 0x1D12D41AFCA3C2AC },
+    { 0x725E69AC4C2D9C83, 0x17424348CA1C9BBD },
+    { 0xF5185489D68AE39C, 0x129B69070816E2FD },
+    { 0xEE8D540FBDAB05C6, 0x1DC574D80CF16B2F },
+    { 0xBED77672FE226B05, 0x17D12A4670C1228C },
+    { 0xFF12C528CB4EBC04, 0x130DBB6B8D674ED6 },
+    { 0xCB513B74787DF9A0, 0x1E7C5F127BD87E24 },
+    { 0x090DC929F9FE614D, 0x18637F41FCAD31B7 },
+    { 0xA0D7D42194CB810A, 0x1382CC34CA2427C5 },
+    { 0x67BFB9CF5478CE77, 0x1F37AD21436D0C6F },
+    { 0x1FCC94A5DD2D71F9, 0x18F9574DCF8A7059 },
+    { 0x7FD6DD517DBDF4C7, 0x13FAAC3E3FA1F37A },
+    { 0xFFBE2EE8C92FEE0B, 0x1FF779FD329CB8C3 },
+    { 0x6631BF20A0F324D6, 0x1992C7FDC216FA36 },
+    { 0xB827CC1A1A5C1D78, 0x14756CCB01ABFB5E },
+    { 0x935309AE7B7CE460, 0x105DF0A267BCC918 },
+    { 0x1EEB42B0C594A099, 0x1A2FE76A3F9474F4 },
+    { 0xE58902270476E6E1, 0x14F31F8832DD2A5C },
+    { 0xB7A0CE859D2BEBE7, 0x10C27FA028B0EEB0 },
+    { 0x59014A6F61DFDFD8, 0x1AD0CC33744E4AB4 },
+    { 0xE0CDD525E7E64CAD, 0x1573D68F903EA229 },
+    { 0x4D7177518651D6F1, 0x11297872D9CBB4EE },
+    { 0x7BE8BEE8D6E957E8, 0x1B758D848FAC54B0 },
+    { 0xFCBA3253DF211320, 0x15F7A46A0C89DD59 },
+    { 0x63C8284318E74280, 0x1192E9EE706E4AAE },
+    { 0x060D0D3827D86A66, 0x1C1E43171A4A1117 },
+    { 0x6B3DA42CECAD21EB, 0x167E9C127B6E7412 },
+    { 0x88FE1CF0BD574E56, 0x11FEE341FC585CDB },
+    { 0x419694B462254A23, 0x1CCB0536608D615F },
+    { 0x67ABAA29E81DD4E9, 0x1708D0F84D3DE77F },
+    { 0xB95621BB2017DD87, 0x126D73F9D764B932 },
+    { 0xC223692B668C95A5, 0x1D7BECC2F23AC1EA },
+    { 0xCE82BA891ED6DE1D, 0x179657025B6234BB },
+    { 0xA53562074BDF1818, 0x12DEAC01E2B4F6FC },
+    { 0x3B889CD87964F359, 0x1E3113363787F194 },
+    { 0xFC6D4A46C783F5E1, 0x18274291C6065ADC },
+    { 0x30576E9F06032B1A, 0x13529BA7D19EAF17 },
+    { 0x1A257DCB3CD1DE90, 0x1EEA92A61C311825 },
+    { 0x481DFE3C30A7E540, 0x18BBA884E35A79B7 },
+    { 0xD34B31C9C0865100, 0x13C9539D82AEC7C5 },
+    { 0x5211E942CDA3B4CD, 0x1FA885C8D117A609 },
+    { 0x74DB21023E1C90A4, 0x19539E3A40DFB807 },
+    { 0xF715B401CB4A0D50, 0x1442E4FB67196005 },
+    { 0xF8DE299B09080AA7, 0x103583FC527AB337 },
+    { 0x8E304291A80CDDD7, 0x19EF3993B72AB859 },
+    { 0x3E8D020E200A4B13, 0x14BF6142F8EEF9E1 },
+    { 0x653D9B3E80083C0F, 0x10991A9BFA58C7E7 },
+    { 0x6EC8F864000D2CE4, 0x1A8E90F9908E0CA5 },
+    { 0x8BD3F9E999A423EA, 0x153EDA614071A3B7 },
+    { 0x3CA994BAE1501CBB, 0x10FF151A99F482F9 },
+    { 0xC775BAC49BB3612B, 0x1B31BB5DC320D18E },
+    { 0xD2C4956A16291A89, 0x15C162B168E70E0B },
+    { 0xDBD0778811BA7BA1, 0x11678227871F3E6F },
+    { 0x2C80BF401C5D929B, 0x1BD8D03F3E9863E6 },
+    { 0xBD33CC3349E47549, 0x16470CFF6546B651 },
+    { 0xCA8FD68F6E505DD4, 0x11D270CC51055EA7 },
+    { 0x4419574BE3B3C953, 0x1C83E7AD4E6EFDD9 },
+    { 0x0347790982F63AA9, 0x16CFEC8AA52597E1 },
+    { 0xCF6C60D468C4FBBA, 0x123FF06EEA847980 },
+    { 0xE57A34870E07F92A, 0x1D331A4B10D3F59A },
+    { 0x512E906C0B399422, 0x175C1508DA432AE2 },
+    { 0xDA8BA6BCD5C7A9B5, 0x12B010D3E1CF5581 },
+    { 0x90DF712E22D90F87, 0x1DE6815302E5559C },
+    { 0xDA4C5A8B4F140C6C, 0x17EB9AA8CF1DDE16 },
+    { 0xAEA37BA2A5A9A38A, 0x1322E220A5B17E78 },
+    { 0x7DD25F6AA2A905A9, 0x1E9E369AA2B59727 },
+    { 0x97DB7F888220D154, 0x187E92154EF7AC1F },
+    { 0x797C6606CE80A777, 0x139874DDD8C6234C },
+    { 0x8F2D700AE4010BF1, 0x1F5A549627A36BAD },
+    { 0x0C2459A25000D65A, 0x191510781FB5EFBE },
+    { 0x701D1481D99A4515, 0x1410D9F9B2F7F2FE },
+    { 0xC017439B147B6A77, 0x100D7B2E28C65BFE },
+    { 0xCCF205C4ED9243F2, 0x19AF2B7D0E0A2CCA },
+    { 0x0A5B37D0BE0E9CC2, 0x148C22CA71A1BD6F },
+    { 0x0848F973CB3EE3CE, 0x10701BD527B4978C },
+    { 0xDA0E5BEC78649FB0, 0x1A4CF9550C5425AC },
+    { 0x7B3EAFF060507FC0, 0x150A6110D6A9B7BD },
+    { 0x95CBBFF380406633, 0x10D51A73DEEE2C97 },
+    { 0xEFAC665266CD7052, 0x1AEE90B964B04758 },
+    { 0x2623850EB8A459DB, 0x158BA6FAB6F36C47 },
+    { 0x1E82D0D893B6AE49, 0x113C85955F29236C },
+    { 0xFD9E1AF41F8AB075, 0x1B9408EEFEA838AC },
+    { 0x97B1AF29B2D559F7, 0x16100725988693BD },
+    { 0xAC8E25BAF5777B2C, 0x11A66C1E139EDC97 },
+    { 0x7A7D092B2258C513, 0x1C3D79C9B8FE2DBF },
+    { 0x61FDA0EF4EAD6A76, 0x169794A160CB57CC },
+    { 0xE7FE1A590BBDEEC5, 0x1212DD4DE7091309 },
+    { 0xA6635D5B45FCB13A, 0x1CEAFBAFD80E84DC },
+    { 0x851C4AAF6B308DC8, 0x172262F3133ED0B0 },
+    { 0xD0E36EF2BC26D7D4, 0x1281E8C275CBDA26 },
+    { 0xB49F17EAC6A48C86, 0x1D9CA79D894629D7 },
+    { 0x2A18DFEF0550706B, 0x17B08617A104EE46 },
+    { 0x54E0B3259DD9F389, 0x12F39E794D9D8B6B },
+    { 0x87CDEB6F62F65274, 0x1E5297287C2F4578 },
+    { 0xD30B22BF825EA85D, 0x18421286C9BF6AC6 },
+    { 0x0F3C1BCC684BB9E4, 0x13680ED23AFF889F },
+    { 0x18602C7A4079296D, 0x1F0CE4839198DA98 },
+    { 0x46B356C833942124, 0x18D71D360E13E213 },
+    { 0x388F78A029434DB6, 0x13DF4A91A4DCB4DC },
+    { 0x5A7F2766A86BAF8A, 0x1FCBAA82A1612160 },
+    { 0x153285EBB9EFBFA2, 0x196FBB9BB44DB44D },
+    { 0xAA8ED189618C994E, 0x145962E2F6A4903D },
+    { 0xEED8A7A11AD6E10C, 0x1047824F2BB6D9CA },
+    { 0x7E27729B5E249B45, 0x1A0C03B1DF8AF611 },
+    { 0xFE85F549181D4904, 0x14D6695B193BF80D },
+    { 0xCB9E5DD4134AA0D0, 0x10AB877C142FF9A4 },
+    { 0xDF63C9535211014D, 0x1AAC0BF9B9E65C3A },
+    { 0x191CA10F74DA6771, 0x15566FFAFB1EB02F },
+    { 0xADB080D92A4852C1, 0x1111F32F2F4BC025 },
+    { 0x15E7348EAA0D5134, 0x1B4FEB7EB212CD09 },
+    { 0xAB1F5D3EEE710DC4, 0x15D98932280F0A6D },
+    { 0xBC1917658B8DA49D, 0x117AD428200C0857 },
+    { 0x2CF4F23C127C3A94, 0x1BF7B9D9CCE00D59 },
+    { 0xF0C3F4FCDB969543, 0x165FC7E170B33DE0 },
+    { 0x5A365D9716121103, 0x11E6398126F5CB1A },
+    { 0x9056FC24F01CE804, 0x1CA38F350B22DE90 },
+    { 0xD9DF301D8CE3ECD0, 0x16E93F5DA2824BA6 },
+    { 0xE17F59B13D8323DA, 0x125432B14ECEA2EB },
+    { 0x68CBC2B52F38395C, 0x1D53844EE47DD179 },
+    { 0x53D6355DBF602DE3, 0x177603725064A794 },
+    { 0xA9782AB165E68B1C, 0x12C4CF8EA6B6EC76 },
+    { 0x0F26AAB56FD744FA, 0x1E07B27DD78B13F1 },
+    { 0x3F52222ABFDF6A62, 0x18062864AC6F4327 },
+    { 0x65DB4E88997F884E, 0x1338205089F29C1F },
+    { 0x6FC54A7428CC0D4A, 0x1EC033B40FEA9365 },
+    { 0x596AA1F68709A43B, 0x1899C2F673220F84 },
+    { 0xADEEE7F86C07B696, 0x13AE3591F5B4D936 },
+    { 0x497E3FF3E00C5756, 0x1F7D228322BAF524 },
+    { 0xD464FFF64CD6AC45, 0x1930E868E89590E9 },
+    { 0x4383FFF83D7889D1, 0x14272053ED4473EE },
+    { 0xCF9CCCC69793A174, 0x101F4D0FF1038FF1 },
+    { 0x7F6147A425B90252, 0x19CBAE7FE805B31C },
+    { 0xCC4DD2E9B7C7350F, 0x14A2F1FFECD15C16 },
+    { 0x3D0B0F215FD290D9, 0x10825B3323DAB012 },
+    { 0x61AB4B689950E7C1, 0x1A6A2B85062AB350 },
+    { 0x4E22A2BA1440B967, 0x1521BC6A6B555C40 },
+    { 0x0B4EE894DD009453, 0x10E7C9EEBC4449CD },
+    { 0x1217DA87C800ED51, 0x1B0C764AC6D3A948 },
+    { 0xDB46486CA000BDDA, 0x15A391D56BDC876C },
+    { 0x490506BD4CCD64AF, 0x114FA7DDEFE39F8A },
+    { 0xA8080AC87AE23AB1, 0x1BB2A62FE638FF43 },
+    { 0x5339A239FBE82EF4, 0x162884F31E93FF69 },
+    { 0x75C7B4FB2FECF25D, 0x11BA03F5B20FFF87 },
+    { 0x22D92191E647EA2E, 0x1C5CD322B67FFF3F },
+    { 0xB57A8141850654F2, 0x16B0A8E891FFFF65 },
+    { 0xC4620101373843F5, 0x1226ED86DB3332B7 },
+    { 0x3A366801F1F39FEE, 0x1D0B15A491EB8459 },
+    { 0xFB5EB99B27F6198B, 0x173C115074BC69E0 },
+    { 0x2F7EFAE2865E7AD6, 0x129674405D6387E7 },
+    { 0xE597F7D0D6FD9156, 0x1DBD86CD6238D971 },
+    { 0x8479930D78CADAAB, 0x17CAD23DE82D7AC1 },
+    { 0xD06142712D6F1556, 0x1308A831868AC89A },
+    { 0x4D686A4EAF182222, 0x1E74404F3DAADA91 },
+    { 0xA453883EF279B4E8, 0x185D003F6488AEDA },
+    { 0xE9DC6CFF28615D87, 0x137D99CC506D58AE },
+    { 0xA960AE650D6895A4, 0x1F2F5C7A1A488DE4 },
+    { 0xBAB3BEB73DED4483, 0x18F2B061AEA07183 },
+    { 0x2EF6322C318A9D36, 0x13F559E7BEE6C136 }
+  };
+
+  /** @brief floor(e * log10(2)), for 0 <= e <= 1650 */
+  inline uint32_t log10Pow2(int32_t e) {
+    return ((uint32_t)e * 78913) >> 18;
+  }
+
+  /** @brief floor(e * log10(5)), for 0 <= e <= 2620 */
+  inline uint32_t log10Pow5(int32_t e) {
+    return ((uint32_t)e * 732923) >> 20;
+  }
+
+  /** @brief Number of bits in 5^e, for 0 <= e <= 3528 */
+  inline int32_t pow5Bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+  }
+
+  inline bool multipleOfPowerOf5(uint64_t v, uint32_t p) {
+    uint32_t n= 0;
+    while (!(v % 5)) {
+      v /= 5;
+      ++n;
+    }
+    return n >= p;
+  }
+
+  inline bool multipleOfPowerOf2(uint64_t v, uint32_t p) {
+    return !(v & (((uint64_t)1 << p) - 1));
+  }
+
+  /** @brief (m * mul) >> j, where mul is a 128-bit table entry, m has
+   *         at most 55 bits and 64 < j < 128
+   */
+  inline uint64_t mulShift(uint64_t m, const uint64_t* mul, int32_t j) {
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 low= (unsigned __int128)m * mul[0];
+    const unsigned __int128 high= (unsigned __int128)m * mul[1];
+    return (uint64_t)(((low >> 64) + high) >> (j - 64));
+#else
+    const uint64_t M32= 0xFFFFFFFFu;
+    const auto mulHigh= [M32](uint64_t a, uint64_t b, uint64_t& high) {
+      const uint64_t aLow= a & M32, aHigh= a >> 32;
+      const uint64_t bLow= b & M32, bHigh= b >> 32;
+      const uint64_t ll= aLow * bLow, lh= aLow * bHigh;
+      const uint64_t hl= aHigh * bLow, hh= aHigh * bHigh;
+      const uint64_t mid= (ll >> 32) + (lh & M32) + (hl & M32);
+      high= hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+      return (mid << 32) | (ll & M32);
+    };
+    uint64_t high0, high1;
+    mulHigh(m, mul[0], high0);
+    const uint64_t low1= mulHigh(m, mul[1], high1);
+    const uint64_t sum= high0 + low1;
+    if (sum < high0) {
+      ++high1;
+    }
+    const int32_t shift= j - 64;
+    return (high1 << (64 - shift)) | (sum >> shift);
+#endif
+  }
+
+  /** @brief Find the shortest decimal d * 10^exponent that reads back as
+   *         v, which must be positive and finite
+   *
+   *  This is Ulf Adams' Ryu.  It works entirely in integers, so unlike
+   *  printf and strtod it does not depend on the locale, and it always
+   *  finds the shortest digits, choosing the one closest to v when
+   *  several are equally short.
+   */
+  uint64_t shortestDecimal(double v, int32_t& exponent) {
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    const uint64_t mantissa= bits & (((uint64_t)1 << 52) - 1);
+    const uint32_t biasedExponent= (uint32_t)(bits >> 52) & 0x7FF;
+
+    // v= m2 * 2^e2, with two more bits so the midpoints to the doubles
+    // on either side, which bound the digits that read back as v, are
+    // integers too
+    int32_t e2;
+    uint64_t m2;
+    if (biasedExponent) {
+      e2= (int32_t)biasedExponent - 1023 - 52 - 2;
+      m2= ((uint64_t)1 << 52) | mantissa;
+    } else {
+      e2= 1 - 1023 - 52 - 2;
+      m2= mantissa;
+    }
+    const bool acceptBounds= !(m2 & 1);
+    const uint64_t mv= 4 * m2;
+    const uint32_t mmShift= (mantissa || (biasedExponent <= 1)) ? 1 : 0;
+
+    // Scale v and the midpoints by a power of ten, keeping just enough
+    // of the result to tell whether the digits dropped were all zero
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vmIsTrailingZeros= false;
+    bool vrIsTrailingZeros= false;
+    if (e2 >= 0) {
+      const uint32_t q= log10Pow2(e2) - (e2 > 3);
+      const int32_t i= -e2 + (int32_t)q + POW5_BITS +
+	               pow5Bits((int32_t)q) - 1;
+      e10= (int32_t)q;
+      vr= mulShift(mv, POW5_INV_SPLIT[q], i);
+      vp= mulShift(mv + 2, POW5_INV_SPLIT[q], i);
+      vm= mulShift(mv - 1 - mmShift, POW5_INV_SPLIT[q], i);
+      if (q <= 21) {
+	// Only these can be divisible by 10^q
+	if (!(mv % 5)) {
+	  vrIsTrailingZeros= multipleOfPowerOf5(mv, q);
+	} else if (acceptBounds) {
+	  vmIsTrailingZeros= multipleOfPowerOf5(mv - 1 - mmShift, q);
+	} else {
+	  vp -= multipleOfPowerOf5(mv + 2, q);
+	}
+      }
+    } else {
+      const uint32_t q= log10Pow5(-e2) - (-e2 > 1);
+      const int32_t i= -e2 - (int32_t)q;
+      const int32_t j= (int32_t)q - (pow5Bits(i) - POW5_BITS);
+      e10= (int32_t)q + e2;
+      vr= mulShift(mv, POW5_SPLIT[i], j);
+      vp= mulShift(mv + 2, POW5_SPLIT[i], j);
+      vm= mulShift(mv - 1 - mmShift, POW5_SPLIT[i], j);
+      if (q <= 1) {
+	vrIsTrailingZeros= true;
+	if (acceptBounds) {
+	  vmIsTrailingZeros= (mmShift == 1);
+	} else {
+	  --vp;
+	}
+      } else if (q < 63) {
+	vrIsTrailingZeros= multipleOfPowerOf2(mv, q);
+      }
+    }
+
+    // Drop digits while the bounds still differ, rounding what is left
+    uint32_t removed= 0;
+    uint64_t output;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+      // Rare; the bounds and ties need exact handling
+      uint32_t lastRemovedDigit= 0;
+      while (vp / 10 > vm / 10) {
+	vmIsTrailingZeros &= !(vm % 10);
+	vrIsTrailingZeros &= !lastRemovedDigit;
+	lastRemovedDigit= (uint32_t)(vr % 10);
+	vr /= 10;
+	vp /= 10;
+	vm /= 10;
+	++removed;
+      }
+      if (vmIsTrailingZeros) {
+	while (!(vm % 10)) {
+	  vrIsTrailingZeros &= !lastRemovedDigit;
+	  lastRemovedDigit= (uint32_t)(vr % 10);
+	  vr /= 10;
+	  vp /= 10;
+	  vm /= 10;
+	  ++removed;
+	}
+      }
+      if (vrIsTrailingZeros && (lastRemovedDigit == 5) && !(vr % 2)) {
+	lastRemovedDigit= 4;  // Round half to even
+      }
+      output= vr + (((vr == vm) && (!acceptBounds || !vmIsTrailingZeros)) ||
+		    (lastRemovedDigit >= 5));
+    } else {
+      bool roundUp= false;
+      if (vp / 100 > vm / 100) {
+	roundUp= (vr % 100) >= 50;
+	vr /= 100;
+	vp /= 100;
+	vm /= 100;
+	removed += 2;
+      }
+      while (vp / 10 > vm / 10) {
+	roundUp= (vr % 10) >= 5;
+	vr /= 10;
+	vp /= 10;
+	vm /= 10;
+	++removed;
+      }
+      output= vr + ((vr == vm) || roundUp);
+    }
+    exponent= e10 + (int32_t)removed;
+    return output;
+  }
+
+  /* End of the code derived from Ryu */
+
+  /** @brief Write <tt>n</tt> digits with the decimal point after the
+   *         first and a decimal exponent, as "%g" does for very large and
+   *         very small numbers
+   */
+  char* writeScientific(char* out, const char* digits, size_t n,
+			int exponent) {
+    *out++ = digits[0];
+    if (n > 1) {
+      *out++ = '.';
+      memcpy(out, digits + 1, n - 1);
+      out += n - 1;
+    }
+    *out++ = 'e';
+    *out++ = (exponent < 0) ? '-' : '+';
+    const unsigned magnitude= (unsigned)((exponent < 0) ? -exponent
+			                                : exponent);
+    if (magnitude < 10) {
+      *out++ = '0';
+    }
+    return formatUnsigned(out, magnitude);
+  }
+
+  /** @brief Write <tt>n</tt> digits without an exponent, where the
+   *         first digit's place value is 10^<tt>exponent</tt>
+   */
+  char* writeFixed(char* out, const char* digits, size_t n, int exponent) {
+    if (exponent < 0) {
+      *out++ = '0';
+      *out++ = '.';
+      for (int i= -1; i > exponent; --i) {
+	*out++ = '0';
+      }
+      memcpy(out, digits, n);
+      return out + n;
+    }
+
+    const size_t numIntegralDigits= (size_t)exponent + 1;
+    if (n <= numIntegralDigits) {
+      memcpy(out, digits, n);
+      out += n;
+      for (size_t i= n; i < numIntegralDigits; ++i) {
+	*out++ = '0';
+      }
+      return out;
+    }
+    memcpy(out, digits, numIntegralDigits);
+    out += numIntegralDigits;
+    *out++ = '.';
+    memcpy(out, digits + numIntegralDigits, n - numIntegralDigits);
+    return out + (n - numIntegralDigits);
+  }
+}
+
+char* pistis::logging::formatDouble(char* out, double v) {
+  // Integers that %g would write without an exponent
+  if ((fabs(v) < 1e15) && (v == (double)(int64_t)v)) {
+    if ((v == 0.0) && signbit(v)) {
+      *out++ = '-';
+    }
+    return formatSigned(out, (int64_t)v);
+  }
+  if (!isfinite(v)) {
+    return writePrintf(out, v, 1);
+  }
+
+  if (signbit(v)) {
+    *out++ = '-';
+    v= -v;
+  }
+
+  char digits[MAX_FORMATTED_NUMBER_SIZE];
+  int32_t exponent;
+  const size_t n=
+      (size_t)(formatUnsigned(digits, shortestDecimal(v, exponent)) - digits);
+
+  // Place value of the first digit, and the precision "%g" would need
+  // to print the digits, which decides when it switches to scientific
+  // notation.  The precision is never less than 15, so numbers switch
+  // where they always have.
+  const int leadingExponent= exponent + (int)n - 1;
+  const int precision= std::max((int)n, 15);
+  if ((leadingExponent < -4) || (leadingExponent >= precision)) {
+    return writeScientific(out, digits, n, leadingExponent);
+  }
+  return writeFixed(out, digits, n, leadingExponent);
+}
+
+char* pistis::logging::formatDouble(char* out, double v, int precision) {
+  // %g writes integers with no more than "precision" digits as integers
+  static const double POWERS_OF_TEN[MAX_DOUBLE_FORMAT_PRECISION + 1]= {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17
+  };
+  if ((fabs(v) < POWERS_OF_TEN[std::max(precision, 1)]) &&
+      (v == (double)(int64_t)v)) {
+    if ((v == 0.0) && signbit(v)) {
+      *out++ = '-';
+    }
+    return formatSigned(out, (int64_t)v);
+  }
+  return writePrintf(out, v, precision);
+}
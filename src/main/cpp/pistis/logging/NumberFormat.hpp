@@ -0,0 +1,172 @@
+#ifndef __PISTIS__LOGGING__NUMBERFORMAT_HPP__
+#define __PISTIS__LOGGING__NUMBERFORMAT_HPP__
+
+#include <type_traits>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Room needed by any of the format functions below */
+    static constexpr size_t MAX_FORMATTED_NUMBER_SIZE= 32;
+
+    /** @brief Largest precision formatDouble(char*, double, int) accepts.
+     *
+     *  Doubles have no more than 17 significant decimal digits.
+     */
+    static constexpr int MAX_DOUBLE_FORMAT_PRECISION= 17;
+
+    /** @brief "00", "01", ..., "99", used to write integers two digits at
+     *         a time
+     */
+    extern const char DIGIT_PAIRS[200];
+
+    /** @brief Returns the number of decimal digits in <tt>v</tt> */
+    inline size_t numDecimalDigits(uint64_t v) {
+      size_t n= 1;
+      while (v >= 10000) {
+	v /= 10000;
+	n += 4;
+      }
+      return n + (v >= 10) + (v >= 100) + (v >= 1000);
+    }
+
+    /** @brief Write <tt>v</tt> in decimal to <tt>out</tt>
+     *
+     *  None of the format functions write a terminating null character.
+     *  <tt>out</tt> must have room for MAX_FORMATTED_NUMBER_SIZE
+     *  characters.
+     *
+     *  @returns The end of the text written
+     */
+    inline char* formatUnsigned(char* out, uint64_t v) {
+      char* const end= out + numDecimalDigits(v);
+      char* p= end;
+      while (v >= 100) {
+	const size_t i= (size_t)(v % 100) * 2;
+	v /= 100;
+	*--p = DIGIT_PAIRS[i + 1];
+	*--p = DIGIT_PAIRS[i];
+      }
+      if (v >= 10) {
+	*--p = DIGIT_PAIRS[v * 2 + 1];
+	*--p = DIGIT_PAIRS[v * 2];
+      } else {
+	*--p = (char)('0' + v);
+      }
+      return end;
+    }
+
+    /** @brief Write <tt>v</tt> in decimal to <tt>out</tt> */
+    inline char* formatSigned(char* out, int64_t v) {
+      if (v < 0) {
+	*out++ = '-';
+	// Negate as unsigned so INT64_MIN does not overflow
+	return formatUnsigned(out, ~(uint64_t)v + 1);
+      }
+      return formatUnsigned(out, (uint64_t)v);
+    }
+
+    /** @brief Write <tt>v</tt> in hexadecimal, without a prefix, to
+     *         <tt>out</tt>
+     */
+    inline char* formatHex(char* out, uint64_t v, bool upperCase= false) {
+      const char* const digits=
+	  upperCase ? "0123456789ABCDEF" : "0123456789abcdef";
+      size_t n= 1;
+      for (uint64_t rest= v >> 4; rest; rest >>= 4) {
+	++n;
+      }
+      char* const end= out + n;
+      char* p= end;
+      do {
+	*--p = digits[v & 0xF];
+	v >>= 4;
+      } while (v);
+      return end;
+    }
+
+    /** @brief Write <tt>p</tt> in hexadecimal, with a leading "0x", to
+     *         <tt>out</tt>
+     */
+    inline char* formatPointer(char* out, const void* p) {
+      *out++ = '0';
+      *out++ = 'x';
+      return formatHex(out, (uint64_t)(uintptr_t)p);
+    }
+
+    /** @brief Write the shortest decimal representation of <tt>v</tt>
+     *         that reads back as exactly <tt>v</tt>
+     *
+     *  The digits come from Ryu, which works in integer arithmetic, so
+     *  the result is always the shortest, is the closest to <tt>v</tt>
+     *  of the shortest candidates, and does not depend on the locale.
+     *  They are written in the notation of printf's "%g" with just
+     *  enough precision for them, and always with '.' as the decimal
+     *  point.
+     */
+    char* formatDouble(char* out, double v);
+
+    /** @brief Write <tt>v</tt> as printf's "%.*g" does with
+     *         <tt>precision</tt>, which is also how a std::ostream with
+     *         default flags writes floating-point values.
+     */
+    char* formatDouble(char* out, double v, int precision);
+
+    /** @brief How LogStream can write values of type <tt>T</tt> without
+     *         going through std::num_put.
+     *
+     *  bool and the character types are not numbers as far as
+     *  std::ostream is concerned, and long double needs more precision
+     *  than formatDouble() provides, so they use the ordinary path.
+     */
+    enum class NumberFormatKind {
+      NONE,
+      SIGNED,
+      UNSIGNED,
+      FLOATING_POINT,
+      POINTER
+    };
+
+    template <typename T>
+    struct NumberFormatKindOf {
+    private:
+      typedef typename std::remove_cv<T>::type U;
+      typedef typename std::remove_cv<
+	  typename std::remove_pointer<U>::type
+      >::type Pointee;
+
+      static constexpr bool IS_CHAR_LIKE=
+	  std::is_same<U, bool>::value || std::is_same<U, char>::value ||
+	  std::is_same<U, signed char>::value ||
+	  std::is_same<U, unsigned char>::value ||
+	  std::is_same<U, wchar_t>::value ||
+	  std::is_same<U, char16_t>::value ||
+	  std::is_same<U, char32_t>::value;
+
+      // Pointers to characters are written as strings
+      static constexpr bool IS_POINTER=
+	  std::is_pointer<U>::value && !std::is_function<Pointee>::value &&
+	  !std::is_same<Pointee, char>::value &&
+	  !std::is_same<Pointee, signed char>::value &&
+	  !std::is_same<Pointee, unsigned char>::value &&
+	  !std::is_same<Pointee, wchar_t>::value;
+
+    public:
+      static constexpr NumberFormatKind value=
+	  (std::is_integral<U>::value && !IS_CHAR_LIKE)
+	      ? (std::is_signed<U>::value ? NumberFormatKind::SIGNED
+		                          : NumberFormatKind::UNSIGNED)
+	  : (std::is_same<U, float>::value || std::is_same<U, double>::value)
+	      ? NumberFormatKind::FLOATING_POINT
+	  : IS_POINTER ? NumberFormatKind::POINTER
+	  : NumberFormatKind::NONE;
+    };
+
+    template <typename T>
+    constexpr NumberFormatKind NumberFormatKindOf<T>::value;
+
+  }
+}
+#endif
@@ -0,0 +1,54 @@
+#include "ReassemblingLogMessageReceiver.hpp"
+#include <algorithm>
+
+using namespace pistis::logging;
+
+ReassemblingLogMessageReceiver::ReassemblingLogMessageReceiver(
+    LogMessageReceiver* next
+):
+    next_(next), pending_(), sync_() {
+  // Intentionally left blank
+}
+
+ReassemblingLogMessageReceiver::~ReassemblingLogMessageReceiver() {
+  for (auto& statement : pending_) {
+    forward_(statement.second);
+  }
+}
+
+size_t ReassemblingLogMessageReceiver::numPending() const {
+  std::unique_lock<std::mutex> lock(sync_);
+  return pending_.size();
+}
+
+void ReassemblingLogMessageReceiver::receive(LogMessage* msg) {
+  std::unique_lock<std::mutex> lock(sync_);
+  if (!msg->isMultiPart()) {
+    next_->receive(msg);
+  } else if (!msg->isFinalPart()) {
+    pending_[msg->statementId()].push_back(msg);
+  } else {
+    auto i= pending_.find(msg->statementId());
+    if (i == pending_.end()) {
+      next_->receive(msg);
+    } else {
+      i->second.push_back(msg);
+      forward_(i->second);
+      pending_.erase(i);
+    }
+  }
+}
+
+void ReassemblingLogMessageReceiver::forward_(
+    std::vector<LogMessage*>& parts
+) {
+  // Each writer sends its parts in order, so this only matters for
+  // receivers that reorder messages before they get here
+  std::stable_sort(parts.begin(), parts.end(),
+		   [](const LogMessage* left, const LogMessage* right) {
+		     return left->partNumber() < right->partNumber();
+		   });
+  for (auto msg : parts) {
+    next_->receive(msg);
+  }
+}
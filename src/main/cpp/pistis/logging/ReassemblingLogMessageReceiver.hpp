@@ -0,0 +1,52 @@
+#ifndef __PISTIS__LOGGING__REASSEMBLINGLOGMESSAGERECEIVER_HPP__
+#define __PISTIS__LOGGING__REASSEMBLINGLOGMESSAGERECEIVER_HPP__
+
+#include <pistis/logging/LogMessageReceiver.hpp>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Holds back the parts of a statement that was too large for
+     *         one message until the statement is complete, then passes
+     *         them on to another LogMessageReceiver one after another.
+     *
+     *  Parts from different threads may arrive interleaved, but <tt>next</tt>
+     *  receives all the parts of a statement in order, with no other
+     *  messages between them.  Messages that are not part of a larger
+     *  statement are passed on as soon as they arrive.  Parts of
+     *  statements that are still incomplete when the
+     *  ReassemblingLogMessageReceiver is destroyed are passed on then.
+     *
+     *  Safe to call from multiple threads, but <tt>next</tt> is called
+     *  with a lock held, so it does not need to be.
+     */
+    class ReassemblingLogMessageReceiver : public LogMessageReceiver {
+    public:
+      ReassemblingLogMessageReceiver(LogMessageReceiver* next);
+      ReassemblingLogMessageReceiver(const ReassemblingLogMessageReceiver&) =
+	  delete;
+      virtual ~ReassemblingLogMessageReceiver();
+
+      /** @brief Number of statements waiting for their final part */
+      size_t numPending() const;
+
+      virtual void receive(LogMessage* msg);
+
+      ReassemblingLogMessageReceiver& operator=(
+	  const ReassemblingLogMessageReceiver&
+      ) = delete;
+
+    private:
+      LogMessageReceiver* next_;
+      std::unordered_map< uint64_t, std::vector<LogMessage*> > pending_;
+      mutable std::mutex sync_;
+
+      void forward_(std::vector<LogMessage*>& parts);
+    };
+
+  }
+}
+#endif
@@ -0,0 +1,237 @@
+#include "ShardedLogMessagePool.hpp"
+#include "LogMessagePool.hpp"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+using namespace pistis::logging;
+
+namespace {
+  const size_t CACHE_LINE_SIZE= 64;
+
+  void* tagFor(size_t shard) { return (void*)(uintptr_t)(shard + 1); }
+
+  size_t shardOf(const LogMessage* msg) {
+    return (size_t)(uintptr_t)msg->factoryTag() - 1;
+  }
+}
+
+/** @brief A LogMessagePool for one node or CPU, with counts that only
+ *         threads using the shard touch
+ */
+class ShardedLogMessagePool::Shard_ : public LogMessagePool {
+public:
+  Shard_(size_t index, size_t initialMessageSize, size_t maxMessageSize,
+	 size_t maxReturnedMessageSize, uint32_t initialSize,
+	 uint32_t maxSize, LogMemoryResource* resource):
+      LogMessagePool(initialMessageSize, maxMessageSize,
+		     maxReturnedMessageSize, initialSize, maxSize, resource),
+      index_(index), numIssued_(0), numReturned_(0) {
+    // The initial messages were created before create() could tag them
+    std::vector<LogMessage*> initial;
+    getMessagesInPool_(std::back_inserter(initial));
+    for (auto msg : initial) {
+      msg->setFactoryTag(tagFor(index_));
+    }
+  }
+
+  size_t numMessages() const { return numMessagesInPool_(); }
+  LogMessage* take(size_t sizeHint) { return popMessage_(sizeHint); }
+
+  LogMessage* create(size_t sizeHint) {
+    LogMessage* msg= createMessage_(sizeHint);
+    msg->setFactoryTag(tagFor(index_));
+    return msg;
+  }
+
+  void give(LogMessage* msg) { LogMessagePool::release_(msg); }
+
+  uint64_t numIssued() const {
+    return numIssued_.load(std::memory_order_acquire);
+  }
+
+  uint64_t numReturned() const {
+    return numReturned_.load(std::memory_order_seq_cst);
+  }
+
+  void countIssued() { numIssued_.fetch_add(1, std::memory_order_release); }
+
+  void countReturned() {
+    numReturned_.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+private:
+  size_t index_;
+  char issuedPad_[CACHE_LINE_SIZE];
+  std::atomic<uint64_t> numIssued_;
+  char returnedPad_[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+  std::atomic<uint64_t> numReturned_;
+  char endPad_[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+};
+
+ShardedLogMessagePool::ShardedLogMessagePool(size_t initialMessageSize,
+					     size_t maxMessageSize,
+					     size_t maxReturnedMessageSize,
+					     uint32_t initialShardSize,
+					     uint32_t maxShardSize,
+					     LogShardPolicy policy,
+					     const LogCpuTopology& topology,
+					     LogMemoryResource* resource):
+    ShardedLogMessagePool(initialMessageSize, maxMessageSize,
+			  maxReturnedMessageSize, initialShardSize,
+			  maxShardSize, policy, topology,
+			  std::vector<LogMemoryResource*>(topology.numNodes(),
+							  resource)) {
+  // Intentionally left blank
+}
+
+ShardedLogMessagePool::ShardedLogMessagePool(
+    size_t initialMessageSize, size_t maxMessageSize,
+    size_t maxReturnedMessageSize, uint32_t initialShardSize,
+    uint32_t maxShardSize, LogShardPolicy policy,
+    const LogCpuTopology& topology,
+    const std::vector<LogMemoryResource*>& nodeResources
+):
+    policy_(policy), topology_(topology), nodeResources_(nodeResources),
+    shards_(), shardOfCpu_(shardsForCpus_()),
+    fallbacks_(fallbacksForShards_()), numRemoteGets_(0) {
+  if ((nodeResources_.size() != topology_.numNodes()) ||
+      (std::find(nodeResources_.begin(), nodeResources_.end(), nullptr) !=
+         nodeResources_.end())) {
+    throw std::invalid_argument("A ShardedLogMessagePool needs a memory "
+				"resource for each node");
+  }
+  for (auto node : nodesOfShards_()) {
+    shards_.emplace_back(new Shard_(shards_.size(), initialMessageSize,
+				    maxMessageSize, maxReturnedMessageSize,
+				    initialShardSize, maxShardSize,
+				    nodeResources_[node]));
+  }
+}
+
+ShardedLogMessagePool::~ShardedLogMessagePool() {
+  // Intentionally left blank
+}
+
+size_t ShardedLogMessagePool::currentShard() const {
+  if (policy_ == LogShardPolicy::PER_CPU) {
+    // A CPU brought online after the pool was made has no shard
+    const uint32_t cpu= topology_.currentCpu();
+    return (cpu < shardOfCpu_.size()) ? shardOfCpu_[cpu] : 0;
+  }
+  return topology_.currentNode();
+}
+
+size_t ShardedLogMessagePool::numMessagesInShard(size_t shard) const {
+  if (shard >= shards_.size()) {
+    throw std::invalid_argument("No such shard");
+  }
+  return shards_[shard]->numMessages();
+}
+
+LogMessage* ShardedLogMessagePool::get_() {
+  return get_(0);
+}
+
+LogMessage* ShardedLogMessagePool::get_(size_t sizeHint) {
+  const size_t home= currentShard();
+  Shard_* shard= shards_[home].get();
+  LogMessage* msg= shard->take(sizeHint);
+
+  if (!msg) {
+    for (auto other : fallbacks_[home]) {
+      msg= shards_[other]->take(sizeHint);
+      if (msg) {
+	numRemoteGets_.fetch_add(1, std::memory_order_relaxed);
+	break;
+      }
+    }
+  }
+
+  if (!msg) {
+    // Every shard is empty
+    msg= shard->create(sizeHint);
+  }
+  shard->countIssued();
+  return msg;
+}
+
+void ShardedLogMessagePool::release_(LogMessage* msg) {
+  shards_[shardOf(msg)]->give(msg);
+}
+
+void ShardedLogMessagePool::messageIssued_() {
+  // Counted by get_(), which already knows the caller's shard
+}
+
+void ShardedLogMessagePool::messageReturned_() {
+  // Counted on the releasing thread's shard, once release_() has given
+  // the message back to its own.  The pool may be destroyed as soon as
+  // the count shows every message returned
+  shards_[currentShard()]->countReturned();
+}
+
+size_t ShardedLogMessagePool::countMessagesActive_() const {
+  // Messages may be counted as returned on a different shard than
+  // issued them, so only the totals balance
+  uint64_t numIssued= 0;
+  uint64_t numReturned= 0;
+  for (const auto& shard : shards_) {
+    numReturned += shard->numReturned();
+  }
+  for (const auto& shard : shards_) {
+    numIssued += shard->numIssued();
+  }
+  return (size_t)(numIssued - numReturned);
+}
+
+std::vector<uint32_t> ShardedLogMessagePool::nodesOfShards_() const {
+  std::vector<uint32_t> nodes;
+  if (policy_ == LogShardPolicy::PER_CPU) {
+    for (auto cpu : topology_.cpus()) {
+      nodes.push_back(topology_.nodeOf(cpu));
+    }
+  } else {
+    for (uint32_t node= 0; node < topology_.numNodes(); ++node) {
+      nodes.push_back(node);
+    }
+  }
+  return nodes;
+}
+
+std::vector<size_t> ShardedLogMessagePool::shardsForCpus_() const {
+  std::vector<size_t> shards;
+  if (policy_ == LogShardPolicy::PER_CPU) {
+    const auto& cpus= topology_.cpus();
+    shards.resize(cpus.back() + 1, 0);
+    for (size_t shard= 0; shard < cpus.size(); ++shard) {
+      shards[cpus[shard]]= shard;
+    }
+  }
+  return shards;
+}
+
+std::vector< std::vector<size_t> >
+    ShardedLogMessagePool::fallbacksForShards_() const {
+  std::vector< std::vector<size_t> > fallbacks;
+  if (policy_ == LogShardPolicy::PER_CPU) {
+    for (auto cpu : topology_.cpus()) {
+      std::vector<size_t> others;
+      for (auto node : topology_.nodesNearestTo(topology_.nodeOf(cpu))) {
+	for (auto other : topology_.cpusOn(node)) {
+	  if (other != cpu) {
+	    others.push_back(shardOfCpu_[other]);
+	  }
+	}
+      }
+      fallbacks.push_back(others);
+    }
+  } else {
+    for (uint32_t node= 0; node < topology_.numNodes(); ++node) {
+      const auto& nearest= topology_.nodesNearestTo(node);
+      fallbacks.push_back(std::vector<size_t>(nearest.begin() + 1,
+					      nearest.end()));
+    }
+  }
+  return fallbacks;
+}
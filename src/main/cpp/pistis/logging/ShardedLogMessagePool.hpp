@@ -0,0 +1,150 @@
+#ifndef __PISTIS__LOGGING__SHARDEDLOGMESSAGEPOOL_HPP__
+#define __PISTIS__LOGGING__SHARDEDLOGMESSAGEPOOL_HPP__
+
+#include <pistis/logging/AbstractLogMessageFactory.hpp>
+#include <pistis/logging/LogCpuTopology.hpp>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief How a ShardedLogMessagePool divides its messages */
+    enum class LogShardPolicy {
+      /** @brief One shard for each NUMA node */
+      PER_NODE,
+
+      /** @brief One shard for each CPU */
+      PER_CPU
+    };
+
+    /** @brief LogMessageFactory that splits its pool into shards, one
+     *         for each NUMA node or each CPU.
+     *
+     *  get() takes a message from the shard of the CPU the calling
+     *  thread runs on.  When that shard is empty, it tries the other
+     *  shards, nearest first: other CPUs on the same node before other
+     *  nodes, and nearer nodes before farther ones.  Only when every
+     *  shard is empty does it allocate a new message, which belongs to
+     *  the caller's shard.  A released message goes back to the shard
+     *  it belongs to, whichever thread releases it, so a message that
+     *  a writer thread on one node releases for a producer on another
+     *  still returns to the producer's node.
+     *
+     *  Each shard allocates its messages, and the messages allocate
+     *  the text they grow into, from the LogMemoryResource of the
+     *  shard's node.  Given a resource per node that binds its memory
+     *  to that node, e.g. with mbind() and LogCpuTopology::
+     *  systemNodeId(), every message lives in its shard's node's
+     *  memory, whichever thread allocates it and whenever.  Given a
+     *  single resource, all shards share it, and messages live
+     *  wherever it puts them.
+     *
+     *  Each shard is a lock-free LogMessagePool with counts of its own,
+     *  so threads on different nodes share no cache lines when they get
+     *  and release messages.  numMessagesActive() adds up the counts of
+     *  every shard.
+     */
+    class ShardedLogMessagePool : public AbstractLogMessageFactory {
+    public:
+      /** @brief Create a pool with one shard for each node or CPU in
+       *         <tt>topology</tt>
+       *
+       *  @param initialShardSize  Number of messages allocated for each
+       *                             shard up front
+       *  @param maxShardSize      Most messages each shard keeps
+       *  @param resource          Where every shard allocates messages
+       */
+      ShardedLogMessagePool(size_t initialMessageSize,
+			    size_t maxMessageSize,
+			    size_t maxReturnedMessageSize,
+			    uint32_t initialShardSize, uint32_t maxShardSize,
+			    LogShardPolicy policy= LogShardPolicy::PER_NODE,
+			    const LogCpuTopology& topology=
+			        LogCpuTopology::system(),
+			    LogMemoryResource* resource=
+			        LogMemoryResource::defaultResource());
+
+      /** @brief Create a pool whose shards allocate messages from the
+       *         resource of their node
+       *
+       *  @param nodeResources  The resource of each node in
+       *                          <tt>topology</tt>, which must outlive
+       *                          the pool and its messages
+       *  @throws std::invalid_argument if <tt>nodeResources</tt> does not
+       *            have one resource for each node
+       */
+      ShardedLogMessagePool(size_t initialMessageSize,
+			    size_t maxMessageSize,
+			    size_t maxReturnedMessageSize,
+			    uint32_t initialShardSize, uint32_t maxShardSize,
+			    LogShardPolicy policy,
+			    const LogCpuTopology& topology,
+			    const std::vector<LogMemoryResource*>&
+			        nodeResources);
+      ShardedLogMessagePool(const ShardedLogMessagePool&) = delete;
+      virtual ~ShardedLogMessagePool();
+
+      LogShardPolicy policy() const { return policy_; }
+      const LogCpuTopology& topology() const { return topology_; }
+      size_t numShards() const { return shards_.size(); }
+
+      /** @brief Where the shards of <tt>node</tt> allocate messages */
+      LogMemoryResource* nodeResource(uint32_t node) const {
+	return nodeResources_[node];
+      }
+
+      /** @brief The shard the calling thread gets messages from */
+      size_t currentShard() const;
+
+      /** @brief Number of messages in <tt>shard</tt> */
+      size_t numMessagesInShard(size_t shard) const;
+
+      /** @brief Number of times get() took a message from a shard other
+       *         than the caller's, because the caller's was empty
+       */
+      uint64_t numRemoteGets() const {
+	return numRemoteGets_.load(std::memory_order_relaxed);
+      }
+
+      ShardedLogMessagePool& operator=(const ShardedLogMessagePool&) = delete;
+
+    protected:
+      virtual LogMessage* get_();
+      virtual LogMessage* get_(size_t sizeHint);
+      virtual void release_(LogMessage* msg);
+
+      virtual void messageIssued_();
+      virtual void messageReturned_();
+      virtual size_t countMessagesActive_() const;
+
+    private:
+      class Shard_;
+
+      LogShardPolicy policy_;
+      const LogCpuTopology& topology_;
+      std::vector<LogMemoryResource*> nodeResources_;
+      std::vector< std::unique_ptr<Shard_> > shards_;
+
+      /** @brief The shard of each CPU id, for pools with a shard per
+       *         CPU.  CPU ids may have gaps, so shards are numbered in
+       *         the order of LogCpuTopology::cpus().
+       */
+      std::vector<size_t> shardOfCpu_;
+
+      /** @brief For each shard, the other shards in the order get()
+       *         tries them
+       */
+      std::vector< std::vector<size_t> > fallbacks_;
+      std::atomic<uint64_t> numRemoteGets_;
+
+      /** @brief The node of each shard */
+      std::vector<uint32_t> nodesOfShards_() const;
+      std::vector<size_t> shardsForCpus_() const;
+      std::vector< std::vector<size_t> > fallbacksForShards_() const;
+    };
+
+  }
+}
+#endif
@@ -3,18 +3,20 @@
 using namespace pistis::logging;
 
 SimpleLogMessageFactory::SimpleLogMessageFactory(size_t initialMessageSize,
-						 size_t maxMessageSize):
+						 size_t maxMessageSize,
+						 LogMemoryResource* resource):
   AbstractLogMessageFactory(), initialMessageSize_(initialMessageSize),
-  maxMessageSize_(maxMessageSize) {
+  maxMessageSize_(maxMessageSize), resource_(resource) {
 }
 
 SimpleLogMessageFactory::~SimpleLogMessageFactory() {
 }
 
 LogMessage* SimpleLogMessageFactory::get_() {
-  return new LogMessage(initialMessageSize(), maxMessageSize());
+  return LogMessage::create(initialMessageSize(), maxMessageSize(),
+			    resource_);
 }
 
 void SimpleLogMessageFactory::release_(LogMessage* msg) {
-  delete msg;
+  LogMessage::destroy(msg);
 }
@@ -9,19 +9,26 @@ namespace pistis {
     class SimpleLogMessageFactory : public AbstractLogMessageFactory {
     public:
       SimpleLogMessageFactory(size_t initialMessageSize,
-			      size_t maxMessageSize);
+			      size_t maxMessageSize,
+			      LogMemoryResource* resource=
+				  LogMemoryResource::defaultResource());
       virtual ~SimpleLogMessageFactory();
 
       size_t initialMessageSize() const { return initialMessageSize_; }
       size_t maxMessageSize() const { return maxMessageSize_; }
 
+      /** @brief Where the factory allocates messages */
+      LogMemoryResource* resource() const { return resource_; }
+
     protected:
+      using AbstractLogMessageFactory::get_;
       virtual LogMessage* get_() override;
       virtual void release_(LogMessage* msg) override;
 	
     private:
       size_t initialMessageSize_;
       size_t maxMessageSize_;
+      LogMemoryResource* resource_;
     };
 
   }
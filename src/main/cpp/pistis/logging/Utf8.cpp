@@ -0,0 +1,124 @@
+#include "Utf8.hpp"
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace pistis::logging;
+
+namespace {
+  static const uint32_t REPLACEMENT_CHARACTER= 0xFFFD;
+
+  /** @brief Convert as many leading ASCII characters as possible, sixteen
+   *         at a time
+   *
+   *  @returns The number of characters converted
+   */
+  size_t convertAscii(const wchar_t* in, size_t n, char* out,
+		      size_t outSize) {
+    size_t i= 0;
+#if defined(__SSE2__)
+    if (sizeof(wchar_t) == 4) {
+      const __m128i nonAscii= _mm_set1_epi32(~0x7F);
+      const size_t limit= (n < outSize) ? n : outSize;
+      for (; i + 16 <= limit; i += 16) {
+	const __m128i a= _mm_loadu_si128((const __m128i*)(in + i));
+	const __m128i b= _mm_loadu_si128((const __m128i*)(in + i + 4));
+	const __m128i c= _mm_loadu_si128((const __m128i*)(in + i + 8));
+	const __m128i d= _mm_loadu_si128((const __m128i*)(in + i + 12));
+	const __m128i any=
+	    _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)),
+			  nonAscii);
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128()))
+	      != 0xFFFF) {
+	  break;  // Let the scalar code find the first non-ASCII character
+	}
+	// Every value is below 0x80, so narrowing with saturation is exact
+	const __m128i ab= _mm_packs_epi32(a, b);
+	const __m128i cd= _mm_packs_epi32(c, d);
+	_mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(ab, cd));
+      }
+    }
+#endif
+    while ((i < n) && (i < outSize) && ((uint32_t)in[i] < 0x80)) {
+      out[i]= (char)in[i];
+      ++i;
+    }
+    return i;
+  }
+
+  size_t utf8Size(uint32_t cp) {
+    return (cp < 0x80) ? 1 : (cp < 0x800) ? 2 : (cp < 0x10000) ? 3 : 4;
+  }
+
+  char* writeUtf8(char* out, uint32_t cp) {
+    if (cp < 0x80) {
+      *out++ = (char)cp;
+    } else if (cp < 0x800) {
+      *out++ = (char)(0xC0 | (cp >> 6));
+      *out++ = (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      *out++ = (char)(0xE0 | (cp >> 12));
+      *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+      *out++ = (char)(0x80 | (cp & 0x3F));
+    } else {
+      *out++ = (char)(0xF0 | (cp >> 18));
+      *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+      *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+      *out++ = (char)(0x80 | (cp & 0x3F));
+    }
+    return out;
+  }
+
+  bool isSurrogate(uint32_t c) { return (c >= 0xD800) && (c < 0xE000); }
+  bool isHighSurrogate(uint32_t c) { return (c >= 0xD800) && (c < 0xDC00); }
+  bool isLowSurrogate(uint32_t c) { return (c >= 0xDC00) && (c < 0xE000); }
+}
+
+size_t pistis::logging::encodeUtf8(const wchar_t* in, size_t n, char* out,
+				   size_t outSize, size_t& nWritten) {
+  size_t i= 0;
+  size_t j= 0;
+
+  while (i < n) {
+    const size_t nAscii= convertAscii(in + i, n - i, out + j, outSize - j);
+    i += nAscii;
+    j += nAscii;
+    if ((i == n) || (j == outSize)) {
+      break;
+    }
+
+    // in[i] is not ASCII
+    uint32_t cp= (uint32_t)in[i];
+    size_t nUnits= 1;
+    if (sizeof(wchar_t) == 2) {
+      cp &= 0xFFFF;
+      if (isHighSurrogate(cp)) {
+	if (i + 1 == n) {
+	  break;  // Wait for the low surrogate
+	}
+	const uint32_t low= (uint32_t)in[i + 1] & 0xFFFF;
+	if (isLowSurrogate(low)) {
+	  cp= 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+	  nUnits= 2;
+	} else {
+	  cp= REPLACEMENT_CHARACTER;
+	}
+      } else if (isSurrogate(cp)) {
+	cp= REPLACEMENT_CHARACTER;
+      }
+    } else if ((cp > 0x10FFFF) || isSurrogate(cp)) {
+      cp= REPLACEMENT_CHARACTER;
+    }
+
+    if (utf8Size(cp) > outSize - j) {
+      break;
+    }
+    j= (size_t)(writeUtf8(out + j, cp) - out);
+    i += nUnits;
+  }
+
+  nWritten= j;
+  return i;
+}
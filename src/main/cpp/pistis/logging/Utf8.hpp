@@ -0,0 +1,35 @@
+#ifndef __PISTIS__LOGGING__UTF8_HPP__
+#define __PISTIS__LOGGING__UTF8_HPP__
+
+#include <stddef.h>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Most bytes encodeUtf8() writes for a single wchar_t */
+    static constexpr size_t MAX_UTF8_BYTES_PER_WCHAR= 4;
+
+    /** @brief Encode wide characters as UTF-8.
+     *
+     *  Wide characters are UTF-32 if wchar_t has 32 bits and UTF-16 if it
+     *  has 16.  Invalid code points and unpaired surrogates are replaced
+     *  by U+FFFD.  Encoding stops early rather than write part of a
+     *  character's encoding, and, for UTF-16, rather than separate a
+     *  high surrogate at the end of <tt>in</tt> from the low surrogate
+     *  that may follow it, so the caller can pass the remaining input
+     *  in again later.  Runs of ASCII characters are converted
+     *  several at a time with SSE2 when it is available.
+     *
+     *  @param in        Wide characters to encode
+     *  @param n         Number of characters in <tt>in</tt>
+     *  @param out       Where to write the UTF-8 encoding
+     *  @param outSize   Room available at <tt>out</tt>
+     *  @param nWritten  Set to the number of bytes written to <tt>out</tt>
+     *  @returns The number of characters from <tt>in</tt> consumed
+     */
+    size_t encodeUtf8(const wchar_t* in, size_t n, char* out, size_t outSize,
+		      size_t& nWritten);
+
+  }
+}
+#endif
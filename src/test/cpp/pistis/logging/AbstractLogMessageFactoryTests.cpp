@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <set>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "helpers/Join.hpp"
@@ -34,6 +37,46 @@ TEST(AbstractLogMessageFactoryTests, GetAndRelease) {
   EXPECT_FALSE(factory.hasErrors()) << factory.errorDetails();
 }
 
+TEST(AbstractLogMessageFactoryTests, ReleaseSegments) {
+  TrackingLogMessageFactory factory(16, 64);
+  LogMessage* msg= factory.get();
+  LogMessage* first= factory.get();
+  LogMessage* second= factory.get();
+
+  EXPECT_FALSE(factory.segmented());
+  factory.setSegmented(true);
+  EXPECT_TRUE(factory.segmented());
+
+  msg->appendSegment(first);
+  msg->appendSegment(second);
+  EXPECT_EQ(factory.numMessagesActive(), 3);
+
+  // The segments go back to the factory along with the message
+  factory.release(msg);
+  EXPECT_EQ(factory.numMessagesActive(), 0);
+  EXPECT_EQ(factory.issuedMessages().size(), 0);
+  ASSERT_EQ(factory.releasedMessages().size(), 3);
+  EXPECT_EQ(first->nextSegment(), nullptr);
+  EXPECT_FALSE(factory.hasErrors()) << factory.errorDetails();
+}
+
+TEST(AbstractLogMessageFactoryTests, ReleaseSharedMessage) {
+  TrackingLogMessageFactory factory(16, 64);
+  LogMessage* msg= factory.get();
+
+  msg->addReferences(2);
+  factory.release(msg);
+  factory.release(msg);
+  EXPECT_EQ(factory.numMessagesActive(), 1);
+  EXPECT_EQ(factory.releasedMessages().size(), 0);
+
+  factory.release(msg);
+  EXPECT_EQ(factory.numMessagesActive(), 0);
+  ASSERT_EQ(factory.releasedMessages().size(), 1);
+  EXPECT_EQ(msg->numReferences(), 1);
+  EXPECT_FALSE(factory.hasErrors()) << factory.errorDetails();
+}
+
 TEST(AbstractLogMessageFactoryTests, SimultaneousGetTest) {
   static const size_t INITIAL_CAPACITY=128;
   static const size_t MAX_CAPACITY= 1024;
@@ -281,3 +324,38 @@ TEST(AbstractLogMessageFactoryTests, WaitTest) {
 
   exitGate1.open();
 }
+
+TEST(AbstractLogMessageFactoryTests, WakeWaitersOnLastRelease) {
+  static const size_t INITIAL_CAPACITY = 128;
+  static const size_t MAX_CAPACITY = 1024;
+  TrackingLogMessageFactory factory(INITIAL_CAPACITY, MAX_CAPACITY);
+  LogMessage* first= factory.get();
+  LogMessage* second= factory.get();
+  std::atomic<bool> done(false);
+  bool allReturned= false;
+  std::chrono::system_clock::time_point wokeAt;
+
+  // Waiters do not look for themselves, so unless the last release
+  // wakes it, the waiter sleeps until its deadline
+  const auto deadline=
+      std::chrono::system_clock::now() + std::chrono::seconds(10);
+  std::thread waiter([&]() {
+    allReturned= factory.waitUntilAllReturned(deadline);
+    wokeAt= std::chrono::system_clock::now();
+    done= true;
+  });
+
+  while (factory.numWaitingUntilAllReturned() != 1) {
+    std::this_thread::yield();
+  }
+  factory.release(first);
+  EXPECT_FALSE(done);
+
+  factory.release(second);
+  waiter.join();
+
+  EXPECT_TRUE(allReturned);
+  EXPECT_LT(wokeAt, deadline - std::chrono::seconds(5));
+  EXPECT_EQ(factory.numWaitingUntilAllReturned(), 0);
+  EXPECT_FALSE(factory.hasErrors()) << factory.errorDetails();
+}
@@ -0,0 +1,118 @@
+#include <pistis/logging/BinaryLogMessage.hpp>
+#include <pistis/logging/SimpleLogMessageFactory.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <sstream>
+
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+namespace {
+  struct Point {
+    int x;
+    int y;
+  };
+
+  std::ostream& operator<<(std::ostream& out, const Point& p) {
+    return out << "(" << p.x << ", " << p.y << ")";
+  }
+
+  std::string toText(const LogMessage* msg) {
+    return std::string(msg->begin(), msg->end());
+  }
+}
+
+TEST(BinaryLogMessageTests, WriteAndDecode) {
+  static constexpr LogSite SITE(
+      "{} {} {} {} {} {} {} {} {} {}", "test.cpp", 10, LogLevel::INFO
+  );
+  const std::string DESTINATION= "some.destination";
+  const std::string TEXT= "a std::string";
+  int x= 0;
+  std::ostringstream truth;
+  SimpleLogMessageFactory msgFactory(16, 1024);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogMessage msg(16, 1024);
+
+  truth << "true c " << std::numeric_limits<int64_t>::min() << " "
+	<< std::numeric_limits<uint64_t>::max() << " 0.25 a C string "
+	<< TEXT << " (3, -4) " << (void*)&x << " 0x0";
+  {
+    // Everything but the site and the numbers is copied, so the
+    // arguments do not have to outlive the message
+    std::string text(TEXT);
+    Point point{ 3, -4 };
+    const FormatArg args[]= {
+      FormatArg(true), FormatArg('c'),
+      FormatArg(std::numeric_limits<int64_t>::min()),
+      FormatArg(std::numeric_limits<uint64_t>::max()), FormatArg(0.25),
+      FormatArg("a C string"), FormatArg(text), FormatArg(point),
+      FormatArg(&x), FormatArg(nullptr)
+    };
+    ASSERT_TRUE(writeBinaryLogMessage(msg, SITE, args, 10));
+  }
+  EXPECT_EQ(msg.encoding(), LogMessageEncoding::BINARY);
+  EXPECT_EQ(BinaryLogDecoder::siteOf(msg), &SITE);
+
+  BinaryLogDecoder decoder;
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::INFO);
+    EXPECT_TRUE(decoder.write(msg, out));
+  }
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  EXPECT_EQ(toText(msgReceiver.messages()[0]), truth.str());
+  EXPECT_EQ(msgReceiver.messages()[0]->encoding(), LogMessageEncoding::TEXT);
+}
+
+TEST(BinaryLogMessageTests, WriteTooLarge) {
+  static constexpr LogSite SITE("{}", "test.cpp", 10, LogLevel::INFO);
+  const std::string TEXT(64, 'x');
+  const FormatArg args[]= { FormatArg(TEXT) };
+  LogMessage msg(16, 64);
+
+  EXPECT_FALSE(writeBinaryLogMessage(msg, SITE, args, 1));
+}
+
+TEST(BinaryLogMessageTests, DecodeTextMessage) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(16, 1024);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogMessage msg(16);
+  BinaryLogDecoder decoder;
+
+  EXPECT_EQ(BinaryLogDecoder::siteOf(msg), nullptr);
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::INFO);
+    EXPECT_FALSE(decoder.write(msg, out));
+  }
+  EXPECT_EQ(msgReceiver.messages().size(), 0);
+}
+
+TEST(BinaryLogMessageTests, RegisterSites) {
+  static constexpr LogSite SITE_1("First {}", "test.cpp", 10,
+				  LogLevel::INFO);
+  static constexpr LogSite SITE_2("Second {}", "test.cpp", 20,
+				  LogLevel::WARN);
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(16, 1024);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  BinaryLogDecoder decoder;
+
+  EXPECT_FALSE(decoder.isRegistered(SITE_1));
+  EXPECT_EQ(decoder.registerSite(SITE_1), 0);
+  EXPECT_EQ(decoder.registerSite(SITE_2), 1);
+  EXPECT_EQ(decoder.registerSite(SITE_1), 0);
+  EXPECT_TRUE(decoder.isRegistered(SITE_1));
+  EXPECT_EQ(decoder.numSites(), 2);
+
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::WARN);
+    decoder.writeDictionaryEntry(SITE_2, out);
+  }
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  EXPECT_EQ(toText(msgReceiver.messages()[0]), "1 WARN test.cpp:20 Second {}");
+}
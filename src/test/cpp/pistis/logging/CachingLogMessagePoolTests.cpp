@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "helpers/TestingCachingLogMessagePool.hpp"
+
+using namespace pistis::logging;
+
+TEST(CachingLogMessagePoolTests, GetFromThreadCache) {
+  TestingCachingLogMessagePool pool(128, 1024, 256, 8, 16, 4);
+
+  // The first get moves a batch of half the cache size from the pool
+  LogMessage* msg= pool.get();
+  EXPECT_TRUE(msg->empty());
+  EXPECT_EQ(pool.numMessagesInPool(), 6);
+  EXPECT_EQ(pool.numMessagesInThreadCache(), 1);
+  EXPECT_EQ(pool.numMessagesActive(), 1);
+
+  // After that, the thread gets and releases without the pool
+  msg->setEnd(msg->begin() + 10);
+  pool.release(msg);
+  EXPECT_EQ(pool.numMessagesInThreadCache(), 2);
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+
+  LogMessage* next= pool.get();
+  EXPECT_EQ(next, msg);
+  EXPECT_TRUE(next->empty());
+  EXPECT_EQ(pool.numMessagesInPool(), 6);
+  pool.release(next);
+  EXPECT_EQ(pool.numThreadCaches(), 1);
+}
+
+TEST(CachingLogMessagePoolTests, FullCacheDrainsToPool) {
+  TestingCachingLogMessagePool pool(128, 1024, 256, 0, 16, 4);
+  std::vector<LogMessage*> msgs;
+
+  for (int i= 0; i < 6; ++i) {
+    msgs.push_back(pool.get());
+  }
+  EXPECT_EQ(pool.numMessagesInPool(), 0);
+
+  // The fifth release overflows the cache, which keeps half its size
+  for (auto msg : msgs) {
+    pool.release(msg);
+  }
+  EXPECT_EQ(pool.numMessagesInThreadCache(), 3);
+  EXPECT_EQ(pool.numMessagesInPool(), 3);
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+}
+
+TEST(CachingLogMessagePoolTests, LargeMessagesBypassThreadCache) {
+  TestingCachingLogMessagePool pool(128, 4096, 1024, 2, 16, 4);
+
+  LogMessage* large= pool.get(600);
+  EXPECT_EQ(large->capacity(), 1024);
+  pool.release(large);
+  EXPECT_EQ(pool.numMessagesInThreadCache(), 0);
+  EXPECT_EQ(pool.numMessagesInPool(), 3);
+
+  // Small gets leave it for the next large write
+  LogMessage* small= pool.get();
+  EXPECT_EQ(small->capacity(), 128);
+  EXPECT_EQ(pool.get(600), large);
+  pool.release(small);
+  pool.release(large);
+  EXPECT_EQ(pool.numMessagesInThreadCache(), 2);
+  EXPECT_EQ(pool.numMessagesInPool(), 1);
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+}
+
+TEST(CachingLogMessagePoolTests, ReleaseOnAnotherThread) {
+  TestingCachingLogMessagePool pool(128, 1024, 256, 0, 16, 4);
+  LogMessage* msg= pool.get();
+
+  std::thread([&pool, msg]() { pool.release(msg); }).join();
+
+  // The message went back to this thread, not the pool, and
+  // every thread's counts add up
+  EXPECT_EQ(pool.numMessagesInPool(), 0);
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+  EXPECT_TRUE(pool.waitUntilAllReturned(std::chrono::system_clock::now()));
+  EXPECT_EQ(pool.get(), msg);
+  pool.release(msg);
+}
+
+TEST(CachingLogMessagePoolTests, ReturnToAnotherThreadInBatches) {
+  // Batches of four messages
+  TestingCachingLogMessagePool pool(128, 1024, 256, 0, 16, 8);
+  std::vector<LogMessage*> messages;
+  for (int i= 0; i < 6; ++i) {
+    messages.push_back(pool.get());
+  }
+
+  std::atomic<int> step(0);
+  std::thread releaser([&pool, &messages, &step]() {
+    for (int i= 0; i < 3; ++i) {
+      pool.release(messages[i]);
+    }
+    step= 1;
+    while (step.load() != 2) {
+      std::this_thread::yield();
+    }
+    pool.release(messages[3]);
+    pool.release(messages[4]);
+    step= 3;
+    while (step.load() != 4) {
+      std::this_thread::yield();
+    }
+  });
+
+  while (step.load() != 1) {
+    std::this_thread::yield();
+  }
+  // Held by the releasing thread until the batch fills
+  EXPECT_EQ(pool.numMessagesReturnedToThread(), 0);
+  step= 2;
+
+  while (step.load() != 3) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(pool.numMessagesReturnedToThread(), 4);
+  step= 4;
+
+  // The rest of the batch comes back when the releasing thread exits
+  releaser.join();
+  EXPECT_EQ(pool.numMessagesReturnedToThread(), 5);
+  EXPECT_EQ(pool.numMessagesInPool(), 0);
+
+  pool.release(messages[5]);
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+}
+
+TEST(CachingLogMessagePoolTests, ExitedThreadsCacheIsReused) {
+  TestingCachingLogMessagePool pool(128, 1024, 256, 0, 16, 4);
+  LogMessage* msg= nullptr;
+
+  std::thread([&pool]() {
+    LogMessage* first= pool.get();
+    LogMessage* second= pool.get();
+    pool.release(first);
+    pool.release(second);
+  }).join();
+
+  // The exiting thread gave its messages back to the pool
+  EXPECT_EQ(pool.numMessagesInPool(), 2);
+  EXPECT_EQ(pool.numThreadCaches(), 1);
+
+  std::thread([&pool, &msg]() { msg= pool.get(); }).join();
+  EXPECT_EQ(pool.numThreadCaches(), 1);
+
+  // This thread takes over the cache msg belongs to, so msg goes
+  // straight back into it
+  pool.release(msg);
+  EXPECT_EQ(pool.numThreadCaches(), 1);
+  EXPECT_EQ(pool.numMessagesInThreadCache(), 1);
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+}
+
+TEST(CachingLogMessagePoolTests, ForgetDestroyedPools) {
+  for (int i= 0; i < 10; ++i) {
+    TestingCachingLogMessagePool pool(128, 1024, 256, 0, 16, 4);
+    pool.release(pool.get());
+  }
+
+  // The first use of a new pool drops the entries for the ones gone
+  TestingCachingLogMessagePool pool(128, 1024, 256, 0, 16, 4);
+  pool.release(pool.get());
+  EXPECT_EQ(TestingCachingLogMessagePool::numThreadCacheEntries(), 1);
+}
+
+TEST(CachingLogMessagePoolTests, ManyProducersOneWriter) {
+  static const size_t NUM_PRODUCERS= 4;
+  static const size_t MESSAGES_PER_PRODUCER= 1000;
+  TestingCachingLogMessagePool pool(128, 1024, 256, 16, 64, 8);
+  std::vector<LogMessage*> toWrite;
+  std::mutex sync;
+  std::vector<std::thread> producers;
+  std::set<LogMessage*> outstanding;
+  size_t numReissued= 0;
+
+  for (size_t i= 0; i < NUM_PRODUCERS; ++i) {
+    producers.emplace_back([&]() {
+      for (size_t j= 0; j < MESSAGES_PER_PRODUCER; ++j) {
+	LogMessage* msg= pool.get();
+	std::unique_lock<std::mutex> lock(sync);
+	if (!outstanding.insert(msg).second) {
+	  ++numReissued;
+	}
+	toWrite.push_back(msg);
+      }
+    });
+  }
+
+  size_t numWritten= 0;
+  while (numWritten < NUM_PRODUCERS * MESSAGES_PER_PRODUCER) {
+    std::vector<LogMessage*> batch;
+    {
+      std::unique_lock<std::mutex> lock(sync);
+      batch.swap(toWrite);
+      for (auto msg : batch) {
+	outstanding.erase(msg);
+      }
+    }
+    for (auto msg : batch) {
+      pool.release(msg);
+    }
+    numWritten += batch.size();
+    std::this_thread::yield();
+  }
+  for (auto& p : producers) {
+    p.join();
+  }
+
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+  EXPECT_LE(pool.numMessagesInPool(), pool.maxPoolSize());
+  EXPECT_EQ(numReissued, 0);
+}
+
+TEST(CachingLogMessagePoolTests, DestroyAsSoonAsAllReturned) {
+  static const size_t NUM_THREADS= 4;
+  static const size_t NUM_MESSAGES= 200;
+  static const int NUM_ROUNDS= 20;
+
+  for (int round= 0; round < NUM_ROUNDS; ++round) {
+    std::unique_ptr<CachingLogMessagePool> pool(
+	new CachingLogMessagePool(128, 1024, 256, 0, 16, 4)
+    );
+    std::atomic<size_t> numReady(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+
+    for (size_t i= 0; i < NUM_THREADS; ++i) {
+      // Messages from this thread go back to it from another one
+      std::vector<LogMessage*> fromMain;
+      for (size_t j= 0; j < NUM_MESSAGES; ++j) {
+	fromMain.push_back(pool->get());
+      }
+      threads.emplace_back([&pool, &numReady, &go, fromMain]() {
+	std::vector<LogMessage*> own;
+	for (size_t j= 0; j < NUM_MESSAGES; ++j) {
+	  own.push_back(pool->get());
+	  own.push_back(pool->get(600));
+	}
+	++numReady;
+	while (!go.load()) {
+	  std::this_thread::yield();
+	}
+	for (size_t j= 0; j < NUM_MESSAGES; ++j) {
+	  pool->release(fromMain[j]);
+	  pool->release(own[2 * j]);
+	  pool->release(own[2 * j + 1]);
+	}
+      });
+    }
+
+    while (numReady.load() < NUM_THREADS) {
+      std::this_thread::yield();
+    }
+    go= true;
+
+    // The pool is gone the moment the last message is counted as
+    // returned, while the releasing threads may still be running
+    EXPECT_TRUE(pool->waitUntilAllReturned(
+	std::chrono::system_clock::now() + std::chrono::seconds(10)
+    ));
+    pool.reset();
+
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+}
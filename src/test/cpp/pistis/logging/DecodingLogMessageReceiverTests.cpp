@@ -0,0 +1,65 @@
+#include <pistis/logging/DecodingLogMessageReceiver.hpp>
+#include <pistis/logging/LogMacros.hpp>
+#include <pistis/logging/SimpleLogMessageFactory.hpp>
+#include <gtest/gtest.h>
+
+#include "helpers/TestingLog.hpp"
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+namespace {
+  std::string toText(const LogMessage* msg) {
+    return std::string(msg->begin(), msg->end());
+  }
+}
+
+TEST(DecodingLogMessageReceiverTests, DecodeMessages) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(16, 256);
+  TrackingLogMessageReceiver next(&msgFactory);
+  DecodingLogMessageReceiver msgReceiver(&msgFactory, &next);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  const std::string USER("bob");
+  const uint32_t line= __LINE__;
+
+  PISTIS_INFO_DEFERRED(log, "User {} took {} ms")(USER, 250);
+  log.info() << "Not deferred";
+
+  ASSERT_EQ(next.messages().size(), 2);
+  EXPECT_EQ(toText(next.messages()[0]), "User bob took 250 ms");
+  EXPECT_EQ(next.messages()[0]->encoding(), LogMessageEncoding::TEXT);
+  EXPECT_EQ(next.messages()[0]->destination(), DESTINATION);
+  EXPECT_EQ(next.messages()[0]->logLevel(), LogLevel::INFO);
+  EXPECT_STREQ(next.messages()[0]->sourceLocation().file(), __FILE__);
+  EXPECT_EQ(next.messages()[0]->sourceLocation().line(), line + 2);
+  EXPECT_TRUE(next.messages()[0]->timestamp().isSet());
+  EXPECT_LE(LogClock::toNanoseconds(next.messages()[0]->timestamp()),
+	    LogClock::toNanoseconds(next.messages()[1]->timestamp()));
+  EXPECT_EQ(toText(next.messages()[1]), "Not deferred");
+
+  // The binary message has been returned to the factory
+  EXPECT_EQ(msgFactory.numMessagesActive(), 2);
+}
+
+TEST(DecodingLogMessageReceiverTests, EmitSiteDictionary) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(16, 256);
+  TrackingLogMessageReceiver next(&msgFactory);
+  DecodingLogMessageReceiver msgReceiver(&msgFactory, &next, true);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  uint32_t line= 0;
+
+  for (int i= 0; i < 2; ++i) {
+    line= __LINE__; PISTIS_WARN_DEFERRED(log, "Attempt {}")(i);
+  }
+
+  ASSERT_EQ(next.messages().size(), 3);
+  EXPECT_EQ(next.messages()[0]->encoding(),
+	    LogMessageEncoding::SITE_DICTIONARY);
+  EXPECT_EQ(toText(next.messages()[0]),
+	    "0 WARN " __FILE__ ":" + std::to_string(line) + " Attempt {}");
+  EXPECT_EQ(toText(next.messages()[1]), "Attempt 0");
+  EXPECT_EQ(toText(next.messages()[2]), "Attempt 1");
+  EXPECT_EQ(msgReceiver.decoder().numSites(), 1);
+}
@@ -0,0 +1,46 @@
+#include <pistis/logging/FanOutLogMessageReceiver.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+#include "helpers/TrackingLogMessageFactory.hpp"
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+TEST(FanOutLogMessageReceiverTests, Construct) {
+  TrackingLogMessageFactory factory(16, 64);
+  TrackingLogMessageReceiver first(&factory);
+  TrackingLogMessageReceiver second(&factory);
+  FanOutLogMessageReceiver receiver({ &first, &second });
+
+  ASSERT_EQ(receiver.receivers().size(), 2);
+  EXPECT_EQ(receiver.receivers()[0], &first);
+  EXPECT_EQ(receiver.receivers()[1], &second);
+  EXPECT_THROW(FanOutLogMessageReceiver(std::vector<LogMessageReceiver*>()),
+	       std::invalid_argument);
+}
+
+TEST(FanOutLogMessageReceiverTests, ShareMessage) {
+  TrackingLogMessageFactory factory(16, 64);
+  TrackingLogMessageReceiver first(&factory);
+  TrackingLogMessageReceiver second(&factory);
+  TrackingLogMessageReceiver third(&factory);
+  FanOutLogMessageReceiver receiver({ &first, &second, &third });
+  LogMessage* msg= factory.get();
+
+  receiver.receive(msg);
+  EXPECT_EQ(msg->numReferences(), 3);
+  ASSERT_EQ(first.messages().size(), 1);
+  ASSERT_EQ(third.messages().size(), 1);
+  EXPECT_EQ(first.messages()[0], msg);
+  EXPECT_EQ(third.messages()[0], msg);
+
+  // Only the last receiver to let go returns the message
+  first.flush();
+  second.flush();
+  EXPECT_EQ(factory.numMessagesActive(), 1);
+  third.flush();
+  EXPECT_EQ(factory.numMessagesActive(), 0);
+  EXPECT_EQ(factory.releasedMessages().size(), 1);
+  EXPECT_FALSE(factory.hasErrors()) << factory.errorDetails();
+}
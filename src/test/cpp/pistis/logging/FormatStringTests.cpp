@@ -0,0 +1,29 @@
+#include <pistis/logging/FormatString.hpp>
+#include <gtest/gtest.h>
+
+using namespace pistis::logging;
+
+TEST(FormatStringTests, CountFormatArgs) {
+  static_assert(countFormatArgs("") == 0, "Empty string has no arguments");
+  static_assert(countFormatArgs("No arguments") == 0,
+		"String without placeholders has no arguments");
+  static_assert(countFormatArgs("User {} took {} ms") == 2,
+		"String has two placeholders");
+  static_assert(countFormatArgs("{{}} {{{}}}") == 1,
+		"Escaped braces are not placeholders");
+
+  EXPECT_EQ(countFormatArgs("{}{}{}"), 3);
+  EXPECT_THROW(countFormatArgs("Unmatched { brace"), std::invalid_argument);
+  EXPECT_THROW(countFormatArgs("Unmatched } brace"), std::invalid_argument);
+  EXPECT_THROW(countFormatArgs("Specs {:x} are unsupported"),
+	       std::invalid_argument);
+}
+
+TEST(FormatStringTests, CreateWithMacro) {
+  auto text= PISTIS_FMT("User {} took {} ms");
+
+  EXPECT_EQ(decltype(text)::numArgs(), 2);
+  EXPECT_STREQ(text.text(), "User {} took {} ms");
+  EXPECT_TRUE(IsFormatString<decltype(text)>::value);
+  EXPECT_FALSE(IsFormatString<const char*>::value);
+}
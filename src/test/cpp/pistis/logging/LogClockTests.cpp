@@ -0,0 +1,72 @@
+#include <pistis/logging/LogClock.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+using namespace pistis::logging;
+
+namespace {
+  int64_t nanosNow() {
+    return (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+	std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+  }
+
+  void verifyCloseToNow(LogClockSource source, int64_t tolerance) {
+    const int64_t before= nanosNow();
+    const LogTimestamp t= LogClock::now(source);
+    const int64_t after= nanosNow();
+    const int64_t nanos= (int64_t)LogClock::toNanoseconds(t);
+
+    EXPECT_EQ(t.source(), source);
+    EXPECT_TRUE(t.isSet());
+    EXPECT_GE(nanos, before - tolerance);
+    EXPECT_LE(nanos, after + tolerance);
+  }
+}
+
+TEST(LogClockTests, DefaultTimestamp) {
+  LogTimestamp t;
+
+  EXPECT_FALSE(t.isSet());
+  EXPECT_EQ(t.source(), LogClockSource::NONE);
+  EXPECT_EQ(LogClock::toNanoseconds(t), 0);
+}
+
+TEST(LogClockTests, ConvertToWallTime) {
+  LogClock::calibrate();
+  verifyCloseToNow(LogClockSource::REALTIME, 0);
+  verifyCloseToNow(LogClockSource::COARSE, 20000000);
+  verifyCloseToNow(LogClockSource::TSC, 5000000);
+}
+
+TEST(LogClockTests, TscIsMonotonic) {
+  const LogTimestamp first= LogClock::now(LogClockSource::TSC);
+  const LogTimestamp second= LogClock::now(LogClockSource::TSC);
+
+  EXPECT_LE(first.raw(), second.raw());
+  EXPECT_LE(LogClock::toNanoseconds(first), LogClock::toNanoseconds(second));
+}
+
+TEST(LogClockTests, SetSource) {
+  const LogClockSource original= LogClock::source();
+
+  LogClock::setSource(LogClockSource::COARSE);
+  EXPECT_EQ(LogClock::source(), LogClockSource::COARSE);
+  EXPECT_EQ(LogClock::now().source(), LogClockSource::COARSE);
+
+  LogClock::setSource(LogClockSource::TSC);
+  EXPECT_EQ(LogClock::now().source(), LogClockSource::TSC);
+
+  EXPECT_THROW(LogClock::setSource(LogClockSource::NONE),
+	       std::invalid_argument);
+  EXPECT_EQ(LogClock::source(), LogClockSource::TSC);
+
+  LogClock::setSource(original);
+}
+
+TEST(LogClockTests, WriteSourceToStream) {
+  std::ostringstream out;
+  out << LogClockSource::TSC << " " << LogClockSource::REALTIME;
+  EXPECT_EQ(out.str(), "TSC REALTIME");
+}
@@ -0,0 +1,154 @@
+#include <pistis/logging/LogCpuTopology.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace pistis::logging;
+
+namespace {
+  /** @brief A directory laid out like /sys/devices/system/node, removed
+   *         when the test is done with it
+   */
+  class FakeNodeDir {
+  public:
+    FakeNodeDir(): path_(), files_(), dirs_() {
+      char name[]= "/tmp/LogCpuTopologyTests.XXXXXX";
+      path_= mkdtemp(name) ? name : "";
+    }
+
+    ~FakeNodeDir() {
+      for (const auto& f : files_) {
+	unlink(f.c_str());
+      }
+      for (auto i= dirs_.rbegin(); i != dirs_.rend(); ++i) {
+	rmdir(i->c_str());
+      }
+      rmdir(path_.c_str());
+    }
+
+    const std::string& path() const { return path_; }
+
+    void write(const std::string& name, const std::string& text) {
+      const size_t slash= name.find('/');
+      if (slash != std::string::npos) {
+	const std::string dir= path_ + "/" + name.substr(0, slash);
+	if (!mkdir(dir.c_str(), 0700)) {
+	  dirs_.push_back(dir);
+	}
+      }
+      files_.push_back(path_ + "/" + name);
+      std::ofstream(files_.back()) << text << "\n";
+    }
+
+  private:
+    std::string path_;
+    std::vector<std::string> files_;
+    std::vector<std::string> dirs_;
+  };
+}
+
+TEST(LogCpuTopologyTests, ParseCpuList) {
+  typedef std::vector<uint32_t> CpuList;
+
+  EXPECT_EQ(LogCpuTopology::parseCpuList("0"), CpuList({ 0 }));
+  EXPECT_EQ(LogCpuTopology::parseCpuList("0-3,8,10-11\n"),
+	    CpuList({ 0, 1, 2, 3, 8, 10, 11 }));
+  EXPECT_EQ(LogCpuTopology::parseCpuList(""), CpuList());
+  EXPECT_THROW(LogCpuTopology::parseCpuList("3-1"), std::invalid_argument);
+  EXPECT_THROW(LogCpuTopology::parseCpuList("a"), std::invalid_argument);
+}
+
+TEST(LogCpuTopologyTests, NodesOrderedByDistance) {
+  // Four nodes of two CPUs, where node 0 is nearer node 2 than node 1
+  LogCpuTopology topology({ 0, 0, 1, 1, 2, 2, 3, 3 },
+			  { { 10, 21, 12, 31 },
+			    { 21, 10, 31, 12 },
+			    { 12, 31, 10, 21 },
+			    { 31, 12, 21, 10 } });
+
+  EXPECT_EQ(topology.numCpus(), 8);
+  EXPECT_EQ(topology.numNodes(), 4);
+  EXPECT_EQ(topology.nodeOf(5), 2);
+  EXPECT_EQ(topology.nodeOf(100), 0);
+  EXPECT_EQ(topology.cpusOn(3), std::vector<uint32_t>({ 6, 7 }));
+  EXPECT_EQ(topology.nodesNearestTo(0), std::vector<uint32_t>({ 0, 2, 1, 3 }));
+  EXPECT_EQ(topology.nodesNearestTo(3), std::vector<uint32_t>({ 3, 1, 2, 0 }));
+
+  // Without distances, nodes with nearer numbers are nearer
+  LogCpuTopology numbered({ 0, 1, 2 });
+  EXPECT_EQ(numbered.nodesNearestTo(2), std::vector<uint32_t>({ 2, 1, 0 }));
+}
+
+TEST(LogCpuTopologyTests, CpusWithGaps) {
+  const uint32_t NO_NODE= LogCpuTopology::NO_NODE;
+  LogCpuTopology topology({ 0, NO_NODE, 0, NO_NODE, 1, 1 }, { },
+			  { 0, 2 });
+
+  EXPECT_EQ(topology.numCpus(), 4);
+  EXPECT_EQ(topology.cpus(), std::vector<uint32_t>({ 0, 2, 4, 5 }));
+  EXPECT_EQ(topology.cpusOn(0), std::vector<uint32_t>({ 0, 2 }));
+  EXPECT_EQ(topology.nodeOf(4), 1);
+  EXPECT_EQ(topology.nodeOf(3), 0);
+  EXPECT_EQ(topology.systemNodeId(1), 2);
+}
+
+TEST(LogCpuTopologyTests, ReadNodes) {
+  FakeNodeDir sysfs;
+  ASSERT_FALSE(sysfs.path().empty());
+
+  // Node 1 is missing and node 3 only has memory
+  sysfs.write("online", "0,2-3");
+  sysfs.write("node0/cpulist", "0-1");
+  sysfs.write("node0/distance", "10 20 30");
+  sysfs.write("node2/cpulist", "4,6");
+  sysfs.write("node2/distance", "20 10 30");
+  sysfs.write("node3/cpulist", "");
+  sysfs.write("node3/distance", "30 30 10");
+
+  const LogCpuTopology topology= LogCpuTopology::readNodes(sysfs.path());
+  EXPECT_EQ(topology.numNodes(), 2);
+  EXPECT_EQ(topology.systemNodeId(0), 0);
+  EXPECT_EQ(topology.systemNodeId(1), 2);
+  EXPECT_EQ(topology.cpus(), std::vector<uint32_t>({ 0, 1, 4, 6 }));
+  EXPECT_EQ(topology.cpusOn(1), std::vector<uint32_t>({ 4, 6 }));
+  EXPECT_EQ(topology.nodeOf(6), 1);
+  EXPECT_EQ(topology.nodesNearestTo(1), std::vector<uint32_t>({ 1, 0 }));
+}
+
+TEST(LogCpuTopologyTests, ReadNodesWithoutCpus) {
+  FakeNodeDir sysfs;
+  ASSERT_FALSE(sysfs.path().empty());
+
+  EXPECT_THROW(LogCpuTopology::readNodes(sysfs.path()),
+	       std::invalid_argument);
+  sysfs.write("online", "0");
+  sysfs.write("node0/cpulist", "");
+  EXPECT_THROW(LogCpuTopology::readNodes(sysfs.path()),
+	       std::invalid_argument);
+}
+
+TEST(LogCpuTopologyTests, InvalidTopology) {
+  EXPECT_THROW(LogCpuTopology(std::vector<uint32_t>()),
+	       std::invalid_argument);
+  EXPECT_THROW(LogCpuTopology({ 0, 2 }), std::invalid_argument);
+  EXPECT_THROW(LogCpuTopology({ 0, 1 }, { { 10, 20 } }),
+	       std::invalid_argument);
+  EXPECT_THROW(LogCpuTopology({ LogCpuTopology::NO_NODE }),
+	       std::invalid_argument);
+  EXPECT_THROW(LogCpuTopology({ 0, 1 }, { }, { 0 }),
+	       std::invalid_argument);
+}
+
+TEST(LogCpuTopologyTests, SystemTopology) {
+  const LogCpuTopology& topology= LogCpuTopology::system();
+
+  EXPECT_GE(topology.numCpus(), 1);
+  EXPECT_GE(topology.numNodes(), 1);
+  EXPECT_LT(topology.currentNode(), topology.numNodes());
+  EXPECT_EQ(&topology, &LogCpuTopology::system());
+}
@@ -0,0 +1,71 @@
+#include <pistis/logging/LogDestination.hpp>
+#include <pistis/logging/LogMessage.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace pistis::logging;
+
+TEST(LogDestinationTests, DefaultIsEmpty) {
+  LogDestination destination;
+
+  EXPECT_EQ(destination.id(), 0);
+  EXPECT_EQ(destination.name(), "");
+  EXPECT_EQ(destination, LogDestination(""));
+}
+
+TEST(LogDestinationTests, InternSameName) {
+  LogDestination first("tests.intern.same");
+  LogDestination second(std::string("tests.intern.same"));
+
+  EXPECT_NE(first.id(), 0);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(&first.name(), &second.name());
+  EXPECT_EQ(first.name(), "tests.intern.same");
+}
+
+TEST(LogDestinationTests, InternDifferentNames) {
+  const size_t numInterned= LogDestination::numInterned();
+  LogDestination first("tests.intern.first");
+  LogDestination second("tests.intern.second");
+
+  EXPECT_NE(first, second);
+  EXPECT_NE(first.id(), second.id());
+  EXPECT_EQ(LogDestination::numInterned(), numInterned + 2);
+}
+
+TEST(LogDestinationTests, InternFromManyThreads) {
+  std::vector<std::thread> threads;
+  std::vector<uint32_t> ids(8, 0);
+
+  for (size_t i= 0; i < ids.size(); ++i) {
+    threads.emplace_back([&ids, i]() {
+      ids[i]= LogDestination("tests.intern.threads").id();
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (auto id : ids) {
+    EXPECT_EQ(id, LogDestination("tests.intern.threads").id());
+  }
+}
+
+TEST(LogDestinationTests, WriteToStream) {
+  std::ostringstream out;
+  out << LogDestination("tests.intern.write");
+  EXPECT_EQ(out.str(), "tests.intern.write");
+}
+
+TEST(LogDestinationTests, MessageCarriesHandle) {
+  const LogDestination destination("tests.intern.message");
+  LogMessage msg(16);
+
+  msg.setDestination(destination);
+  EXPECT_EQ(msg.destinationHandle(), destination);
+  EXPECT_EQ(&msg.destination(), &destination.name());
+
+  LogMessage moved(std::move(msg));
+  EXPECT_EQ(moved.destinationHandle(), destination);
+}
@@ -0,0 +1,112 @@
+#include <pistis/logging/LogFieldFormat.hpp>
+#include <pistis/logging/LogStream.hpp>
+#include <pistis/logging/SimpleLogMessageFactory.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+namespace {
+  struct Point {
+    int x;
+    int y;
+  };
+
+  std::ostream& operator<<(std::ostream& out, const Point& p) {
+    return out << "(" << p.x << ", " << p.y << ")";
+  }
+
+  std::string toText(const LogMessage* msg) {
+    return std::string(msg->begin(), msg->end());
+  }
+
+  void addTestFields(LogMessage& msg) {
+    msg.addField("user", 4, FormatArg("bob"));
+    msg.addField("latency_us", 10, FormatArg(250));
+    msg.addField("ok", 2, FormatArg(false));
+    msg.addField("ratio", 5, FormatArg(0.5));
+    msg.addField("path", 4, FormatArg("C:\\a \"b\""));
+    msg.addField("grade", 5, FormatArg('A'));
+    msg.addField("empty", 5, FormatArg(""));
+    msg.addField("nan", 3,
+		 FormatArg(std::numeric_limits<double>::quiet_NaN()));
+  }
+}
+
+TEST(LogFieldFormatTests, WriteLogfmt) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogMessage msg(16, 256);
+
+  addTestFields(msg);
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::INFO);
+    writeFieldsAsLogfmt(msg, out);
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  EXPECT_EQ(toText(msgReceiver.messages()[0]),
+	    "user=bob latency_us=250 ok=false ratio=0.5 "
+	    "path=\"C:\\\\a \\\"b\\\"\" grade=A empty=\"\" nan=nan");
+}
+
+TEST(LogFieldFormatTests, WriteJson) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogMessage msg(16, 256);
+
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::INFO);
+    writeFieldsAsJson(msg, out);
+    out.flush();
+
+    addTestFields(msg);
+    msg.addField("tab\t", 4, FormatArg("\x01"));
+    writeFieldsAsJson(msg, out);
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  EXPECT_EQ(toText(msgReceiver.messages()[0]), "{}");
+  EXPECT_EQ(toText(msgReceiver.messages()[1]),
+	    "{\"user\":\"bob\",\"latency_us\":250,\"ok\":false,\"ratio\":0.5,"
+	    "\"path\":\"C:\\\\a \\\"b\\\"\",\"grade\":\"A\",\"empty\":\"\","
+	    "\"nan\":null,\"tab\\t\":\"\\u0001\"}");
+}
+
+TEST(LogFieldFormatTests, LogStreamFields) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TrackingLogMessageReceiver fieldReceiver(&msgFactory);
+  const Point POINT{ 3, -4 };
+
+  {
+    LogStream<char> s(msgFactory, msgReceiver, DESTINATION, LogLevel::INFO,
+		      true);
+    s.kv("user", std::string("bob")).kv("latency_us", 250) << "done";
+    s.kv("where", POINT);
+  }
+  {
+    LogStream<char> s(msgFactory, msgReceiver, DESTINATION, LogLevel::INFO,
+		      false);
+    s.kv("user", "alice") << "disabled";
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages()[0];
+  EXPECT_EQ(toText(msg), "done");
+  {
+    LogMessageWriter out(msgFactory, fieldReceiver, DESTINATION,
+			 LogLevel::INFO);
+    writeFieldsAsLogfmt(*msg, out);
+  }
+  ASSERT_EQ(fieldReceiver.messages().size(), 1);
+  EXPECT_EQ(toText(fieldReceiver.messages()[0]),
+	    "user=bob latency_us=250 where=\"(3, -4)\"");
+}
@@ -0,0 +1,195 @@
+#include <pistis/logging/BinaryLogMessage.hpp>
+#include <pistis/logging/LogMacros.hpp>
+#include <pistis/logging/SimpleLogMessageFactory.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "helpers/TestingLog.hpp"
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+namespace {
+  int countCall(int& numCalls) {
+    return ++numCalls;
+  }
+}
+
+TEST(LogMacrosTests, EnabledStatement) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  int numCalls= 0;
+
+  PISTIS_INFO(log) << "Call number " << countCall(numCalls);
+  PISTIS_LOG(log, LogLevel::ERROR) << "Call number " << countCall(numCalls);
+
+  EXPECT_EQ(numCalls, 2);
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  LogMessage* msg= msgReceiver.messages()[0];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "Call number 1");
+  EXPECT_EQ(msg->destination(), DESTINATION);
+  EXPECT_EQ(msg->logLevel(), LogLevel::INFO);
+
+  msg= msgReceiver.messages()[1];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "Call number 2");
+  EXPECT_EQ(msg->logLevel(), LogLevel::ERROR);
+}
+
+TEST(LogMacrosTests, DisabledStatementSkipsArguments) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  int numCalls= 0;
+
+  PISTIS_TRACE(log) << "Call number " << countCall(numCalls);
+  PISTIS_DEBUG(log) << "Call number " << countCall(numCalls);
+  PISTIS_WLOG(log, LogLevel::DEBUG) << L"Call number " << countCall(numCalls);
+
+  EXPECT_EQ(numCalls, 0);
+  EXPECT_EQ(msgReceiver.messages().size(), 0);
+  EXPECT_EQ(msgFactory.numMessagesActive(), 0);
+}
+
+TEST(LogMacrosTests, UnbracedIfElse) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  bool condition= false;
+
+  if (condition)
+    PISTIS_WARN(log) << "Condition was true";
+  else
+    PISTIS_WARN(log) << "Condition was false";
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages()[0];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "Condition was false");
+}
+
+TEST(LogMacrosTests, MinimumCompiledLevel) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::TRACE);
+  int numCalls= 0;
+
+  // Statements below PISTIS_LOGGING_MIN_LEVEL are discarded even though
+  // the log would accept them at runtime
+  PISTIS_TRACE(log) << "Call number " << countCall(numCalls);
+  PISTIS_DEBUG(log) << "Call number " << countCall(numCalls);
+  PISTIS_LOG(log, LogLevel::TRACE) << "Call number " << countCall(numCalls);
+  PISTIS_ERROR(log) << "Call number " << countCall(numCalls);
+
+  const int expected= (isCompiledIn(LogLevel::TRACE) ? 2 : 0) +
+                      (isCompiledIn(LogLevel::DEBUG) ? 1 : 0) + 1;
+  EXPECT_EQ(numCalls, expected);
+  EXPECT_EQ(msgReceiver.messages().size(), expected);
+}
+
+TEST(LogMacrosTests, LevelValuesMatchLogLevel) {
+  EXPECT_EQ((uint32_t)LogLevel::TRACE, PISTIS_LOGGING_LEVEL_TRACE);
+  EXPECT_EQ((uint32_t)LogLevel::DEBUG, PISTIS_LOGGING_LEVEL_DEBUG);
+  EXPECT_EQ((uint32_t)LogLevel::INFO, PISTIS_LOGGING_LEVEL_INFO);
+  EXPECT_EQ((uint32_t)LogLevel::WARN, PISTIS_LOGGING_LEVEL_WARN);
+  EXPECT_EQ((uint32_t)LogLevel::ERROR, PISTIS_LOGGING_LEVEL_ERROR);
+  EXPECT_EQ((uint32_t)MIN_COMPILED_LOG_LEVEL, PISTIS_LOGGING_MIN_LEVEL_VALUE);
+}
+
+TEST(LogMacrosTests, DeferredStatement) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  int numCalls= 0;
+
+  PISTIS_DEBUG_DEFERRED(log, "Call number {}")(countCall(numCalls));
+  PISTIS_INFO_DEFERRED(log, "Call number {}")(countCall(numCalls));
+  PISTIS_LOG_DEFERRED(log, LogLevel::ERROR, "No arguments")();
+
+  EXPECT_EQ(numCalls, 1);
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+
+  LogMessage* msg= msgReceiver.messages()[0];
+  EXPECT_EQ(msg->encoding(), LogMessageEncoding::BINARY);
+  EXPECT_EQ(msg->destination(), DESTINATION);
+  EXPECT_EQ(msg->logLevel(), LogLevel::INFO);
+  const LogSite* site= BinaryLogDecoder::siteOf(*msg);
+  ASSERT_NE(site, nullptr);
+  EXPECT_STREQ(site->format(), "Call number {}");
+  EXPECT_STREQ(site->file(), __FILE__);
+  EXPECT_EQ(site->logLevel(), LogLevel::INFO);
+
+  msg= msgReceiver.messages()[1];
+  EXPECT_EQ(msg->logLevel(), LogLevel::ERROR);
+  site= BinaryLogDecoder::siteOf(*msg);
+  ASSERT_NE(site, nullptr);
+  EXPECT_STREQ(site->format(), "No arguments");
+}
+
+TEST(LogMacrosTests, DeferredUnbracedIfElse) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  bool condition= false;
+  bool elseTaken= false;
+
+  if (condition)
+    PISTIS_INFO_DEFERRED(log, "Taken")();
+  else
+    elseTaken= true;
+
+  EXPECT_TRUE(elseTaken);
+  EXPECT_EQ(msgReceiver.messages().size(), 0);
+}
+
+TEST(LogMacrosTests, ThrottledStatements) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  int numCalls= 0;
+
+  for (int i= 0; i < 10; ++i) {
+    PISTIS_LOG_FIRST_N(log, LogLevel::INFO, 2) << "First " << i;
+    PISTIS_LOG_EVERY_N(log, LogLevel::WARN, 4) << "Every " << i;
+    PISTIS_LOG_FIRST_N(log, LogLevel::DEBUG, 2)
+        << "Disabled " << countCall(numCalls);
+  }
+
+  EXPECT_EQ(numCalls, 0);
+  std::vector<std::string> text;
+  std::vector<uint64_t> suppressed;
+  for (auto msg : msgReceiver.messages()) {
+    text.push_back(std::string(msg->begin(), msg->end()));
+    suppressed.push_back(
+	msg->hasFields() ? msg->fieldsBegin()->value().uintValue() : 0
+    );
+  }
+  EXPECT_EQ(text, std::vector<std::string>({
+      "First 0", "Every 0", "First 1", "Every 4", "Every 8"
+  }));
+  EXPECT_EQ(suppressed, std::vector<uint64_t>({ 0, 0, 0, 3, 3 }));
+  EXPECT_EQ(msgReceiver.messages()[3]->fieldsBegin()->key(), "suppressed");
+}
+
+TEST(LogMacrosTests, ThrottledUnbracedIfElse) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  bool condition= false;
+
+  if (condition)
+    PISTIS_LOG_RATE_LIMITED(log, LogLevel::INFO, 100) << "Then";
+  else
+    PISTIS_LOG_RATE_LIMITED(log, LogLevel::INFO, 100) << "Else";
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages()[0];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "Else");
+}
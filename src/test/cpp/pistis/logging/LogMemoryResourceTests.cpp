@@ -0,0 +1,117 @@
+#include <pistis/logging/LogMemoryResource.hpp>
+#include <pistis/logging/LogMessagePool.hpp>
+#include <pistis/logging/LogStream.hpp>
+#include <pistis/logging/SimpleLogMessageFactory.hpp>
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "helpers/CountingLogMemoryResource.hpp"
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+TEST(LogMemoryResourceTests, DefaultResource) {
+  LogMemoryResource* resource= LogMemoryResource::defaultResource();
+  ASSERT_NE(resource, nullptr);
+  EXPECT_EQ(LogMemoryResource::defaultResource(), resource);
+
+  void* p= resource->allocate(100, 64);
+  EXPECT_EQ((uintptr_t)p % 64, 0);
+  resource->deallocate(p, 100, 64);
+
+  LogMessage msg(16);
+  EXPECT_EQ(msg.resource(), resource);
+}
+
+TEST(LogMemoryResourceTests, CreateAndDestroy) {
+  CountingLogMemoryResource resource;
+  LogMessage* msg= LogMessage::create(16, 256, &resource);
+
+  EXPECT_EQ(msg->resource(), &resource);
+  EXPECT_TRUE(resource.owns(msg));
+  EXPECT_EQ(resource.numOutstanding(), 1);
+  EXPECT_EQ((uintptr_t)msg % LOG_MESSAGE_ALIGNMENT, 0);
+
+  // Growing the text and adding fields allocate from the resource too
+  msg->increaseCapacity(64);
+  EXPECT_TRUE(resource.owns(msg->begin()));
+  EXPECT_TRUE(msg->addField("key", 3, FormatArg(1)));
+  EXPECT_EQ(resource.numOutstanding(), 3);
+
+  msg->increaseCapacity(128);
+  EXPECT_EQ(resource.numOutstanding(), 3);
+
+  LogMessage::destroy(msg);
+  EXPECT_EQ(resource.numOutstanding(), 0);
+}
+
+TEST(LogMemoryResourceTests, ConstructWithResource) {
+  CountingLogMemoryResource resource;
+  {
+    LogMessage msg(16, 64, &resource);
+    EXPECT_TRUE(resource.owns(msg.begin()));
+    EXPECT_EQ(resource.numOutstanding(), 1);
+
+    // Move construction takes over the buffer and the resource
+    LogMessage moved(std::move(msg));
+    EXPECT_EQ(moved.resource(), &resource);
+    EXPECT_EQ(resource.numOutstanding(), 1);
+  }
+  EXPECT_EQ(resource.numOutstanding(), 0);
+}
+
+TEST(LogMemoryResourceTests, MoveAssignAcrossResources) {
+  CountingLogMemoryResource first;
+  CountingLogMemoryResource second;
+  {
+    LogMessage from(16, 64, &first);
+    LogMessage to(16, 64, &second);
+
+    memcpy(from.begin(), "abcdef", 6);
+    from.setEnd(from.begin() + 6);
+    ASSERT_TRUE(from.addField("key", 3, FormatArg(1)));
+
+    // The target keeps its resource, so the text and fields are copied
+    to= std::move(from);
+    EXPECT_EQ(to.resource(), &second);
+    EXPECT_EQ(std::string(to.begin(), to.end()), "abcdef");
+    EXPECT_TRUE(second.owns(to.begin()));
+    EXPECT_TRUE(to.hasFields());
+    EXPECT_EQ(first.numOutstanding(), 0);
+    EXPECT_EQ(second.numOutstanding(), 2);
+  }
+  EXPECT_EQ(second.numOutstanding(), 0);
+}
+
+TEST(LogMemoryResourceTests, SimpleLogMessageFactory) {
+  CountingLogMemoryResource resource;
+  {
+    SimpleLogMessageFactory msgFactory(16, 256, &resource);
+    TrackingLogMessageReceiver msgReceiver(&msgFactory);
+    LogStream<char> out(msgFactory, msgReceiver, "some.destination",
+			LogLevel::INFO, true);
+
+    EXPECT_EQ(msgFactory.resource(), &resource);
+    out << "Some text that is longer than sixteen bytes";
+    out.flush();
+    ASSERT_EQ(msgReceiver.messages().size(), 1);
+    EXPECT_TRUE(resource.owns(msgReceiver.messages()[0]));
+    EXPECT_TRUE(resource.owns(msgReceiver.messages()[0]->begin()));
+  }
+  EXPECT_GT(resource.numAllocations(), 1);
+  EXPECT_EQ(resource.numOutstanding(), 0);
+}
+
+TEST(LogMemoryResourceTests, LogMessagePool) {
+  CountingLogMemoryResource resource;
+  {
+    LogMessagePool pool(16, 256, 256, 2, 4, &resource);
+    EXPECT_EQ(pool.resource(), &resource);
+    EXPECT_EQ(resource.numOutstanding(), 2);
+
+    LogMessage* msg= pool.get();
+    EXPECT_TRUE(resource.owns(msg));
+    pool.release(msg);
+  }
+  EXPECT_EQ(resource.numOutstanding(), 0);
+}
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <iterator>
 #include <set>
+#include <thread>
 #include <vector>
 
 #include "helpers/Join.hpp"
@@ -173,6 +174,185 @@ TEST(LogMessagePoolTests, ReturnTooLargeMessage) {
   EXPECT_EQ(factory.numMessagesInPool(), INITIAL_POOL_SIZE-1);
 }
 
+TEST(LogMessagePoolTests, SizeClasses) {
+  TestingLogMessagePool factory(128, 4096, 1024, 2, 4);
+
+  ASSERT_EQ(factory.numSizeClasses(), 4);
+  EXPECT_EQ(factory.sizeClassCapacity(0), 128);
+  EXPECT_EQ(factory.sizeClassCapacity(3), 1024);
+  EXPECT_EQ(factory.sizeClassOf(128), 0);
+  EXPECT_EQ(factory.sizeClassOf(300), 1);
+  EXPECT_EQ(factory.sizeClassOf(1024), 3);
+  EXPECT_EQ(factory.sizeClassOf(1025), 4);
+
+  // A large write gets a new message rounded up to a class size, which
+  // is filed under that class when it comes back
+  LogMessage* large= factory.get(600);
+  EXPECT_EQ(large->capacity(), 1024);
+  EXPECT_EQ(factory.numMessagesInPool(), 2);
+  factory.release(large);
+  EXPECT_EQ(factory.numMessagesInSizeClass(3), 1);
+  EXPECT_EQ(factory.get(600), large);
+
+  // Small writes do not take it from the pool
+  factory.release(large);
+  LogMessage* small= factory.get();
+  EXPECT_EQ(small->capacity(), 128);
+  EXPECT_EQ(factory.numMessagesInSizeClass(3), 1);
+
+  // A message that grew is filed by its new capacity
+  small->increaseCapacity(300);
+  factory.release(small);
+  EXPECT_EQ(factory.numMessagesInSizeClass(0), 1);
+  EXPECT_EQ(factory.numMessagesInSizeClass(1), 1);
+  EXPECT_EQ(factory.get(200), small);
+
+  // When the right class is empty, a larger one will do
+  LogMessage* medium= factory.get(200);
+  EXPECT_EQ(medium, large);
+  EXPECT_TRUE(medium->empty());
+  factory.release(small);
+  factory.release(medium);
+  EXPECT_EQ(factory.numMessagesActive(), 0);
+}
+
+TEST(LogMessagePoolTests, MaxPoolSizeBoundsAllSizeClasses) {
+  TestingLogMessagePool factory(128, 4096, 1024, 0, 4);
+  std::vector<LogMessage*> small;
+  std::vector<LogMessage*> large;
+
+  for (int i= 0; i < 3; ++i) {
+    small.push_back(factory.get());
+    large.push_back(factory.get(600));
+  }
+  for (auto msg : small) {
+    factory.release(msg);
+  }
+  for (auto msg : large) {
+    factory.release(msg);
+  }
+
+  // Each class has room for four, but the pool only for four in all
+  EXPECT_EQ(factory.numMessagesInSizeClass(0), 3);
+  EXPECT_EQ(factory.numMessagesInSizeClass(3), 1);
+  EXPECT_EQ(factory.numMessagesInPool(), 4);
+
+  // Taking a message out makes room for one of any size
+  LogMessage* msg= factory.get();
+  EXPECT_EQ(factory.get(600), large[0]);
+  factory.release(large[0]);
+  EXPECT_EQ(factory.numMessagesInSizeClass(3), 1);
+  factory.release(msg);
+  EXPECT_EQ(factory.numMessagesInPool(), 4);
+  EXPECT_EQ(factory.numMessagesActive(), 0);
+}
+
+TEST(LogMessagePoolTests, AdaptToBursts) {
+  TestingLogMessagePool factory(128, 1024, 256, 0,
+				LogPoolSizingPolicy(2, 16,
+						    std::chrono::seconds(1),
+						    3));
+  const auto start= std::chrono::steady_clock::now();
+  std::vector<LogMessage*> msgs;
+  auto burst= [&factory, &msgs]() {
+    for (int i= 0; i < 10; ++i) {
+      msgs.push_back(factory.get());
+    }
+    for (auto msg : msgs) {
+      factory.release(msg);
+    }
+    msgs.clear();
+  };
+
+  // The first burst outgrows the pool, which keeps what it needed
+  // once the window closes
+  burst();
+  EXPECT_EQ(factory.numMessagesInPool(), 2);
+  EXPECT_EQ(factory.numMisses(), 10);
+  EXPECT_EQ(factory.trim(start + std::chrono::seconds(1)), 0);
+  EXPECT_EQ(factory.retainLimit(0), 12);
+
+  burst();
+  EXPECT_EQ(factory.numMessagesInPool(), 10);
+  EXPECT_EQ(factory.numMisses(), 18);
+  EXPECT_EQ(factory.trim(start + std::chrono::seconds(2)), 0);
+  EXPECT_EQ(factory.retainLimit(0), 16);
+
+  // Messages are freed once they have been idle for three windows
+  // without a miss
+  EXPECT_EQ(factory.trim(start + std::chrono::seconds(3)), 0);
+  EXPECT_EQ(factory.trim(start + std::chrono::seconds(4)), 0);
+  EXPECT_EQ(factory.trim(start + std::chrono::milliseconds(4500)), 0);
+  EXPECT_EQ(factory.trim(start + std::chrono::seconds(5)), 8);
+  EXPECT_EQ(factory.numMessagesInPool(), 2);
+  EXPECT_EQ(factory.retainLimit(0), 6);
+  EXPECT_EQ(factory.retainLimit(1), 2);
+  EXPECT_EQ(factory.numMessagesActive(), 0);
+}
+
+TEST(LogMessagePoolTests, FixedPoolIsNotTrimmed) {
+  TestingLogMessagePool factory(128, 1024, 256, 4, 8);
+
+  EXPECT_TRUE(factory.sizingPolicy().isFixed());
+  EXPECT_EQ(factory.trim(std::chrono::steady_clock::now() +
+			 std::chrono::hours(1)), 0);
+  EXPECT_EQ(factory.numMessagesInPool(), 4);
+  EXPECT_EQ(factory.retainLimit(0), 8);
+}
+
+TEST(LogMessagePoolTests, ReuseAcrossRingWraparound) {
+  TestingLogMessagePool factory(128, 1024, 256, 2, 3);
+  std::set<LogMessage*> seen;
+
+  // Cycle through the pool's ring many times over
+  for (int i= 0; i < 100; ++i) {
+    LogMessage* first= factory.get();
+    LogMessage* second= factory.get();
+    seen.insert(first);
+    seen.insert(second);
+    factory.release(first);
+    factory.release(second);
+    ASSERT_EQ(factory.numMessagesInPool(), 2);
+  }
+  EXPECT_EQ(seen.size(), 2);
+  EXPECT_EQ(factory.numMessagesActive(), 0);
+}
+
+TEST(LogMessagePoolTests, SimultaneousReleaseToFullPool) {
+  static const size_t MAX_POOL_SIZE= 8;
+  static const size_t NUM_THREADS= 8;
+  static const size_t MESSAGES_PER_THREAD= 16;
+  TestingLogMessagePool factory(128, 1024, 256, 0, MAX_POOL_SIZE);
+  std::vector< std::vector<LogMessage*> > msgs(NUM_THREADS);
+  std::vector<std::thread> threads;
+
+  for (auto& m : msgs) {
+    for (size_t i= 0; i < MESSAGES_PER_THREAD; ++i) {
+      m.push_back(factory.get());
+    }
+  }
+  for (size_t i= 0; i < NUM_THREADS; ++i) {
+    threads.emplace_back([&factory, &msgs, i]() {
+      for (auto m : msgs[i]) {
+	factory.release(m);
+	factory.release(factory.get());
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::vector<LogMessage*> messagesInPool;
+  factory.getMessagesInPool(std::back_inserter(messagesInPool));
+  EXPECT_EQ(factory.numMessagesActive(), 0);
+  EXPECT_LE(messagesInPool.size(), MAX_POOL_SIZE);
+  EXPECT_EQ(messagesInPool.size(), factory.numMessagesInPool());
+  EXPECT_EQ(std::set<LogMessage*>(messagesInPool.begin(),
+				  messagesInPool.end()).size(),
+	    messagesInPool.size());
+}
+
 TEST(LogMessagePoolTests, ReleaseNonEmptyMessage) {
   static const size_t INITIAL_CAPACITY=128;
   static const size_t MAX_CAPACITY= 1024;
@@ -193,7 +373,10 @@ TEST(LogMessagePoolTests, ReleaseNonEmptyMessage) {
 
   // Make the message not empty and return it to the pool
   msg->setEnd(msg->begin() + msg->capacity()/2);
+  msg->addField("key", 3, FormatArg(1));
+  msg->setSourceLocation(LogSourceLocation::current());
   ASSERT_FALSE(msg->empty());
+  ASSERT_TRUE(msg->hasFields());
   factory.release(msg);
   ASSERT_EQ(factory.numMessagesInPool(), INITIAL_POOL_SIZE);
 
@@ -202,6 +385,8 @@ TEST(LogMessagePoolTests, ReleaseNonEmptyMessage) {
   for (int i=0;i<INITIAL_POOL_SIZE;++i) {
     messages.push_back(factory.get());
     EXPECT_TRUE(messages.back()->empty());
+    EXPECT_FALSE(messages.back()->hasFields());
+    EXPECT_FALSE(messages.back()->sourceLocation().known());
   }
   EXPECT_EQ(factory.numMessagesInPool(), 0);
   EXPECT_TRUE(std::find(messages.begin(), messages.end(), msg) != messages.end());
@@ -0,0 +1,39 @@
+#include <pistis/logging/LogMessagePoolTrimmer.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+
+#include "helpers/TestingLogMessagePool.hpp"
+
+using namespace pistis::logging;
+
+TEST(LogMessagePoolTrimmerTests, TrimIdlePools) {
+  const auto WINDOW= std::chrono::milliseconds(10);
+  TestingLogMessagePool pool(128, 1024, 256, 8,
+			     LogPoolSizingPolicy(0, 8, WINDOW, 1));
+  const auto deadline=
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+  {
+    LogMessagePoolTrimmer trimmer({ &pool }, WINDOW);
+    EXPECT_EQ(trimmer.interval(), WINDOW);
+    while ((trimmer.numMessagesFreed() < 8) &&
+	   (std::chrono::steady_clock::now() < deadline)) {
+      std::this_thread::sleep_for(WINDOW);
+    }
+    EXPECT_EQ(trimmer.numMessagesFreed(), 8);
+    EXPECT_EQ(pool.numMessagesInPool(), 0);
+  }
+  EXPECT_EQ(pool.retainLimit(0), 0);
+}
+
+TEST(LogMessagePoolTrimmerTests, InvalidArguments) {
+  TestingLogMessagePool pool(128, 1024, 256, 0, 8);
+
+  EXPECT_THROW(LogMessagePoolTrimmer({ }, std::chrono::seconds(1)),
+	       std::invalid_argument);
+  EXPECT_THROW(LogMessagePoolTrimmer({ nullptr }, std::chrono::seconds(1)),
+	       std::invalid_argument);
+  EXPECT_THROW(LogMessagePoolTrimmer({ &pool }, std::chrono::seconds(0)),
+	       std::invalid_argument);
+}
@@ -1,8 +1,24 @@
 #include <pistis/logging/LogMessage.hpp>
 #include <gtest/gtest.h>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include <string.h>
 
 using namespace pistis::logging;
 
+namespace {
+  class AnnotatedLogMessage : public LogMessage {
+  public:
+    AnnotatedLogMessage(): LogMessage(64) {
+      memset(notes, 'n', sizeof(notes));
+    }
+
+    char notes[4096];
+  };
+}
+
 TEST(LogMessageTests, ConstructAtMaxCapacity) {
   static const size_t CAPACITY= 1024;
   LogMessage msg(CAPACITY);
@@ -40,6 +56,59 @@ TEST(LogMessageTests, ConstructWithInitialAndMaxCapacity) {
   EXPECT_EQ(msg.eos() - msg.begin(), INITIAL_CAPACITY);
 }
 
+TEST(LogMessageTests, CreateWithInlineStorage) {
+  static const size_t INITIAL_CAPACITY= 200;
+  static const size_t MAX_CAPACITY= 4096;
+  std::unique_ptr<LogMessage> msg(
+      LogMessage::create(INITIAL_CAPACITY, MAX_CAPACITY)
+  );
+
+  EXPECT_EQ((uintptr_t)msg.get() % LOG_MESSAGE_ALIGNMENT, 0);
+  EXPECT_TRUE(msg->usesInlineStorage());
+  EXPECT_EQ(msg->inlineCapacity(), INITIAL_CAPACITY);
+  EXPECT_EQ(msg->begin(), (char*)msg.get() + sizeof(LogMessage));
+  EXPECT_TRUE(msg->empty());
+  EXPECT_EQ(msg->capacity(), INITIAL_CAPACITY);
+  EXPECT_EQ(msg->maxCapacity(), MAX_CAPACITY);
+
+  // Outgrowing the inline storage moves the text to the heap
+  memcpy(msg->begin(), "Some text", 9);
+  msg->setEnd(msg->begin() + 9);
+  EXPECT_EQ(msg->increaseCapacity(1024), 1024);
+  EXPECT_FALSE(msg->usesInlineStorage());
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "Some text");
+}
+
+TEST(LogMessageTests, MoveFromInlineStorage) {
+  std::unique_ptr<LogMessage> msg(LogMessage::create(64, 1024));
+  memcpy(msg->begin(), "Some text", 9);
+  msg->setEnd(msg->begin() + 9);
+
+  LogMessage moved(std::move(*msg));
+  EXPECT_FALSE(moved.usesInlineStorage());
+  EXPECT_EQ(std::string(moved.begin(), moved.end()), "Some text");
+  EXPECT_EQ(moved.capacity(), 64);
+  EXPECT_EQ(moved.maxCapacity(), 1024);
+  EXPECT_EQ(msg->begin(), (char*)0);
+  EXPECT_EQ(msg->capacity(), 0);
+
+  std::unique_ptr<LogMessage> other(LogMessage::create(64, 1024));
+  *other= std::move(moved);
+  EXPECT_FALSE(other->usesInlineStorage());
+  EXPECT_EQ(std::string(other->begin(), other->end()), "Some text");
+}
+
+TEST(LogMessageTests, NewDerivedMessage) {
+  // operator new must allocate room for the derived class's members
+  std::unique_ptr<LogMessage> msg(new AnnotatedLogMessage());
+  const AnnotatedLogMessage& annotated=
+      static_cast<const AnnotatedLogMessage&>(*msg);
+
+  EXPECT_EQ(annotated.notes[0], 'n');
+  EXPECT_EQ(annotated.notes[sizeof(annotated.notes) - 1], 'n');
+  EXPECT_EQ(msg->capacity(), 64);
+}
+
 TEST(LogMessageTests, SetEnd) {
   static const size_t CAPACITY= 1024;
   static const size_t IN_USE= CAPACITY/4;
@@ -79,6 +148,16 @@ TEST(LogMessageTests, SetDestination) {
   EXPECT_EQ(msg.destination(), DESTINATION);
 }
 
+TEST(LogMessageTests, SetSourceLocation) {
+  LogMessage msg(1024);
+
+  EXPECT_FALSE(msg.sourceLocation().known());
+  msg.setSourceLocation(LogSourceLocation("some/file.cpp", 42, "f"));
+  EXPECT_STREQ(msg.sourceLocation().file(), "some/file.cpp");
+  EXPECT_EQ(msg.sourceLocation().line(), 42);
+  EXPECT_STREQ(msg.sourceLocation().function(), "f");
+}
+
 TEST(LogMessageTests, IncreaseCapacity) {
   static const size_t INITIAL_CAPACITY= 1024;
   static const size_t MAX_CAPACITY= 4096;
@@ -212,3 +291,132 @@ TEST(LogMessageTests, MoveAssignment) {
   EXPECT_EQ(msg.end(), (char*)0);
   EXPECT_EQ(msg.eos(), (char*)0);
 }
+
+TEST(LogMessageTests, AddFields) {
+  struct Point {
+    int x, y;
+  };
+  LogMessage msg(16, 1024);
+  int x= 0;
+
+  EXPECT_FALSE(msg.hasFields());
+  EXPECT_TRUE(msg.fieldsBegin() == msg.fieldsEnd());
+
+  {
+    // Strings are copied, so they need not outlive the call
+    std::string user("bob");
+    EXPECT_TRUE(msg.addField("user", 4, FormatArg(user)));
+  }
+  EXPECT_TRUE(msg.addField("latency_us", 10, FormatArg(-250)));
+  EXPECT_TRUE(msg.addField("ok", 2, FormatArg(true)));
+  EXPECT_TRUE(msg.addField("ratio", 5, FormatArg(0.25)));
+  EXPECT_TRUE(msg.addField("count", 5, FormatArg(7U)));
+  EXPECT_TRUE(msg.addField("ptr", 3, FormatArg(&x)));
+  EXPECT_FALSE(msg.addField("none", 4, FormatArg()));
+  EXPECT_TRUE(msg.hasFields());
+  EXPECT_TRUE(msg.empty());
+
+  std::vector<LogField> fields(msg.fieldsBegin(), msg.fieldsEnd());
+  ASSERT_EQ(fields.size(), 6);
+  EXPECT_EQ(fields[0].key(), "user");
+  EXPECT_EQ(fields[0].value().type(), FormatArg::Type::STRING);
+  EXPECT_EQ(std::string(fields[0].value().stringData(),
+			fields[0].value().stringSize()), "bob");
+  EXPECT_EQ(fields[1].key(), "latency_us");
+  EXPECT_EQ(fields[1].value().type(), FormatArg::Type::INT);
+  EXPECT_EQ(fields[1].value().intValue(), -250);
+  EXPECT_EQ(fields[2].value().type(), FormatArg::Type::BOOL);
+  EXPECT_TRUE(fields[2].value().boolValue());
+  EXPECT_EQ(fields[3].value().type(), FormatArg::Type::DOUBLE);
+  EXPECT_EQ(fields[3].value().doubleValue(), 0.25);
+  EXPECT_EQ(fields[4].value().type(), FormatArg::Type::UINT);
+  EXPECT_EQ(fields[4].value().uintValue(), 7);
+  EXPECT_EQ(fields[5].value().type(), FormatArg::Type::POINTER);
+  EXPECT_EQ(fields[5].value().pointerValue(), &x);
+
+  // Fields move with the message
+  LogMessage moved(std::move(msg));
+  EXPECT_FALSE(msg.hasFields());
+  EXPECT_EQ(std::distance(moved.fieldsBegin(), moved.fieldsEnd()), 6);
+
+  moved.clearFields();
+  EXPECT_FALSE(moved.hasFields());
+}
+
+TEST(LogMessageTests, AddFieldTooLarge) {
+  LogMessage msg(16, 64);
+  const std::string TEXT(40, 'x');
+
+  EXPECT_TRUE(msg.addField("first", 5, FormatArg(TEXT)));
+  const size_t size= msg.fieldsSize();
+
+  // Does not fit, so the fields are unchanged
+  EXPECT_FALSE(msg.addField("second", 6, FormatArg(TEXT)));
+  EXPECT_EQ(msg.fieldsSize(), size);
+  EXPECT_EQ(std::distance(msg.fieldsBegin(), msg.fieldsEnd()), 1);
+}
+
+TEST(LogMessageTests, Segments) {
+  LogMessage msg(8);
+  LogMessage* first= new LogMessage(8);
+  LogMessage* second= new LogMessage(8);
+  const std::string TEXT("abcdefghijklmnopqrst");
+
+  memcpy(msg.begin(), TEXT.c_str(), 8);
+  msg.setEnd(msg.begin() + 8);
+  memcpy(first->begin(), TEXT.c_str() + 8, 8);
+  first->setEnd(first->begin() + 8);
+  memcpy(second->begin(), TEXT.c_str() + 16, 4);
+  second->setEnd(second->begin() + 4);
+
+  EXPECT_EQ(msg.nextSegment(), nullptr);
+  EXPECT_EQ(msg.numSegments(), 1);
+  msg.appendSegment(first);
+  msg.appendSegment(second);
+
+  EXPECT_EQ(msg.nextSegment(), first);
+  EXPECT_EQ(first->nextSegment(), second);
+  EXPECT_EQ(msg.numSegments(), 3);
+  EXPECT_EQ(msg.size(), 8);
+  EXPECT_EQ(msg.totalSize(), TEXT.size());
+
+  std::ostringstream out;
+  out << msg;
+  EXPECT_EQ(out.str(), TEXT);
+
+  struct iovec iov[4];
+  ASSERT_EQ(msg.gather(iov, 4), 3);
+  EXPECT_EQ(iov[0].iov_base, msg.begin());
+  EXPECT_EQ(iov[0].iov_len, 8);
+  EXPECT_EQ(iov[1].iov_base, first->begin());
+  EXPECT_EQ(iov[1].iov_len, 8);
+  EXPECT_EQ(iov[2].iov_base, second->begin());
+  EXPECT_EQ(iov[2].iov_len, 4);
+  EXPECT_EQ(msg.gather(iov, 2), 2);
+
+  // Moving takes the segments along; destroying deletes them
+  LogMessage moved(std::move(msg));
+  EXPECT_EQ(msg.nextSegment(), nullptr);
+  EXPECT_EQ(moved.nextSegment(), first);
+  EXPECT_EQ(moved.totalSize(), TEXT.size());
+
+  EXPECT_EQ(moved.detachSegments(), first);
+  EXPECT_EQ(moved.numSegments(), 1);
+  delete first;
+}
+
+TEST(LogMessageTests, References) {
+  LogMessage msg(16);
+  EXPECT_EQ(msg.numReferences(), 1);
+
+  msg.addReferences(2);
+  EXPECT_EQ(msg.numReferences(), 3);
+  EXPECT_FALSE(msg.removeReference());
+  EXPECT_FALSE(msg.removeReference());
+  EXPECT_EQ(msg.numReferences(), 1);
+
+  // The last reference leaves the count at one, ready for reuse
+  EXPECT_TRUE(msg.removeReference());
+  EXPECT_EQ(msg.numReferences(), 1);
+  EXPECT_TRUE(msg.removeReference());
+}
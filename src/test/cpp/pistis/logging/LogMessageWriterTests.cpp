@@ -0,0 +1,272 @@
+#include <pistis/logging/FormatArg.hpp>
+#include <pistis/logging/LogMessagePool.hpp>
+#include <pistis/logging/LogMessageWriter.hpp>
+#include <pistis/logging/SimpleLogMessageFactory.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <sstream>
+
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+namespace {
+  struct Point {
+    int x;
+    int y;
+  };
+
+  std::ostream& operator<<(std::ostream& out, const Point& p) {
+    return out << "(" << p.x << ", " << p.y << ")";
+  }
+
+  std::string toText(const LogMessage* msg) {
+    return std::string(msg->begin(), msg->end());
+  }
+}
+
+TEST(LogMessageWriterTests, WriteAndFlush) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(16, 32);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogMessageWriter out(msgFactory, msgReceiver, DESTINATION, LogLevel::WARN);
+
+  EXPECT_EQ(out.destination(), DESTINATION);
+  EXPECT_EQ(out.logLevel(), LogLevel::WARN);
+
+  // Nothing is sent until something is written
+  out.flush();
+  EXPECT_EQ(msgReceiver.messages().size(), 0);
+
+  out.write("abcdefghijklm", 13);
+  out.put('n');
+  out.flush();
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages().front();
+  EXPECT_EQ(toText(msg), "abcdefghijklmn");
+  EXPECT_EQ(msg->destination(), DESTINATION);
+  EXPECT_EQ(msg->logLevel(), LogLevel::WARN);
+  EXPECT_EQ(msg->capacity(), 16);
+}
+
+TEST(LogMessageWriterTests, WriteIncreasingCapacity) {
+  const std::string DESTINATION= "some.destination";
+  const std::string MESSAGE= "abcdefghijklmnopqrstuvwxyz";
+  SimpleLogMessageFactory msgFactory(16, 40);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::WARN);
+    out.write(MESSAGE.c_str(), MESSAGE.size());
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages().front();
+  EXPECT_EQ(toText(msg), MESSAGE);
+  EXPECT_EQ(msg->capacity(), 32);
+}
+
+TEST(LogMessageWriterTests, WriteWithSizeHint) {
+  const std::string MESSAGE(600, 'x');
+  LogMessagePool msgFactory(128, 4096, 1024, 0, 4);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+
+  // The pool hands out a message large enough for the first write
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, "some.destination",
+			 LogLevel::WARN);
+    out.write(MESSAGE.c_str(), MESSAGE.size());
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  EXPECT_EQ(toText(msgReceiver.messages().front()), MESSAGE);
+  EXPECT_EQ(msgReceiver.messages().front()->capacity(), 1024);
+}
+
+TEST(LogMessageWriterTests, StampWhenFirstMessageIsObtained) {
+  SimpleLogMessageFactory msgFactory(128, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, "some.destination",
+			 LogLevel::WARN);
+    EXPECT_FALSE(out.timestamp().isSet());
+    EXPECT_FALSE(out.thread().known());
+
+    out.write("Hi", 2);
+    ASSERT_TRUE(out.timestamp().isSet());
+    EXPECT_EQ(out.thread(), LogThreadInfo::current());
+    out.flush();
+    out.write("There", 5);
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  EXPECT_TRUE(msgReceiver.messages()[0]->timestamp().isSet());
+  EXPECT_EQ(msgReceiver.messages()[0]->timestamp(),
+	    msgReceiver.messages()[1]->timestamp());
+}
+
+TEST(LogMessageWriterTests, WriteOverflowingMsg) {
+  const std::string DESTINATION= "some.destination";
+  const std::string MESSAGE= "abcdefghijklmnopqrstuvwxyz0123456789";
+  SimpleLogMessageFactory msgFactory(16, 32);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::WARN);
+    out.write(MESSAGE.c_str(), MESSAGE.size());
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  EXPECT_EQ(toText(msgReceiver.messages()[0]), MESSAGE.substr(0, 32));
+  EXPECT_EQ(msgReceiver.messages()[0]->capacity(), 32);
+  EXPECT_EQ(toText(msgReceiver.messages()[1]), MESSAGE.substr(32));
+  EXPECT_EQ(msgReceiver.messages()[1]->capacity(), 16);
+
+  EXPECT_NE(msgReceiver.messages()[0]->statementId(), 0);
+  EXPECT_EQ(msgReceiver.messages()[1]->statementId(),
+	    msgReceiver.messages()[0]->statementId());
+  EXPECT_EQ(msgReceiver.messages()[0]->partNumber(), 0);
+  EXPECT_EQ(msgReceiver.messages()[1]->partNumber(), 1);
+  EXPECT_FALSE(msgReceiver.messages()[0]->isFinalPart());
+  EXPECT_TRUE(msgReceiver.messages()[1]->isFinalPart());
+}
+
+TEST(LogMessageWriterTests, FlushEndsStatementAfterPart) {
+  SimpleLogMessageFactory msgFactory(16, 32);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogMessageWriter out(msgFactory, msgReceiver, "some.destination",
+		       LogLevel::WARN);
+
+  out.write("abc", 3);
+  out.flushPart();
+  out.write("def", 3);
+  out.flushPart();
+
+  // Nothing more was written, but the statement still needs an end
+  out.flush();
+  out.write("ghi", 3);
+  out.flush();
+
+  ASSERT_EQ(msgReceiver.messages().size(), 4);
+  const uint64_t statementId= msgReceiver.messages()[0]->statementId();
+  for (uint32_t i= 0; i < 3; ++i) {
+    LogMessage* msg= msgReceiver.messages()[i];
+    EXPECT_EQ(msg->statementId(), statementId);
+    EXPECT_EQ(msg->partNumber(), i);
+    EXPECT_EQ(msg->isFinalPart(), i == 2);
+  }
+  EXPECT_EQ(toText(msgReceiver.messages()[2]), "");
+
+  EXPECT_FALSE(msgReceiver.messages()[3]->isMultiPart());
+  EXPECT_TRUE(msgReceiver.messages()[3]->isFinalPart());
+}
+
+TEST(LogMessageWriterTests, NumbersAreNotSplitBetweenMessages) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(32, 32);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::WARN);
+    out.write("abcdefghijklmnopqrstuvwxyz", 26);
+    out.write(FormatArg(1234567890));
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  EXPECT_EQ(toText(msgReceiver.messages()[0]), "abcdefghijklmnopqrstuvwxyz");
+  EXPECT_EQ(toText(msgReceiver.messages()[1]), "1234567890");
+}
+
+TEST(LogMessageWriterTests, WriteSegmented) {
+  const std::string DESTINATION= "some.destination";
+  const std::string TEXT(40, 'a');
+  const std::string MORE(60, 'b');
+  SimpleLogMessageFactory msgFactory(48, 96);
+  msgFactory.setSegmented(true);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::WARN);
+    out.write(TEXT.c_str(), TEXT.size());
+    out.write(FormatArg(1234567890));
+    out.write(MORE.c_str(), MORE.size());
+  }
+
+  // Segments fill up without growing, numbers are not split between
+  // segments, and the chain stops at the maximum capacity
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  const LogMessage* msg= msgReceiver.messages()[0];
+  ASSERT_EQ(msg->numSegments(), 3);
+  EXPECT_EQ(msg->totalSize(), 96);
+  EXPECT_EQ(toText(msg), TEXT);
+  EXPECT_EQ(toText(msg->nextSegment()), "1234567890" + MORE.substr(0, 38));
+  EXPECT_EQ(toText(msg->nextSegment()->nextSegment()), MORE.substr(38, 8));
+  for (const LogMessage* p= msg; p; p= p->nextSegment()) {
+    EXPECT_EQ(p->capacity(), 48);
+  }
+  EXPECT_EQ(toText(msgReceiver.messages()[1]), MORE.substr(46));
+}
+
+TEST(LogMessageWriterTests, WriteArgs) {
+  const std::string DESTINATION= "some.destination";
+  const std::string TEXT= "a std::string";
+  const Point POINT{ 3, -4 };
+  int x= 0;
+  std::ostringstream truth;
+  SimpleLogMessageFactory msgFactory(16, 1024);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+
+  truth << "true|false|c|-42|42|" << std::numeric_limits<int64_t>::min()
+	<< "|" << std::numeric_limits<uint64_t>::max()
+	<< "|0.25|1e+100|a C string|a std::string|(3, -4)|" << (void*)&x
+	<< "|0x0";
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::WARN);
+    const FormatArg args[]= {
+      FormatArg(true), FormatArg(false), FormatArg('c'), FormatArg(-42),
+      FormatArg((unsigned char)42),
+      FormatArg(std::numeric_limits<int64_t>::min()),
+      FormatArg(std::numeric_limits<uint64_t>::max()), FormatArg(0.25),
+      FormatArg(1e100), FormatArg("a C string"), FormatArg(TEXT),
+      FormatArg(POINT), FormatArg(&x), FormatArg(nullptr)
+    };
+    const size_t NUM_ARGS= sizeof(args)/sizeof(FormatArg);
+
+    for (size_t i= 0; i < NUM_ARGS; ++i) {
+      if (i) {
+	out.put('|');
+      }
+      out.write(args[i]);
+    }
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  EXPECT_EQ(toText(msgReceiver.messages()[0]), truth.str());
+}
+
+TEST(LogMessageWriterTests, Format) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(16, 1024);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  const FormatArg args[]= { FormatArg("bob"), FormatArg(250) };
+
+  {
+    LogMessageWriter out(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::WARN);
+    out.format("User {} took {} ms {{not an arg}}", args, 2);
+    out.flush();
+    out.format("Missing {} {}", args, 1);
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  EXPECT_EQ(toText(msgReceiver.messages()[0]),
+	    "User bob took 250 ms {not an arg}");
+  EXPECT_EQ(toText(msgReceiver.messages()[1]), "Missing bob {}");
+}
@@ -0,0 +1,28 @@
+#include <pistis/logging/LogPoolSizingPolicy.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+using namespace pistis::logging;
+
+TEST(LogPoolSizingPolicyTests, Create) {
+  LogPoolSizingPolicy policy(4, 64, std::chrono::milliseconds(500), 10);
+
+  EXPECT_EQ(policy.minRetained(), 4);
+  EXPECT_EQ(policy.maxRetained(), 64);
+  EXPECT_EQ(policy.window(), std::chrono::milliseconds(500));
+  EXPECT_EQ(policy.idleWindows(), 10);
+  EXPECT_FALSE(policy.isFixed());
+
+  LogPoolSizingPolicy fixed= LogPoolSizingPolicy::fixed(16);
+  EXPECT_EQ(fixed.minRetained(), 16);
+  EXPECT_EQ(fixed.maxRetained(), 16);
+  EXPECT_TRUE(fixed.isFixed());
+}
+
+TEST(LogPoolSizingPolicyTests, InvalidPolicy) {
+  EXPECT_THROW(LogPoolSizingPolicy(8, 4), std::invalid_argument);
+  EXPECT_THROW(LogPoolSizingPolicy(0, 4, std::chrono::seconds(0)),
+	       std::invalid_argument);
+  EXPECT_THROW(LogPoolSizingPolicy(0, 4, std::chrono::seconds(1), 0),
+	       std::invalid_argument);
+}
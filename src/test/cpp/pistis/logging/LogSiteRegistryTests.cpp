@@ -0,0 +1,207 @@
+#include <pistis/logging/LogMacros.hpp>
+#include <pistis/logging/LogSiteRegistry.hpp>
+#include <pistis/logging/SimpleLogMessageFactory.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "helpers/TestingLog.hpp"
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+namespace {
+  const uint32_t FIRST_STATEMENT_LINE= __LINE__ + 3;
+
+  void logTwoStatements(const Log& log, int n) {
+    PISTIS_DEBUG(log) << "First " << n;
+    PISTIS_DEBUG(log) << "Second " << n;
+  }
+
+  void logDeferredStatement(const Log& log, int n) {
+    PISTIS_DEBUG_DEFERRED(log, "Deferred {}")(n);
+  }
+
+  std::vector<std::string> messageText(
+      const TrackingLogMessageReceiver& receiver
+  ) {
+    std::vector<std::string> text;
+    for (auto msg : receiver.messages()) {
+      if (msg->encoding() == LogMessageEncoding::BINARY) {
+	text.push_back("<binary>");
+      } else {
+	text.push_back(std::string(msg->begin(), msg->end()));
+      }
+    }
+    return text;
+  }
+}
+
+TEST(LogSiteRegistryTests, ParsePattern) {
+  LogSitePattern p= LogSitePattern::parse("file=net/Server.cpp:120");
+  EXPECT_EQ(p.file, "net/Server.cpp");
+  EXPECT_EQ(p.line, 120);
+  EXPECT_EQ(p.function, "");
+  EXPECT_EQ(p.destination, "");
+
+  p= LogSitePattern::parse("  func=accept   destination=net.* line=7 ");
+  EXPECT_EQ(p.file, "");
+  EXPECT_EQ(p.line, 7);
+  EXPECT_EQ(p.function, "accept");
+  EXPECT_EQ(p.destination, "net.*");
+
+  EXPECT_THROW(LogSitePattern::parse("file"), std::invalid_argument);
+  EXPECT_THROW(LogSitePattern::parse("line=x"), std::invalid_argument);
+  EXPECT_THROW(LogSitePattern::parse("file=a.cpp:"), std::invalid_argument);
+  EXPECT_THROW(LogSitePattern::parse("color=red"), std::invalid_argument);
+}
+
+TEST(LogSiteRegistryTests, EnableSingleStatement) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  LogSiteRegistry* registry= LogSiteRegistry::getInstance();
+  registry->reset();
+
+  // Registers both statements
+  logTwoStatements(log, 1);
+  EXPECT_EQ(msgReceiver.messages().size(), 0);
+
+  std::ostringstream pattern;
+  pattern << "file=logging/LogSiteRegistryTests.cpp:" << FIRST_STATEMENT_LINE;
+  registry->enable(LogSitePattern::parse(pattern.str()));
+  logTwoStatements(log, 2);
+
+  registry->disable(LogSitePattern::parse(pattern.str()));
+  logTwoStatements(log, 3);
+
+  registry->enable(LogSitePattern::parse("func=logTwoStatements"));
+  logTwoStatements(log, 4);
+  registry->reset();
+  logTwoStatements(log, 5);
+
+  EXPECT_EQ(messageText(msgReceiver),
+	    std::vector<std::string>({ "First 2", "First 4", "Second 4" }));
+  EXPECT_EQ(msgReceiver.messages()[0]->logLevel(), LogLevel::DEBUG);
+
+  bool found= false;
+  for (const LogSiteInfo& site : registry->sites()) {
+    if ((site.line == FIRST_STATEMENT_LINE) && site.function &&
+	(std::string(site.function) == "logTwoStatements")) {
+      EXPECT_EQ(site.destination, DESTINATION);
+      EXPECT_EQ(site.logLevel, LogLevel::DEBUG);
+      EXPECT_FALSE(site.enabled);
+      found= true;
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
+TEST(LogSiteRegistryTests, PatternsApplyToLaterStatements) {
+  const std::string DESTINATION("other.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  LogSiteRegistry* registry= LogSiteRegistry::getInstance();
+  registry->reset();
+
+  // The deferred statement has not executed yet, so it registers after
+  // the pattern is given
+  registry->enable(LogSitePattern::parse("destination=other.*"));
+  registry->disable(LogSitePattern::parse("func=nothingLikeThis"));
+  logDeferredStatement(log, 1);
+  registry->reset();
+  logDeferredStatement(log, 2);
+
+  EXPECT_EQ(messageText(msgReceiver),
+	    std::vector<std::string>({ "<binary>" }));
+}
+
+TEST(LogSiteRegistryTests, DecideSharedStatementPerDestination) {
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog netLog(&msgFactory, &msgReceiver, "shared.net", LogLevel::INFO);
+  TestingLog dbLog(&msgFactory, &msgReceiver, "shared.db", LogLevel::INFO);
+  LogSiteRegistry* registry= LogSiteRegistry::getInstance();
+  registry->reset();
+
+  // Both Logs go through the same two statements
+  registry->enable(LogSitePattern::parse("destination=shared.net"));
+  logTwoStatements(dbLog, 1);
+  logTwoStatements(netLog, 2);
+  logTwoStatements(dbLog, 3);
+
+  // A later pattern without a destination decides for every Log
+  registry->enable(LogSitePattern::parse("func=logTwoStatements"));
+  logTwoStatements(dbLog, 4);
+  registry->disable(LogSitePattern::parse("destination=shared.*"));
+  logTwoStatements(netLog, 5);
+  logTwoStatements(dbLog, 6);
+  registry->reset();
+
+  EXPECT_EQ(messageText(msgReceiver),
+	    std::vector<std::string>({ "First 2", "Second 2",
+		                       "First 4", "Second 4" }));
+
+  size_t numFound= 0;
+  for (const LogSiteInfo& site : registry->sites()) {
+    if ((site.line == FIRST_STATEMENT_LINE) &&
+	((site.destination == "shared.net") ||
+	 (site.destination == "shared.db"))) {
+      ++numFound;
+    }
+  }
+  EXPECT_EQ(numFound, 2);
+}
+
+TEST(LogSiteRegistryTests, RememberAnswersForSeveralDestinations) {
+  static LogSiteSwitch site(__FILE__, __LINE__);
+  const LogDestination net("alternate.net");
+  const LogDestination db("alternate.db");
+  LogSiteRegistry* registry= LogSiteRegistry::getInstance();
+  registry->reset();
+  registry->enable(LogSitePattern::parse("destination=alternate.net"));
+
+  // Each destination asks the registry once
+  EXPECT_TRUE(site.isOn(LogLevel::DEBUG, "f", net));
+  EXPECT_FALSE(site.isOn(LogLevel::DEBUG, "f", db));
+  const uint64_t numLookups= registry->numLookups();
+
+  for (int i= 0; i < 10; ++i) {
+    EXPECT_TRUE(site.isOn(LogLevel::DEBUG, "f", net));
+    EXPECT_FALSE(site.isOn(LogLevel::DEBUG, "f", db));
+  }
+  EXPECT_EQ(registry->numLookups(), numLookups);
+
+  // Changing the patterns updates the answers for both
+  registry->enable(LogSitePattern::parse("destination=alternate.db"));
+  registry->disable(LogSitePattern::parse("destination=alternate.net"));
+  EXPECT_FALSE(site.isOn(LogLevel::DEBUG, "f", net));
+  EXPECT_TRUE(site.isOn(LogLevel::DEBUG, "f", db));
+  EXPECT_EQ(registry->numLookups(), numLookups);
+  registry->reset();
+}
+
+TEST(LogSiteRegistryTests, RepeatedPatternsDoNotAccumulate) {
+  LogSiteRegistry* registry= LogSiteRegistry::getInstance();
+  registry->reset();
+
+  for (int i= 0; i < 100; ++i) {
+    registry->enable(LogSitePattern::parse("func=accept destination=net"));
+    registry->disable(LogSitePattern::parse("func=accept destination=net"));
+  }
+  EXPECT_EQ(registry->numRules(), 1);
+
+  registry->enable(LogSitePattern::parse("func=connect"));
+  EXPECT_EQ(registry->numRules(), 2);
+
+  // Selects everything the earlier patterns do, so it replaces them
+  registry->enable(LogSitePattern::parse("destination=net"));
+  registry->enable(LogSitePattern::parse(""));
+  EXPECT_EQ(registry->numRules(), 1);
+  registry->reset();
+  EXPECT_EQ(registry->numRules(), 0);
+}
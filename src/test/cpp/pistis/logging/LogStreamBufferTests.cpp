@@ -2,6 +2,7 @@
 #include <pistis/logging/SimpleLogMessageFactory.hpp>
 #include <gtest/gtest.h>
 #include <memory>
+#include <sstream>
 
 #include "helpers/TrackingLogMessageReceiver.hpp"
 
@@ -170,3 +171,93 @@ TEST(LogStreamBufferTests, WriteBlockOverflowingMsg) {
   EXPECT_EQ(msg->logLevel(), LogLevel::WARN);
   EXPECT_EQ(msg->capacity(), INITIAL_CAPACITY);
 }
+
+TEST(LogStreamBufferTests, OverflowingMsgIsSentInParts) {
+  const std::string MESSAGE= "abcdefghijklmnopqrstuvwxyz0123456789";
+  SimpleLogMessageFactory msgFactory(16, 32);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogStreamBuffer<char> buffer(msgFactory, msgReceiver, "some.destination",
+			       LogLevel::WARN);
+
+  buffer.sputn(MESSAGE.c_str(), MESSAGE.size());
+  buffer.pubsync();
+  buffer.sputn("next", 4);
+  buffer.pubsync();
+
+  ASSERT_EQ(msgReceiver.messages().size(), 3);
+  LogMessage* first= msgReceiver.messages()[0];
+  LogMessage* second= msgReceiver.messages()[1];
+  EXPECT_TRUE(first->isMultiPart());
+  EXPECT_EQ(first->partNumber(), 0);
+  EXPECT_FALSE(first->isFinalPart());
+  EXPECT_EQ(second->statementId(), first->statementId());
+  EXPECT_EQ(second->partNumber(), 1);
+  EXPECT_TRUE(second->isFinalPart());
+
+  // The next statement fits in one message, so it is not split
+  LogMessage* third= msgReceiver.messages()[2];
+  EXPECT_FALSE(third->isMultiPart());
+  EXPECT_EQ(third->statementId(), 0);
+  EXPECT_TRUE(third->isFinalPart());
+}
+
+TEST(LogStreamBufferTests, WriteBlockSegmented) {
+  static const size_t INITIAL_CAPACITY= 16;
+  static const size_t MAX_CAPACITY= 64;
+  const std::string DESTINATION= "some.destination";
+  const std::string MESSAGE= "abcdefghijklmnopqrstuvwxyz0123456789";
+  SimpleLogMessageFactory msgFactory(INITIAL_CAPACITY, MAX_CAPACITY);
+  msgFactory.setSegmented(true);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogStreamBuffer<char> buffer(msgFactory, msgReceiver, DESTINATION,
+			       LogLevel::WARN);
+
+  EXPECT_EQ(buffer.sputn(MESSAGE.c_str(), 20), 20);
+  EXPECT_EQ(buffer.sputc('!'), '!');
+  EXPECT_EQ(buffer.sputn(MESSAGE.c_str() + 20, MESSAGE.size() - 20),
+	    MESSAGE.size() - 20);
+  EXPECT_NE(buffer.pubsync(), -1);
+
+  // Nothing was grown, so nothing was copied
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages().front();
+  std::ostringstream text;
+  text << *msg;
+  EXPECT_EQ(text.str(), MESSAGE.substr(0, 20) + "!" + MESSAGE.substr(20));
+  EXPECT_EQ(msg->numSegments(), 3);
+  for (LogMessage* p= msg; p; p= p->nextSegment()) {
+    EXPECT_EQ(p->capacity(), INITIAL_CAPACITY);
+  }
+  EXPECT_EQ(msg->destination(), DESTINATION);
+  EXPECT_EQ(msg->logLevel(), LogLevel::WARN);
+}
+
+TEST(LogStreamBufferTests, WriteOneByOneSegmentedOverflowingMsg) {
+  static const size_t INITIAL_CAPACITY= 16;
+  static const size_t MAX_CAPACITY= 40;
+  const std::string DESTINATION= "some.destination";
+  const std::string MESSAGE= "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGH";
+  SimpleLogMessageFactory msgFactory(INITIAL_CAPACITY, MAX_CAPACITY);
+  msgFactory.setSegmented(true);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogStreamBuffer<char> buffer(msgFactory, msgReceiver, DESTINATION,
+			       LogLevel::WARN);
+
+  for (auto c : MESSAGE) {
+    EXPECT_EQ(buffer.sputc(c), c);
+  }
+  EXPECT_NE(buffer.pubsync(), -1);
+
+  // The chain stops at the maximum capacity, then a new message starts
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  std::ostringstream first;
+  first << *msgReceiver.messages()[0];
+  EXPECT_EQ(first.str(), MESSAGE.substr(0, MAX_CAPACITY));
+  EXPECT_EQ(msgReceiver.messages()[0]->numSegments(), 3);
+  EXPECT_EQ(msgReceiver.messages()[0]->totalSize(), MAX_CAPACITY);
+
+  std::ostringstream second;
+  second << *msgReceiver.messages()[1];
+  EXPECT_EQ(second.str(), MESSAGE.substr(MAX_CAPACITY));
+  EXPECT_EQ(msgReceiver.messages()[1]->numSegments(), 1);
+}
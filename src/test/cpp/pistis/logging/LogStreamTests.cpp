@@ -2,6 +2,10 @@
 #include <pistis/logging/SimpleLogMessageFactory.hpp>
 #include <gtest/gtest.h>
 #include <iomanip>
+#include <limits>
+#include <sstream>
+#include <locale.h>
+#include <stdio.h>
 
 #include "helpers/TrackingLogMessageReceiver.hpp"
 
@@ -107,3 +111,187 @@ TEST(LogStreamTests, MoveTest) {
   EXPECT_EQ(msg->logLevel(), LogLevel::INFO);
 }
 
+
+TEST(LogStreamTests, MoveAfterWriteTest) {
+  const std::string DESTINATION= "some.destination";
+  const std::string OTHER_DESTINATION= "other.destination";
+  const std::string TRUTH= "This is a number in base-16: abcdef";
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  LogStream<char> s(msgFactory, msgReceiver, DESTINATION, LogLevel::INFO, true);
+
+  // Text written before the move and the formatting state of the
+  // stream should both carry over to the new stream
+  s << "This is a number in base-" << 16 << ": " << std::hex;
+  LogStream<char> moved(std::move(s));
+  moved << 0xABCDEF;
+
+  LogStream<char> assigned(msgFactory, msgReceiver, OTHER_DESTINATION,
+			   LogLevel::WARN, true);
+  assigned << "Sent when overwritten";
+  assigned= std::move(moved);
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  EXPECT_EQ(msgReceiver.messages()[0]->destination(), OTHER_DESTINATION);
+
+  assigned.flush();
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  LogMessage* msg= msgReceiver.messages()[1];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), TRUTH);
+  EXPECT_EQ(msg->destination(), DESTINATION);
+  EXPECT_EQ(msg->logLevel(), LogLevel::INFO);
+}
+
+TEST(LogStreamTests, WriteNumbersTest) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(16, 1024);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  std::ostringstream truth;
+  int x= 0;
+
+  // The fast path must write exactly what std::ostream does, whatever
+  // the format, so write the same things to both
+  auto writeAll= [&x](auto& out) {
+    out << std::numeric_limits<int64_t>::min() << " " << (uint32_t)4000000000U
+	<< " " << (short)-12 << " " << 1.0/3.0 << " " << 2.5f << " " << 1e100
+	<< " " << (void*)&x << " " << (void*)nullptr << " " << &x << " "
+	<< true << " " << 'c' << " " << (unsigned char)'d' << " " << 1.5L
+	<< " " << std::hex << -1 << " " << 0xABCDEFU << " " << std::uppercase
+	<< 0xABCDEF << " " << std::nouppercase << std::showbase << 255 << " "
+	<< std::dec << std::noshowbase << std::setw(6) << 42 << "|" << 42
+	<< " " << std::setprecision(3) << 3.14159 << " "
+	<< std::setprecision(25) << 0.1 << " " << std::setprecision(6)
+	<< std::fixed << 2.5 << " " << std::scientific << 2.5 << " "
+	<< std::defaultfloat << std::showpos << 7 << " " << 7.5;
+  };
+
+  writeAll(truth);
+  {
+    LogStream<char> s(msgFactory, msgReceiver, DESTINATION, LogLevel::INFO,
+		      true);
+    writeAll(s);
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages().front();
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), truth.str());
+}
+
+TEST(LogStreamTests, WriteNumbersInCommaDecimalLocaleTest) {
+  const std::string DESTINATION= "some.destination";
+  const std::string TRUTH= "3.5 0.333333 3.14 1e+100 2.5 -0.25";
+  static const char* const COMMA_LOCALES[]= {
+    "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8",
+    "fr_FR", "ru_RU.UTF-8", "ru_RU.utf8"
+  };
+  SimpleLogMessageFactory msgFactory(16, 1024);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  const std::string previous= setlocale(LC_NUMERIC, nullptr);
+  char buffer[16]= "";
+
+  // Like std::ostream, the stream ignores the C locale
+  for (const char* name : COMMA_LOCALES) {
+    if (setlocale(LC_NUMERIC, name)) {
+      snprintf(buffer, sizeof(buffer), "%g", 3.5);
+      if (std::string(buffer) == "3,5") {
+	break;
+      }
+      setlocale(LC_NUMERIC, previous.c_str());
+    }
+  }
+  if (std::string(buffer) != "3,5") {
+    GTEST_SKIP() << "No locale with a comma for the decimal point";
+  }
+
+  {
+    LogStream<char> s(msgFactory, msgReceiver, DESTINATION, LogLevel::INFO,
+		      true);
+    s << 3.5 << " " << 1.0/3.0 << " " << std::setprecision(3) << 3.14159
+      << " " << 1e100 << " " << 2.5f << " " << -0.25;
+  }
+  setlocale(LC_NUMERIC, previous.c_str());
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages().front();
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), TRUTH);
+}
+
+TEST(LogStreamTests, WriteWideNumbersTest) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(16, 1024);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  std::ostringstream truth;
+
+  truth << -1234567 << " " << 0.25 << " " << std::hex << 255;
+  {
+    LogStream<wchar_t> s(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::INFO, true);
+    s << -1234567 << L" " << 0.25 << L" " << std::hex << 255;
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages().front();
+  EXPECT_EQ(msg->encoding(), LogMessageEncoding::UTF8);
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), truth.str());
+}
+
+TEST(LogStreamTests, WriteWideTextAsUtf8Test) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(16, 1024);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  const std::wstring TEXT(L"Caf\u00e9 costs 3\u20ac \U0001F600, "
+			  L"and this sentence is long enough to overflow "
+			  L"the stream buffer's own small buffer");
+
+  {
+    LogStream<wchar_t> s(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::INFO, true);
+    s << TEXT << L'!' << 42;
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 1);
+  LogMessage* msg= msgReceiver.messages().front();
+  EXPECT_EQ(msg->encoding(), LogMessageEncoding::UTF8);
+  EXPECT_EQ(std::string(msg->begin(), msg->end()),
+	    "Caf\xC3\xA9 costs 3\xE2\x82\xAC \xF0\x9F\x98\x80, "
+	    "and this sentence is long enough to overflow "
+	    "the stream buffer's own small buffer!42");
+}
+
+TEST(LogStreamTests, WideCharactersAreNotSplitBetweenMessagesTest) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(4, 8);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+
+  {
+    LogStream<wchar_t> s(msgFactory, msgReceiver, DESTINATION,
+			 LogLevel::INFO, true);
+    s << L"abc\u20ac\u20ac\U0001F600c";
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  EXPECT_EQ(std::string(msgReceiver.messages()[0]->begin(),
+			msgReceiver.messages()[0]->end()),
+	    "abc\xE2\x82\xAC");
+  EXPECT_EQ(std::string(msgReceiver.messages()[1]->begin(),
+			msgReceiver.messages()[1]->end()),
+	    "\xE2\x82\xAC\xF0\x9F\x98\x80" "c");
+}
+
+TEST(LogStreamTests, NumbersAreNotSplitBetweenMessagesTest) {
+  const std::string DESTINATION= "some.destination";
+  SimpleLogMessageFactory msgFactory(32, 40);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+
+  {
+    LogStream<char> s(msgFactory, msgReceiver, DESTINATION, LogLevel::INFO,
+		      true);
+    s << "abcdefghijklmnopqrstuvwxyz" << 1234567890;
+  }
+
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  LogMessage* msg= msgReceiver.messages()[0];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()),
+	    "abcdefghijklmnopqrstuvwxyz");
+  msg= msgReceiver.messages()[1];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "1234567890");
+}
@@ -58,3 +58,129 @@ TEST(LogTests, LogTest) {
   EXPECT_EQ(msg->destination(), DESTINATION);
   EXPECT_EQ(msg->logLevel(), LogLevel::ERROR);
 }
+
+TEST(LogTests, LogWithWriterTest) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(256, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  int numCalls= 0;
+
+  log.trace([&](auto& s) { s << "Call " << ++numCalls; });
+  log.debug([&](auto& s) { s << "Call " << ++numCalls; });
+  log.info([&](auto& s) { s << "Call " << ++numCalls; });
+  log.wlog(LogLevel::DEBUG, [&](auto& s) { s << L"Call " << ++numCalls; });
+  log.log(LogLevel::ERROR, [&](auto& s) { s << "Call " << ++numCalls; });
+
+  EXPECT_EQ(numCalls, 2);
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  LogMessage* msg= msgReceiver.messages()[0];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "Call 1");
+  EXPECT_EQ(msg->logLevel(), LogLevel::INFO);
+
+  msg= msgReceiver.messages()[1];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "Call 2");
+  EXPECT_EQ(msg->logLevel(), LogLevel::ERROR);
+}
+
+TEST(LogTests, LogWithFormatTest) {
+  const std::string DESTINATION("some.destination");
+  const std::string USER("bob");
+  SimpleLogMessageFactory msgFactory(16, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+
+  log.debug(PISTIS_FMT("User {} took {} ms"), USER, 250);
+  log.info(PISTIS_FMT("User {} took {} ms"), USER, 250);
+  log.log(LogLevel::ERROR, PISTIS_FMT("No arguments"));
+
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  LogMessage* msg= msgReceiver.messages()[0];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "User bob took 250 ms");
+  EXPECT_EQ(msg->destination(), DESTINATION);
+  EXPECT_EQ(msg->logLevel(), LogLevel::INFO);
+
+  msg= msgReceiver.messages()[1];
+  EXPECT_EQ(std::string(msg->begin(), msg->end()), "No arguments");
+  EXPECT_EQ(msg->logLevel(), LogLevel::ERROR);
+}
+
+TEST(LogTests, LogDeferredTooLargeTest) {
+  static constexpr LogSite SITE("Text is {}", "test.cpp", 10,
+				LogLevel::INFO);
+  const std::string DESTINATION("some.destination");
+  const std::string TEXT(30, 'x');
+  SimpleLogMessageFactory msgFactory(16, 32);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  const FormatArg args[]= { FormatArg(TEXT) };
+
+  // Too big to defer, so it is formatted right away
+  log.logDeferred(SITE, args, 1);
+
+  ASSERT_EQ(msgReceiver.messages().size(), 2);
+  std::string text;
+  for (auto msg : msgReceiver.messages()) {
+    EXPECT_EQ(msg->encoding(), LogMessageEncoding::TEXT);
+    text += std::string(msg->begin(), msg->end());
+  }
+  EXPECT_EQ(text, "Text is " + TEXT);
+  EXPECT_EQ(msgFactory.numMessagesActive(), 2);
+}
+
+TEST(LogTests, SourceLocationTest) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(16, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  const uint32_t line= __LINE__;
+
+  log.info() << "Stream";
+  log.warn([](auto& s) { s << "Writer"; });
+  log.error(PISTIS_FMT("Format {}"), 1);
+  log.winfo() << L"Wide";
+  log.log(LogLevel::INFO, LogSourceLocation("elsewhere.cpp", 7, "f"))
+      << "Explicit";
+
+  ASSERT_EQ(msgReceiver.messages().size(), 5);
+  for (size_t i= 0; i < 4; ++i) {
+    const LogSourceLocation& location=
+        msgReceiver.messages()[i]->sourceLocation();
+    ASSERT_TRUE(location.known());
+    EXPECT_STREQ(location.file(), __FILE__);
+    EXPECT_EQ(location.line(), line + 2 + i);
+    EXPECT_STREQ(location.function(), "TestBody");
+  }
+
+  const LogSourceLocation& location=
+      msgReceiver.messages()[4]->sourceLocation();
+  EXPECT_STREQ(location.file(), "elsewhere.cpp");
+  EXPECT_EQ(location.line(), 7);
+  EXPECT_STREQ(location.function(), "f");
+}
+
+TEST(LogTests, TimestampTest) {
+  const std::string DESTINATION("some.destination");
+  SimpleLogMessageFactory msgFactory(4, 8);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, DESTINATION, LogLevel::INFO);
+  const uint64_t before= LogClock::toNanoseconds(LogClock::now());
+
+  log.info() << "Split across several messages";
+  log.error(PISTIS_FMT("Format {}"), 1);
+
+  const uint64_t after= LogClock::toNanoseconds(LogClock::now());
+  const auto& messages= msgReceiver.messages();
+  ASSERT_GT(messages.size(), 2);
+  for (const auto& msg : messages) {
+    const uint64_t nanos= LogClock::toNanoseconds(msg->timestamp());
+    EXPECT_EQ(msg->timestamp().source(), LogClock::source());
+    EXPECT_GE(nanos, before);
+    EXPECT_LE(nanos, after);
+  }
+
+  // Every part of a statement split across messages has the same time
+  for (size_t i= 1; i < messages.size() - 1; ++i) {
+    EXPECT_EQ(messages[i]->timestamp(), messages[0]->timestamp());
+  }
+}
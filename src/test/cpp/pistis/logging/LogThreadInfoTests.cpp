@@ -0,0 +1,94 @@
+#include <pistis/logging/LogThreadInfo.hpp>
+#include <pistis/logging/SimpleLogMessageFactory.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "helpers/TestingLog.hpp"
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+TEST(LogThreadInfoTests, DefaultIsUnknown) {
+  LogThreadInfo thread;
+
+  EXPECT_FALSE(thread.known());
+  EXPECT_EQ(thread.id(), 0);
+  EXPECT_EQ(thread.name(), "");
+}
+
+TEST(LogThreadInfoTests, Current) {
+  const LogThreadInfo& thread= LogThreadInfo::current();
+
+  EXPECT_TRUE(thread.known());
+  EXPECT_EQ(thread.id(), (uint32_t)syscall(SYS_gettid));
+  EXPECT_EQ(&LogThreadInfo::current(), &thread);
+}
+
+TEST(LogThreadInfoTests, SetCurrentName) {
+  std::thread t([]() {
+    const uint32_t id= LogThreadInfo::current().id();
+    LogThreadInfo::setCurrentName("worker-with-a-long-name");
+
+    EXPECT_EQ(LogThreadInfo::current().id(), id);
+    EXPECT_EQ(LogThreadInfo::current().name(), "worker-with-a-l");
+
+    char name[16];
+    ASSERT_EQ(pthread_getname_np(pthread_self(), name, sizeof(name)), 0);
+    EXPECT_STREQ(name, "worker-with-a-l");
+  });
+  t.join();
+}
+
+TEST(LogThreadInfoTests, RefreshCurrent) {
+  std::thread t([]() {
+    LogThreadInfo::current();
+    pthread_setname_np(pthread_self(), "renamed");
+    EXPECT_NE(LogThreadInfo::current().name(), "renamed");
+
+    LogThreadInfo::refreshCurrent();
+    EXPECT_EQ(LogThreadInfo::current().name(), "renamed");
+  });
+  t.join();
+}
+
+TEST(LogThreadInfoTests, NamesAreInterned) {
+  LogThreadInfo first(1, "pool");
+  LogThreadInfo second(2, "pool");
+
+  EXPECT_EQ(&first.name(), &second.name());
+  EXPECT_NE(first, second);
+  EXPECT_EQ(first, LogThreadInfo(1, "pool"));
+}
+
+TEST(LogThreadInfoTests, WriteToStream) {
+  std::ostringstream out;
+  out << LogThreadInfo(12, "pool") << " " << LogThreadInfo(13, "");
+  EXPECT_EQ(out.str(), "pool:12 13");
+}
+
+TEST(LogThreadInfoTests, MessagesCarryWritingThread) {
+  SimpleLogMessageFactory msgFactory(16, 256);
+  TrackingLogMessageReceiver msgReceiver(&msgFactory);
+  TestingLog log(&msgFactory, &msgReceiver, "some.destination",
+		 LogLevel::INFO);
+  LogThreadInfo worker;
+
+  std::thread t([&log, &worker]() {
+    LogThreadInfo::setCurrentName("writer");
+    worker= LogThreadInfo::current();
+    log.info() << "Stream";
+    log.warn(PISTIS_FMT("Format {}"), 1);
+  });
+  t.join();
+  log.info() << "Main";
+
+  ASSERT_EQ(msgReceiver.messages().size(), 3);
+  EXPECT_EQ(msgReceiver.messages()[0]->thread(), worker);
+  EXPECT_EQ(msgReceiver.messages()[0]->thread().name(), "writer");
+  EXPECT_EQ(msgReceiver.messages()[1]->thread(), worker);
+  EXPECT_EQ(msgReceiver.messages()[2]->thread(), LogThreadInfo::current());
+}
@@ -0,0 +1,98 @@
+#include <pistis/logging/LogThrottle.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace pistis::logging;
+
+TEST(LogThrottleTests, FirstN) {
+  FirstNLogThrottle throttle(3);
+  uint64_t suppressed= 99;
+
+  for (int i= 0; i < 3; ++i) {
+    EXPECT_TRUE(throttle.allow(suppressed));
+    EXPECT_EQ(suppressed, 0);
+  }
+  for (int i= 0; i < 10; ++i) {
+    EXPECT_FALSE(throttle.allow(suppressed));
+  }
+}
+
+TEST(LogThrottleTests, EveryN) {
+  EveryNLogThrottle throttle(5);
+  std::vector<int> allowed;
+  std::vector<uint64_t> suppressedCounts;
+
+  for (int i= 0; i < 12; ++i) {
+    uint64_t suppressed= 99;
+    if (throttle.allow(suppressed)) {
+      allowed.push_back(i);
+      suppressedCounts.push_back(suppressed);
+    }
+  }
+  EXPECT_EQ(allowed, std::vector<int>({ 0, 5, 10 }));
+  EXPECT_EQ(suppressedCounts, std::vector<uint64_t>({ 0, 4, 4 }));
+}
+
+TEST(LogThrottleTests, RateLimit) {
+  RateLimitLogThrottle throttle(2);
+  uint64_t suppressed= 99;
+
+  EXPECT_TRUE(throttle.allow(suppressed, 0));
+  EXPECT_EQ(suppressed, 0);
+  EXPECT_TRUE(throttle.allow(suppressed, 0));
+  EXPECT_EQ(suppressed, 0);
+  EXPECT_FALSE(throttle.allow(suppressed, 0));
+  EXPECT_FALSE(throttle.allow(suppressed, 0));
+  EXPECT_FALSE(throttle.allow(suppressed, 0));
+
+  EXPECT_TRUE(throttle.allow(suppressed, 1));
+  EXPECT_EQ(suppressed, 3);
+  EXPECT_TRUE(throttle.allow(suppressed, 1));
+  EXPECT_EQ(suppressed, 0);
+  EXPECT_FALSE(throttle.allow(suppressed, 1));
+
+  EXPECT_TRUE(throttle.allow(suppressed, 5));
+  EXPECT_EQ(suppressed, 1);
+}
+
+TEST(LogThrottleTests, RateLimitOfZero) {
+  RateLimitLogThrottle throttle(0);
+  uint64_t suppressed= 0;
+
+  EXPECT_FALSE(throttle.allow(suppressed, 0));
+  EXPECT_FALSE(throttle.allow(suppressed, 1));
+}
+
+TEST(LogThrottleTests, SimultaneousEveryN) {
+  static const int NUM_THREADS= 4;
+  static const int NUM_CALLS= 10000;
+  EveryNLogThrottle throttle(10);
+  std::vector<uint64_t> numAllowed(NUM_THREADS, 0);
+  std::vector<uint64_t> numSuppressed(NUM_THREADS, 0);
+  std::vector<std::thread> threads;
+
+  for (int i= 0; i < NUM_THREADS; ++i) {
+    threads.push_back(std::thread([&, i]() {
+      for (int j= 0; j < NUM_CALLS; ++j) {
+	uint64_t suppressed= 0;
+	if (throttle.allow(suppressed)) {
+	  ++numAllowed[i];
+	  numSuppressed[i] += suppressed;
+	}
+      }
+    }));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  uint64_t totalAllowed= 0;
+  uint64_t totalSuppressed= 0;
+  for (int i= 0; i < NUM_THREADS; ++i) {
+    totalAllowed += numAllowed[i];
+    totalSuppressed += numSuppressed[i];
+  }
+  EXPECT_EQ(totalAllowed, NUM_THREADS * NUM_CALLS / 10);
+  EXPECT_EQ(totalAllowed + totalSuppressed, NUM_THREADS * NUM_CALLS - 9);
+}
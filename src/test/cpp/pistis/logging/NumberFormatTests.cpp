@@ -0,0 +1,150 @@
+#include <pistis/logging/NumberFormat.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace pistis::logging;
+
+namespace {
+  template <typename FormatterT>
+  std::string format(FormatterT f) {
+    char buffer[MAX_FORMATTED_NUMBER_SIZE];
+    return std::string(buffer, f(buffer));
+  }
+
+  std::string formatUnsigned(uint64_t v) {
+    return format([v](char* p) {
+      return pistis::logging::formatUnsigned(p, v);
+    });
+  }
+
+  std::string formatSigned(int64_t v) {
+    return format([v](char* p) {
+      return pistis::logging::formatSigned(p, v);
+    });
+  }
+
+  std::string formatDouble(double v) {
+    return format([v](char* p) {
+      return pistis::logging::formatDouble(p, v);
+    });
+  }
+}
+
+TEST(NumberFormatTests, FormatIntegers) {
+  uint64_t v= 1;
+  EXPECT_EQ(formatUnsigned(0), "0");
+  for (int i= 1; i < 20; ++i) {
+    v *= 10;
+    EXPECT_EQ(formatUnsigned(v - 1), std::to_string(v - 1));
+    EXPECT_EQ(formatUnsigned(v), std::to_string(v));
+  }
+  EXPECT_EQ(formatUnsigned(std::numeric_limits<uint64_t>::max()),
+	    std::to_string(std::numeric_limits<uint64_t>::max()));
+
+  EXPECT_EQ(formatSigned(0), "0");
+  EXPECT_EQ(formatSigned(-7), "-7");
+  EXPECT_EQ(formatSigned(-1234567), "-1234567");
+  EXPECT_EQ(formatSigned(std::numeric_limits<int64_t>::min()),
+	    std::to_string(std::numeric_limits<int64_t>::min()));
+  EXPECT_EQ(formatSigned(std::numeric_limits<int64_t>::max()),
+	    std::to_string(std::numeric_limits<int64_t>::max()));
+}
+
+TEST(NumberFormatTests, FormatHexAndPointers) {
+  int x= 0;
+  std::ostringstream truth;
+
+  truth << (const void*)&x;
+  EXPECT_EQ(format([](char* p) { return formatHex(p, 0); }), "0");
+  EXPECT_EQ(format([](char* p) { return formatHex(p, 0xABCDEF); }), "abcdef");
+  EXPECT_EQ(format([](char* p) { return formatHex(p, 0xABCDEF, true); }),
+	    "ABCDEF");
+  EXPECT_EQ(format([](char* p) { return formatHex(p, ~(uint64_t)0); }),
+	    "ffffffffffffffff");
+  EXPECT_EQ(format([&x](char* p) { return formatPointer(p, &x); }),
+	    truth.str());
+}
+
+TEST(NumberFormatTests, FormatShortestDouble) {
+  EXPECT_EQ(formatDouble(0.0), "0");
+  EXPECT_EQ(formatDouble(-0.0), "-0");
+  EXPECT_EQ(formatDouble(250.0), "250");
+  EXPECT_EQ(formatDouble(-3.0), "-3");
+  EXPECT_EQ(formatDouble(0.1), "0.1");
+  EXPECT_EQ(formatDouble(0.25), "0.25");
+  EXPECT_EQ(formatDouble(1.0/3.0), "0.3333333333333333");
+  EXPECT_EQ(formatDouble(1e15), "1e+15");
+  EXPECT_EQ(formatDouble(1e100), "1e+100");
+  EXPECT_EQ(formatDouble(std::numeric_limits<double>::max()),
+	    "1.7976931348623157e+308");
+  EXPECT_EQ(formatDouble(std::numeric_limits<double>::denorm_min()),
+	    "5e-324");
+  EXPECT_EQ(formatDouble(std::numeric_limits<double>::min()),
+	    "2.2250738585072014e-308");
+  EXPECT_EQ(formatDouble(1e23), "1e+23");
+  EXPECT_EQ(formatDouble(-2.5e-7), "-2.5e-07");
+  EXPECT_EQ(formatDouble(1.5e-5), "1.5e-05");
+  EXPECT_EQ(formatDouble(0.0001), "0.0001");
+  EXPECT_EQ(formatDouble(123456789012345.6), "123456789012345.6");
+  EXPECT_EQ(formatDouble(9007199254740993.0), "9007199254740992");
+  EXPECT_EQ(formatDouble(std::numeric_limits<double>::infinity()), "inf");
+  EXPECT_EQ(formatDouble(-std::numeric_limits<double>::infinity()), "-inf");
+  EXPECT_EQ(formatDouble(std::numeric_limits<double>::quiet_NaN()), "nan");
+
+  std::mt19937_64 random(1);
+  for (int i= 0; i < 10000; ++i) {
+    uint64_t bits= random();
+    double v;
+    memcpy(&v, &bits, sizeof(v));
+    if (isfinite(v)) {
+      const std::string text= formatDouble(v);
+      ASSERT_EQ(strtod(text.c_str(), nullptr), v) << text;
+      ASSERT_LT(text.size(), MAX_FORMATTED_NUMBER_SIZE);
+    }
+  }
+}
+
+TEST(NumberFormatTests, FormatDoubleWithPrecision) {
+  const double VALUES[]= {
+    0.0, -0.0, 1.0/3.0, 250.0, -99999.0, 1e100, -2.5e-7, 123456789.0,
+    12345678901234567.0
+  };
+  for (double v : VALUES) {
+    for (int precision= 0; precision <= MAX_DOUBLE_FORMAT_PRECISION;
+	 ++precision) {
+      std::ostringstream truth;
+      truth.precision(precision);
+      truth << v;
+      EXPECT_EQ(format([=](char* p) { return formatDouble(p, v, precision); }),
+		truth.str());
+    }
+  }
+}
+
+TEST(NumberFormatTests, NumberFormatKindOf) {
+  EXPECT_EQ(NumberFormatKindOf<int>::value, NumberFormatKind::SIGNED);
+  EXPECT_EQ(NumberFormatKindOf<const long>::value, NumberFormatKind::SIGNED);
+  EXPECT_EQ(NumberFormatKindOf<uint32_t>::value, NumberFormatKind::UNSIGNED);
+  EXPECT_EQ(NumberFormatKindOf<double>::value,
+	    NumberFormatKind::FLOATING_POINT);
+  EXPECT_EQ(NumberFormatKindOf<float>::value,
+	    NumberFormatKind::FLOATING_POINT);
+  EXPECT_EQ(NumberFormatKindOf<int*>::value, NumberFormatKind::POINTER);
+  EXPECT_EQ(NumberFormatKindOf<const void*>::value,
+	    NumberFormatKind::POINTER);
+
+  EXPECT_EQ(NumberFormatKindOf<bool>::value, NumberFormatKind::NONE);
+  EXPECT_EQ(NumberFormatKindOf<char>::value, NumberFormatKind::NONE);
+  EXPECT_EQ(NumberFormatKindOf<unsigned char>::value, NumberFormatKind::NONE);
+  EXPECT_EQ(NumberFormatKindOf<wchar_t>::value, NumberFormatKind::NONE);
+  EXPECT_EQ(NumberFormatKindOf<long double>::value, NumberFormatKind::NONE);
+  EXPECT_EQ(NumberFormatKindOf<const char*>::value, NumberFormatKind::NONE);
+  EXPECT_EQ(NumberFormatKindOf<char[4]>::value, NumberFormatKind::NONE);
+  EXPECT_EQ(NumberFormatKindOf<std::string>::value, NumberFormatKind::NONE);
+}
@@ -0,0 +1,51 @@
+#include <pistis/logging/LogMessageWriter.hpp>
+#include <pistis/logging/ReassemblingLogMessageReceiver.hpp>
+#include <pistis/logging/SimpleLogMessageFactory.hpp>
+#include <gtest/gtest.h>
+
+#include "helpers/TrackingLogMessageReceiver.hpp"
+
+using namespace pistis::logging;
+
+namespace {
+  std::string toText(const LogMessage* msg) {
+    return std::string(msg->begin(), msg->end());
+  }
+}
+
+TEST(ReassemblingLogMessageReceiverTests, PartsAreKeptTogether) {
+  SimpleLogMessageFactory msgFactory(16, 16);
+  TrackingLogMessageReceiver tracker(&msgFactory);
+  ReassemblingLogMessageReceiver receiver(&tracker);
+  LogMessageWriter first(msgFactory, receiver, "first", LogLevel::INFO);
+  LogMessageWriter second(msgFactory, receiver, "second", LogLevel::INFO);
+
+  first.write("aaaaaaaaaaaaaaaabbbb", 20);
+  second.write("short", 5);
+  second.flush();
+  EXPECT_EQ(receiver.numPending(), 1);
+  ASSERT_EQ(tracker.messages().size(), 1);
+  EXPECT_EQ(toText(tracker.messages()[0]), "short");
+
+  first.flush();
+  EXPECT_EQ(receiver.numPending(), 0);
+  ASSERT_EQ(tracker.messages().size(), 3);
+  EXPECT_EQ(toText(tracker.messages()[1]), "aaaaaaaaaaaaaaaa");
+  EXPECT_EQ(toText(tracker.messages()[2]), "bbbb");
+}
+
+TEST(ReassemblingLogMessageReceiverTests, IncompleteStatementsPassedOnAtEnd) {
+  SimpleLogMessageFactory msgFactory(16, 16);
+  TrackingLogMessageReceiver tracker(&msgFactory);
+
+  {
+    ReassemblingLogMessageReceiver receiver(&tracker);
+    LogMessage* part= msgFactory.get();
+    part->setPart(LogMessage::newStatementId(), 0, false);
+    receiver.receive(part);
+    EXPECT_EQ(tracker.messages().size(), 0);
+  }
+
+  ASSERT_EQ(tracker.messages().size(), 1);
+  EXPECT_FALSE(tracker.messages()[0]->isFinalPart());
+}
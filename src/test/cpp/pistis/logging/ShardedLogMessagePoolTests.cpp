@@ -0,0 +1,175 @@
+#include <pistis/logging/ShardedLogMessagePool.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "helpers/CountingLogMemoryResource.hpp"
+#include "helpers/TestingLogCpuTopology.hpp"
+
+using namespace pistis::logging;
+
+TEST(ShardedLogMessagePoolTests, GetFromLocalNode) {
+  TestingLogCpuTopology topology({ 0, 0, 1, 1 });
+  ShardedLogMessagePool pool(128, 1024, 256, 2, 4, LogShardPolicy::PER_NODE,
+			     topology);
+
+  EXPECT_EQ(pool.numShards(), 2);
+  EXPECT_EQ(pool.numMessagesInShard(0), 2);
+  EXPECT_EQ(pool.numMessagesInShard(1), 2);
+
+  topology.setCpu(3);
+  EXPECT_EQ(pool.currentShard(), 1);
+  LogMessage* msg= pool.get();
+  EXPECT_TRUE(msg->empty());
+  EXPECT_EQ(pool.numMessagesInShard(0), 2);
+  EXPECT_EQ(pool.numMessagesInShard(1), 1);
+  EXPECT_EQ(pool.numMessagesActive(), 1);
+
+  // A message released on another node goes back to its own
+  topology.setCpu(0);
+  pool.release(msg);
+  EXPECT_EQ(pool.numMessagesInShard(0), 2);
+  EXPECT_EQ(pool.numMessagesInShard(1), 2);
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+  EXPECT_EQ(pool.numRemoteGets(), 0);
+}
+
+TEST(ShardedLogMessagePoolTests, FallBackToNearestShard) {
+  TestingLogCpuTopology topology({ 0, 0, 1, 1 });
+  ShardedLogMessagePool pool(128, 1024, 256, 1, 4, LogShardPolicy::PER_CPU,
+			     topology);
+  std::vector<LogMessage*> msgs;
+
+  EXPECT_EQ(pool.numShards(), 4);
+
+  // CPU 2 takes its own message, then the one from CPU 3 on the same
+  // node, then one from the other node
+  topology.setCpu(2);
+  for (int i= 0; i < 3; ++i) {
+    msgs.push_back(pool.get());
+  }
+  EXPECT_EQ(pool.numMessagesInShard(0) + pool.numMessagesInShard(1), 1);
+  EXPECT_EQ(pool.numMessagesInShard(2), 0);
+  EXPECT_EQ(pool.numMessagesInShard(3), 0);
+  EXPECT_EQ(pool.numRemoteGets(), 2);
+
+  // When every shard is empty, the new message belongs to the caller's
+  topology.setCpu(0);
+  msgs.push_back(pool.get());
+  msgs.push_back(pool.get());
+  EXPECT_EQ(pool.numRemoteGets(), 3);
+  EXPECT_EQ(pool.numMessagesActive(), 5);
+
+  for (auto msg : msgs) {
+    pool.release(msg);
+  }
+  EXPECT_EQ(pool.numMessagesInShard(0), 2);
+  EXPECT_EQ(pool.numMessagesInShard(1), 1);
+  EXPECT_EQ(pool.numMessagesInShard(2), 1);
+  EXPECT_EQ(pool.numMessagesInShard(3), 1);
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+}
+
+TEST(ShardedLogMessagePoolTests, ShardPerCpuWithGaps) {
+  // CPUs 1 and 3 are offline
+  const uint32_t NO_NODE= LogCpuTopology::NO_NODE;
+  TestingLogCpuTopology topology({ 0, NO_NODE, 0, NO_NODE, 1, 1 });
+  ShardedLogMessagePool pool(128, 1024, 256, 1, 4, LogShardPolicy::PER_CPU,
+			     topology);
+  std::vector<size_t> shards;
+
+  EXPECT_EQ(pool.numShards(), 4);
+  for (auto cpu : topology.cpus()) {
+    topology.setCpu(cpu);
+    shards.push_back(pool.currentShard());
+  }
+  EXPECT_EQ(shards, std::vector<size_t>({ 0, 1, 2, 3 }));
+
+  // CPU 2 falls back to CPU 0, on the same node, before the others
+  topology.setCpu(2);
+  LogMessage* own= pool.get();
+  LogMessage* borrowed= pool.get();
+  EXPECT_EQ(pool.numMessagesInShard(0), 0);
+  EXPECT_EQ(pool.numMessagesInShard(2), 1);
+  EXPECT_EQ(pool.numMessagesInShard(3), 1);
+  pool.release(own);
+  pool.release(borrowed);
+  EXPECT_EQ(pool.numMessagesInShard(0), 1);
+  EXPECT_EQ(pool.numMessagesInShard(1), 1);
+}
+
+TEST(ShardedLogMessagePoolTests, AllocateFromEachNodesResource) {
+  TestingLogCpuTopology topology({ 0, 0, 1, 1 });
+  CountingLogMemoryResource node0;
+  CountingLogMemoryResource node1;
+  std::vector<LogMessage*> msgs;
+
+  {
+    ShardedLogMessagePool pool(128, 1024, 256, 1, 4,
+			       LogShardPolicy::PER_CPU, topology,
+			       { &node0, &node1 });
+    EXPECT_EQ(pool.nodeResource(1), &node1);
+    EXPECT_EQ(node0.numAllocations(), 2);
+    EXPECT_EQ(node1.numAllocations(), 2);
+
+    // Messages made after a miss come from the caller's node, and grow
+    // there too
+    topology.setCpu(3);
+    for (int i= 0; i < 5; ++i) {
+      msgs.push_back(pool.get());
+    }
+    EXPECT_EQ(node0.numAllocations(), 2);
+    EXPECT_EQ(node1.numAllocations(), 3);
+    msgs.back()->increaseCapacity(512);
+    EXPECT_EQ(node0.numAllocations(), 2);
+    EXPECT_GT(node1.numAllocations(), 3);
+
+    for (auto msg : msgs) {
+      pool.release(msg);
+    }
+  }
+  EXPECT_EQ(node0.numOutstanding(), 0);
+  EXPECT_EQ(node1.numOutstanding(), 0);
+}
+
+TEST(ShardedLogMessagePoolTests, ResourceForEachNode) {
+  TestingLogCpuTopology topology({ 0, 0, 1, 1 });
+  CountingLogMemoryResource resource;
+  const std::vector<LogMemoryResource*> tooFew(1, &resource);
+
+  EXPECT_THROW(ShardedLogMessagePool(128, 1024, 256, 1, 4,
+				     LogShardPolicy::PER_NODE, topology,
+				     tooFew),
+	       std::invalid_argument);
+  EXPECT_THROW(ShardedLogMessagePool(128, 1024, 256, 1, 4,
+				     LogShardPolicy::PER_NODE, topology,
+				     { &resource, nullptr }),
+	       std::invalid_argument);
+}
+
+TEST(ShardedLogMessagePoolTests, ManyThreadsOnSystemTopology) {
+  ShardedLogMessagePool pool(128, 1024, 256, 4, 64);
+  std::vector<std::thread> threads;
+
+  for (int t= 0; t < 4; ++t) {
+    threads.emplace_back([&pool]() {
+      for (int i= 0; i < 1000; ++i) {
+	LogMessage* msg= pool.get();
+	EXPECT_TRUE(msg->empty());
+	msg->setEnd(msg->begin() + 1);
+	pool.release(msg);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(pool.numShards(), LogCpuTopology::system().numNodes());
+  EXPECT_EQ(pool.numMessagesActive(), 0);
+}
+
+TEST(ShardedLogMessagePoolTests, InvalidShard) {
+  ShardedLogMessagePool pool(128, 1024, 256, 0, 4);
+  EXPECT_THROW(pool.numMessagesInShard(pool.numShards()),
+	       std::invalid_argument);
+}
@@ -0,0 +1,73 @@
+#include <pistis/logging/Utf8.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace pistis::logging;
+
+namespace {
+  std::string encode(const std::wstring& text, size_t outSize,
+		     size_t& nRead) {
+    std::string out(outSize, '\0');
+    size_t nWritten= 0;
+    nRead= encodeUtf8(text.data(), text.size(), &out[0], outSize, nWritten);
+    out.resize(nWritten);
+    return out;
+  }
+
+  std::string encode(const std::wstring& text) {
+    size_t nRead= 0;
+    std::string out= encode(text, text.size() * MAX_UTF8_BYTES_PER_WCHAR,
+			    nRead);
+    EXPECT_EQ(nRead, text.size());
+    return out;
+  }
+}
+
+TEST(Utf8Tests, EncodeAscii) {
+  EXPECT_EQ(encode(L""), "");
+  EXPECT_EQ(encode(L"a"), "a");
+
+  // Long enough to take the vectorized path
+  const std::string ascii=
+      "The quick brown fox jumps over the lazy dog 0123456789 "
+      "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG\x7F";
+  EXPECT_EQ(encode(std::wstring(ascii.begin(), ascii.end())), ascii);
+}
+
+TEST(Utf8Tests, EncodeMultibyte) {
+  EXPECT_EQ(encode(L"é"), "\xC3\xA9");
+  EXPECT_EQ(encode(L"߿ࠀ"), "\xDF\xBF\xE0\xA0\x80");
+  EXPECT_EQ(encode(L"€"), "\xE2\x82\xAC");
+  EXPECT_EQ(encode(L"\U0001F600"), "\xF0\x9F\x98\x80");
+  EXPECT_EQ(encode(L"\U0010FFFF"), "\xF4\x8F\xBF\xBF");
+
+  // Non-ASCII characters in the middle and at the end of a long ASCII run
+  EXPECT_EQ(encode(L"0123456789abcdefghijéklmnopqrstuvwxyz0123456789€"),
+	    "0123456789abcdefghij\xC3\xA9klmnopqrstuvwxyz0123456789"
+	    "\xE2\x82\xAC");
+}
+
+TEST(Utf8Tests, ReplaceInvalidCharacters) {
+  std::wstring text;
+  text.push_back((wchar_t)0xD800);
+  text.push_back(L'x');
+  text.push_back((wchar_t)0xDFFF);
+  EXPECT_EQ(encode(text), "\xEF\xBF\xBD" "x" "\xEF\xBF\xBD");
+
+  if (sizeof(wchar_t) == 4) {
+    text.assign(1, (wchar_t)0x110000);
+    EXPECT_EQ(encode(text), "\xEF\xBF\xBD");
+  }
+}
+
+TEST(Utf8Tests, StopBeforeSplittingCharacter) {
+  size_t nRead= 0;
+  EXPECT_EQ(encode(L"ab€c", 4, nRead), "ab");
+  EXPECT_EQ(nRead, 2);
+  EXPECT_EQ(encode(L"ab€c", 5, nRead), "ab\xE2\x82\xAC");
+  EXPECT_EQ(nRead, 3);
+
+  const std::wstring longAscii(40, L'z');
+  EXPECT_EQ(encode(longAscii, 17, nRead), std::string(17, 'z'));
+  EXPECT_EQ(nRead, 17);
+}
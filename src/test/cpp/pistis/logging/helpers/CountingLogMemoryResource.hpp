@@ -0,0 +1,57 @@
+#ifndef __PISTIS__LOGGING__HELPERS__COUNTINGLOGMEMORYRESOURCE_HPP__
+#define __PISTIS__LOGGING__HELPERS__COUNTINGLOGMEMORYRESOURCE_HPP__
+
+#include <pistis/logging/LogMemoryResource.hpp>
+#include <gtest/gtest.h>
+#include <map>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief Allocates from the heap and keeps track of every allocation
+     *         that has not been returned
+     */
+    class CountingLogMemoryResource : public LogMemoryResource {
+    public:
+      CountingLogMemoryResource(): allocations_(), numAllocations_(0) { }
+
+      size_t numAllocations() const { return numAllocations_; }
+      size_t numOutstanding() const { return allocations_.size(); }
+
+      size_t bytesOutstanding() const {
+	size_t n= 0;
+	for (const auto& a : allocations_) {
+	  n += a.second;
+	}
+	return n;
+      }
+
+      bool owns(const void* p) const {
+	return allocations_.count(p) > 0;
+      }
+
+    protected:
+      virtual void* allocate_(size_t bytes, size_t alignment) override {
+	void* p= defaultResource()->allocate(bytes, alignment);
+	allocations_[p]= bytes;
+	++numAllocations_;
+	return p;
+      }
+
+      virtual void deallocate_(void* p, size_t bytes,
+			       size_t alignment) override {
+	auto i= allocations_.find(p);
+	ASSERT_NE(i, allocations_.end());
+	EXPECT_EQ(i->second, bytes);
+	allocations_.erase(i);
+	defaultResource()->deallocate(p, bytes, alignment);
+      }
+
+    private:
+      std::map<const void*, size_t> allocations_;
+      size_t numAllocations_;
+    };
+
+  }
+}
+#endif
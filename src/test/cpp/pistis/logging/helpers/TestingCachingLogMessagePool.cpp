@@ -0,0 +1,14 @@
+#include "TestingCachingLogMessagePool.hpp"
+
+using namespace pistis::logging;
+
+TestingCachingLogMessagePool::TestingCachingLogMessagePool(
+    size_t initialMessageSize, size_t maxMessageSize,
+    size_t maxReturnedMessageSize, uint32_t initialPoolSize,
+    uint32_t maxPoolSize, uint32_t threadCacheSize
+):
+    CachingLogMessagePool(initialMessageSize, maxMessageSize,
+			  maxReturnedMessageSize, initialPoolSize,
+			  maxPoolSize, threadCacheSize) {
+  // Intentionally left blank
+}
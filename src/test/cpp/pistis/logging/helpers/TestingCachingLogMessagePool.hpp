@@ -0,0 +1,41 @@
+#ifndef __PISTIS__LOGGING__HELPERS__TESTINGCACHINGLOGMESSAGEPOOL_HPP__
+#define __PISTIS__LOGGING__HELPERS__TESTINGCACHINGLOGMESSAGEPOOL_HPP__
+
+#include <pistis/logging/CachingLogMessagePool.hpp>
+
+namespace pistis {
+  namespace logging {
+
+    class TestingCachingLogMessagePool : public CachingLogMessagePool {
+    public:
+      TestingCachingLogMessagePool(size_t initialMessageSize,
+				   size_t maxMessageSize,
+				   size_t maxReturnedMessageSize,
+				   uint32_t initialPoolSize,
+				   uint32_t maxPoolSize,
+				   uint32_t threadCacheSize);
+
+      /** @brief Number of messages in the shared pool */
+      size_t numMessagesInPool() const { return numMessagesInPool_(); }
+
+      /** @brief Number of messages in the calling thread's cache */
+      size_t numMessagesInThreadCache() {
+	return numMessagesInThreadCache_();
+      }
+
+      /** @brief Number of pools the calling thread keeps a cache for */
+      static size_t numThreadCacheEntries() {
+	return numThreadCacheEntries_();
+      }
+
+      /** @brief Number of messages other threads have returned to the
+       *         calling thread that it has not taken back yet
+       */
+      size_t numMessagesReturnedToThread() {
+	return numMessagesReturnedToThread_();
+      }
+    };
+
+  }
+}
+#endif
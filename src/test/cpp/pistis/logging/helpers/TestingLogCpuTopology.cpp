@@ -0,0 +1,15 @@
+#include "TestingLogCpuTopology.hpp"
+
+using namespace pistis::logging;
+
+TestingLogCpuTopology::TestingLogCpuTopology(
+    const std::vector<uint32_t>& nodeOfCpu,
+    const std::vector< std::vector<uint32_t> >& distances
+):
+    LogCpuTopology(nodeOfCpu, distances), cpu_(0) {
+  // Intentionally left blank
+}
+
+uint32_t TestingLogCpuTopology::currentCpu_() const {
+  return cpu_.load();
+}
@@ -0,0 +1,31 @@
+#ifndef __PISTIS__LOGGING__HELPERS__TESTINGLOGCPUTOPOLOGY_HPP__
+#define __PISTIS__LOGGING__HELPERS__TESTINGLOGCPUTOPOLOGY_HPP__
+
+#include <pistis/logging/LogCpuTopology.hpp>
+#include <atomic>
+
+namespace pistis {
+  namespace logging {
+
+    /** @brief LogCpuTopology whose threads run on whichever CPU the test
+     *         says they do
+     */
+    class TestingLogCpuTopology : public LogCpuTopology {
+    public:
+      TestingLogCpuTopology(const std::vector<uint32_t>& nodeOfCpu,
+			    const std::vector< std::vector<uint32_t> >&
+			        distances=
+			            std::vector< std::vector<uint32_t> >());
+
+      void setCpu(uint32_t cpu) { cpu_= cpu; }
+
+    protected:
+      virtual uint32_t currentCpu_() const;
+
+    private:
+      std::atomic<uint32_t> cpu_;
+    };
+
+  }
+}
+#endif
@@ -14,3 +14,13 @@ TestingLogMessagePool::TestingLogMessagePool(
 
 
 
+
+TestingLogMessagePool::TestingLogMessagePool(
+    size_t initialMessageSize, size_t maxMessageSize,
+    size_t maxReturnedMessageSize, uint32_t initialPoolSize,
+    const LogPoolSizingPolicy& sizingPolicy
+):
+    LogMessagePool(initialMessageSize, maxMessageSize, maxReturnedMessageSize,
+		   initialPoolSize, sizingPolicy) {
+  // Intentionally left blank
+}
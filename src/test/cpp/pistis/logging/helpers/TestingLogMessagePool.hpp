@@ -11,6 +11,10 @@ namespace pistis {
       TestingLogMessagePool(size_t initialMessageSize, size_t maxMessageSize,
 			    size_t maxReturnedMessageSize,
 			    uint32_t initialPoolSize, uint32_t maxPoolSize);
+      TestingLogMessagePool(size_t initialMessageSize, size_t maxMessageSize,
+			    size_t maxReturnedMessageSize,
+			    uint32_t initialPoolSize,
+			    const LogPoolSizingPolicy& sizingPolicy);
 
       /** @brief Return the number of messages currently in the pool
        *
@@ -18,6 +22,11 @@ namespace pistis {
        */
       size_t numMessagesInPool() const { return numMessagesInPool_(); }
 
+      /** @brief Return the number of messages in one size class */
+      size_t numMessagesInSizeClass(size_t sizeClass) const {
+	return numMessagesInSizeClass_(sizeClass);
+      }
+
       /** @brief Retrieve the messages currently in the pool
        *
        *  This method is NOT thread safe and should only be invoked when
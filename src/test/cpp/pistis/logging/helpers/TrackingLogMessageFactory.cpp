@@ -23,7 +23,8 @@ void TrackingLogMessageFactory::clear() {
 
 LogMessage* TrackingLogMessageFactory::get_() {
   std::unique_lock<std::mutex> lock(sync_);
-  issuedMsgs_.push_back(new LogMessage(initialMessageSize(), maxMessageSize()));
+  issuedMsgs_.push_back(LogMessage::create(initialMessageSize(),
+					   maxMessageSize()));
   return issuedMsgs_.back();
 }
 
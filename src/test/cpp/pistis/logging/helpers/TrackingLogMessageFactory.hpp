@@ -38,6 +38,7 @@ namespace pistis {
       void clear();
 
     protected:
+      using AbstractLogMessageFactory::get_;
       virtual LogMessage* get_();
       virtual void release_(LogMessage* msg);
 
@@ -23,4 +23,5 @@ void TrackingLogMessageReceiver::receive(LogMessage* msg) {
 void TrackingLogMessageReceiver::flush() {
   std::for_each(msgs_.begin(), msgs_.end(),
 		[this](LogMessage* msg) { factory_->release(msg); });
+  msgs_.clear();
 }